@@ -1,10 +1,18 @@
 #include "AppController.h"
 #include "../services/infrastructure/ProcessMonitor.h"
 #include "ApplicationRepository.h"
+#include "SessionHistoryStore.h"
 #include "CategorizationManager.h"
 #include "../services/infrastructure/ProcessMonitor.h"
 #include "../services/application/ProcessEventDispatcher.h"
 #include "GameSessionManager.h"
+#include "../services/infrastructure/TimeSource.h"
+#include "../services/infrastructure/ProcessTrace.h"
+#include "../services/infrastructure/ResourceWatchdog.h"
+#include "../services/metrics/Metrics.h"
+#include "../services/metrics/MetricsServer.h"
+#include "../services/metrics/TraceSpans.h"
+#include "EventLogger.h"
 #include "ConfigWindow.h"
 
 #include <QSystemTrayIcon>
@@ -12,12 +20,15 @@
 #include <QMenu>
 #include <QIcon>
 #include <QThread>
+#include <QTimer>
 
 AppController::AppController(QObject *parent)
     : QObject(parent),
       m_appRepository(nullptr),
+      m_sessionHistory(nullptr),
       m_processMonitorService(nullptr),
       m_processEventDispatcherService(nullptr),
+      m_processRecorder(nullptr),
       m_sessionManager(nullptr),
       m_configWindow(nullptr),
       m_trayIcon(nullptr)
@@ -26,16 +37,65 @@ AppController::AppController(QObject *parent)
 
     // Repositories
     m_appRepository = new ApplicationRepository();
+    m_sessionHistory = new SessionHistoryStore();
 
     // Managers
-    m_sessionManager = new GameSessionManager(this);
+    m_sessionManager = new GameSessionManager(m_appRepository, m_sessionHistory, TimeSource::system(), this);
     m_categorizationManager = new CategorizationManager(m_appRepository, this);
 
     // Services
 
+    // With MINDFULNESS_PROCESS_TRACE set, every change to the process list
+    // is also written to that file, to be replayed offline later.
+    ProcessSource* processSource = ProcessSource::system();
+    const QString tracePath = qEnvironmentVariable("MINDFULNESS_PROCESS_TRACE");
+    if (!tracePath.isEmpty()) {
+        m_processRecorder = new RecordingProcessSource(processSource, TimeSource::system());
+        if (m_processRecorder->open(tracePath)) {
+            processSource = m_processRecorder;
+        }
+    }
+
+    // MINDFULNESS_METRICS_SOCKET serves the metrics on a local socket;
+    // MINDFULNESS_METRICS_FILE gets a fresh snapshot every METRICS_INTERVAL_MS.
+    const QString metricsSocket = qEnvironmentVariable("MINDFULNESS_METRICS_SOCKET");
+    if (!metricsSocket.isEmpty()) {
+        MetricsServer* metricsServer = new MetricsServer(this);
+        if (!metricsServer->listen(metricsSocket)) {
+            MF_LOG_WARNING(General, "Cannot serve metrics on %1: %2", metricsSocket, metricsServer->errorString());
+        }
+    }
+    m_metricsPath = qEnvironmentVariable("MINDFULNESS_METRICS_FILE");
+    if (!m_metricsPath.isEmpty()) {
+        QTimer* metricsTimer = new QTimer(this);
+        connect(metricsTimer, &QTimer::timeout, this, [this]() {
+            MetricsRegistry::writeSnapshot(m_metricsPath);
+        });
+        metricsTimer->start(METRICS_INTERVAL_MS);
+    }
+
+    // MINDFULNESS_SPAN_TRACE turns on trace spans; they are written there as
+    // Chrome trace-event JSON from the tray menu and at exit. With
+    // MINDFULNESS_SPAN_WINDOW_MS as well, the file is also rewritten that
+    // often with just the spans of the last window.
+    m_spanTracePath = qEnvironmentVariable("MINDFULNESS_SPAN_TRACE");
+    if (!m_spanTracePath.isEmpty()) {
+        SpanTracer::setThreadName("main");
+        SpanTracer::setEnabled(true);
+        const int windowMs = qEnvironmentVariableIntValue("MINDFULNESS_SPAN_WINDOW_MS");
+        if (windowMs > 0) {
+            QTimer* spanTimer = new QTimer(this);
+            connect(spanTimer, &QTimer::timeout, this, [this, windowMs]() {
+                SpanTracer::writeChromeTrace(m_spanTracePath, qint64(windowMs) * 1000000);
+            });
+            spanTimer->start(windowMs);
+        }
+    }
+
     // The ProcessMonitor must have no parent (parent = nullptr)
     // so it can be moved to a different thread.
-    m_processMonitorService = new ProcessMonitor();  // Infrastructure
+    // It only reads the repository through its lock-free published snapshot.
+    m_processMonitorService = new ProcessMonitor(m_appRepository, TimeSource::system(), processSource);  // Infrastructure
     m_processEventDispatcherService = new ProcessEventDispatcher(m_appRepository, m_categorizationManager, this);
 
     // --- 2. Create Process Monitor and its Thread ---
@@ -79,6 +139,28 @@ AppController::AppController(QObject *parent)
     connect(monitorThread, &QThread::finished,
             monitorThread, &QObject::deleteLater);
 
+    // Keep our own CPU and memory use out of the user's way: over budget the
+    // monitor is throttled and only warnings are logged until usage drops.
+    // MINDFULNESS_CPU_BUDGET (percent of one core) and MINDFULNESS_RSS_BUDGET_MB
+    // replace the default budgets; 0 turns one off.
+    ResourceWatchdog::Budget budget;
+    bool budgetSet = false;
+    const double cpuBudget = qEnvironmentVariable("MINDFULNESS_CPU_BUDGET").toDouble(&budgetSet);
+    if (budgetSet) {
+        budget.cpuPercent = cpuBudget;
+    }
+    const qint64 rssBudgetMb = qEnvironmentVariable("MINDFULNESS_RSS_BUDGET_MB").toLongLong(&budgetSet);
+    if (budgetSet) {
+        budget.rssBytes = rssBudgetMb * 1024 * 1024;
+    }
+    ResourceWatchdog* watchdog = new ResourceWatchdog(budget, TimeSource::system(), ResourceWatchdog::Sampler(), this);
+    connect(watchdog, &ResourceWatchdog::throttleChanged,
+            m_processMonitorService, &ProcessMonitor::setThrottled);
+    connect(watchdog, &ResourceWatchdog::throttleChanged, this, [](bool throttled) {
+        LogFilter::setFloor(throttled ? MF_LOG_LEVEL_WARNING : MF_LOG_LEVEL_DEBUG);
+    });
+    watchdog->start();
+
     // --- 5. Start the Thread ---
     monitorThread->start();
 }
@@ -91,6 +173,17 @@ AppController::~AppController()
     // We must manually delete the components we created
     // that are not QObject children.
     delete m_appRepository; // m_gameList is not a QObject
+    delete m_sessionHistory;
+
+    // The monitor thread has finished, so nothing polls the recorder anymore
+    delete m_processRecorder;
+
+    if (!m_metricsPath.isEmpty()) {
+        MetricsRegistry::writeSnapshot(m_metricsPath);
+    }
+    if (!m_spanTracePath.isEmpty()) {
+        SpanTracer::writeChromeTrace(m_spanTracePath);
+    }
     
     // m_configWindow is a widget. If it's still open, delete it.
     // We set WA_DeleteOnClose, but this is a final fallback.
@@ -106,28 +199,24 @@ void AppController::onShowConfig()
         return;
     }
 
-    QList<Application*> gameApps;
-    QList<Application*> otherApps;
+    m_configWindow = new ConfigWindow(nullptr);
 
-    QList<Application*> allApps = m_appRepository->findAll();
-
-    for(Application* app : allApps){
-        if(app == nullptr) continue;
-
-        Application::Category cat = app->getCategory();
-
-        if(cat == Application::Category::Game || cat == Application::Category::Leisure){
-            gameApps.append(app);
-        }else{
-            otherApps.append(app);
-        }
-    }
-
-        
-
-
-    
-    m_configWindow = new ConfigWindow(gameApps, otherApps, nullptr);
+    // Fill the window straight from the repository's indexes; entries are
+    // read in place, nothing is copied or collected first
+    ApplicationQuery games = ApplicationQuery().inCategories({
+        Application::Category::Game,
+        Application::Category::Leisure
+    });
+    ApplicationQuery otherApps = ApplicationQuery().excludingCategories({
+        Application::Category::Game,
+        Application::Category::Leisure
+    });
+    m_appRepository->forEach(games, [this](const Application& app) {
+        m_configWindow->addGame(app);
+    });
+    m_appRepository->forEach(otherApps, [this](const Application& app) {
+        m_configWindow->addOtherApplication(app);
+    });
 
     // This attribute tells Qt to delete the widget
     // when it's closed (e.g., user clicks the 'X').
@@ -145,12 +234,19 @@ void AppController::onShowConfig()
     m_configWindow->raise();
 }
 
+void AppController::onSaveTrace()
+{
+    if (!SpanTracer::writeChromeTrace(m_spanTracePath)) {
+        MF_LOG_WARNING(General, "Cannot write trace spans to %1", m_spanTracePath);
+    }
+}
+
 void AppController::onQuit(){
     // Hide icon immediately
     m_trayIcon->hide();
 
-    // Tell the monitor to stop its internal QTimer
-    m_processMonitorService->stopMonitor();
+    // Tell the monitor to stop polling; its scheduler lives on the monitor thread
+    QMetaObject::invokeMethod(m_processMonitorService, &ProcessMonitor::stopMonitor);
 
     // Tell the monitor's thread event loop to stop
     // This will eventually trigger the thread's "finished" signal.
@@ -170,6 +266,9 @@ void AppController::createTrayIcon(){
     // Create the right-click menu
     QMenu* trayMenu = new QMenu();
     trayMenu->addAction("Configuration", this, &AppController::onShowConfig);
+    if (SpanTracer::isEnabled()) {
+        trayMenu->addAction("Save Trace", this, &AppController::onSaveTrace);
+    }
     trayMenu->addSeparator();
 
     // Add the "Quit" action and connect it directly
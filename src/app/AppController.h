@@ -3,14 +3,16 @@
 
 #include <QObject>
 #include <QString>
-#include <windows.h> // For DWORD
+#include "services/utils/PlatformTypes.h" // For DWORD
 
 // Forward declarations to reduce header includes
 // Repositories
 class ApplicationRepository;
+class SessionHistoryStore;
 
 // Services
 class ProcessMonitor;           // Infrastructure
+class RecordingProcessSource;   // Infrastructure
 class ProcessEventDispatcher;   // Application
 
 // Managers
@@ -29,8 +31,11 @@ public:
     explicit AppController(QObject *parent = nullptr);
     ~AppController();
 
+    static constexpr int METRICS_INTERVAL_MS = 10000;
+
 public slots:
     void onShowConfig();
+    void onSaveTrace();
     void onQuit();
 
 private:
@@ -38,6 +43,7 @@ private:
     
     // Repositories
     ApplicationRepository* m_appRepository;
+    SessionHistoryStore* m_sessionHistory;
 
     // Managers
     GameSessionManager* m_sessionManager;
@@ -46,6 +52,9 @@ private:
     // Services
     ProcessMonitor* m_processMonitorService;                    // Infrastructure
     ProcessEventDispatcher* m_processEventDispatcherService;    // Application
+    RecordingProcessSource* m_processRecorder;                  // Only while tracing
+    QString m_metricsPath;                                      // Snapshot file, if any
+    QString m_spanTracePath;                                    // Trace span file, if any
 
 
     ConfigWindow* m_configWindow;
@@ -1,94 +1,162 @@
 #include "Application.h"
+#include "ApplicationFields.h"
+#include "ApplicationObserver.h"
+#include "StringPool.h"
+#include "services/infrastructure/TimeSource.h"
 #include <QJsonDocument>
 #include <QDebug>
+#include <algorithm>
 
 // Constructors
 
 Application::Application()
-    : m_processName(""),
-      m_displayName(""),
-      m_category(Category::Uncategorized),
-      m_firstSeen(QDateTime::currentDateTime()),
-      m_lastSeen(QDateTime::currentDateTime()),
+    : m_processNameId(StringPool::EMPTY_ID),
+      m_displayNameId(StringPool::EMPTY_ID),
+      m_firstSeen(0),
+      m_lastSeen(0),
       m_totalSessions(0),
       m_totalMinutesUsed(0),
       m_longestSession(0),
       m_customTimeLimit(-1),
-      m_warningStrategy(WarningStrategy::Standard),
+      m_observer(nullptr),
+      m_category(static_cast<quint8>(Category::Uncategorized)),
+      m_warningStrategy(static_cast<quint8>(WarningStrategy::Standard)),
       m_requiresPrompt(true)
 {
 }
 
 Application::Application(const QString& processName)
-    : m_processName(processName.toLower()),
-      m_displayName(processName),
-      m_category(Category::Uncategorized),
-      m_firstSeen(QDateTime::currentDateTime()),
-      m_lastSeen(QDateTime::currentDateTime()),
+    : m_processNameId(StringPool::instance().intern(processName.toLower())),
+      m_displayNameId(StringPool::instance().intern(processName)),
+      m_firstSeen(TimeSource::current()->currentSecsSinceEpoch()),
+      m_lastSeen(m_firstSeen),
       m_totalSessions(0),
       m_totalMinutesUsed(0),
       m_longestSession(0),
       m_customTimeLimit(-1),
-      m_warningStrategy(WarningStrategy::Standard),
+      m_observer(nullptr),
+      m_category(static_cast<quint8>(Category::Uncategorized)),
+      m_warningStrategy(static_cast<quint8>(WarningStrategy::Standard)),
       m_requiresPrompt(true)
 {
 }
 
 Application::Application(const QString& processName, Category category)
-    : m_processName(processName.toLower()),
-      m_displayName(processName),
-      m_category(category),
-      m_firstSeen(QDateTime::currentDateTime()),
-      m_lastSeen(QDateTime::currentDateTime()),
+    : m_processNameId(StringPool::instance().intern(processName.toLower())),
+      m_displayNameId(StringPool::instance().intern(processName)),
+      m_firstSeen(TimeSource::current()->currentSecsSinceEpoch()),
+      m_lastSeen(m_firstSeen),
       m_totalSessions(0),
       m_totalMinutesUsed(0),
       m_longestSession(0),
       m_customTimeLimit(-1),
-      m_warningStrategy(WarningStrategy::Standard),
+      m_observer(nullptr),
+      m_category(static_cast<quint8>(category)),
+      m_warningStrategy(static_cast<quint8>(WarningStrategy::Standard)),
       m_requiresPrompt(true)
 {
 }
 
+Application::Application(const Application& other)
+    : m_processNameId(other.m_processNameId),
+      m_displayNameId(other.m_displayNameId),
+      m_firstSeen(other.m_firstSeen),
+      m_lastSeen(other.m_lastSeen),
+      m_totalSessions(other.m_totalSessions),
+      m_totalMinutesUsed(other.m_totalMinutesUsed),
+      m_longestSession(other.m_longestSession),
+      m_sessionLengths(other.m_sessionLengths),
+      m_customTimeLimit(other.m_customTimeLimit),
+      m_observer(nullptr),
+      m_category(other.m_category),
+      m_warningStrategy(other.m_warningStrategy),
+      m_requiresPrompt(other.m_requiresPrompt)
+{
+}
+
+Application& Application::operator=(const Application& other)
+{
+    if (this == &other) {
+        return *this;
+    }
+    
+    // Keep our own observer, but report the changed fields to it
+    Category oldCategory = getCategory();
+    qint64 oldLastSeen = m_lastSeen;
+    int oldTotalSessions = m_totalSessions;
+    
+    m_processNameId = other.m_processNameId;
+    m_displayNameId = other.m_displayNameId;
+    m_firstSeen = other.m_firstSeen;
+    m_lastSeen = other.m_lastSeen;
+    m_totalSessions = other.m_totalSessions;
+    m_totalMinutesUsed = other.m_totalMinutesUsed;
+    m_longestSession = other.m_longestSession;
+    m_sessionLengths = other.m_sessionLengths;
+    m_customTimeLimit = other.m_customTimeLimit;
+    m_category = other.m_category;
+    m_warningStrategy = other.m_warningStrategy;
+    m_requiresPrompt = other.m_requiresPrompt;
+    
+    if (m_observer && oldCategory != getCategory()) {
+        m_observer->onCategoryChanged(this, oldCategory);
+    }
+    notifyUsageChanged(oldLastSeen, oldTotalSessions);
+    notifyDetailsChanged();
+    return *this;
+}
+
 // Core Properties
 
 QString Application::getProcessName() const
 {
-    return m_processName;
+    return StringPool::instance().get(m_processNameId);
 }
 
 QString Application::getDisplayName() const
 {
-    return m_displayName.isEmpty() ? m_processName : m_displayName;
+    return StringPool::instance().get(m_displayNameId == StringPool::EMPTY_ID ? m_processNameId : m_displayNameId);
 }
 
 Application::Category Application::getCategory() const
 {
-    return m_category;
+    return static_cast<Category>(m_category);
 }
 
 void Application::setCategory(Category category)
 {
-    m_category = category;
+    Category oldCategory = getCategory();
+    m_category = static_cast<quint8>(category);
     
     // Adjust defaults based on category
     if (category == Category::System || category == Category::Utility) {
         m_requiresPrompt = false;
     }
+    
+    if (m_observer && oldCategory != category) {
+        m_observer->onCategoryChanged(this, oldCategory);
+    }
 }
 
 void Application::setDisplayName(const QString& displayName)
 {
-    m_displayName = displayName;
+    m_displayNameId = StringPool::instance().intern(displayName);
+    notifyDetailsChanged();
 }
 
 // Statistics
 
 QDateTime Application::getFirstSeen() const
 {
-    return m_firstSeen;
+    return QDateTime::fromSecsSinceEpoch(m_firstSeen);
 }
 
 QDateTime Application::getLastSeen() const
+{
+    return QDateTime::fromSecsSinceEpoch(m_lastSeen);
+}
+
+qint64 Application::getLastSeenSecs() const
 {
     return m_lastSeen;
 }
@@ -116,6 +184,16 @@ int Application::getLongestSession() const
     return m_longestSession;
 }
 
+const SessionLengthSketch& Application::getSessionLengths() const
+{
+    return m_sessionLengths;
+}
+
+double Application::getSessionLengthPercentile(double q) const
+{
+    return m_sessionLengths.quantile(q);
+}
+
 // Configuration
 
 int Application::getCustomTimeLimit() const
@@ -126,16 +204,18 @@ int Application::getCustomTimeLimit() const
 void Application::setCustomTimeLimit(int minutes)
 {
     m_customTimeLimit = minutes;
+    notifyDetailsChanged();
 }
 
 Application::WarningStrategy Application::getWarningStrategy() const
 {
-    return m_warningStrategy;
+    return static_cast<WarningStrategy>(m_warningStrategy);
 }
 
 void Application::setWarningStrategy(WarningStrategy strategy)
 {
-    m_warningStrategy = strategy;
+    m_warningStrategy = static_cast<quint8>(strategy);
+    notifyDetailsChanged();
 }
 
 // Business Rules
@@ -148,12 +228,13 @@ bool Application::shouldPromptForTime() const
     }
     
     // Games and leisure always prompt
-    if (m_category == Category::Game || m_category == Category::Leisure) {
+    Category category = getCategory();
+    if (category == Category::Game || category == Category::Leisure) {
         return true;
     }
     
     // Work apps with custom limits prompt
-    if (m_category == Category::Work && m_customTimeLimit > 0) {
+    if (category == Category::Work && m_customTimeLimit > 0) {
         return true;
     }
     
@@ -163,7 +244,8 @@ bool Application::shouldPromptForTime() const
 bool Application::requiresTermination() const
 {
     // Only games and leisure apps are forcefully terminated
-    return (m_category == Category::Game || m_category == Category::Leisure);
+    Category category = getCategory();
+    return (category == Category::Game || category == Category::Leisure);
 }
 
 int Application::getEffectiveTimeLimit() const
@@ -174,7 +256,7 @@ int Application::getEffectiveTimeLimit() const
     }
     
     // Category defaults
-    switch (m_category) {
+    switch (getCategory()) {
         case Category::Game:
             return DEFAULT_GAME_TIME_LIMIT;
         case Category::Leisure:
@@ -184,6 +266,40 @@ int Application::getEffectiveTimeLimit() const
     }
 }
 
+QList<int> Application::getWarningMinutes(int limitMinutes) const
+{
+    QList<int> schedule;
+    switch (getWarningStrategy()) {
+        case WarningStrategy::Standard:
+            schedule = {15, 10, 5};
+            break;
+        case WarningStrategy::Aggressive:
+            schedule = {30, 20, 10, 5};
+            break;
+        case WarningStrategy::Gentle:
+            schedule = {5};
+            break;
+        case WarningStrategy::None:
+            return schedule;
+    }
+    
+    // Warnings at or past the start of the session are pointless
+    schedule.erase(std::remove_if(schedule.begin(), schedule.end(),
+                                  [limitMinutes](int minutes) { return minutes >= limitMinutes; }),
+                   schedule.end());
+    
+    // If sessions of this app usually run up to the limit, give one early
+    // heads-up at half time so there is room to wind down
+    if (m_sessionLengths.count() >= HISTORY_WARNING_MIN_SESSIONS
+        && m_sessionLengths.quantile(0.9) >= limitMinutes * (1.0 - SessionLengthSketch::RELATIVE_ACCURACY)) {
+        int halfway = limitMinutes / 2;
+        if (halfway > 0 && (schedule.isEmpty() || halfway > schedule.first())) {
+            schedule.prepend(halfway);
+        }
+    }
+    return schedule;
+}
+
 bool Application::isFrequentlyUsed() const
 {
     return m_totalSessions >= FREQUENT_USE_THRESHOLD;
@@ -191,71 +307,179 @@ bool Application::isFrequentlyUsed() const
 
 bool Application::isProductivityApp() const
 {
-    return (m_category == Category::Work || 
-            m_category == Category::Productivity ||
-            m_category == Category::Educational);
+    Category category = getCategory();
+    return (category == Category::Work || 
+            category == Category::Productivity ||
+            category == Category::Educational);
 }
 
 // Session Tracking
 
 void Application::recordSessionStart()
 {
+    qint64 oldLastSeen = m_lastSeen;
+    int oldTotalSessions = m_totalSessions;
+    
     m_totalSessions++;
-    updateLastSeen();
+    m_lastSeen = TimeSource::current()->currentSecsSinceEpoch();
+    
+    notifyUsageChanged(oldLastSeen, oldTotalSessions);
 }
 
 void Application::recordSessionEnd(int durationMinutes)
 {
+    const qint64 end = TimeSource::current()->currentSecsSinceEpoch();
+    recordSessionEnd(end - static_cast<qint64>(durationMinutes) * 60, end, durationMinutes * 60);
+}
+
+void Application::recordSessionEnd(qint64 start, qint64 end, int activeSeconds)
+{
+    // The totals keep whole minutes; the rollups get the exact seconds
+    const int durationMinutes = qRound(activeSeconds / 60.0);
     m_totalMinutesUsed += durationMinutes;
     
     if (durationMinutes > m_longestSession) {
         m_longestSession = durationMinutes;
     }
+    m_sessionLengths.add(durationMinutes);
     
-    updateLastSeen();
+    qint64 oldLastSeen = m_lastSeen;
+    m_lastSeen = end;
+    notifyUsageChanged(oldLastSeen, m_totalSessions);
+    notifyDetailsChanged();
+    notifySessionRecorded(start, end, activeSeconds);
 }
 
 void Application::updateLastSeen()
 {
-    m_lastSeen = QDateTime::currentDateTime();
+    qint64 oldLastSeen = m_lastSeen;
+    m_lastSeen = TimeSource::current()->currentSecsSinceEpoch();
+    notifyUsageChanged(oldLastSeen, m_totalSessions);
+}
+
+// Change Notification
+
+void Application::setObserver(ApplicationObserver* observer)
+{
+    m_observer = observer;
+}
+
+void Application::notifyUsageChanged(qint64 oldLastSeen, int oldTotalSessions)
+{
+    if (m_observer && (oldLastSeen != m_lastSeen || oldTotalSessions != m_totalSessions)) {
+        m_observer->onUsageChanged(this, oldLastSeen, oldTotalSessions);
+    }
+}
+
+void Application::notifyDetailsChanged()
+{
+    if (m_observer) {
+        m_observer->onDetailsChanged(this);
+    }
+}
+
+void Application::notifySessionRecorded(qint64 start, qint64 end, int activeSeconds)
+{
+    if (m_observer) {
+        m_observer->onSessionRecorded(this, start, end, activeSeconds);
+    }
 }
 
 // Serialization
 
 QJsonObject Application::toJson() const
 {
+    StringPool& pool = StringPool::instance();
+    
     QJsonObject json;
-    json["processName"] = m_processName;
-    json["displayName"] = m_displayName;
-    json["category"] = categoryToString(m_category);
-    json["firstSeen"] = m_firstSeen.toString(Qt::ISODate);
-    json["lastSeen"] = m_lastSeen.toString(Qt::ISODate);
-    json["totalSessions"] = m_totalSessions;
-    json["totalMinutesUsed"] = m_totalMinutesUsed;
-    json["longestSession"] = m_longestSession;
-    json["customTimeLimit"] = m_customTimeLimit;
-    json["warningStrategy"] = static_cast<int>(m_warningStrategy);
-    json["requiresPrompt"] = m_requiresPrompt;
+    for (const ApplicationFields::Descriptor& field : ApplicationFields::TABLE) {
+        QString key = QString::fromLatin1(field.key, field.keyLength);
+        qint64 value = field.get(*this);
+        
+        switch (field.kind) {
+            case ApplicationFields::Kind::String:
+                json[key] = pool.get(static_cast<quint32>(value));
+                break;
+            case ApplicationFields::Kind::Timestamp:
+                json[key] = QDateTime::fromSecsSinceEpoch(value, Qt::UTC).toString(Qt::ISODate);
+                break;
+            case ApplicationFields::Kind::Category:
+                json[key] = categoryToString(static_cast<Category>(value));
+                break;
+            case ApplicationFields::Kind::Int:
+                json[key] = static_cast<int>(value);
+                break;
+            case ApplicationFields::Kind::Bool:
+                json[key] = value != 0;
+                break;
+            case ApplicationFields::Kind::Sketch:
+                json[key] = QString::fromLatin1((this->*field.sketch).toBytes().toBase64());
+                break;
+        }
+    }
     return json;
 }
 
 Application Application::fromJson(const QJsonObject& json)
 {
+    StringPool& pool = StringPool::instance();
+    
     Application app;
-    app.m_processName = json["processName"].toString();
-    app.m_displayName = json["displayName"].toString();
-    app.m_category = categoryFromString(json["category"].toString());
-    app.m_firstSeen = QDateTime::fromString(json["firstSeen"].toString(), Qt::ISODate);
-    app.m_lastSeen = QDateTime::fromString(json["lastSeen"].toString(), Qt::ISODate);
-    app.m_totalSessions = json["totalSessions"].toInt();
-    app.m_totalMinutesUsed = json["totalMinutesUsed"].toInt();
-    app.m_longestSession = json["longestSession"].toInt();
-    app.m_customTimeLimit = json["customTimeLimit"].toInt(-1);
-    app.m_warningStrategy = static_cast<WarningStrategy>(json["warningStrategy"].toInt());
-    app.m_requiresPrompt = json["requiresPrompt"].toBool(true);
+    ApplicationFields::applyDefaults(app);
+    
+    // One pass over the object, dispatching each key through the field table
+    int expected = 0;
+    for (auto it = json.constBegin(); it != json.constEnd(); ++it) {
+        QString key = it.key();
+        char latin1[32];
+        if (key.size() > static_cast<qsizetype>(sizeof(latin1))) {
+            continue;
+        }
+        for (qsizetype i = 0; i < key.size(); ++i) {
+            latin1[i] = key.at(i).toLatin1();
+        }
+        
+        int index = ApplicationFields::indexOf(latin1, static_cast<int>(key.size()), expected);
+        if (index < 0 || it.value().isNull()) {
+            continue;
+        }
+        expected = index + 1;
+        
+        const ApplicationFields::Descriptor& field = ApplicationFields::TABLE[index];
+        QJsonValue value = it.value();
+        switch (field.kind) {
+            case ApplicationFields::Kind::String:
+                field.set(app, pool.intern(value.toString()));
+                break;
+            case ApplicationFields::Kind::Timestamp:
+                field.set(app, secsFromIsoString(value.toString()));
+                break;
+            case ApplicationFields::Kind::Category:
+                field.set(app, static_cast<qint64>(categoryFromString(value.toString())));
+                break;
+            case ApplicationFields::Kind::Int:
+                field.set(app, value.toInt(static_cast<int>(field.defaultValue)));
+                break;
+            case ApplicationFields::Kind::Bool:
+                field.set(app, value.toBool(field.defaultValue != 0));
+                break;
+            case ApplicationFields::Kind::Sketch: {
+                // A damaged sketch stays empty; the rest of the entry still loads
+                QByteArray bytes = QByteArray::fromBase64(value.toString().toLatin1());
+                (app.*field.sketch).fromBytes(bytes.constData(), static_cast<int>(bytes.size()));
+                break;
+            }
+        }
+    }
     return app;
 }
 
+qint64 Application::secsFromIsoString(const QString& str)
+{
+    QDateTime dateTime = QDateTime::fromString(str, Qt::ISODate);
+    return dateTime.isValid() ? dateTime.toSecsSinceEpoch() : 0;
+}
+
 // Utility
 
 QString Application::categoryToString(Category category)
@@ -4,6 +4,10 @@
 #include <QString>
 #include <QDateTime>
 #include <QJsonObject>
+#include <QList>
+#include "SessionLengthSketch.h"
+
+class ApplicationObserver;
 
 /**
  * @brief Domain entity representing a monitored application
@@ -11,6 +15,13 @@
  * This class encapsulates all data and business logic related to
  * an application that Mindfulness tracks. It includes categorization,
  * usage statistics, and custom configuration.
+ * 
+ * Storage is kept compact because the repository may hold very large
+ * catalogs: names are ids into the shared StringPool, timestamps are
+ * epoch seconds, and the small enums are packed into one byte. The
+ * getters build QString/QDateTime values on demand. The session length
+ * distribution is a SessionLengthSketch, which costs one pointer until the
+ * first session is recorded.
  */
 class Application
 {
@@ -30,6 +41,8 @@ public:
         System
     };
     
+    static constexpr int CATEGORY_COUNT = static_cast<int>(Category::System) + 1;
+    
     /**
      * @brief Warning strategy for session limits
      */
@@ -39,12 +52,18 @@ public:
         Gentle,      // 5 minute warning only
         None         // No warnings
     };
+    
+    static constexpr int WARNING_STRATEGY_COUNT = static_cast<int>(WarningStrategy::None) + 1;
 
     // Constructors
-    Application();
+    Application();                  // Empty slot or decode target: never seen (0), no clock read
     explicit Application(const QString& processName);
     Application(const QString& processName, Category category);
     
+    // Copies never inherit the observer; only the stored instance is indexed
+    Application(const Application& other);
+    Application& operator=(const Application& other);
+    
     // Core Properties
     QString getProcessName() const;
     QString getDisplayName() const;
@@ -55,10 +74,13 @@ public:
     // Statistics
     QDateTime getFirstSeen() const;
     QDateTime getLastSeen() const;
+    qint64 getLastSeenSecs() const;  // Seconds since epoch, no conversion
     int getTotalSessions() const;
     int getTotalMinutesUsed() const;
     float getAverageSessionLength() const;
     int getLongestSession() const;
+    const SessionLengthSketch& getSessionLengths() const;
+    double getSessionLengthPercentile(double q) const;  // Minutes, q in 0..1
     
     // Configuration
     int getCustomTimeLimit() const;  // -1 means use default
@@ -70,44 +92,65 @@ public:
     bool shouldPromptForTime() const;
     bool requiresTermination() const;
     int getEffectiveTimeLimit() const;
+    QList<int> getWarningMinutes(int limitMinutes) const;  // Minutes before the limit, descending
     bool isFrequentlyUsed() const;
     bool isProductivityApp() const;
     
     // Session Tracking
     void recordSessionStart();
-    void recordSessionEnd(int durationMinutes);
+    void recordSessionEnd(int durationMinutes);                      // Ended now
+    void recordSessionEnd(qint64 start, qint64 end, int activeSeconds); // Seconds since epoch
     void updateLastSeen();
     
     // Serialization
     QJsonObject toJson() const;
     static Application fromJson(const QJsonObject& json);
     
+    // Change Notification
+    void setObserver(ApplicationObserver* observer);
+    
     // Utility
     static QString categoryToString(Category category);
     static Category categoryFromString(const QString& str);
 
 private:
-    // Core Identity
-    QString m_processName;      // e.g., "chrome.exe"
-    QString m_displayName;      // e.g., "Google Chrome"
-    Category m_category;
+    // Serialized fields are described in ApplicationFields::TABLE
+    friend struct ApplicationFields;
+    
+    // Core Identity (ids into StringPool)
+    quint32 m_processNameId;    // e.g., "chrome.exe"
+    quint32 m_displayNameId;    // e.g., "Google Chrome"
     
     // Statistics
-    QDateTime m_firstSeen;
-    QDateTime m_lastSeen;
-    int m_totalSessions;
-    int m_totalMinutesUsed;
-    int m_longestSession;       // in minutes
+    qint64 m_firstSeen;         // seconds since epoch
+    qint64 m_lastSeen;          // seconds since epoch
+    qint32 m_totalSessions;
+    qint32 m_totalMinutesUsed;
+    qint32 m_longestSession;    // in minutes
+    SessionLengthSketch m_sessionLengths;   // in minutes
     
     // Configuration
-    int m_customTimeLimit;      // -1 for default, otherwise minutes
-    WarningStrategy m_warningStrategy;
-    bool m_requiresPrompt;      // Some apps might not need prompting
+    qint32 m_customTimeLimit;   // -1 for default, otherwise minutes
+    
+    // Not owned, not serialized, not copied
+    ApplicationObserver* m_observer;
+    
+    // Packed flags
+    quint8 m_category : 4;          // Category
+    quint8 m_warningStrategy : 3;   // WarningStrategy
+    quint8 m_requiresPrompt : 1;    // Some apps might not need prompting
+    
+    void notifyUsageChanged(qint64 oldLastSeen, int oldTotalSessions);
+    void notifyDetailsChanged();
+    void notifySessionRecorded(qint64 start, qint64 end, int activeSeconds);
+    
+    static qint64 secsFromIsoString(const QString& str);
     
     // Constants
     static constexpr int DEFAULT_GAME_TIME_LIMIT = 45;     // minutes
     static constexpr int DEFAULT_LEISURE_TIME_LIMIT = 30;  // minutes
     static constexpr int FREQUENT_USE_THRESHOLD = 10;      // sessions
+    static constexpr int HISTORY_WARNING_MIN_SESSIONS = 5; // sessions
 };
 
 #endif // APPLICATION_H
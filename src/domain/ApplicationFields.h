@@ -0,0 +1,221 @@
+#ifndef APPLICATIONFIELDS_H
+#define APPLICATIONFIELDS_H
+
+#include "Application.h"
+#include <QtGlobal>
+#include <array>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+/**
+ * @brief Compile-time description of Application's persisted fields
+ *
+ * Every serialized field appears once in TABLE, in the order the encoders
+ * write it. Each entry carries its JSON key (plus the key's length and
+ * FNV-1a hash, both computed at compile time), a value kind, the default
+ * used when a decoder does not find the field, and accessors that move the
+ * value in and out of an Application as a plain integer:
+ *
+ * - String:    StringPool id
+ * - Timestamp: seconds since epoch
+ * - Category:  Application::Category
+ * - Int:       the number itself
+ * - Bool:      0 or 1
+ *
+ * Setters of enum fields stored in bitfields range-check the value and
+ * fall back to the field default, so a damaged or foreign file can never
+ * leave an out-of-range enum behind (or a value truncated into a
+ * different one).
+ *
+ * Sketch fields are not integers: they also carry a member pointer to the
+ * SessionLengthSketch, which the codecs encode as bytes (base64 in JSON).
+ * Their integer accessors report the session count and clear the sketch.
+ *
+ * The JSON, CBOR and binary codecs (ApplicationCodecs.h) are generated from
+ * this table with forEach(), so adding a field here adds it to all of them.
+ */
+struct ApplicationFields
+{
+    enum class Kind : quint8 {
+        String,
+        Timestamp,
+        Category,
+        Int,
+        Bool,
+        Sketch
+    };
+
+    struct Descriptor {
+        const char* key;
+        int keyLength;
+        quint32 keyHash;
+        Kind kind;
+        qint64 defaultValue;
+        qint64 (*get)(const Application&);
+        void (*set)(Application&, qint64);
+        SessionLengthSketch Application::* sketch;  // Sketch fields only
+    };
+
+    /**
+     * @brief 32-bit FNV-1a, usable at compile time
+     */
+    static constexpr quint32 hash(const char* data, std::size_t length)
+    {
+        quint32 h = 2166136261u;
+        for (std::size_t i = 0; i < length; ++i) {
+            h ^= static_cast<quint8>(data[i]);
+            h *= 16777619u;
+        }
+        return h;
+    }
+
+    static constexpr std::size_t length(const char* str)
+    {
+        std::size_t n = 0;
+        while (str[n] != '\0') {
+            ++n;
+        }
+        return n;
+    }
+
+    static constexpr Descriptor field(const char* key, Kind kind, qint64 defaultValue,
+                                      qint64 (*get)(const Application&),
+                                      void (*set)(Application&, qint64),
+                                      SessionLengthSketch Application::* sketch = nullptr)
+    {
+        return Descriptor{key, static_cast<int>(length(key)), hash(key, length(key)),
+                          kind, defaultValue, get, set, sketch};
+    }
+
+    static constexpr int COUNT = 12;
+
+    /**
+     * @brief The field table, in encoding order (defined below the class)
+     */
+    static const std::array<Descriptor, COUNT> TABLE;
+
+    /**
+     * @brief Fingerprint of keys, kinds and order; stored by the binary codec
+     */
+    static constexpr quint32 schemaHash()
+    {
+        quint32 h = 2166136261u;
+        for (const Descriptor& d : TABLE) {
+            h = (h ^ d.keyHash) * 16777619u;
+            h = (h ^ static_cast<quint8>(d.kind)) * 16777619u;
+        }
+        return h;
+    }
+
+    /**
+     * @brief Index of the field with the given key, or -1
+     * @param expected Index to try first (decoders pass the next field in table order)
+     */
+    static constexpr int indexOf(const char* key, int keyLength, int expected = 0)
+    {
+        if (expected >= 0 && expected < COUNT && matches(TABLE[expected], key, keyLength)) {
+            return expected;
+        }
+
+        quint32 h = hash(key, static_cast<std::size_t>(keyLength));
+        for (int i = 0; i < COUNT; ++i) {
+            if (TABLE[i].keyHash == h && matches(TABLE[i], key, keyLength)) {
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    /**
+     * @brief Reset every field to its table default
+     */
+    static void applyDefaults(Application& app)
+    {
+        for (const Descriptor& d : TABLE) {
+            d.set(app, d.defaultValue);
+        }
+    }
+
+    /**
+     * @brief Call visitor(std::integral_constant<int, I>) for every field, unrolled
+     *
+     * The index is a constant expression, so visitors can branch on
+     * TABLE[I].kind with if constexpr and generate per-field code.
+     */
+    template<typename Visitor>
+    static void forEach(Visitor&& visitor)
+    {
+        forEachImpl(visitor, std::make_integer_sequence<int, COUNT>());
+    }
+
+private:
+    static constexpr bool matches(const Descriptor& d, const char* key, int keyLength)
+    {
+        if (d.keyLength != keyLength) {
+            return false;
+        }
+        for (int i = 0; i < keyLength; ++i) {
+            if (d.key[i] != key[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    template<typename Visitor, int... I>
+    static void forEachImpl(Visitor& visitor, std::integer_sequence<int, I...>)
+    {
+        (visitor(std::integral_constant<int, I>()), ...);
+    }
+};
+
+// Defined out of class so the initializer can call field() on the complete type
+inline constexpr std::array<ApplicationFields::Descriptor, ApplicationFields::COUNT> ApplicationFields::TABLE = {{
+    field("processName", Kind::String, 0,
+          [](const Application& a) -> qint64 { return a.m_processNameId; },
+          [](Application& a, qint64 v) { a.m_processNameId = static_cast<quint32>(v); }),
+    field("displayName", Kind::String, 0,
+          [](const Application& a) -> qint64 { return a.m_displayNameId; },
+          [](Application& a, qint64 v) { a.m_displayNameId = static_cast<quint32>(v); }),
+    field("category", Kind::Category, 0,
+          [](const Application& a) -> qint64 { return a.m_category; },
+          [](Application& a, qint64 v) {
+              a.m_category = static_cast<quint8>(v >= 0 && v < Application::CATEGORY_COUNT ? v : 0);
+          }),
+    field("firstSeen", Kind::Timestamp, 0,
+          [](const Application& a) -> qint64 { return a.m_firstSeen; },
+          [](Application& a, qint64 v) { a.m_firstSeen = v; }),
+    field("lastSeen", Kind::Timestamp, 0,
+          [](const Application& a) -> qint64 { return a.m_lastSeen; },
+          [](Application& a, qint64 v) { a.m_lastSeen = v; }),
+    field("totalSessions", Kind::Int, 0,
+          [](const Application& a) -> qint64 { return a.m_totalSessions; },
+          [](Application& a, qint64 v) { a.m_totalSessions = static_cast<qint32>(v); }),
+    field("totalMinutesUsed", Kind::Int, 0,
+          [](const Application& a) -> qint64 { return a.m_totalMinutesUsed; },
+          [](Application& a, qint64 v) { a.m_totalMinutesUsed = static_cast<qint32>(v); }),
+    field("longestSession", Kind::Int, 0,
+          [](const Application& a) -> qint64 { return a.m_longestSession; },
+          [](Application& a, qint64 v) { a.m_longestSession = static_cast<qint32>(v); }),
+    field("customTimeLimit", Kind::Int, -1,
+          [](const Application& a) -> qint64 { return a.m_customTimeLimit; },
+          [](Application& a, qint64 v) { a.m_customTimeLimit = static_cast<qint32>(v); }),
+    field("warningStrategy", Kind::Int, 0,
+          [](const Application& a) -> qint64 { return a.m_warningStrategy; },
+          [](Application& a, qint64 v) {
+              a.m_warningStrategy = static_cast<quint8>(v >= 0 && v < Application::WARNING_STRATEGY_COUNT ? v : 0);
+          }),
+    field("requiresPrompt", Kind::Bool, 1,
+          [](const Application& a) -> qint64 { return a.m_requiresPrompt; },
+          [](Application& a, qint64 v) { a.m_requiresPrompt = v != 0; }),
+    field("sessionLengths", Kind::Sketch, 0,
+          [](const Application& a) -> qint64 { return static_cast<qint64>(a.m_sessionLengths.count()); },
+          [](Application& a, qint64) { a.m_sessionLengths.clear(); },
+          &Application::m_sessionLengths),
+}};
+
+static_assert(ApplicationFields::indexOf("lastSeen", 8) == 4, "field lookup must work at compile time");
+static_assert(ApplicationFields::TABLE[0].keyLength == 11, "key lengths are computed at compile time");
+
+#endif // APPLICATIONFIELDS_H
@@ -0,0 +1,44 @@
+#ifndef APPLICATIONID_H
+#define APPLICATIONID_H
+
+#include <QtGlobal>
+#include <QHash>
+#include <QMetaType>
+
+/**
+ * @brief Generation-checked handle to an Application stored in the repository
+ * 
+ * The index selects a storage slot and the generation identifies which
+ * occupant of that slot the handle was issued for. When an application is
+ * removed its slot's generation changes, so resolving an old handle returns
+ * nullptr instead of a dangling or reused object.
+ * 
+ * Handles are plain values: cheap to copy, safe to queue across threads,
+ * and only meaningful to the ApplicationRepository that issued them.
+ */
+struct ApplicationId
+{
+    quint32 index = 0;
+    quint32 generation = 0;     // 0 = null handle; live slots use odd generations
+    
+    bool isNull() const { return generation == 0; }
+    
+    bool operator==(const ApplicationId& other) const
+    {
+        return index == other.index && generation == other.generation;
+    }
+    
+    bool operator!=(const ApplicationId& other) const
+    {
+        return !(*this == other);
+    }
+};
+
+inline size_t qHash(const ApplicationId& id, size_t seed = 0)
+{
+    return qHash((static_cast<quint64>(id.generation) << 32) | id.index, seed);
+}
+
+Q_DECLARE_METATYPE(ApplicationId)
+
+#endif // APPLICATIONID_H
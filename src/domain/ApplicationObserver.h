@@ -0,0 +1,53 @@
+#ifndef APPLICATIONOBSERVER_H
+#define APPLICATIONOBSERVER_H
+
+#include "Application.h"
+
+/**
+ * @brief Change notifications for fields that the repository indexes
+ *
+ * An Application reports changes to its category and usage statistics
+ * to at most one observer (normally the ApplicationRepository that owns
+ * it). The observer receives the previous values so that it can update
+ * its secondary indexes incrementally instead of rebuilding them. Changes
+ * to fields that are not indexed are reported through onDetailsChanged(),
+ * and every finished session through onSessionRecorded() so that time-based
+ * rollups can be updated as well.
+ */
+class ApplicationObserver
+{
+public:
+    virtual ~ApplicationObserver() = default;
+
+    /**
+     * @brief Called after the application's category has changed
+     * @param app The application that changed
+     * @param oldCategory The category before the change
+     */
+    virtual void onCategoryChanged(Application* app, Application::Category oldCategory) = 0;
+
+    /**
+     * @brief Called after lastSeen and/or totalSessions have changed
+     * @param app The application that changed
+     * @param oldLastSeen Previous lastSeen in seconds since epoch
+     * @param oldTotalSessions Previous session count
+     */
+    virtual void onUsageChanged(Application* app, qint64 oldLastSeen, int oldTotalSessions) = 0;
+    
+    /**
+     * @brief Called when a finished session has been added to the statistics
+     * @param app The application that changed
+     * @param start Session start in seconds since epoch
+     * @param end Session end in seconds since epoch
+     * @param activeSeconds Time actually played within [start, end)
+     */
+    virtual void onSessionRecorded(Application* app, qint64 start, qint64 end, int activeSeconds) = 0;
+    
+    /**
+     * @brief Called after any non-indexed field has changed
+     * @param app The application that changed
+     */
+    virtual void onDetailsChanged(Application* app) = 0;
+};
+
+#endif // APPLICATIONOBSERVER_H
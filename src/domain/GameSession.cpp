@@ -1,26 +1,28 @@
 #include "GameSession.h"
 #include "TimeSetDialog.h"
 #include "WarningDialog.h"
+#include "services/infrastructure/TimeSource.h"
 #include "services/utils/ProcessUtils.h"
-#include <QTimer>
 
-GameSession::GameSession(DWORD pid, const QString& processName, QObject *parent)
+GameSession::GameSession(DWORD pid, const QString& processName, DeadlineScheduler* scheduler, QObject *parent)
     : QObject(parent),
       m_pid(pid),
       m_processName(processName),
-      m_countdownTimer(nullptr),
-      m_warningTimer(nullptr),
-      m_remainingSeconds(0),
-      m_totalTimeSeconds(0)
+      m_scheduler(scheduler),
+      m_warningMinutes({15, 10, 5}),
+      m_countdownStart(-1),
+      m_deadline(-1),
+      m_finishedAt(-1),
+      m_totalTimeSeconds(0),
+      m_startedAt(scheduler->timeSource()->currentSecsSinceEpoch()),
+      m_terminationReason(SessionRecord::Termination::ProcessExited)
 {
-    // TODO: Implement
-    m_countdownTimer = new QTimer(this);
-    // connect(m_countdownTimer, &QTimer::timeout, this, &GameSession::updateTimer);
 }
 
 GameSession::~GameSession()
 {
-    // TODO: Implement
+    // The callbacks refer to this session
+    cancelDeadlines();
 }
 
 void GameSession::startSessionPrompt()
@@ -31,38 +33,62 @@ void GameSession::startSessionPrompt()
     // dialog->exec(); // Show modal
 }
 
-void GameSession::onTimeSet(int minutes)
+void GameSession::startCountdown(int minutes)
 {
-    // TODO: Implement
-    // m_remainingSeconds = minutes * 60;
-    // m_totalTimeSeconds = m_remainingSeconds;
-    // m_countdownTimer->start(1000); // Tick every second
+    cancelDeadlines();
+    m_totalTimeSeconds = minutes * 60;
+    m_countdownStart = m_scheduler->now();
+    m_deadline = m_countdownStart + static_cast<qint64>(m_totalTimeSeconds) * 1000;
+    m_finishedAt = -1;
+
+    for (int warning : m_warningMinutes) {
+        if (warning > 0 && warning < minutes) {
+            m_deadlines.append(m_scheduler->schedule(m_deadline - warning * 60000LL, [this, warning]() {
+                showWarning(warning);
+            }));
+        }
+    }
+    m_deadlines.append(m_scheduler->schedule(m_deadline, [this]() {
+        onTimeLimitReached();
+    }));
 }
 
-void GameSession::updateTimer()
+void GameSession::setWarningMinutes(const QList<int>& minutes)
 {
-    // TODO: Implement
-    // m_remainingSeconds--;
-    // 
-    // // Check for warning times
-    // if (m_remainingSeconds == 15 * 60 ||
-    //     m_remainingSeconds == 10 * 60 ||
-    //     m_remainingSeconds == 5 * 60) {
-    //     showWarning();
-    // }
-    //
-    // // Check for end of time
-    // if (m_remainingSeconds <= 0) {
-    //     m_countdownTimer->stop();
-    //     terminateGame();
-    //     emit sessionFinished();
-    // }
+    m_warningMinutes = minutes;
+}
+
+int GameSession::remainingSeconds() const
+{
+    if (m_deadline < 0) {
+        return m_totalTimeSeconds;
+    }
+    if (m_finishedAt >= 0) {
+        return 0;
+    }
+    qint64 remaining = (m_deadline - m_scheduler->now() + 999) / 1000;
+    return static_cast<int>(qBound<qint64>(0, remaining, m_totalTimeSeconds));
+}
+
+int GameSession::activeSeconds() const
+{
+    if (m_deadline < 0) {
+        return 0;
+    }
+    const qint64 end = m_finishedAt >= 0 ? m_finishedAt : m_scheduler->now();
+    return static_cast<int>(qBound<qint64>(0, (end - m_countdownStart) / 1000, m_totalTimeSeconds));
+}
+
+void GameSession::onTimeSet(int minutes)
+{
+    startCountdown(minutes);
 }
 
-void GameSession::showWarning()
+void GameSession::showWarning(int minutesLeft)
 {
+    emit warningIssued(minutesLeft);
     // TODO: Implement
-    // WarningDialog* dialog = new WarningDialog(m_remainingSeconds / 60);
+    // WarningDialog* dialog = new WarningDialog(minutesLeft);
     // connect(dialog, &WarningDialog::finished, this, &GameSession::onWarningDialogClosed);
     // dialog->exec();
 }
@@ -73,8 +99,25 @@ void GameSession::onWarningDialogClosed()
     // Check if user requested extension
 }
 
+void GameSession::onTimeLimitReached()
+{
+    m_finishedAt = m_deadline;
+    m_deadlines.clear();
+    terminateGame();
+    emit sessionFinished();
+}
+
+void GameSession::cancelDeadlines()
+{
+    for (DeadlineScheduler::Handle handle : m_deadlines) {
+        m_scheduler->cancel(handle);
+    }
+    m_deadlines.clear();
+}
+
 void GameSession::terminateGame()
 {
+    m_terminationReason = SessionRecord::Termination::TimeLimitReached;
     // TODO: Implement
     // ProcessUtils::terminateProcess(m_pid);
 }
\ No newline at end of file
@@ -2,40 +2,77 @@
 #define GAMESESSION_H
 
 #include <QObject>
+#include <QList>
 #include <QString>
-#include <windows.h> // For DWORD
-
-// Forward declarations
-class QTimer;
+#include "services/utils/PlatformTypes.h" // For DWORD
+#include "SessionRecord.h"
+#include "services/infrastructure/DeadlineScheduler.h"
 
 class GameSession : public QObject
 {
     Q_OBJECT
 
 public:
-    explicit GameSession(DWORD pid, const QString& processName, QObject *parent = nullptr);
+    /**
+     * @param scheduler Runs the warning and time limit deadlines and provides
+     * the session's clock (not owned)
+     */
+    GameSession(DWORD pid, const QString& processName, DeadlineScheduler* scheduler, QObject *parent = nullptr);
     ~GameSession();
 
     void startSessionPrompt();
 
+    /**
+     * @brief Start the time limit; warnings and the end are registered with
+     * the scheduler, so the session does no work until one of them is due
+     */
+    void startCountdown(int minutes);
+
+    /**
+     * @brief Minutes before the limit at which to warn (default 15, 10, 5)
+     */
+    void setWarningMinutes(const QList<int>& minutes);
+
+    /**
+     * @brief Time left and time played, derived from the scheduler clock
+     *
+     * Nothing is counted down, so the values stay exact however long the
+     * event loop is blocked, and time spent suspended is handled by the
+     * scheduler's MonotonicClock policy.
+     */
+    int remainingSeconds() const;
+    int activeSeconds() const;
+
+    // Session facts, read by GameSessionManager when the session finishes
+    const QString& processName() const { return m_processName; }
+    qint64 startedAt() const { return m_startedAt; }
+    SessionRecord::Termination terminationReason() const { return m_terminationReason; }
+
 signals:
     void sessionFinished();
+    void warningIssued(int minutesLeft);
 
 private slots:
     void onTimeSet(int minutes);
-    void updateTimer();
-    void showWarning();
     void onWarningDialogClosed();
 
 private:
+    void showWarning(int minutesLeft);
+    void onTimeLimitReached();
+    void cancelDeadlines();
     void terminateGame();
 
     DWORD m_pid;
     QString m_processName;
-    QTimer* m_countdownTimer;
-    QTimer* m_warningTimer; // Or just calculate from countdown
-    int m_remainingSeconds;
+    DeadlineScheduler* m_scheduler;
+    QList<DeadlineScheduler::Handle> m_deadlines; // Pending warnings and the limit
+    QList<int> m_warningMinutes;
+    qint64 m_countdownStart; // Scheduler time at which the countdown started
+    qint64 m_deadline; // Scheduler time at which the limit is reached, -1 if not started
+    qint64 m_finishedAt; // Scheduler time at which the limit ended the session, -1 while running
     int m_totalTimeSeconds;
+    qint64 m_startedAt; // Seconds since epoch
+    SessionRecord::Termination m_terminationReason;
 };
 
 #endif // GAMESESSION_H
\ No newline at end of file
@@ -0,0 +1,247 @@
+#include "SessionLengthSketch.h"
+
+#include <cmath>
+
+namespace {
+
+constexpr quint8 FORMAT_VERSION = 1;
+
+const double GAMMA = (1.0 + SessionLengthSketch::RELATIVE_ACCURACY)
+                   / (1.0 - SessionLengthSketch::RELATIVE_ACCURACY);
+const double LOG_GAMMA = std::log(GAMMA);
+
+void appendVarint(QByteArray& out, quint64 value)
+{
+    while (value >= 0x80) {
+        out.append(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    out.append(static_cast<char>(value));
+}
+
+bool readVarint(const char*& pos, const char* end, quint64& value)
+{
+    value = 0;
+    for (int shift = 0; shift < 64 && pos < end; shift += 7) {
+        quint8 byte = static_cast<quint8>(*pos++);
+        value |= static_cast<quint64>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+}
+
+SessionLengthSketch::SessionLengthSketch() = default;
+
+// Buckets
+
+int SessionLengthSketch::keyOf(int minutes)
+{
+    // Slightly below the exact logarithm so exact powers of gamma stay in their bucket
+    return static_cast<int>(std::ceil(std::log(static_cast<double>(minutes)) / LOG_GAMMA - 1e-9));
+}
+
+double SessionLengthSketch::lengthOf(int key)
+{
+    // Midpoint of (gamma^(k-1), gamma^k] in relative terms
+    return 2.0 * std::pow(GAMMA, key) / (GAMMA + 1.0);
+}
+
+quint32& SessionLengthSketch::Data::slot(int key)
+{
+    if (counts.empty()) {
+        offset = key;
+        counts.assign(1, 0);
+        return counts[0];
+    }
+
+    if (key < offset) {
+        // Grow downwards as far as the bucket limit allows; anything lower
+        // lands in the lowest bucket
+        const int top = offset + static_cast<int>(counts.size()) - 1;
+        const int low = qMax(key, top - MAX_BUCKETS + 1);
+        if (low < offset) {
+            counts.insert(counts.begin(), static_cast<size_t>(offset - low), 0);
+            offset = low;
+        }
+        return counts[static_cast<size_t>(qMax(0, key - offset))];
+    }
+
+    if (key >= offset + static_cast<int>(counts.size())) {
+        counts.resize(static_cast<size_t>(key - offset + 1), 0);
+        const int excess = static_cast<int>(counts.size()) - MAX_BUCKETS;
+        if (excess > 0) {
+            // Fold the lowest buckets into the new lowest one
+            quint32 folded = 0;
+            for (int i = 0; i < excess; ++i) {
+                folded += counts[static_cast<size_t>(i)];
+            }
+            counts.erase(counts.begin(), counts.begin() + excess);
+            counts[0] += folded;
+            offset += excess;
+        }
+    }
+    return counts[static_cast<size_t>(key - offset)];
+}
+
+// Recording
+
+void SessionLengthSketch::add(int minutes, quint32 count)
+{
+    if (count == 0) {
+        return;
+    }
+    if (!d) {
+        d = new Data;
+    }
+
+    if (minutes <= 0) {
+        d->zeroCount += count;
+    } else {
+        d->slot(keyOf(minutes)) += count;
+    }
+    d->total += count;
+}
+
+void SessionLengthSketch::merge(const SessionLengthSketch& other)
+{
+    if (!other.d || other.d->total == 0) {
+        return;
+    }
+    if (!d) {
+        d = other.d;
+        return;
+    }
+
+    const Data& source = *other.d;
+    d->zeroCount += source.zeroCount;
+    d->total += source.total;
+
+    // Highest first, so any folding happens once at the bottom
+    for (int i = static_cast<int>(source.counts.size()) - 1; i >= 0; --i) {
+        if (source.counts[static_cast<size_t>(i)] != 0) {
+            d->slot(source.offset + i) += source.counts[static_cast<size_t>(i)];
+        }
+    }
+}
+
+// Queries
+
+double SessionLengthSketch::quantile(double q) const
+{
+    if (!d || d->total == 0) {
+        return 0.0;
+    }
+
+    q = qBound(0.0, q, 1.0);
+    const quint64 rank = static_cast<quint64>(q * static_cast<double>(d->total - 1));
+
+    quint64 seen = d->zeroCount;
+    if (seen > rank) {
+        return 0.0;
+    }
+    for (size_t i = 0; i < d->counts.size(); ++i) {
+        seen += d->counts[i];
+        if (seen > rank) {
+            return lengthOf(d->offset + static_cast<int>(i));
+        }
+    }
+    return lengthOf(d->offset + static_cast<int>(d->counts.size()) - 1);
+}
+
+quint64 SessionLengthSketch::count() const
+{
+    return d ? d->total : 0;
+}
+
+bool SessionLengthSketch::isEmpty() const
+{
+    return count() == 0;
+}
+
+int SessionLengthSketch::bucketCount() const
+{
+    return d ? static_cast<int>(d->counts.size()) : 0;
+}
+
+void SessionLengthSketch::clear()
+{
+    d.reset();
+}
+
+bool SessionLengthSketch::operator==(const SessionLengthSketch& other) const
+{
+    if (isEmpty() || other.isEmpty()) {
+        return isEmpty() == other.isEmpty();
+    }
+    return d->zeroCount == other.d->zeroCount
+        && (d->counts.empty() || d->offset == other.d->offset)
+        && d->counts == other.d->counts;
+}
+
+// Encoding
+
+void SessionLengthSketch::appendTo(QByteArray& out) const
+{
+    if (isEmpty()) {
+        return;
+    }
+
+    out.append(static_cast<char>(FORMAT_VERSION));
+    appendVarint(out, d->zeroCount);
+    appendVarint(out, static_cast<quint64>(d->offset));
+    appendVarint(out, d->counts.size());
+    for (quint32 count : d->counts) {
+        appendVarint(out, count);
+    }
+}
+
+QByteArray SessionLengthSketch::toBytes() const
+{
+    QByteArray out;
+    appendTo(out);
+    return out;
+}
+
+bool SessionLengthSketch::fromBytes(const char* data, int length)
+{
+    if (length == 0) {
+        clear();
+        return true;
+    }
+
+    const char* pos = data;
+    const char* end = data + length;
+    if (static_cast<quint8>(*pos++) != FORMAT_VERSION) {
+        return false;
+    }
+
+    quint64 zeroCount, offset, size;
+    if (!readVarint(pos, end, zeroCount) || !readVarint(pos, end, offset) || !readVarint(pos, end, size)
+        || zeroCount > 0xFFFFFFFFu || offset > 0xFFFF || size > static_cast<quint64>(MAX_BUCKETS)) {
+        return false;
+    }
+
+    QSharedDataPointer<Data> decoded(new Data);
+    decoded->zeroCount = static_cast<quint32>(zeroCount);
+    decoded->offset = static_cast<qint32>(offset);
+    decoded->total = zeroCount;
+    decoded->counts.resize(static_cast<size_t>(size));
+    for (quint32& count : decoded->counts) {
+        quint64 value;
+        if (!readVarint(pos, end, value) || value > 0xFFFFFFFFu) {
+            return false;
+        }
+        count = static_cast<quint32>(value);
+        decoded->total += value;
+    }
+    if (pos != end) {
+        return false;
+    }
+
+    d = decoded;
+    return true;
+}
@@ -0,0 +1,93 @@
+#ifndef SESSIONLENGTHSKETCH_H
+#define SESSIONLENGTHSKETCH_H
+
+#include <QByteArray>
+#include <QSharedData>
+#include <QSharedDataPointer>
+#include <QtGlobal>
+#include <vector>
+
+/**
+ * @brief Mergeable quantile sketch of session lengths (DDSketch)
+ *
+ * Lengths in minutes are counted in logarithmically spaced buckets: bucket
+ * k holds lengths in (gamma^(k-1), gamma^k] with
+ * gamma = (1 + RELATIVE_ACCURACY) / (1 - RELATIVE_ACCURACY), so every
+ * quantile is returned within RELATIVE_ACCURACY of a length that was
+ * actually recorded. Zero-minute sessions have their own counter.
+ *
+ * Buckets are stored densely from the lowest used key. At most MAX_BUCKETS
+ * are kept (a span of about 2000x, e.g. one minute to a day and a half);
+ * beyond that the lowest buckets are folded together, which keeps the
+ * upper quantiles exact to the stated accuracy at the cost of the shortest
+ * sessions. Worst case storage is MAX_BUCKETS counters; applications that
+ * were never used hold a null pointer.
+ *
+ * Sketches merge by adding bucket counts, so totals for a category or any
+ * group of applications (or sketches kept per time window) are combined
+ * without losing accuracy. The data is implicitly shared, so copying an
+ * Application for a snapshot does not copy its buckets.
+ */
+class SessionLengthSketch
+{
+public:
+    static constexpr double RELATIVE_ACCURACY = 0.04;
+    static constexpr int MAX_BUCKETS = 96;
+
+    SessionLengthSketch();
+
+    /**
+     * @brief Record count sessions of the given length
+     */
+    void add(int minutes, quint32 count = 1);
+
+    /**
+     * @brief Add all sessions recorded by other
+     */
+    void merge(const SessionLengthSketch& other);
+
+    /**
+     * @brief Estimated length at quantile q (0..1), in minutes
+     * @return 0 if the sketch is empty
+     *
+     * Walks the buckets once, so it costs O(bucketCount()).
+     */
+    double quantile(double q) const;
+
+    quint64 count() const;
+    bool isEmpty() const;
+    int bucketCount() const;
+    void clear();
+
+    /**
+     * @brief Compact varint encoding; an empty sketch encodes to no bytes
+     */
+    void appendTo(QByteArray& out) const;
+    QByteArray toBytes() const;
+
+    /**
+     * @brief Replace the contents with an encoding from appendTo()
+     * @return false (leaving the sketch unchanged) if the bytes are malformed
+     */
+    bool fromBytes(const char* data, int length);
+
+    bool operator==(const SessionLengthSketch& other) const;
+    bool operator!=(const SessionLengthSketch& other) const { return !(*this == other); }
+
+private:
+    struct Data : QSharedData {
+        quint64 total = 0;
+        quint32 zeroCount = 0;
+        qint32 offset = 0;                  // Key of counts[0]
+        std::vector<quint32> counts;
+
+        quint32& slot(int key);
+    };
+
+    static int keyOf(int minutes);
+    static double lengthOf(int key);
+
+    QSharedDataPointer<Data> d;
+};
+
+#endif // SESSIONLENGTHSKETCH_H
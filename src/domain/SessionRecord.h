@@ -0,0 +1,35 @@
+#ifndef SESSIONRECORD_H
+#define SESSIONRECORD_H
+
+#include <QtGlobal>
+
+/**
+ * @brief One finished GameSession, as kept by SessionHistoryStore
+ *
+ * Times are seconds since epoch (UTC). appKey is the history store's
+ * persistent key for the process name (see SessionHistoryStore::appKey()),
+ * which unlike ApplicationId stays the same across restarts.
+ */
+struct SessionRecord
+{
+    enum class Termination : quint8 {
+        ProcessExited = 0,     // The game was closed by the user
+        TimeLimitReached = 1,  // We terminated it when the time ran out
+        Abandoned = 2,         // The monitor stopped (shutdown, crash) first
+    };
+
+    quint32 appKey = 0;
+    qint64 start = 0;
+    qint64 end = 0;
+    quint32 activeSeconds = 0;
+    Termination reason = Termination::ProcessExited;
+
+    qint64 duration() const { return end - start; }
+
+    /**
+     * @brief True if the session overlaps [from, to)
+     */
+    bool overlaps(qint64 from, qint64 to) const { return start < to && end > from; }
+};
+
+#endif // SESSIONRECORD_H
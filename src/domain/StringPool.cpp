@@ -0,0 +1,136 @@
+#include "StringPool.h"
+#include <QMutexLocker>
+#include <cstring>
+
+StringPool& StringPool::instance()
+{
+    // Deliberately never destroyed: QStrings handed out by get() wrap pooled
+    // characters and may outlive static destruction order.
+    static StringPool* pool = new StringPool();
+    return *pool;
+}
+
+StringPool::StringPool()
+    : m_size(0),
+      m_charBytes(0)
+{
+    for (std::atomic<Entry*>& page : m_pages) {
+        page.store(nullptr, std::memory_order_relaxed);
+    }
+    
+    // Id 0 is reserved for the empty string
+    intern(QString());
+}
+
+StringPool::~StringPool()
+{
+    for (std::atomic<Entry*>& page : m_pages) {
+        delete[] page.load(std::memory_order_relaxed);
+    }
+    for (Shard& shard : m_shards) {
+        for (QChar* block : shard.blocks) {
+            delete[] block;
+        }
+    }
+}
+
+quint32 StringPool::intern(const QString& str)
+{
+    Shard& shard = m_shards[qHash(str, size_t(0)) % SHARD_COUNT];
+    QMutexLocker locker(&shard.mutex);
+    
+    auto it = shard.lookup.constFind(str);
+    if (it != shard.lookup.constEnd()) {
+        return it.value();
+    }
+    
+    // The shard lock keeps a string from being added twice; the id itself
+    // is claimed from the counter all shards share
+    const quint32 id = m_size.fetch_add(1, std::memory_order_relaxed);
+    Q_ASSERT(id / ENTRIES_PER_PAGE < MAX_PAGES);
+    
+    const QChar* data = storeCharacters(shard, str);
+    page(static_cast<int>(id / ENTRIES_PER_PAGE))[id % ENTRIES_PER_PAGE] =
+        Entry{data, static_cast<qint32>(str.size())};
+    shard.lookup.insert(QString::fromRawData(data, str.size()), id);
+    return id;
+}
+
+QString StringPool::get(quint32 id) const
+{
+    if (id >= m_size.load(std::memory_order_acquire)) {
+        return QString();
+    }
+    
+    const Entry* page = m_pages[id / ENTRIES_PER_PAGE].load(std::memory_order_acquire);
+    if (!page) {
+        return QString();
+    }
+    const Entry& entry = page[id % ENTRIES_PER_PAGE];
+    return QString::fromRawData(entry.data, entry.length);
+}
+
+quint32 StringPool::size() const
+{
+    return m_size.load(std::memory_order_acquire);
+}
+
+qint64 StringPool::memoryUsage() const
+{
+    quint32 count = size();
+    qint64 pages = (count + ENTRIES_PER_PAGE - 1) / ENTRIES_PER_PAGE;
+    
+    // Rough hash cost: key + value + bucket overhead per entry
+    qint64 lookupBytes = static_cast<qint64>(count) * (sizeof(QString) + sizeof(quint32) + 16);
+    
+    return m_charBytes.load(std::memory_order_relaxed)
+         + pages * ENTRIES_PER_PAGE * static_cast<qint64>(sizeof(Entry))
+         + lookupBytes;
+}
+
+StringPool::Entry* StringPool::page(int index)
+{
+    Entry* page = m_pages[index].load(std::memory_order_acquire);
+    if (page) {
+        return page;
+    }
+    
+    // Threads that fill the previous page at the same time race to add
+    // this one; the losers drop theirs
+    Entry* fresh = new Entry[ENTRIES_PER_PAGE]();
+    if (m_pages[index].compare_exchange_strong(page, fresh, std::memory_order_acq_rel)) {
+        return fresh;
+    }
+    delete[] fresh;
+    return page;
+}
+
+const QChar* StringPool::storeCharacters(Shard& shard, const QString& str)
+{
+    static const QChar empty[1] = {QChar(0)};
+    qsizetype length = str.size();
+    if (length == 0) {
+        return empty;
+    }
+    
+    // Oversized strings get a block of their own
+    if (length > CHARS_PER_BLOCK / 4) {
+        QChar* block = new QChar[length];
+        std::memcpy(static_cast<void*>(block), str.constData(), length * sizeof(QChar));
+        shard.blocks.push_back(block);
+        m_charBytes.fetch_add(length * sizeof(QChar), std::memory_order_relaxed);
+        return block;
+    }
+    
+    if (shard.blockUsed + length > CHARS_PER_BLOCK) {
+        shard.currentBlock = new QChar[CHARS_PER_BLOCK];
+        shard.blocks.push_back(shard.currentBlock);
+        shard.blockUsed = 0;
+        m_charBytes.fetch_add(CHARS_PER_BLOCK * sizeof(QChar), std::memory_order_relaxed);
+    }
+    
+    QChar* dest = shard.currentBlock + shard.blockUsed;
+    std::memcpy(static_cast<void*>(dest), str.constData(), length * sizeof(QChar));
+    shard.blockUsed += length;
+    return dest;
+}
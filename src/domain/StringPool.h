@@ -0,0 +1,105 @@
+#ifndef STRINGPOOL_H
+#define STRINGPOOL_H
+
+#include <QString>
+#include <QHash>
+#include <QMutex>
+#include <atomic>
+#include <vector>
+
+/**
+ * @brief Process-wide, append-only pool of interned strings
+ * 
+ * Process and display names are stored once in large character blocks and
+ * referred to by a 32-bit id. Application keeps only these ids, which keeps
+ * the entity small and lets repeated names (e.g. display name == process
+ * name) share one copy.
+ * 
+ * Strings are never removed, so the QString returned by get() can wrap the
+ * pooled characters with QString::fromRawData() and never copies them.
+ * 
+ * Thread Safety: intern() may be called from any thread. The lookup is split
+ * into SHARD_COUNT shards by string hash, each with its own mutex and
+ * character blocks, so threads interning different strings (e.g. parallel
+ * import workers) rarely wait for each other; ids come from one atomic
+ * counter and stay dense. get() takes no lock; an id may be resolved on any
+ * thread that received it through normal synchronization (signals, snapshot
+ * publication, ...).
+ */
+class StringPool
+{
+public:
+    /**
+     * @brief The pool shared by all Application instances
+     */
+    static StringPool& instance();
+    
+    /**
+     * @brief Id of the empty string; always valid
+     */
+    static constexpr quint32 EMPTY_ID = 0;
+    
+    /**
+     * @brief Store a string (if not already present) and return its id
+     */
+    quint32 intern(const QString& str);
+    
+    /**
+     * @brief Resolve an id returned by intern()
+     * @return A QString referencing the pooled characters (no copy)
+     */
+    QString get(quint32 id) const;
+    
+    /**
+     * @brief Number of distinct strings stored, including the empty string
+     */
+    quint32 size() const;
+    
+    /**
+     * @brief Total bytes held by the pool (characters, entries and lookup table)
+     */
+    qint64 memoryUsage() const;
+    
+    StringPool(const StringPool&) = delete;
+    StringPool& operator=(const StringPool&) = delete;
+
+private:
+    StringPool();
+    ~StringPool();
+    
+    struct Entry {
+        const QChar* data;
+        qint32 length;
+    };
+    
+    static constexpr int ENTRIES_PER_PAGE = 4096;
+    static constexpr int MAX_PAGES = 4096;           // 16M distinct strings
+    static constexpr qsizetype CHARS_PER_BLOCK = 64 * 1024;
+    static constexpr int SHARD_COUNT = 16;
+    
+    /**
+     * @brief Writer state for the strings that hash to one shard
+     * 
+     * Aligned to a cache line so that shards locked by different threads
+     * do not share one.
+     */
+    struct alignas(64) Shard {
+        QMutex mutex;
+        QHash<QString, quint32> lookup;     // Keys wrap pooled characters
+        std::vector<QChar*> blocks;
+        QChar* currentBlock = nullptr;
+        qsizetype blockUsed = CHARS_PER_BLOCK;
+    };
+    
+    Entry* page(int index);
+    const QChar* storeCharacters(Shard& shard, const QString& str);
+    
+    // Entry pages never move, so get() can read them without a lock
+    std::atomic<Entry*> m_pages[MAX_PAGES];
+    std::atomic<quint32> m_size;
+    std::atomic<qint64> m_charBytes;
+    
+    Shard m_shards[SHARD_COUNT];
+};
+
+#endif // STRINGPOOL_H
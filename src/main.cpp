@@ -4,7 +4,15 @@
 
 int main(int argc, char *argv[])
 {
-    EventLogger::install();
+    // With MINDFULNESS_BINARY_LOG set, structured events go to that file in
+    // binary form (render it with mindfulness_logdecode) instead of the text log.
+    EventLogger::install(EventLogger::DEFAULT_FILE, true, qEnvironmentVariable("MINDFULNESS_BINARY_LOG"));
+
+    // e.g. MINDFULNESS_LOG_RULES="repository=warning,dispatch=off"
+    const QString logRules = qEnvironmentVariable("MINDFULNESS_LOG_RULES");
+    if (!LogFilter::configure(logRules)) {
+        MF_LOG_WARNING(General, "Ignoring unknown log rules in %1", logRules);
+    }
 
     QApplication app(argc, argv);
 
@@ -13,5 +21,9 @@ int main(int argc, char *argv[])
 
     AppController controller;
     
-    return app.exec();
+    int result = app.exec();
+
+    // Write out whatever is still queued before the logger goes away
+    EventLogger::shutdown();
+    return result;
 }
\ No newline at end of file
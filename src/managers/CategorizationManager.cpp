@@ -3,8 +3,8 @@
 #include "CategorizeDialog.h"      // <-- We'll need to create this new dialog
 #include "ApplicationRepository.h"
 #include "Application.h"
-#include <QDebug>
-#include <windows.h>
+#include "EventLogger.h"
+#include "services/metrics/TraceSpans.h"
 
 
 
@@ -67,31 +67,30 @@ void CategorizationManager::onShowConfigWindow()
     // This is the logic you were trying to place in AppController.
     // It now lives here, in the correct manager.
 
-    QList<Application*> gameApps;
-    QList<Application*> otherApps;
+    // The repository keeps a per-category index, so each bucket is
+    // walked directly instead of splitting the master list here.
+    ApplicationQuery games = ApplicationQuery().inCategories({
+        Application::Category::Game,
+        Application::Category::Leisure
+    });
 
-    // Get the master list ONCE.
-    QList<Application*> allApps = m_appRepository->findAll();
-
-    // Sort the list into two buckets in a single O(N) pass.
-    for (Application* app : allApps)
-    {
-        if (app == nullptr) continue;
-
-        Application::Category cat = app->getCategory();
-
-        if (cat == Application::Category::Game || cat == Application::Category::Leisure) {
-            gameApps.append(app);
-        } else {
-            // Includes "Work", "Productivity", "System", "Uncategorized", etc.
-            otherApps.append(app);
-        }
-    }
+    // Includes "Work", "Productivity", "System", "Uncategorized", etc.
+    ApplicationQuery otherApps = ApplicationQuery().excludingCategories({
+        Application::Category::Game,
+        Application::Category::Leisure
+    });
 
     // --- 3. Create the window ---
     
-    // We pass the sorted lists to the passive ConfigWindow constructor.
-    m_configWindow = new ConfigWindow(gameApps, otherApps, nullptr);
+    // The passive ConfigWindow is filled in place from the repository;
+    // no intermediate lists or Application copies are made.
+    m_configWindow = new ConfigWindow(nullptr);
+    m_appRepository->forEach(games, [this](const Application& app) {
+        m_configWindow->addGame(app);
+    });
+    m_appRepository->forEach(otherApps, [this](const Application& app) {
+        m_configWindow->addOtherApplication(app);
+    });
     m_configWindow->setAttribute(Qt::WA_DeleteOnClose);
 
     // Connect the window's destroyed signal to our cleanup slot.
@@ -140,6 +139,7 @@ void CategorizationManager::showCategorizeDialog(const QString& processName)
     // NOTE: This assumes a constructor for CategorizeDialog exists
     // that takes the repository. We will need to design this dialog.
     
+    MF_TRACE_SPAN("create categorize dialog");
     m_categorizeDialog = new CategorizeDialog(processName, m_appRepository, nullptr);
     m_categorizeDialog->setAttribute(Qt::WA_DeleteOnClose);
     
@@ -151,5 +151,5 @@ void CategorizationManager::showCategorizeDialog(const QString& processName)
     m_categorizeDialog->raise();
 
     // For now, let's just log it so we know the signal is working.
-    qDebug() << "Signal received: Uncategorized app detected:" << processName;
+    MF_LOG_DEBUG(Dispatch, "Signal received: Uncategorized app detected: %1", processName);
 }
\ No newline at end of file
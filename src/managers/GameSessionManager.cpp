@@ -1,10 +1,18 @@
 #include "GameSessionManager.h"
+#include "ApplicationRepository.h"
 #include "GameSession.h"
+#include "SessionHistoryStore.h"
+#include "services/infrastructure/DeadlineScheduler.h"
+#include "services/infrastructure/TimeSource.h"
+#include "services/metrics/DetectionLatency.h"
 
-GameSessionManager::GameSessionManager(QObject *parent)
-    : QObject(parent)
+GameSessionManager::GameSessionManager(ApplicationRepository* repository, SessionHistoryStore* history,
+                                       TimeSource* time, QObject *parent)
+    : QObject(parent),
+      m_repository(repository),
+      m_history(history),
+      m_scheduler(new DeadlineScheduler(time, this))
 {
-    // TODO: Implement
 }
 
 GameSessionManager::~GameSessionManager()
@@ -19,19 +27,44 @@ void GameSessionManager::onGameDetected(DWORD pid, const QString& processName)
     // TODO: Implement
     // 1. Check if a session for this PID or Name already exists
     // 2. If not, create a new one:
-    // GameSession* session = new GameSession(pid, processName);
+    // GameSession* session = new GameSession(pid, processName, m_scheduler);
     // connect(session, &GameSession::sessionFinished, 
     //         this, &GameSessionManager::onSessionFinished);
     // m_activeSessions.append(session);
     // session->startSessionPrompt(); // New method to show dialog
+
+    // End of the detection path; until sessions are created above this
+    // times the hand-off from the dispatcher
+    DetectionLatency::sessionStarted(pid);
 }
 
 void GameSessionManager::onSessionFinished()
 {
-    // TODO: Implement
-    // GameSession* session = qobject_cast<GameSession*>(sender());
-    // if (session) {
-    //     m_activeSessions.removeOne(session);
-    //     session->deleteLater();
-    // }
+    GameSession* session = qobject_cast<GameSession*>(sender());
+    if (!session) {
+        return;
+    }
+
+    const qint64 end = m_scheduler->timeSource()->currentSecsSinceEpoch();
+    const int activeSeconds = qMax(0, session->activeSeconds());
+
+    if (m_history) {
+        SessionRecord record;
+        record.appKey = m_history->appKey(session->processName());
+        record.start = session->startedAt();
+        record.end = end;
+        record.activeSeconds = static_cast<quint32>(activeSeconds);
+        record.reason = session->terminationReason();
+        m_history->append(record);
+    }
+
+    // Updates the totals and the usage rollups
+    if (m_repository) {
+        if (Application* app = m_repository->find(session->processName())) {
+            app->recordSessionEnd(session->startedAt(), end, activeSeconds);
+        }
+    }
+
+    m_activeSessions.removeOne(session);
+    session->deleteLater();
 }
\ No newline at end of file
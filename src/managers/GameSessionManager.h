@@ -4,17 +4,27 @@
 #include <QObject>
 #include <QList>
 #include <QString>
-#include <windows.h> // For DWORD
+#include "services/utils/PlatformTypes.h" // For DWORD
 
 // Forward declarations
+class ApplicationRepository;
+class DeadlineScheduler;
 class GameSession;
+class SessionHistoryStore;
+class TimeSource;
 
 class GameSessionManager : public QObject
 {
     Q_OBJECT
 
 public:
-    explicit GameSessionManager(QObject *parent = nullptr);
+    /**
+     * @param repository Holds the applications whose statistics are updated when a session ends (may be null)
+     * @param history Receives a record for every finished session (may be null)
+     * @param time Clock for session deadlines and records (not owned); TimeSource::system() if null
+     */
+    GameSessionManager(ApplicationRepository* repository, SessionHistoryStore* history,
+                       TimeSource* time, QObject *parent = nullptr);
     ~GameSessionManager();
 
 public slots:
@@ -25,6 +35,9 @@ private slots:
 
 private:
     QList<GameSession*> m_activeSessions;
+    ApplicationRepository* m_repository;
+    SessionHistoryStore* m_history;
+    DeadlineScheduler* m_scheduler; // Warning and time limit deadlines of every session; sleep pauses them
 };
 
 #endif // GAMESESSIONMANAGER_H
\ No newline at end of file
@@ -0,0 +1,794 @@
+#include "ApplicationCodecs.h"
+#include "Application.h"
+#include "ApplicationFields.h"
+#include "JsonReader.h"
+#include "StringPool.h"
+#include <QDateTime>
+#include <cstring>
+
+namespace {
+
+using Kind = ApplicationFields::Kind;
+using Descriptor = ApplicationFields::Descriptor;
+
+// --- Categories ---
+
+struct CategoryName {
+    const char* name;
+    int length;
+};
+
+constexpr CategoryName CATEGORY_NAMES[Application::CATEGORY_COUNT] = {
+    {"Uncategorized", 13},
+    {"Game", 4},
+    {"Leisure", 7},
+    {"Work", 4},
+    {"Productivity", 12},
+    {"Social", 6},
+    {"Educational", 11},
+    {"Utility", 7},
+    {"System", 6}
+};
+
+qint64 categoryFromName(const char* data, int length)
+{
+    for (int i = 0; i < Application::CATEGORY_COUNT; ++i) {
+        if (CATEGORY_NAMES[i].length == length && std::memcmp(CATEGORY_NAMES[i].name, data, length) == 0) {
+            return i;
+        }
+    }
+    return static_cast<qint64>(Application::Category::Uncategorized);
+}
+
+// --- Timestamps (proleptic Gregorian calendar, UTC) ---
+
+constexpr qint64 daysFromCivil(qint64 y, unsigned m, unsigned d)
+{
+    y -= m <= 2;
+    const qint64 era = (y >= 0 ? y : y - 399) / 400;
+    const unsigned yoe = static_cast<unsigned>(y - era * 400);
+    const unsigned doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + static_cast<qint64>(doe) - 719468;
+}
+
+constexpr void civilFromDays(qint64 z, qint64& y, unsigned& m, unsigned& d)
+{
+    z += 719468;
+    const qint64 era = (z >= 0 ? z : z - 146096) / 146097;
+    const unsigned doe = static_cast<unsigned>(z - era * 146097);
+    const unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const unsigned mp = (5 * doy + 2) / 153;
+    d = doy - (153 * mp + 2) / 5 + 1;
+    m = mp < 10 ? mp + 3 : mp - 9;
+    y = static_cast<qint64>(yoe) + era * 400 + (m <= 2);
+}
+
+static_assert(daysFromCivil(1970, 1, 1) == 0, "epoch must map to day 0");
+static_assert(daysFromCivil(2000, 3, 1) == 11017, "leap handling");
+
+void appendDigits(QByteArray& out, qint64 value, int width)
+{
+    char buffer[8];
+    for (int i = width - 1; i >= 0; --i) {
+        buffer[i] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    }
+    out.append(buffer, width);
+}
+
+/**
+ * @brief Append "YYYY-MM-DDTHH:MM:SSZ"
+ */
+void appendIsoUtc(QByteArray& out, qint64 secs)
+{
+    qint64 days = secs / 86400;
+    qint64 rem = secs % 86400;
+    if (rem < 0) {
+        rem += 86400;
+        --days;
+    }
+
+    qint64 year;
+    unsigned month, day;
+    civilFromDays(days, year, month, day);
+    if (year < 0 || year > 9999) {
+        // Out of the ISO 8601 basic range; let Qt format it
+        out.append(QDateTime::fromSecsSinceEpoch(secs, Qt::UTC).toString(Qt::ISODate).toUtf8());
+        return;
+    }
+
+    appendDigits(out, year, 4);
+    out.append('-');
+    appendDigits(out, month, 2);
+    out.append('-');
+    appendDigits(out, day, 2);
+    out.append('T');
+    appendDigits(out, rem / 3600, 2);
+    out.append(':');
+    appendDigits(out, rem / 60 % 60, 2);
+    out.append(':');
+    appendDigits(out, rem % 60, 2);
+    out.append('Z');
+}
+
+bool parseDigits(const char* data, int width, int& value)
+{
+    value = 0;
+    for (int i = 0; i < width; ++i) {
+        if (data[i] < '0' || data[i] > '9') {
+            return false;
+        }
+        value = value * 10 + (data[i] - '0');
+    }
+    return true;
+}
+
+/**
+ * @brief Parse ISO 8601 with an explicit zone ("Z" or "+hh:mm")
+ * @return false if the string has no zone or another shape; callers fall
+ *         back to QDateTime, which handles local times
+ */
+bool parseIsoWithZone(const char* data, int length, qint64& secs)
+{
+    int year, month, day, hour, minute, second;
+    if (length < 20 || data[4] != '-' || data[7] != '-' || data[10] != 'T'
+        || data[13] != ':' || data[16] != ':'
+        || !parseDigits(data, 4, year) || !parseDigits(data + 5, 2, month)
+        || !parseDigits(data + 8, 2, day) || !parseDigits(data + 11, 2, hour)
+        || !parseDigits(data + 14, 2, minute) || !parseDigits(data + 17, 2, second)
+        || month < 1 || month > 12 || day < 1 || day > 31) {
+        return false;
+    }
+
+    const char* zone = data + 19;
+    const char* end = data + length;
+    if (*zone == '.') {
+        // Fractional seconds are dropped
+        ++zone;
+        while (zone < end && *zone >= '0' && *zone <= '9') {
+            ++zone;
+        }
+    }
+
+    qint64 offset = 0;
+    if (end - zone == 1 && *zone == 'Z') {
+        offset = 0;
+    } else if (end - zone == 6 && (*zone == '+' || *zone == '-') && zone[3] == ':') {
+        int offsetHours, offsetMinutes;
+        if (!parseDigits(zone + 1, 2, offsetHours) || !parseDigits(zone + 4, 2, offsetMinutes)) {
+            return false;
+        }
+        offset = (offsetHours * 3600 + offsetMinutes * 60) * (*zone == '-' ? -1 : 1);
+    } else {
+        return false;
+    }
+
+    secs = daysFromCivil(year, month, day) * 86400 + hour * 3600 + minute * 60 + second - offset;
+    return true;
+}
+
+qint64 parseTimestamp(const char* data, int length)
+{
+    qint64 secs;
+    if (parseIsoWithZone(data, length, secs)) {
+        return secs;
+    }
+
+    // Local-time strings written by older versions
+    QDateTime dateTime = QDateTime::fromString(QString::fromUtf8(data, length), Qt::ISODate);
+    return dateTime.isValid() ? dateTime.toSecsSinceEpoch() : 0;
+}
+
+// --- Integers ---
+
+void appendDecimal(QByteArray& out, qint64 value)
+{
+    char buffer[24];
+    char* end = buffer + sizeof(buffer);
+    char* p = end;
+    quint64 magnitude = value < 0 ? 0 - static_cast<quint64>(value) : static_cast<quint64>(value);
+    do {
+        *--p = static_cast<char>('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude);
+    if (value < 0) {
+        *--p = '-';
+    }
+    out.append(p, static_cast<int>(end - p));
+}
+
+void appendVarint(QByteArray& out, quint64 value)
+{
+    while (value >= 0x80) {
+        out.append(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    out.append(static_cast<char>(value));
+}
+
+bool readVarint(const char*& pos, const char* end, quint64& value)
+{
+    value = 0;
+    for (int shift = 0; shift < 64 && pos < end; shift += 7) {
+        quint8 byte = static_cast<quint8>(*pos++);
+        value |= static_cast<quint64>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+constexpr quint64 zigzag(qint64 value)
+{
+    return (static_cast<quint64>(value) << 1) ^ static_cast<quint64>(value >> 63);
+}
+
+constexpr qint64 unzigzag(quint64 value)
+{
+    return static_cast<qint64>(value >> 1) ^ -static_cast<qint64>(value & 1);
+}
+
+// --- CBOR ---
+
+enum CborMajor : quint8 {
+    CborUnsigned = 0,
+    CborNegative = 1,
+    CborBytes = 2,
+    CborText = 3,
+    CborArray = 4,
+    CborMap = 5,
+    CborTag = 6,
+    CborSimple = 7
+};
+
+constexpr quint8 CBOR_FALSE = 20;
+constexpr quint8 CBOR_TRUE = 21;
+constexpr quint64 CBOR_TAG_EPOCH = 1;
+
+void appendCborHead(QByteArray& out, quint8 major, quint64 value)
+{
+    char head[9];
+    int size;
+    quint8 prefix = static_cast<quint8>(major << 5);
+    if (value < 24) {
+        head[0] = static_cast<char>(prefix | value);
+        size = 1;
+    } else if (value <= 0xFF) {
+        head[0] = static_cast<char>(prefix | 24);
+        size = 2;
+    } else if (value <= 0xFFFF) {
+        head[0] = static_cast<char>(prefix | 25);
+        size = 3;
+    } else if (value <= 0xFFFFFFFFu) {
+        head[0] = static_cast<char>(prefix | 26);
+        size = 5;
+    } else {
+        head[0] = static_cast<char>(prefix | 27);
+        size = 9;
+    }
+    // Big-endian argument
+    for (int i = size - 1; i >= 1; --i) {
+        head[i] = static_cast<char>(value & 0xFF);
+        value >>= 8;
+    }
+    out.append(head, size);
+}
+
+void appendCborInt(QByteArray& out, qint64 value)
+{
+    if (value >= 0) {
+        appendCborHead(out, CborUnsigned, static_cast<quint64>(value));
+    } else {
+        appendCborHead(out, CborNegative, static_cast<quint64>(-1 - value));
+    }
+}
+
+bool readCborHead(const char*& pos, const char* end, quint8& major, quint64& value)
+{
+    if (pos >= end) {
+        return false;
+    }
+    quint8 initial = static_cast<quint8>(*pos++);
+    major = initial >> 5;
+    quint8 info = initial & 0x1F;
+    if (info < 24) {
+        value = info;
+        return true;
+    }
+    if (info > 27) {
+        return false;   // Indefinite lengths are not produced by this codec
+    }
+
+    int size = 1 << (info - 24);
+    if (end - pos < size) {
+        return false;
+    }
+    value = 0;
+    for (int i = 0; i < size; ++i) {
+        value = (value << 8) | static_cast<quint8>(*pos++);
+    }
+    return true;
+}
+
+bool skipCborItem(const char*& pos, const char* end, int depth = 0)
+{
+    quint8 major;
+    quint64 value;
+    if (depth > 16 || !readCborHead(pos, end, major, value)) {
+        return false;
+    }
+
+    switch (major) {
+        case CborBytes:
+        case CborText:
+            if (static_cast<quint64>(end - pos) < value) {
+                return false;
+            }
+            pos += value;
+            return true;
+        case CborArray:
+            for (quint64 i = 0; i < value; ++i) {
+                if (!skipCborItem(pos, end, depth + 1)) {
+                    return false;
+                }
+            }
+            return true;
+        case CborMap:
+            for (quint64 i = 0; i < value * 2; ++i) {
+                if (!skipCborItem(pos, end, depth + 1)) {
+                    return false;
+                }
+            }
+            return true;
+        case CborTag:
+            return skipCborItem(pos, end, depth + 1);
+        default:
+            return true;
+    }
+}
+
+bool readCborInt(const char*& pos, const char* end, qint64& value)
+{
+    quint8 major;
+    quint64 raw;
+    if (!readCborHead(pos, end, major, raw)) {
+        return false;
+    }
+    if (major == CborTag && raw == CBOR_TAG_EPOCH) {
+        return readCborInt(pos, end, value);
+    }
+    if (major == CborUnsigned) {
+        value = static_cast<qint64>(raw);
+        return true;
+    }
+    if (major == CborNegative) {
+        value = -1 - static_cast<qint64>(raw);
+        return true;
+    }
+    if (major == CborSimple && (raw == CBOR_FALSE || raw == CBOR_TRUE)) {
+        value = (raw == CBOR_TRUE);
+        return true;
+    }
+    return false;
+}
+
+// --- Sketches ---
+
+bool decodeSketchBase64(const char* data, int length, SessionLengthSketch& sketch)
+{
+    QByteArray::FromBase64Result decoded = QByteArray::fromBase64Encoding(
+        QByteArray::fromRawData(data, length), QByteArray::AbortOnBase64DecodingErrors);
+    return decoded && sketch.fromBytes(decoded->constData(), static_cast<int>(decoded->size()));
+}
+
+} // namespace
+
+// --- Shared helpers ---
+
+quint32 ApplicationCodecBase::internUtf8(const char* data, int length)
+{
+    if (length == 0) {
+        return StringPool::EMPTY_ID;
+    }
+
+    // UTF-16 never needs more units than UTF-8 has bytes
+    m_stringScratch.resize(length);
+    QChar* begin = m_stringScratch.data();
+    QChar* out = begin;
+    const quint8* in = reinterpret_cast<const quint8*>(data);
+    const quint8* end = in + length;
+
+    while (in < end) {
+        uint c = *in++;
+        if (c < 0x80) {
+            *out++ = QChar(static_cast<ushort>(c));
+            continue;
+        }
+
+        int extra = (c >= 0xF0) ? 3 : (c >= 0xE0) ? 2 : (c >= 0xC0) ? 1 : -1;
+        if (extra < 0 || end - in < extra) {
+            *out++ = QChar(QChar::ReplacementCharacter);
+            continue;
+        }
+        uint code = c & (0x3F >> extra);
+        for (int i = 0; i < extra; ++i) {
+            code = (code << 6) | (*in++ & 0x3F);
+        }
+
+        if (code >= 0x10000) {
+            code -= 0x10000;
+            *out++ = QChar(static_cast<ushort>(0xD800 + (code >> 10)));
+            *out++ = QChar(static_cast<ushort>(0xDC00 + (code & 0x3FF)));
+        } else {
+            *out++ = QChar(static_cast<ushort>(code));
+        }
+    }
+
+    m_stringScratch.truncate(out - begin);
+    return StringPool::instance().intern(m_stringScratch);
+}
+
+void ApplicationCodecBase::appendUtf8(QByteArray& out, const QString& str, bool jsonEscape)
+{
+    static const char HEX[] = "0123456789abcdef";
+    const QChar* in = str.constData();
+    const QChar* end = in + str.size();
+
+    while (in < end) {
+        uint c = (in++)->unicode();
+        if (c < 0x80) {
+            if (jsonEscape && (c == '"' || c == '\\' || c < 0x20)) {
+                char escape[6] = {'\\', 'u', '0', '0', HEX[c >> 4], HEX[c & 0xF]};
+                if (c == '"' || c == '\\') {
+                    out.append('\\');
+                    out.append(static_cast<char>(c));
+                } else {
+                    out.append(escape, 6);
+                }
+            } else {
+                out.append(static_cast<char>(c));
+            }
+        } else if (c < 0x800) {
+            out.append(static_cast<char>(0xC0 | (c >> 6)));
+            out.append(static_cast<char>(0x80 | (c & 0x3F)));
+        } else if (c >= 0xD800 && c < 0xDC00 && in < end && in->unicode() >= 0xDC00 && in->unicode() < 0xE000) {
+            uint code = 0x10000 + ((c - 0xD800) << 10) + ((in++)->unicode() - 0xDC00);
+            out.append(static_cast<char>(0xF0 | (code >> 18)));
+            out.append(static_cast<char>(0x80 | ((code >> 12) & 0x3F)));
+            out.append(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+            out.append(static_cast<char>(0x80 | (code & 0x3F)));
+        } else {
+            out.append(static_cast<char>(0xE0 | (c >> 12)));
+            out.append(static_cast<char>(0x80 | ((c >> 6) & 0x3F)));
+            out.append(static_cast<char>(0x80 | (c & 0x3F)));
+        }
+    }
+}
+
+// --- JSON ---
+
+void ApplicationJsonCodec::encode(const Application& app, QByteArray& out)
+{
+    StringPool& pool = StringPool::instance();
+    out.append('{');
+
+    ApplicationFields::forEach([&](auto index) {
+        constexpr int I = decltype(index)::value;
+        constexpr Descriptor field = ApplicationFields::TABLE[I];
+
+        if constexpr (I != 0) {
+            out.append(',');
+        }
+        out.append('"');
+        out.append(field.key, field.keyLength);
+        out.append("\":", 2);
+
+        qint64 value = field.get(app);
+        if constexpr (field.kind == Kind::String) {
+            out.append('"');
+            appendUtf8(out, pool.get(static_cast<quint32>(value)), true);
+            out.append('"');
+        } else if constexpr (field.kind == Kind::Timestamp) {
+            out.append('"');
+            appendIsoUtc(out, value);
+            out.append('"');
+        } else if constexpr (field.kind == Kind::Category) {
+            const CategoryName& name = CATEGORY_NAMES[value < Application::CATEGORY_COUNT ? value : 0];
+            out.append('"');
+            out.append(name.name, name.length);
+            out.append('"');
+        } else if constexpr (field.kind == Kind::Int) {
+            appendDecimal(out, value);
+        } else if constexpr (field.kind == Kind::Sketch) {
+            m_byteScratch.resize(0);
+            (app.*field.sketch).appendTo(m_byteScratch);
+            out.append('"');
+            out.append(m_byteScratch.toBase64());
+            out.append('"');
+        } else {
+            static_assert(field.kind == Kind::Bool, "unhandled field kind");
+            out.append(value ? "true" : "false", value ? 4 : 5);
+        }
+    });
+
+    out.append('}');
+}
+
+bool ApplicationJsonCodec::decode(JsonReader& reader, Application& app)
+{
+    ApplicationFields::applyDefaults(app);
+    if (!reader.expect('{')) {
+        return false;
+    }
+
+    int expected = 0;
+    while (!reader.consume('}')) {
+        const char* key;
+        int keyLength;
+        bool escaped;
+        if (!reader.readString(key, keyLength, escaped) || !reader.expect(':')) {
+            return false;
+        }
+
+        int index = escaped ? -1 : ApplicationFields::indexOf(key, keyLength, expected);
+        if (index < 0 || reader.peek() == 'n') {
+            // Unknown key or null value
+            if (!reader.skipValue()) {
+                return false;
+            }
+            reader.skipComma();
+            continue;
+        }
+        expected = index + 1;
+
+        const Descriptor& field = ApplicationFields::TABLE[index];
+        qint64 value = field.defaultValue;
+        bool ok = true;
+
+        if (field.kind == Kind::Int || (field.kind == Kind::Timestamp && reader.peek() != '"')) {
+            ok = reader.readInteger(value);
+        } else if (field.kind == Kind::Bool) {
+            bool flag = false;
+            ok = reader.readBool(flag);
+            value = flag;
+        } else {
+            const char* data;
+            int length;
+            ok = reader.readString(data, length, escaped);
+            if (ok && escaped) {
+                ok = JsonReader::unescape(data, length, m_byteScratch);
+                data = m_byteScratch.constData();
+                length = m_byteScratch.size();
+            }
+            if (ok) {
+                if (field.kind == Kind::String) {
+                    value = internUtf8(data, length);
+                } else if (field.kind == Kind::Timestamp) {
+                    value = parseTimestamp(data, length);
+                } else if (field.kind == Kind::Sketch) {
+                    // A damaged sketch stays empty, as in Application::fromJson()
+                    decodeSketchBase64(data, length, app.*field.sketch);
+                } else {
+                    value = categoryFromName(data, length);
+                }
+            }
+        }
+
+        if (!ok) {
+            return false;
+        }
+        if (field.kind != Kind::Sketch) {
+            field.set(app, value);
+        }
+        reader.skipComma();
+    }
+
+    return !reader.failed();
+}
+
+bool ApplicationJsonCodec::decode(const char*& pos, const char* end, Application& app)
+{
+    JsonReader reader(pos, end);
+    bool ok = decode(reader, app);
+    pos = reader.position();
+    return ok;
+}
+
+// --- CBOR ---
+
+void ApplicationCborCodec::encode(const Application& app, QByteArray& out)
+{
+    StringPool& pool = StringPool::instance();
+    appendCborHead(out, CborMap, ApplicationFields::COUNT);
+
+    ApplicationFields::forEach([&](auto index) {
+        constexpr int I = decltype(index)::value;
+        constexpr Descriptor field = ApplicationFields::TABLE[I];
+
+        appendCborHead(out, CborUnsigned, I);
+        qint64 value = field.get(app);
+        if constexpr (field.kind == Kind::String) {
+            // The text head needs the UTF-8 length up front
+            m_byteScratch.resize(0);
+            appendUtf8(m_byteScratch, pool.get(static_cast<quint32>(value)), false);
+            appendCborHead(out, CborText, static_cast<quint64>(m_byteScratch.size()));
+            out.append(m_byteScratch);
+        } else if constexpr (field.kind == Kind::Timestamp) {
+            appendCborHead(out, CborTag, CBOR_TAG_EPOCH);
+            appendCborInt(out, value);
+        } else if constexpr (field.kind == Kind::Bool) {
+            appendCborHead(out, CborSimple, value ? CBOR_TRUE : CBOR_FALSE);
+        } else if constexpr (field.kind == Kind::Sketch) {
+            m_byteScratch.resize(0);
+            (app.*field.sketch).appendTo(m_byteScratch);
+            appendCborHead(out, CborBytes, static_cast<quint64>(m_byteScratch.size()));
+            out.append(m_byteScratch);
+        } else {
+            appendCborInt(out, value);
+        }
+    });
+}
+
+bool ApplicationCborCodec::decode(const char*& pos, const char* end, Application& app)
+{
+    ApplicationFields::applyDefaults(app);
+
+    quint8 major;
+    quint64 count;
+    if (!readCborHead(pos, end, major, count) || major != CborMap) {
+        return false;
+    }
+
+    int expected = 0;
+    for (quint64 i = 0; i < count; ++i) {
+        quint64 key;
+        if (!readCborHead(pos, end, major, key)) {
+            return false;
+        }
+
+        int index = -1;
+        if (major == CborUnsigned) {
+            index = key < static_cast<quint64>(ApplicationFields::COUNT) ? static_cast<int>(key) : -1;
+        } else if (major == CborText && static_cast<quint64>(end - pos) >= key) {
+            index = ApplicationFields::indexOf(pos, static_cast<int>(key), expected);
+            pos += key;
+        } else {
+            return false;
+        }
+
+        if (index < 0) {
+            if (!skipCborItem(pos, end)) {
+                return false;
+            }
+            continue;
+        }
+        expected = index + 1;
+
+        const Descriptor& field = ApplicationFields::TABLE[index];
+        qint64 value;
+        if (field.kind == Kind::String) {
+            quint64 length;
+            if (!readCborHead(pos, end, major, length) || major != CborText
+                || static_cast<quint64>(end - pos) < length) {
+                return false;
+            }
+            value = internUtf8(pos, static_cast<int>(length));
+            pos += length;
+        } else if (field.kind == Kind::Sketch) {
+            quint64 length;
+            if (!readCborHead(pos, end, major, length) || major != CborBytes
+                || static_cast<quint64>(end - pos) < length
+                || !(app.*field.sketch).fromBytes(pos, static_cast<int>(length))) {
+                return false;
+            }
+            pos += length;
+            continue;
+        } else if (!readCborInt(pos, end, value)) {
+            return false;
+        }
+        field.set(app, value);
+    }
+
+    return true;
+}
+
+// --- Binary ---
+
+namespace {
+constexpr char BINARY_MAGIC[4] = {'M', 'F', 'A', 'B'};
+}
+
+void ApplicationBinaryCodec::encodeHeader(QByteArray& out, quint32 count)
+{
+    out.append(BINARY_MAGIC, 4);
+    quint32 schema = ApplicationFields::schemaHash();
+    for (int i = 0; i < 4; ++i) {
+        out.append(static_cast<char>((schema >> (8 * i)) & 0xFF));
+    }
+    appendVarint(out, count);
+}
+
+bool ApplicationBinaryCodec::decodeHeader(const char*& pos, const char* end, quint32& count)
+{
+    if (end - pos < 8 || std::memcmp(pos, BINARY_MAGIC, 4) != 0) {
+        return false;
+    }
+
+    quint32 schema = 0;
+    for (int i = 0; i < 4; ++i) {
+        schema |= static_cast<quint32>(static_cast<quint8>(pos[4 + i])) << (8 * i);
+    }
+    if (schema != ApplicationFields::schemaHash()) {
+        return false;
+    }
+    pos += 8;
+
+    quint64 value;
+    if (!readVarint(pos, end, value) || value > 0xFFFFFFFFu) {
+        return false;
+    }
+    count = static_cast<quint32>(value);
+    return true;
+}
+
+void ApplicationBinaryCodec::encode(const Application& app, QByteArray& out)
+{
+    StringPool& pool = StringPool::instance();
+
+    ApplicationFields::forEach([&](auto index) {
+        constexpr Descriptor field = ApplicationFields::TABLE[decltype(index)::value];
+
+        qint64 value = field.get(app);
+        if constexpr (field.kind == Kind::String) {
+            m_byteScratch.resize(0);
+            appendUtf8(m_byteScratch, pool.get(static_cast<quint32>(value)), false);
+            appendVarint(out, static_cast<quint64>(m_byteScratch.size()));
+            out.append(m_byteScratch);
+        } else if constexpr (field.kind == Kind::Sketch) {
+            m_byteScratch.resize(0);
+            (app.*field.sketch).appendTo(m_byteScratch);
+            appendVarint(out, static_cast<quint64>(m_byteScratch.size()));
+            out.append(m_byteScratch);
+        } else {
+            appendVarint(out, zigzag(value));
+        }
+    });
+}
+
+bool ApplicationBinaryCodec::decode(const char*& pos, const char* end, Application& app)
+{
+    bool ok = true;
+
+    ApplicationFields::forEach([&](auto index) {
+        constexpr Descriptor field = ApplicationFields::TABLE[decltype(index)::value];
+
+        quint64 raw;
+        if (!ok || !readVarint(pos, end, raw)) {
+            ok = false;
+            return;
+        }
+
+        if constexpr (field.kind == Kind::String) {
+            if (static_cast<quint64>(end - pos) < raw) {
+                ok = false;
+                return;
+            }
+            field.set(app, internUtf8(pos, static_cast<int>(raw)));
+            pos += raw;
+        } else if constexpr (field.kind == Kind::Sketch) {
+            if (static_cast<quint64>(end - pos) < raw
+                || !(app.*field.sketch).fromBytes(pos, static_cast<int>(raw))) {
+                ok = false;
+                return;
+            }
+            pos += raw;
+        } else {
+            field.set(app, unzigzag(raw));
+        }
+    });
+
+    return ok;
+}
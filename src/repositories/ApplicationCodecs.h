@@ -0,0 +1,112 @@
+#ifndef APPLICATIONCODECS_H
+#define APPLICATIONCODECS_H
+
+#include <QByteArray>
+#include <QString>
+#include <QtGlobal>
+
+class Application;
+class JsonReader;
+
+/**
+ * @brief Shared scratch buffers for the Application codecs
+ *
+ * Decoders turn UTF-8 names into pooled ids. The bytes are converted into a
+ * reusable QString so that names which are already pooled (the common case
+ * when reloading) are looked up without allocating.
+ */
+class ApplicationCodecBase
+{
+protected:
+    /**
+     * @brief Intern a UTF-8 byte range and return its StringPool id
+     */
+    quint32 internUtf8(const char* data, int length);
+
+    /**
+     * @brief Append a pooled string as UTF-8, optionally JSON-escaped
+     */
+    static void appendUtf8(QByteArray& out, const QString& str, bool jsonEscape);
+
+    QString m_stringScratch;
+    QByteArray m_byteScratch;
+};
+
+/**
+ * @brief JSON codec generated from ApplicationFields::TABLE
+ *
+ * Writes one compact object per application with keys in table order,
+ * timestamps as ISO 8601 UTC, categories by name and session length
+ * sketches as base64 strings, so the output stays readable by
+ * QJsonDocument and Application::fromJson().
+ *
+ * The decoder reads the object straight from the byte buffer. Each key is
+ * first compared against the next field in table order (which is how the
+ * encoder wrote it) and otherwise resolved through the precomputed key
+ * hashes, so files written by other tools or older versions still load.
+ * Unknown keys are skipped; missing fields take their table defaults.
+ */
+class ApplicationJsonCodec : public ApplicationCodecBase
+{
+public:
+    /**
+     * @brief Append app as one JSON object
+     */
+    void encode(const Application& app, QByteArray& out);
+
+    /**
+     * @brief Decode the object at the reader's position into app
+     * @return false if the object is malformed
+     */
+    bool decode(JsonReader& reader, Application& app);
+
+    /**
+     * @brief Decode one object from [pos, end) and advance pos past it
+     */
+    bool decode(const char*& pos, const char* end, Application& app);
+};
+
+/**
+ * @brief CBOR (RFC 8949) codec generated from ApplicationFields::TABLE
+ *
+ * Each application is a definite-length map keyed by the field's table
+ * index, so the decoder dispatches with an array index instead of a key
+ * comparison. Text-string keys are also accepted (resolved by hash) for
+ * interoperability. Timestamps are tag 1 epoch integers, sketches are
+ * byte strings.
+ */
+class ApplicationCborCodec : public ApplicationCodecBase
+{
+public:
+    void encode(const Application& app, QByteArray& out);
+    bool decode(const char*& pos, const char* end, Application& app);
+};
+
+/**
+ * @brief Compact binary codec generated from ApplicationFields::TABLE
+ *
+ * Records carry no keys: fields are written in table order as zigzag
+ * varints, strings and sketches as a varint length plus their bytes.
+ * Because the layout is implied by the table, a stream starts with a
+ * header holding ApplicationFields::schemaHash(); decoding refuses streams
+ * written with a different table.
+ */
+class ApplicationBinaryCodec : public ApplicationCodecBase
+{
+public:
+    /**
+     * @brief Append the stream header for count records
+     */
+    static void encodeHeader(QByteArray& out, quint32 count);
+
+    /**
+     * @brief Read and validate the stream header
+     * @return false on bad magic or schema mismatch
+     */
+    static bool decodeHeader(const char*& pos, const char* end, quint32& count);
+
+    void encode(const Application& app, QByteArray& out);
+    bool decode(const char*& pos, const char* end, Application& app);
+};
+
+#endif // APPLICATIONCODECS_H
@@ -0,0 +1,298 @@
+#include "ApplicationImporter.h"
+#include "ApplicationCodecs.h"
+#include "JsonReader.h"
+#include "EventLogger.h"
+
+#include <QFile>
+#include <QSemaphore>
+#include <QThread>
+#include <QThreadPool>
+
+namespace {
+
+constexpr char APPLICATIONS_KEY[] = "applications";
+constexpr char VERSION_KEY[] = "version";
+
+inline bool isJsonSpace(char c)
+{
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+}
+
+ApplicationImporter::ApplicationImporter(int chunkBytes, int threads)
+    : m_chunkBytes(qMax(1024, chunkBytes)),
+      m_pool(new QThreadPool),
+      m_maxInFlight(0),
+      m_pendingCount(0),
+      m_mode(Mode::Root),
+      m_depth(0),
+      m_inString(false),
+      m_escape(false),
+      m_expectKey(false),
+      m_capturingKey(false),
+      m_inElement(false),
+      m_captureElement(false),
+      m_elementStart(nullptr),
+      m_failed(false),
+      m_version(1)
+{
+    int workers = threads > 0 ? threads : QThread::idealThreadCount();
+    workers = qMax(1, workers);
+    m_pool->setMaxThreadCount(workers);
+
+    // Two chunks per worker keep every core busy while the scanner fills the
+    // next one, and bound the undecoded bytes to a small multiple of chunkBytes
+    m_maxInFlight = workers * 2;
+    m_slots.reset(new QSemaphore(m_maxInFlight));
+}
+
+ApplicationImporter::~ApplicationImporter()
+{
+    // Workers hold raw pointers into m_chunks
+    m_pool->waitForDone();
+}
+
+bool ApplicationImporter::importFile(const QString& path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        MF_LOG_WARNING(Repository, "Failed to open file for import: %1 %2", path, file.errorString());
+        return false;
+    }
+    return importDevice(file);
+}
+
+bool ApplicationImporter::importDevice(QIODevice& device)
+{
+    clear();
+
+    m_pending.clear();
+    m_pending.reserve(m_chunkBytes + m_chunkBytes / 4);
+    m_pendingCount = 0;
+    m_mode = Mode::Root;
+    m_depth = 0;
+    m_inString = false;
+    m_escape = false;
+    m_expectKey = false;
+    m_capturingKey = false;
+    m_inElement = false;
+    m_captureElement = false;
+    m_key.clear();
+    m_currentKey.clear();
+    m_versionDigits.clear();
+    m_failed = false;
+    m_version = 1;
+
+    QByteArray block(READ_BLOCK_BYTES, Qt::Uninitialized);
+    while (!m_failed) {
+        qint64 n = device.read(block.data(), READ_BLOCK_BYTES);
+        if (n < 0) {
+            m_failed = true;
+            break;
+        }
+        if (n == 0) {
+            break;
+        }
+        scan(block.constData(), block.constData() + n);
+    }
+
+    return finish();
+}
+
+int ApplicationImporter::count() const
+{
+    int total = 0;
+    for (const std::unique_ptr<Chunk>& chunk : m_chunks) {
+        total += static_cast<int>(chunk->applications.size());
+    }
+    return total;
+}
+
+void ApplicationImporter::clear()
+{
+    m_pool->waitForDone();
+    m_chunks.clear();
+}
+
+bool ApplicationImporter::scan(const char* begin, const char* end)
+{
+    // An element that started in an earlier block continues here
+    if (m_inElement) {
+        m_elementStart = begin;
+    }
+
+    for (const char* p = begin; p < end; ++p) {
+        const char c = *p;
+
+        if (m_inString) {
+            if (m_escape) {
+                m_escape = false;
+            } else if (c == '\\') {
+                m_escape = true;
+            } else if (c == '"') {
+                m_inString = false;
+                m_capturingKey = false;
+                continue;
+            }
+            if (m_capturingKey) {
+                m_key.append(c);
+            }
+            continue;
+        }
+
+        if (m_depth == 0) {
+            // Only whitespace may surround the top-level object
+            if (m_mode == Mode::Root && c == '{') {
+                m_depth = 1;
+                m_expectKey = true;
+            } else if (!isJsonSpace(c)) {
+                m_failed = true;
+                return false;
+            }
+            continue;
+        }
+
+        switch (c) {
+            case '"':
+                m_inString = true;
+                if (m_mode == Mode::Root && m_depth == 1 && m_expectKey) {
+                    m_capturingKey = true;
+                    m_key.clear();
+                }
+                break;
+
+            case '{':
+            case '[':
+                if (m_mode == Mode::Applications && m_depth == 2) {
+                    // Objects are decoded; anything else in the array is skipped
+                    m_inElement = true;
+                    m_captureElement = (c == '{');
+                    m_elementStart = p;
+                } else if (m_mode == Mode::Root && m_depth == 1 && c == '[' && !m_expectKey
+                           && m_currentKey == APPLICATIONS_KEY) {
+                    m_mode = Mode::Applications;
+                }
+                ++m_depth;
+                break;
+
+            case '}':
+            case ']':
+                --m_depth;
+                if (m_mode == Mode::Applications) {
+                    if (m_depth == 2 && m_inElement) {
+                        if (m_captureElement) {
+                            m_pending.append(m_elementStart, static_cast<int>(p + 1 - m_elementStart));
+                            m_pending.append(',');
+                            ++m_pendingCount;
+                            if (m_pending.size() >= m_chunkBytes) {
+                                dispatchChunk();
+                            }
+                        }
+                        m_inElement = false;
+                    } else if (m_depth == 1) {
+                        m_mode = Mode::Root;
+                        dispatchChunk();
+                    }
+                } else if (m_depth == 0) {
+                    m_mode = Mode::Done;
+                }
+                break;
+
+            case ':':
+                if (m_mode == Mode::Root && m_depth == 1) {
+                    m_currentKey = m_key;
+                    m_expectKey = false;
+                }
+                break;
+
+            case ',':
+                if (m_mode == Mode::Root && m_depth == 1) {
+                    m_expectKey = true;
+                }
+                break;
+
+            default:
+                if (m_mode == Mode::Root && m_depth == 1 && !m_expectKey
+                    && m_currentKey == VERSION_KEY && (c == '-' || (c >= '0' && c <= '9'))) {
+                    m_versionDigits.append(c);
+                }
+                break;
+        }
+    }
+
+    // Carry the unfinished element over to the next block
+    if (m_inElement && m_captureElement) {
+        m_pending.append(m_elementStart, static_cast<int>(end - m_elementStart));
+    }
+    return true;
+}
+
+void ApplicationImporter::dispatchChunk()
+{
+    if (m_pendingCount == 0) {
+        return;
+    }
+
+    std::unique_ptr<Chunk> chunk(new Chunk);
+    chunk->bytes.swap(m_pending);
+    chunk->expected = m_pendingCount;
+    m_pending.reserve(m_chunkBytes + m_chunkBytes / 4);
+    m_pendingCount = 0;
+
+    Chunk* raw = chunk.get();
+    m_chunks.push_back(std::move(chunk));
+
+    // Blocks once m_maxInFlight chunks are waiting, which is what bounds memory
+    m_slots->acquire();
+    QSemaphore* inFlight = m_slots.get();
+    m_pool->start([raw, inFlight]() {
+        decodeChunk(raw);
+        inFlight->release();
+    });
+}
+
+bool ApplicationImporter::finish()
+{
+    m_pool->waitForDone();
+
+    if (m_failed || m_mode != Mode::Done || m_inString) {
+        return false;
+    }
+
+    for (const std::unique_ptr<Chunk>& chunk : m_chunks) {
+        if (!chunk->ok) {
+            return false;
+        }
+    }
+
+    if (!m_versionDigits.isEmpty()) {
+        bool ok = false;
+        int version = m_versionDigits.toInt(&ok);
+        if (ok) {
+            m_version = version;
+        }
+    }
+    return true;
+}
+
+void ApplicationImporter::decodeChunk(Chunk* chunk)
+{
+    ApplicationJsonCodec codec;
+    Application app;
+    JsonReader reader(chunk->bytes);
+
+    chunk->applications.reserve(static_cast<std::size_t>(chunk->expected));
+    while (!reader.atEnd()) {
+        if (!codec.decode(reader, app)) {
+            chunk->ok = false;
+            break;
+        }
+        chunk->applications.push_back(app);
+        reader.skipComma();
+    }
+
+    chunk->ok = chunk->ok && !reader.failed()
+                && static_cast<int>(chunk->applications.size()) == chunk->expected;
+    chunk->bytes = QByteArray();
+}
@@ -0,0 +1,140 @@
+#ifndef APPLICATIONIMPORTER_H
+#define APPLICATIONIMPORTER_H
+
+#include "Application.h"
+#include <QByteArray>
+#include <QString>
+#include <memory>
+#include <vector>
+
+class QIODevice;
+class QSemaphore;
+class QThreadPool;
+
+/**
+ * @brief Streaming, parallel reader for applications.json files
+ *
+ * The file is read in fixed-size blocks. A byte-level scanner follows the
+ * JSON structure just far enough to find the top-level "applications"
+ * array and the boundaries of its elements. Complete elements are
+ * collected into chunks of roughly chunkBytes, and each chunk is decoded by
+ * ApplicationJsonCodec on a thread pool while the scanner keeps reading.
+ *
+ * At most a few chunks per worker are in flight at any time, so besides
+ * the decoded (compact) Application records, peak memory is proportional
+ * to the chunk size rather than to the file size. No DOM is ever built.
+ *
+ * The decoded records are kept per chunk in file order; the caller merges
+ * them into the repository in one batch once the whole file has been
+ * accepted, so a malformed file never leaves partial results behind.
+ */
+class ApplicationImporter
+{
+public:
+    static constexpr int DEFAULT_CHUNK_BYTES = 256 * 1024;
+    static constexpr int READ_BLOCK_BYTES = 64 * 1024;
+
+    /**
+     * @param chunkBytes Target size of one decode chunk
+     * @param threads Worker count, or 0 for QThread::idealThreadCount()
+     */
+    explicit ApplicationImporter(int chunkBytes = DEFAULT_CHUNK_BYTES, int threads = 0);
+    ~ApplicationImporter();
+
+    ApplicationImporter(const ApplicationImporter&) = delete;
+    ApplicationImporter& operator=(const ApplicationImporter&) = delete;
+
+    /**
+     * @brief Import a file
+     * @return false if the file can't be opened or is malformed
+     */
+    bool importFile(const QString& path);
+
+    /**
+     * @brief Import from an open device, reading it to the end
+     */
+    bool importDevice(QIODevice& device);
+
+    /**
+     * @brief The document's "version" field (1 if absent)
+     */
+    int version() const { return m_version; }
+
+    /**
+     * @brief Number of decoded applications
+     */
+    int count() const;
+
+    /**
+     * @brief Number of chunks the applications array was split into
+     */
+    int chunkCount() const { return static_cast<int>(m_chunks.size()); }
+
+    /**
+     * @brief Visit the decoded applications in file order
+     * @param visitor Callable taking const Application&
+     */
+    template<typename Visitor>
+    void forEach(Visitor&& visitor) const
+    {
+        for (const std::unique_ptr<Chunk>& chunk : m_chunks) {
+            for (const Application& app : chunk->applications) {
+                visitor(app);
+            }
+        }
+    }
+
+    /**
+     * @brief Release the decoded applications
+     */
+    void clear();
+
+private:
+    struct Chunk {
+        QByteArray bytes;                       // Freed once decoded
+        int expected = 0;                       // Elements the scanner saw
+        std::vector<Application> applications;
+        bool ok = true;
+    };
+
+    enum class Mode {
+        Root,           // Inside the top-level object
+        Applications,   // Inside the top-level "applications" array
+        Done            // Top-level object closed
+    };
+
+    bool scan(const char* begin, const char* end);
+    void onRootKey();
+    void dispatchChunk();
+    bool finish();
+
+    static void decodeChunk(Chunk* chunk);
+
+    int m_chunkBytes;
+    std::unique_ptr<QThreadPool> m_pool;
+    std::unique_ptr<QSemaphore> m_slots;
+    int m_maxInFlight;
+
+    std::vector<std::unique_ptr<Chunk>> m_chunks;
+    QByteArray m_pending;       // Elements not yet dispatched
+    int m_pendingCount;
+
+    // Scanner state (persists across read blocks)
+    Mode m_mode;
+    int m_depth;
+    bool m_inString;
+    bool m_escape;
+    bool m_expectKey;
+    bool m_capturingKey;
+    bool m_inElement;
+    bool m_captureElement;
+    const char* m_elementStart;
+    QByteArray m_key;
+    QByteArray m_currentKey;
+    QByteArray m_versionDigits;
+    bool m_failed;
+
+    int m_version;
+};
+
+#endif // APPLICATIONIMPORTER_H
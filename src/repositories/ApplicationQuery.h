@@ -0,0 +1,143 @@
+#ifndef APPLICATIONQUERY_H
+#define APPLICATIONQUERY_H
+
+#include "Application.h"
+#include <QtGlobal>
+#include <initializer_list>
+#include <limits>
+
+/**
+ * @brief Composable filter for ApplicationRepository::forEach()
+ *
+ * A query is a plain value that combines three conditions with AND:
+ * category membership, a lastSeen window and a minimum session count.
+ * Each builder method narrows the query further, and operator& combines
+ * two queries, so filters can be built up in steps:
+ *
+ *     ApplicationQuery recentGames = ApplicationQuery()
+ *         .inCategories({Application::Category::Game, Application::Category::Leisure})
+ *         .seenSince(cutoff)
+ *         .withMinSessions(5);
+ *
+ * The repository uses the most selective condition to choose which index
+ * to walk and checks the rest with matches(), so no intermediate container
+ * is built.
+ */
+class ApplicationQuery
+{
+public:
+    ApplicationQuery() = default;
+
+    // Builders
+
+    /**
+     * @brief Keep only applications in one of the given categories
+     */
+    ApplicationQuery& inCategories(std::initializer_list<Application::Category> categories)
+    {
+        quint16 mask = 0;
+        for (Application::Category category : categories) {
+            mask |= bit(category);
+        }
+        m_categoryMask &= mask;
+        return *this;
+    }
+
+    /**
+     * @brief Drop applications in any of the given categories
+     */
+    ApplicationQuery& excludingCategories(std::initializer_list<Application::Category> categories)
+    {
+        for (Application::Category category : categories) {
+            m_categoryMask &= static_cast<quint16>(~bit(category));
+        }
+        return *this;
+    }
+
+    /**
+     * @brief Keep only applications last seen at or after the given time
+     * @param fromSecs Seconds since epoch (inclusive)
+     */
+    ApplicationQuery& seenSince(qint64 fromSecs)
+    {
+        m_seenFrom = qMax(m_seenFrom, fromSecs);
+        return *this;
+    }
+
+    /**
+     * @brief Keep only applications last seen inside [fromSecs, toSecs]
+     */
+    ApplicationQuery& seenBetween(qint64 fromSecs, qint64 toSecs)
+    {
+        m_seenFrom = qMax(m_seenFrom, fromSecs);
+        m_seenTo = qMin(m_seenTo, toSecs);
+        return *this;
+    }
+
+    /**
+     * @brief Keep only applications with at least the given number of sessions
+     */
+    ApplicationQuery& withMinSessions(int minSessions)
+    {
+        m_minSessions = qMax(m_minSessions, minSessions);
+        return *this;
+    }
+
+    /**
+     * @brief Both queries must match
+     */
+    ApplicationQuery operator&(const ApplicationQuery& other) const
+    {
+        ApplicationQuery combined = *this;
+        combined.m_categoryMask &= other.m_categoryMask;
+        combined.m_seenFrom = qMax(m_seenFrom, other.m_seenFrom);
+        combined.m_seenTo = qMin(m_seenTo, other.m_seenTo);
+        combined.m_minSessions = qMax(m_minSessions, other.m_minSessions);
+        return combined;
+    }
+
+    // Evaluation
+
+    bool matches(const Application& app) const
+    {
+        qint64 lastSeen = app.getLastSeenSecs();
+        return (m_categoryMask & bit(app.getCategory()))
+            && lastSeen >= m_seenFrom && lastSeen <= m_seenTo
+            && app.getTotalSessions() >= m_minSessions;
+    }
+
+    bool includesCategory(Application::Category category) const
+    {
+        return (m_categoryMask & bit(category)) != 0;
+    }
+
+    bool hasCategoryFilter() const { return m_categoryMask != ALL_CATEGORIES; }
+    bool hasLastSeenFilter() const { return m_seenFrom != NO_LOWER_BOUND || m_seenTo != NO_UPPER_BOUND; }
+    bool hasSessionFilter() const { return m_minSessions > 0; }
+
+    /**
+     * @brief True if no application can match (e.g. disjoint categories)
+     */
+    bool isEmpty() const { return m_categoryMask == 0 || m_seenFrom > m_seenTo; }
+
+    qint64 seenFrom() const { return m_seenFrom; }
+    qint64 seenTo() const { return m_seenTo; }
+    int minSessions() const { return m_minSessions; }
+
+private:
+    static constexpr quint16 ALL_CATEGORIES = (1u << Application::CATEGORY_COUNT) - 1;
+    static constexpr qint64 NO_LOWER_BOUND = std::numeric_limits<qint64>::min();
+    static constexpr qint64 NO_UPPER_BOUND = std::numeric_limits<qint64>::max();
+
+    static quint16 bit(Application::Category category)
+    {
+        return static_cast<quint16>(1u << static_cast<int>(category));
+    }
+
+    quint16 m_categoryMask = ALL_CATEGORIES;
+    qint64 m_seenFrom = NO_LOWER_BOUND;
+    qint64 m_seenTo = NO_UPPER_BOUND;
+    int m_minSessions = 0;      // Session counts are never negative
+};
+
+#endif // APPLICATIONQUERY_H
@@ -1,28 +1,60 @@
 #include "ApplicationRepository.h"
 #include "Application.h"
+#include "ApplicationCodecs.h"
+#include "ApplicationImporter.h"
+#include "StringPool.h"
+#include "services/infrastructure/TimeSource.h"
+#include "EventLogger.h"
+#include "services/metrics/Metrics.h"
+#include "services/metrics/TraceSpans.h"
 
 #include <QFile>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonArray>
-#include <QDebug>
 #include <QDateTime>
 #include <QDir>
+#include <QThread>
+#include <QTimer>
+#include <algorithm>
 
 // Constructors
 
 ApplicationRepository::ApplicationRepository()
-    : m_dataPath(DEFAULT_DATA_FILE),
+    : m_snapshotResetPending(true),
+      m_batchDepth(0),
+      m_snapshotVersion(0),
+      m_publishScheduled(false),
+      m_dataPath(DEFAULT_DATA_FILE),
       m_isDirty(false)
 {
     load();
+    publishSnapshot();
 }
 
 ApplicationRepository::ApplicationRepository(const QString& dataPath)
-    : m_dataPath(dataPath.isEmpty() ? DEFAULT_DATA_FILE : dataPath),
+    : m_snapshotResetPending(true),
+      m_batchDepth(0),
+      m_snapshotVersion(0),
+      m_publishScheduled(false),
+      m_dataPath(dataPath.isEmpty() ? DEFAULT_DATA_FILE : dataPath),
       m_isDirty(false)
 {
     load();
+    publishSnapshot();
+}
+
+ApplicationRepository::BatchUpdate::BatchUpdate(ApplicationRepository* repository)
+    : m_repository(repository)
+{
+    m_repository->m_batchDepth++;
+}
+
+ApplicationRepository::BatchUpdate::~BatchUpdate()
+{
+    if (--m_repository->m_batchDepth == 0) {
+        m_repository->publishSnapshot();
+    }
 }
 
 ApplicationRepository::~ApplicationRepository()
@@ -37,14 +69,32 @@ ApplicationRepository::~ApplicationRepository()
 
 Application* ApplicationRepository::find(const QString& processName) const
 {
+    return m_slab.get(findId(processName));
+}
+
+ApplicationId ApplicationRepository::findId(const QString& processName) const
+{
+    static Counter& lookups = MetricsRegistry::counter(
+        "mindfulness_repository_lookups_total", "Application lookups by process name");
+    lookups.add();
     QString normalized = normalizeProcessName(processName);
-    auto it = m_applications.find(normalized);
-    
-    if (it != m_applications.end()) {
-        return it->get();
+    return m_applications.value(normalized);
+}
+
+Application* ApplicationRepository::get(ApplicationId id) const
+{
+    return m_slab.get(id);
+}
+
+ApplicationId ApplicationRepository::idOf(const Application* app) const
+{
+    if (!app) {
+        return ApplicationId();
     }
     
-    return nullptr;
+    // Only hand out handles for entries that are actually stored here
+    ApplicationId id = findId(app->getProcessName());
+    return m_slab.get(id) == app ? id : ApplicationId();
 }
 
 Application* ApplicationRepository::findOrCreate(const QString& processName)
@@ -56,36 +106,35 @@ Application* ApplicationRepository::findOrCreate(const QString& processName)
     
     // Create new application
     QString normalized = normalizeProcessName(processName);
-    auto app = std::make_unique<Application>(processName);
-    Application* rawPtr = app.get();
-    
-    m_applications[normalized] = std::move(app);
+    Application* rawPtr = store(normalized, Application(processName));
     m_isDirty = true;
     
-    qDebug() << "Created new application:" << processName;
+    static Counter& created = MetricsRegistry::counter(
+        "mindfulness_repository_created_total", "Applications created on first sight");
+    created.add();
+    MF_LOG_DEBUG(Repository, "Created new application: %1", processName);
     return rawPtr;
 }
 
 void ApplicationRepository::save(Application* app)
 {
     if (!app) {
-        qWarning() << "Cannot save null application";
+        MF_LOG_WARNING(Repository, "Cannot save null application");
         return;
     }
     
     QString normalized = normalizeProcessName(app->getProcessName());
     
     // Check if we already have this application
-    auto it = m_applications.find(normalized);
-    if (it != m_applications.end()) {
-        // Update existing
-        if (it->get() != app) {
-            // Replace with new instance
-            m_applications[normalized] = std::make_unique<Application>(*app);
+    Application* existing = find(normalized);
+    if (existing) {
+        // Update existing in place; assignment reports the changes to the indexes
+        if (existing != app) {
+            *existing = *app;
         }
     } else {
         // Add new
-        m_applications[normalized] = std::make_unique<Application>(*app);
+        store(normalized, *app);
     }
     
     m_isDirty = true;
@@ -95,9 +144,14 @@ bool ApplicationRepository::remove(const QString& processName)
 {
     QString normalized = normalizeProcessName(processName);
     
-    if (m_applications.remove(normalized) > 0) {
+    auto it = m_applications.find(normalized);
+    if (it != m_applications.end()) {
+        unindexApplication(m_slab.get(it.value()));
+        m_slab.release(it.value());
+        m_applications.erase(it);
         m_isDirty = true;
-        qDebug() << "Removed application:" << processName;
+        markForSnapshot(normalized);
+        MF_LOG_DEBUG(Repository, "Removed application: %1", processName);
         return true;
     }
     
@@ -109,22 +163,40 @@ bool ApplicationRepository::remove(const QString& processName)
 QList<Application*> ApplicationRepository::findAll() const
 {
     QList<Application*> result;
-    result.reserve(m_applications.size());
+    result.reserve(m_slab.size());
     
-    for (const auto& pair : m_applications) {
-        result.append(pair.get());
-    }
+    m_slab.forEach([&result](Application& app) {
+        result.append(&app);
+    });
     
     return result;
 }
 
 QList<Application*> ApplicationRepository::findByCategory(Application::Category category) const
 {
+    const QSet<quint32>& members = m_categoryIndex[static_cast<int>(category)];
+    
     QList<Application*> result;
+    result.reserve(members.size());
+    for (quint32 index : members) {
+        result.append(m_slab.at(index));
+    }
     
-    for (const auto& pair : m_applications) {
-        if (pair->getCategory() == category) {
-            result.append(pair.get());
+    return result;
+}
+
+QList<Application*> ApplicationRepository::findByCategories(const QList<Application::Category>& categories) const
+{
+    qsizetype total = 0;
+    for (Application::Category category : categories) {
+        total += m_categoryIndex[static_cast<int>(category)].size();
+    }
+    
+    QList<Application*> result;
+    result.reserve(total);
+    for (Application::Category category : categories) {
+        for (quint32 index : m_categoryIndex[static_cast<int>(category)]) {
+            result.append(m_slab.at(index));
         }
     }
     
@@ -136,6 +208,24 @@ int ApplicationRepository::count() const
     return m_applications.size();
 }
 
+int ApplicationRepository::count(const ApplicationQuery& query) const
+{
+    int matches = 0;
+    forEach(query, [&matches](const Application&) {
+        ++matches;
+    });
+    return matches;
+}
+
+SessionLengthSketch ApplicationRepository::sessionLengths(const ApplicationQuery& query) const
+{
+    SessionLengthSketch merged;
+    forEach(query, [&merged](const Application& app) {
+        merged.merge(app.getSessionLengths());
+    });
+    return merged;
+}
+
 bool ApplicationRepository::exists(const QString& processName) const
 {
     QString normalized = normalizeProcessName(processName);
@@ -146,131 +236,201 @@ bool ApplicationRepository::exists(const QString& processName) const
 
 bool ApplicationRepository::saveAll()
 {
-    QJsonObject root;
-    root["version"] = FILE_VERSION;
-    root["lastModified"] = QDateTime::currentDateTime().toString(Qt::ISODate);
-    
-    QJsonArray appsArray;
-    for (const auto& pair : m_applications) {
-        appsArray.append(pair->toJson());
-    }
-    root["applications"] = appsArray;
-    
-    QJsonDocument doc(root);
+    static LatencyHistogram& saveTime = MetricsRegistry::histogram(
+        "mindfulness_repository_save_seconds", "Time saveAll() blocks its caller");
+    ScopedLatency timing(saveTime);
+    MF_TRACE_SPAN("repository saveAll");
+
+    // Written by the table-generated codec; the layout matches what
+    // QJsonDocument would produce, so the file stays plain JSON
+    QByteArray data;
+    data.reserve(static_cast<qsizetype>(m_slab.size()) * 320 + 128);
+    data.append("{\n    \"version\": ");
+    data.append(QByteArray::number(FILE_VERSION));
+    data.append(",\n    \"lastModified\": \"");
+    data.append(QDateTime::currentDateTime().toString(Qt::ISODate).toUtf8());
+    data.append("\",\n    \"applications\": [");
+    
+    ApplicationJsonCodec codec;
+    bool first = true;
+    m_slab.forEach([&](const Application& app) {
+        data.append(first ? "\n        " : ",\n        ");
+        first = false;
+        codec.encode(app, data);
+    });
+    data.append("\n    ]\n}\n");
     
     QFile file(m_dataPath);
     if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
-        qWarning() << "Failed to open file for writing:" << m_dataPath;
-        qWarning() << "Error:" << file.errorString();
+        MF_LOG_WARNING(Repository, "Failed to open file for writing: %1 Error: %2", m_dataPath, file.errorString());
         return false;
     }
     
-    file.write(doc.toJson());
+    file.write(data);
     file.close();
     
+    if (!m_rollups.save(m_dataPath + ".rollups")) {
+        return false;
+    }
+    
     m_isDirty = false;
-    qDebug() << "Saved" << m_applications.size() << "applications to" << m_dataPath;
+    static Gauge& stored = MetricsRegistry::gauge(
+        "mindfulness_repository_applications", "Applications in the repository at the last save");
+    stored.set(m_applications.size());
+    MF_LOG_DEBUG(Repository, "Saved %1 applications to %2", m_applications.size(), m_dataPath);
     return true;
 }
 
 bool ApplicationRepository::load()
 {
+    static LatencyHistogram& loadTime = MetricsRegistry::histogram(
+        "mindfulness_repository_load_seconds", "Time to load the data file");
+    ScopedLatency timing(loadTime);
+    MF_TRACE_SPAN("repository load");
+
     QFile file(m_dataPath);
     
     // If file doesn't exist, that's okay for first run
     if (!file.exists()) {
-        qDebug() << "Data file does not exist, starting with empty repository:" << m_dataPath;
+        MF_LOG_DEBUG(Repository, "Data file does not exist, starting with empty repository: %1", m_dataPath);
         return true;
     }
     
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        qWarning() << "Failed to open file for reading:" << m_dataPath;
-        qWarning() << "Error:" << file.errorString();
+    if (!file.open(QIODevice::ReadOnly)) {
+        MF_LOG_WARNING(Repository, "Failed to open file for reading: %1 Error: %2", m_dataPath, file.errorString());
         return false;
     }
     
-    QByteArray data = file.readAll();
-    file.close();
-    
-    QJsonDocument doc = QJsonDocument::fromJson(data);
-    if (doc.isNull() || !doc.isObject()) {
-        qWarning() << "Invalid JSON in data file:" << m_dataPath;
+    // Stream and decode everything before touching the current data, so a
+    // corrupt file leaves the repository as it was
+    ApplicationImporter importer;
+    if (!importer.importDevice(file)) {
+        MF_LOG_WARNING(Repository, "Invalid JSON in data file: %1", m_dataPath);
         return false;
     }
-    
-    QJsonObject root = doc.object();
+    file.close();
     
     // Check version for future compatibility
-    int version = root["version"].toInt(1);
-    if (version > FILE_VERSION) {
-        qWarning() << "Data file version" << version << "is newer than supported version" << FILE_VERSION;
+    if (importer.version() > FILE_VERSION) {
+        MF_LOG_WARNING(Repository, "Data file version %1 is newer than supported version %2", importer.version(), FILE_VERSION);
     }
     
+    // Publish the loaded data as one version
+    BatchUpdate batch(this);
+    m_snapshotResetPending = true;
+    
     // Clear existing data
-    m_applications.clear();
+    clearStorage();
     
     // Load applications
-    QJsonArray appsArray = root["applications"].toArray();
-    for (const QJsonValue& value : appsArray) {
-        if (value.isObject()) {
-            Application app = Application::fromJson(value.toObject());
-            QString normalized = normalizeProcessName(app.getProcessName());
-            m_applications[normalized] = std::make_unique<Application>(std::move(app));
-        }
+    m_applications.reserve(importer.count());
+    m_slab.reserve(importer.count());
+    importer.forEach([this](const Application& app) {
+        QString normalized = normalizeProcessName(app.getProcessName());
+        store(normalized, app);
+    });
+    
+    if (!m_rollups.load(m_dataPath + ".rollups")) {
+        // Losing the totals is not worth failing the whole load over
+        m_rollups.clear();
     }
     
     m_isDirty = false;
-    qDebug() << "Loaded" << m_applications.size() << "applications from" << m_dataPath;
+    MF_LOG_DEBUG(Repository, "Loaded %1 applications from %2", m_applications.size(), m_dataPath);
     return true;
 }
 
 void ApplicationRepository::clear()
 {
-    m_applications.clear();
+    BatchUpdate batch(this);
+    m_snapshotResetPending = true;
+    clearStorage();
+    m_rollups.clear();
     m_isDirty = true;
 }
 
+// Concurrent Read Access
+
+ApplicationRepository::SnapshotGuard ApplicationRepository::readSnapshot() const
+{
+    if (QThread::currentThread() == m_publishContext.thread() && m_publishScheduled && m_batchDepth == 0) {
+        const_cast<ApplicationRepository*>(this)->publishSnapshot();
+    }
+    return m_snapshots.read();
+}
+
+void ApplicationRepository::publishSnapshot()
+{
+    m_publishScheduled = false;
+    if (!m_snapshotResetPending && m_pendingSnapshotChanges.isEmpty()) {
+        // Nothing changed, but give readers that left a chance to free old versions
+        m_snapshots.reclaim();
+        return;
+    }
+    
+    std::vector<ApplicationSnapshot::Change> changes;
+    std::unique_ptr<const ApplicationSnapshot> snapshot;
+    if (m_snapshotResetPending) {
+        changes.reserve(m_applications.size());
+        for (auto it = m_applications.constBegin(); it != m_applications.constEnd(); ++it) {
+            changes.push_back({it.key(), std::make_shared<const Application>(*m_slab.get(it.value()))});
+        }
+        snapshot = ApplicationSnapshot::fromEntries(std::move(changes), ++m_snapshotVersion);
+    } else {
+        // Only the changed entries are copied; the rest is shared with the previous version
+        changes.reserve(m_pendingSnapshotChanges.size());
+        for (const QString& normalized : m_pendingSnapshotChanges) {
+            const Application* app = find(normalized);
+            changes.push_back({normalized, app ? std::make_shared<const Application>(*app) : nullptr});
+        }
+        SnapshotGuard previous = m_snapshots.read();
+        snapshot = previous ? previous->withChanges(changes, ++m_snapshotVersion)
+                            : ApplicationSnapshot::fromEntries(std::move(changes), ++m_snapshotVersion);
+    }
+    
+    m_pendingSnapshotChanges.clear();
+    m_snapshotResetPending = false;
+    m_snapshots.publish(std::move(snapshot));
+}
+
 // Statistics Queries
 
-QList<Application*> ApplicationRepository::findRecentlyUsed(int days) const
+QList<Application*> ApplicationRepository::findRecentlyUsed(int days, int limit) const
 {
     QList<Application*> result;
-    QDateTime cutoff = QDateTime::currentDateTime().addDays(-days);
+    qint64 cutoff = TimeSource::current()->currentSecsSinceEpoch() - static_cast<qint64>(days) * 24 * 60 * 60;
     
-    for (const auto& pair : m_applications) {
-        if (pair->getLastSeen() >= cutoff) {
-            result.append(pair.get());
+    // Walk the index from the most recent entry down to the cutoff
+    for (auto it = m_lastSeenIndex.rbegin(); it != m_lastSeenIndex.rend(); ++it) {
+        if (it->first < cutoff || (limit >= 0 && result.size() >= limit)) {
+            break;
         }
+        result.append(m_slab.at(it->second));
     }
     
-    // Sort by last seen (most recent first)
-    std::sort(result.begin(), result.end(), 
-              [](const Application* a, const Application* b) {
-                  return a->getLastSeen() > b->getLastSeen();
-              });
-    
     return result;
 }
 
-QList<Application*> ApplicationRepository::findFrequentlyUsed(int minSessions) const
+QList<Application*> ApplicationRepository::findFrequentlyUsed(int minSessions, int limit) const
 {
     QList<Application*> result;
     
-    for (const auto& pair : m_applications) {
-        if (pair->getTotalSessions() >= minSessions) {
-            result.append(pair.get());
+    // Walk the index from the most used entry down to the threshold
+    for (auto it = m_sessionIndex.rbegin(); it != m_sessionIndex.rend(); ++it) {
+        if (it->first < minSessions || (limit >= 0 && result.size() >= limit)) {
+            break;
         }
+        result.append(m_slab.at(it->second));
     }
     
-    // Sort by total sessions (most used first)
-    std::sort(result.begin(), result.end(),
-              [](const Application* a, const Application* b) {
-                  return a->getTotalSessions() > b->getTotalSessions();
-              });
-    
     return result;
 }
 
+const UsageRollups& ApplicationRepository::usageRollups() const
+{
+    return m_rollups;
+}
+
 // Helper Methods
 
 QString ApplicationRepository::normalizeProcessName(const QString& processName) const
@@ -278,6 +438,120 @@ QString ApplicationRepository::normalizeProcessName(const QString& processName)
     return processName.toLower();
 }
 
+Application* ApplicationRepository::store(const QString& normalized, const Application& app)
+{
+    auto it = m_applications.find(normalized);
+    if (it != m_applications.end()) {
+        unindexApplication(m_slab.get(it.value()));
+        m_slab.release(it.value());
+    }
+    
+    // Key on the pooled copy of the name so the hash holds no string payload
+    StringPool& pool = StringPool::instance();
+    QString key = pool.get(pool.intern(normalized));
+    
+    ApplicationId id = m_slab.allocate(app);
+    m_applications[key] = id;
+    
+    Application* rawPtr = m_slab.get(id);
+    indexApplication(rawPtr);
+    markForSnapshot(normalized);
+    return rawPtr;
+}
+
+void ApplicationRepository::clearStorage()
+{
+    clearIndexes();
+    m_applications.clear();
+    m_slab.clear();
+}
+
+void ApplicationRepository::indexApplication(Application* app)
+{
+    quint32 index = m_slab.indexOf(app);
+    m_categoryIndex[static_cast<int>(app->getCategory())].insert(index);
+    m_lastSeenIndex.emplace(app->getLastSeenSecs(), index);
+    m_sessionIndex.emplace(app->getTotalSessions(), index);
+    app->setObserver(this);
+}
+
+void ApplicationRepository::unindexApplication(Application* app)
+{
+    quint32 index = m_slab.indexOf(app);
+    app->setObserver(nullptr);
+    m_categoryIndex[static_cast<int>(app->getCategory())].remove(index);
+    m_lastSeenIndex.erase({app->getLastSeenSecs(), index});
+    m_sessionIndex.erase({app->getTotalSessions(), index});
+}
+
+void ApplicationRepository::clearIndexes()
+{
+    m_slab.forEach([](Application& app) {
+        app.setObserver(nullptr);
+    });
+    for (QSet<quint32>& members : m_categoryIndex) {
+        members.clear();
+    }
+    m_lastSeenIndex.clear();
+    m_sessionIndex.clear();
+}
+
+void ApplicationRepository::markForSnapshot(const QString& normalized)
+{
+    if (!m_snapshotResetPending) {
+        m_pendingSnapshotChanges.insert(normalized);
+    }
+    
+    // One publication per event loop turn, however many changes it holds
+    if (m_batchDepth == 0 && !m_publishScheduled) {
+        m_publishScheduled = true;
+        QTimer::singleShot(0, &m_publishContext, [this]() { publishSnapshot(); });
+    }
+}
+
+// Index Maintenance
+
+void ApplicationRepository::onCategoryChanged(Application* app, Application::Category oldCategory)
+{
+    quint32 index = m_slab.indexOf(app);
+    m_categoryIndex[static_cast<int>(oldCategory)].remove(index);
+    m_categoryIndex[static_cast<int>(app->getCategory())].insert(index);
+    m_isDirty = true;
+    markForSnapshot(normalizeProcessName(app->getProcessName()));
+}
+
+void ApplicationRepository::onUsageChanged(Application* app, qint64 oldLastSeen, int oldTotalSessions)
+{
+    quint32 index = m_slab.indexOf(app);
+    
+    qint64 lastSeen = app->getLastSeenSecs();
+    if (lastSeen != oldLastSeen) {
+        m_lastSeenIndex.erase({oldLastSeen, index});
+        m_lastSeenIndex.emplace(lastSeen, index);
+    }
+    
+    int totalSessions = app->getTotalSessions();
+    if (totalSessions != oldTotalSessions) {
+        m_sessionIndex.erase({oldTotalSessions, index});
+        m_sessionIndex.emplace(totalSessions, index);
+    }
+    m_isDirty = true;
+    markForSnapshot(normalizeProcessName(app->getProcessName()));
+}
+
+void ApplicationRepository::onDetailsChanged(Application* app)
+{
+    m_isDirty = true;
+    markForSnapshot(normalizeProcessName(app->getProcessName()));
+}
+
+void ApplicationRepository::onSessionRecorded(Application* app, qint64 start, qint64 end, int activeSeconds)
+{
+    m_rollups.record(normalizeProcessName(app->getProcessName()), app->getCategory(),
+                     start, end, activeSeconds);
+    m_isDirty = true;
+}
+
 QJsonObject ApplicationRepository::toJson() const
 {
     QJsonObject root;
@@ -285,9 +559,9 @@ QJsonObject ApplicationRepository::toJson() const
     root["lastModified"] = QDateTime::currentDateTime().toString(Qt::ISODate);
     
     QJsonArray appsArray;
-    for (const auto& pair : m_applications) {
-        appsArray.append(pair->toJson());
-    }
+    m_slab.forEach([&appsArray](const Application& app) {
+        appsArray.append(app.toJson());
+    });
     root["applications"] = appsArray;
     
     return root;
@@ -295,14 +569,17 @@ QJsonObject ApplicationRepository::toJson() const
 
 void ApplicationRepository::fromJson(const QJsonObject& json)
 {
-    m_applications.clear();
+    BatchUpdate batch(this);
+    m_snapshotResetPending = true;
+    clearStorage();
     
     QJsonArray appsArray = json["applications"].toArray();
+    m_slab.reserve(appsArray.size());
     for (const QJsonValue& value : appsArray) {
         if (value.isObject()) {
             Application app = Application::fromJson(value.toObject());
             QString normalized = normalizeProcessName(app.getProcessName());
-            m_applications[normalized] = std::make_unique<Application>(std::move(app));
+            store(normalized, app);
         }
     }
     
@@ -2,10 +2,23 @@
 #define APPLICATIONREPOSITORY_H
 
 #include "Application.h"
+#include "ApplicationId.h"
+#include "ApplicationObserver.h"
+#include "ApplicationQuery.h"
+#include "ApplicationSlab.h"
+#include "ApplicationSnapshot.h"
+#include "SnapshotPublisher.h"
+#include "UsageRollups.h"
 #include <QString>
 #include <QHash>
+#include <QObject>
+#include <QSet>
 #include <QList>
-#include <memory>
+#include <array>
+#include <limits>
+#include <set>
+#include <utility>
+#include <vector>
 
 // Forward declaration
 class Application;
@@ -18,12 +31,49 @@ class QJsonObject;
  * It abstracts the storage mechanism (currently JSON file, future: database)
  * and provides a clean interface for querying and persisting Application entities.
  * 
- * Thread Safety: This class is NOT thread-safe. Read operations can be called
- * from any thread, but write operations must only be called from the main thread.
+ * Thread Safety: This class is NOT thread-safe. All methods must be called from
+ * the main thread, with one exception: readSnapshot() may be called from any
+ * thread. Changes are published to background readers as an immutable
+ * ApplicationSnapshot, which they read without locking. Publication is
+ * coalesced: changes outside a BatchUpdate are published together on the
+ * next event loop turn, and a batch publishes once when it ends. Each new
+ * version shares its unchanged entries with the previous one.
+ * 
+ * Indexing: The repository observes every Application it stores and keeps
+ * secondary indexes on category, lastSeen and totalSessions up to date as
+ * the entities change, so category and top-N queries never scan the full set.
+ * forEach() walks those indexes in place with an ApplicationQuery filter and
+ * allocates nothing; the QList-returning queries are kept for convenience.
+ * 
+ * Storage: Applications live in an ApplicationSlab. Application* values stay
+ * valid until the entry is removed (or the repository is cleared/reloaded);
+ * code that holds on to an entry across events should keep an ApplicationId
+ * instead and resolve it with get(), which detects removed entries.
  */
-class ApplicationRepository
+class ApplicationRepository : private ApplicationObserver
 {
 public:
+    using SnapshotGuard = SnapshotPublisher<ApplicationSnapshot>::ReadGuard;
+    
+    /**
+     * @brief Defers snapshot publication until the outermost batch ends
+     * 
+     * Use around a series of mutations so that background readers see one
+     * new version instead of one per change. Batches may be nested.
+     */
+    class BatchUpdate
+    {
+    public:
+        explicit BatchUpdate(ApplicationRepository* repository);
+        ~BatchUpdate();
+        
+        BatchUpdate(const BatchUpdate&) = delete;
+        BatchUpdate& operator=(const BatchUpdate&) = delete;
+        
+    private:
+        ApplicationRepository* m_repository;
+    };
+    
     ApplicationRepository();
     explicit ApplicationRepository(const QString& dataPath);
     ~ApplicationRepository();
@@ -37,6 +87,27 @@ public:
      */
     Application* find(const QString& processName) const;
     
+    /**
+     * @brief Find the handle of an application by process name
+     * @param processName The executable name (e.g., "chrome.exe")
+     * @return Handle to the application, or a null handle if not found
+     */
+    ApplicationId findId(const QString& processName) const;
+    
+    /**
+     * @brief Resolve a handle returned by findId() or idOf()
+     * @param id The handle to resolve
+     * @return Pointer to Application, or nullptr if the entry was removed since
+     */
+    Application* get(ApplicationId id) const;
+    
+    /**
+     * @brief Get the handle of an application stored in this repository
+     * @param app An application returned by this repository
+     * @return Its handle, or a null handle if app is not stored here
+     */
+    ApplicationId idOf(const Application* app) const;
+    
     /**
      * @brief Find or create an application
      * @param processName The executable name
@@ -72,6 +143,51 @@ public:
      */
     QList<Application*> findByCategory(Application::Category category) const;
     
+    /**
+     * @brief Find all applications belonging to any of the given categories
+     * @param categories The categories to include
+     * @return List of matching Application pointers, grouped by category
+     */
+    QList<Application*> findByCategories(const QList<Application::Category>& categories) const;
+    
+    /**
+     * @brief Visit every application matching a query, without copying
+     * 
+     * Walks the most selective index for the query in place: a small set of
+     * categories, then the lastSeen window (newest first), then the session
+     * threshold (most used first), and the full storage otherwise. Any other
+     * conditions are checked per entry. Nothing is allocated.
+     * 
+     * The visitor must not add, remove or modify applications.
+     * 
+     * @param query Filter to apply (default: all applications)
+     * @param visitor Callable taking const Application&; may return bool,
+     *                where false stops the walk
+     */
+    template<typename Visitor>
+    void forEach(const ApplicationQuery& query, Visitor&& visitor) const;
+    
+    /**
+     * @brief Visit every application, without copying
+     */
+    template<typename Visitor>
+    void forEach(Visitor&& visitor) const
+    {
+        forEach(ApplicationQuery(), std::forward<Visitor>(visitor));
+    }
+    
+    /**
+     * @brief Count applications matching a query without materializing them
+     */
+    int count(const ApplicationQuery& query) const;
+    
+    /**
+     * @brief Merged session length distribution of the matching applications
+     * 
+     * E.g. percentiles for a whole category, or for the apps used in a window.
+     */
+    SessionLengthSketch sessionLengths(const ApplicationQuery& query) const;
+    
     /**
      * @brief Get count of all applications
      * @return Total number of applications
@@ -104,28 +220,103 @@ public:
      */
     void clear();
     
+    // Concurrent Read Access
+    
+    /**
+     * @brief Get the most recently published snapshot (any thread, lock-free)
+     * 
+     * On the main thread outside a BatchUpdate, changes still waiting for
+     * the next event loop turn are published first, so the caller sees its
+     * own writes.
+     * 
+     * @return Guard that keeps the snapshot alive while it is in scope
+     */
+    SnapshotGuard readSnapshot() const;
+    
+    /**
+     * @brief Publish pending changes to background readers now
+     * 
+     * Called automatically on the event loop turn after a change outside a
+     * BatchUpdate, and when the outermost BatchUpdate ends.
+     */
+    void publishSnapshot();
+    
     // Statistics Queries (Future Enhancement)
     
     /**
      * @brief Get recently used applications
-     * @param days Number of days to look back
-     * @return List of recently used applications
+     * @param days Number of days to look back from TimeSource::current()
+     * @param limit Maximum number of results, or -1 for no limit
+     * @return List of recently used applications, most recent first
      */
-    QList<Application*> findRecentlyUsed(int days = 7) const;
+    QList<Application*> findRecentlyUsed(int days = 7, int limit = -1) const;
     
     /**
      * @brief Get frequently used applications
      * @param minSessions Minimum number of sessions
-     * @return List of frequently used applications
+     * @param limit Maximum number of results, or -1 for no limit
+     * @return List of frequently used applications, most used first
+     */
+    QList<Application*> findFrequentlyUsed(int minSessions = 10, int limit = -1) const;
+    
+    /**
+     * @brief Hour/day/week usage totals, fed by Application::recordSessionEnd()
+     * 
+     * Saved next to the data file (with a ".rollups" suffix) by saveAll().
      */
-    QList<Application*> findFrequentlyUsed(int minSessions = 10) const;
+    const UsageRollups& usageRollups() const;
 
 private:
     /**
-     * @brief Internal storage of applications
-     * Key: process name (lowercase), Value: Application pointer
+     * @brief Slot storage for all applications
+     */
+    ApplicationSlab m_slab;
+    
+    /**
+     * @brief Name lookup
+     * Key: process name (lowercase), Value: handle into m_slab
+     */
+    QHash<QString, ApplicationId> m_applications;
+    
+    // Secondary Indexes (values are slot indexes into m_slab)
+    
+    /**
+     * @brief Category membership, indexed by static_cast<int>(Category)
      */
-    QHash<QString, std::shared_ptr<Application>> m_applications;
+    std::array<QSet<quint32>, Application::CATEGORY_COUNT> m_categoryIndex;
+    
+    /**
+     * @brief Ordered by lastSeen (seconds since epoch), ascending
+     */
+    std::set<std::pair<qint64, quint32>> m_lastSeenIndex;
+    
+    /**
+     * @brief Ordered by totalSessions, ascending
+     */
+    std::set<std::pair<int, quint32>> m_sessionIndex;
+    
+    // Published Snapshots
+    
+    SnapshotPublisher<ApplicationSnapshot> m_snapshots;
+    
+    /**
+     * @brief Normalized names changed since the last published version
+     */
+    QSet<QString> m_pendingSnapshotChanges;
+    
+    /**
+     * @brief Rebuild the next snapshot from scratch (after load/clear)
+     */
+    bool m_snapshotResetPending;
+    
+    int m_batchDepth;
+    quint64 m_snapshotVersion;
+    
+    /**
+     * @brief Receiver for the deferred publication; lives on the main thread
+     */
+    QObject m_publishContext;
+    bool m_publishScheduled;
     
     /**
      * @brief Path to the data file
@@ -137,6 +328,11 @@ private:
      */
     bool m_isDirty;
     
+    /**
+     * @brief Usage totals per application and category
+     */
+    UsageRollups m_rollups;
+    
     // Helper Methods
     
     /**
@@ -146,6 +342,46 @@ private:
      */
     QString normalizeProcessName(const QString& processName) const;
     
+    /**
+     * @brief Copy an application into the slab, replacing any existing entry
+     * @param normalized The normalized process name used as key
+     * @param app The application to store
+     * @return Pointer to the stored Application
+     */
+    Application* store(const QString& normalized, const Application& app);
+    
+    /**
+     * @brief Drop all entries and release their slots
+     */
+    void clearStorage();
+    
+    /**
+     * @brief Add an application to all secondary indexes and observe it
+     */
+    void indexApplication(Application* app);
+    
+    /**
+     * @brief Remove an application from all secondary indexes and stop observing it
+     */
+    void unindexApplication(Application* app);
+    
+    /**
+     * @brief Drop all index entries
+     */
+    void clearIndexes();
+    
+    /**
+     * @brief Record a change for the next snapshot, and schedule its
+     *        publication unless batching
+     */
+    void markForSnapshot(const QString& normalized);
+    
+    // ApplicationObserver
+    void onCategoryChanged(Application* app, Application::Category oldCategory) override;
+    void onUsageChanged(Application* app, qint64 oldLastSeen, int oldTotalSessions) override;
+    void onDetailsChanged(Application* app) override;
+    void onSessionRecorded(Application* app, qint64 start, qint64 end, int activeSeconds) override;
+    
     /**
      * @brief Convert repository to JSON for persistence
      * @return JSON representation of all applications
@@ -163,4 +399,65 @@ private:
     static constexpr int FILE_VERSION = 1;
 };
 
+template<typename Visitor>
+void ApplicationRepository::forEach(const ApplicationQuery& query, Visitor&& visitor) const
+{
+    if (query.isEmpty()) {
+        return;
+    }
+    
+    auto check = [&query, &visitor](Application& app) {
+        return !query.matches(app) || ApplicationSlab::visit(visitor, app);
+    };
+    
+    // Category buckets win when they are small compared to the whole set
+    if (query.hasCategoryFilter()) {
+        qsizetype candidates = 0;
+        for (int c = 0; c < Application::CATEGORY_COUNT; ++c) {
+            if (query.includesCategory(static_cast<Application::Category>(c))) {
+                candidates += m_categoryIndex[c].size();
+            }
+        }
+        
+        if (candidates * 4 <= m_slab.size() || !(query.hasLastSeenFilter() || query.hasSessionFilter())) {
+            for (int c = 0; c < Application::CATEGORY_COUNT; ++c) {
+                if (!query.includesCategory(static_cast<Application::Category>(c))) {
+                    continue;
+                }
+                for (quint32 index : m_categoryIndex[c]) {
+                    if (!check(*m_slab.at(index))) {
+                        return;
+                    }
+                }
+            }
+            return;
+        }
+    }
+    
+    if (query.hasLastSeenFilter()) {
+        auto first = m_lastSeenIndex.lower_bound({query.seenFrom(), 0});
+        auto last = m_lastSeenIndex.upper_bound({query.seenTo(), std::numeric_limits<quint32>::max()});
+        while (last != first) {
+            --last;
+            if (!check(*m_slab.at(last->second))) {
+                return;
+            }
+        }
+        return;
+    }
+    
+    if (query.hasSessionFilter()) {
+        auto first = m_sessionIndex.lower_bound({query.minSessions(), 0});
+        for (auto it = m_sessionIndex.end(); it != first; ) {
+            --it;
+            if (!check(*m_slab.at(it->second))) {
+                return;
+            }
+        }
+        return;
+    }
+    
+    m_slab.forEach(check);
+}
+
 #endif // APPLICATIONREPOSITORY_H
\ No newline at end of file
@@ -0,0 +1,115 @@
+#include "ApplicationSlab.h"
+#include <cstddef>
+
+ApplicationId ApplicationSlab::allocate(const Application& app)
+{
+    if (m_freeList.empty()) {
+        addChunk();
+    }
+    
+    quint32 index = m_freeList.back();
+    m_freeList.pop_back();
+    
+    Slot* slot = slotAt(index);
+    slot->app = app;
+    slot->generation++;
+    m_size++;
+    
+    return ApplicationId{index, slot->generation};
+}
+
+bool ApplicationSlab::release(ApplicationId id)
+{
+    if (!get(id)) {
+        return false;
+    }
+    
+    Slot* slot = slotAt(id.index);
+    slot->app.setObserver(nullptr);
+    slot->app = Application();
+    slot->generation++;
+    m_freeList.push_back(id.index);
+    m_size--;
+    return true;
+}
+
+Application* ApplicationSlab::get(ApplicationId id) const
+{
+    if (id.isNull() || id.index >= m_chunks.size() * CHUNK_SIZE) {
+        return nullptr;
+    }
+    
+    Slot* slot = slotAt(id.index);
+    return slot->generation == id.generation ? &slot->app : nullptr;
+}
+
+Application* ApplicationSlab::at(quint32 index) const
+{
+    return &slotAt(index)->app;
+}
+
+quint32 ApplicationSlab::indexOf(const Application* app) const
+{
+    return slotOf(app)->index;
+}
+
+int ApplicationSlab::size() const
+{
+    return m_size;
+}
+
+void ApplicationSlab::clear()
+{
+    m_freeList.clear();
+    for (quint32 c = 0; c < m_chunks.size(); ++c) {
+        for (quint32 i = 0; i < CHUNK_SIZE; ++i) {
+            Slot& slot = m_chunks[c][i];
+            if (slot.generation & 1u) {
+                slot.app.setObserver(nullptr);
+                slot.app = Application();
+                slot.generation++;
+            }
+        }
+    }
+    
+    // Hand out low indexes first so live slots stay densely packed
+    for (quint32 index = static_cast<quint32>(m_chunks.size()) * CHUNK_SIZE; index > 0; --index) {
+        m_freeList.push_back(index - 1);
+    }
+    m_size = 0;
+}
+
+void ApplicationSlab::reserve(int n)
+{
+    while (m_size + static_cast<int>(m_freeList.size()) < n) {
+        addChunk();
+    }
+}
+
+ApplicationSlab::Slot* ApplicationSlab::slotAt(quint32 index) const
+{
+    return &m_chunks[index / CHUNK_SIZE][index % CHUNK_SIZE];
+}
+
+const ApplicationSlab::Slot* ApplicationSlab::slotOf(const Application* app)
+{
+    // app is the first member of its Slot, so both share an address
+    static_assert(std::is_standard_layout_v<Slot> && offsetof(Slot, app) == 0,
+                  "Slot must start with its Application");
+    return reinterpret_cast<const Slot*>(app);
+}
+
+void ApplicationSlab::addChunk()
+{
+    quint32 base = static_cast<quint32>(m_chunks.size()) * CHUNK_SIZE;
+    std::unique_ptr<Slot[]> chunk(new Slot[CHUNK_SIZE]);
+    for (quint32 i = 0; i < CHUNK_SIZE; ++i) {
+        chunk[i].index = base + i;
+    }
+    m_chunks.push_back(std::move(chunk));
+    
+    // Push in reverse so the lowest index is handed out first
+    for (quint32 i = CHUNK_SIZE; i > 0; --i) {
+        m_freeList.push_back(base + i - 1);
+    }
+}
@@ -0,0 +1,130 @@
+#ifndef APPLICATIONSLAB_H
+#define APPLICATIONSLAB_H
+
+#include "Application.h"
+#include "ApplicationId.h"
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+/**
+ * @brief Chunked slot storage for Application entities
+ * 
+ * Applications live in fixed-size chunks of slots that are allocated once
+ * and never moved, so Application* values stay dereferenceable for the
+ * lifetime of the slab and iteration walks contiguous memory. Freed slots
+ * go on a free list and are reused before a new chunk is allocated.
+ * 
+ * Every slot carries a generation counter. It is odd while the slot is
+ * occupied and even while it is free, and it is bumped on every allocate
+ * and release. An ApplicationId records the generation it was issued for,
+ * so a stale id is detected with one comparison.
+ */
+class ApplicationSlab
+{
+public:
+    ApplicationSlab() = default;
+    
+    ApplicationSlab(const ApplicationSlab&) = delete;
+    ApplicationSlab& operator=(const ApplicationSlab&) = delete;
+    
+    /**
+     * @brief Store an application in a free slot
+     * @return Handle to the new occupant
+     */
+    ApplicationId allocate(const Application& app);
+    
+    /**
+     * @brief Free a slot; the handle and all copies of it become stale
+     * @return false if the handle was already stale
+     */
+    bool release(ApplicationId id);
+    
+    /**
+     * @brief Resolve a handle
+     * @return The application, or nullptr if the handle is null or stale
+     */
+    Application* get(ApplicationId id) const;
+    
+    /**
+     * @brief Occupant of a slot index without generation check (index must be live)
+     */
+    Application* at(quint32 index) const;
+    
+    /**
+     * @brief Slot index of an application that lives in this slab
+     */
+    quint32 indexOf(const Application* app) const;
+    
+    /**
+     * @brief Number of occupied slots
+     */
+    int size() const;
+    
+    /**
+     * @brief Release every slot; all outstanding handles become stale
+     */
+    void clear();
+    
+    /**
+     * @brief Make sure at least n slots exist without further chunk allocations
+     */
+    void reserve(int n);
+    
+    /**
+     * @brief Visit every live application in slot order
+     * @param visitor Callable taking Application&; may return bool, where
+     *                false stops the walk
+     * @return false if the visitor stopped the walk early
+     */
+    template<typename Visitor>
+    bool forEach(Visitor&& visitor) const
+    {
+        for (const std::unique_ptr<Slot[]>& chunk : m_chunks) {
+            Slot* end = chunk.get() + CHUNK_SIZE;
+            for (Slot* slot = chunk.get(); slot != end; ++slot) {
+                if ((slot->generation & 1u) && !visit(visitor, slot->app)) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+    
+    /**
+     * @brief Call a visitor that may or may not return bool
+     * @return The visitor's result, or true for void visitors
+     */
+    template<typename Visitor>
+    static bool visit(Visitor& visitor, Application& app)
+    {
+        if constexpr (std::is_same_v<std::invoke_result_t<Visitor&, Application&>, bool>) {
+            return visitor(app);
+        } else {
+            visitor(app);
+            return true;
+        }
+    }
+    
+private:
+    static constexpr quint32 CHUNK_SIZE = 1024;
+    
+    /**
+     * @brief One storage slot; app must stay the first member (see slotOf)
+     */
+    struct Slot {
+        Application app;
+        quint32 index = 0;
+        quint32 generation = 0;     // odd = occupied, even = free
+    };
+    
+    Slot* slotAt(quint32 index) const;
+    static const Slot* slotOf(const Application* app);
+    void addChunk();
+    
+    std::vector<std::unique_ptr<Slot[]>> m_chunks;
+    std::vector<quint32> m_freeList;
+    int m_size = 0;
+};
+
+#endif // APPLICATIONSLAB_H
@@ -0,0 +1,211 @@
+#include "ApplicationSnapshot.h"
+
+#include <QHash>
+#include <algorithm>
+
+namespace {
+
+constexpr int BITS = 5;
+constexpr size_t FANOUT = size_t(1) << BITS;
+constexpr size_t MASK = FANOUT - 1;
+constexpr int HASH_BITS = int(sizeof(size_t) * 8);
+
+// Leaves split into a branch once they hold more than this, until the hash
+// runs out of bits; only full hash collisions grow a leaf further
+constexpr size_t LEAF_CAPACITY = 8;
+
+size_t hashKey(const QString& key)
+{
+    return qHash(key, size_t(0));
+}
+
+size_t bucket(size_t hash, int shift)
+{
+    return (hash >> shift) & MASK;
+}
+
+}
+
+/**
+ * @brief Trie node: a branch of FANOUT children, or a leaf of entries
+ *
+ * Nodes are never modified once built; a change copies the nodes on its
+ * path and points the copies at the untouched siblings.
+ */
+struct ApplicationSnapshot::Node
+{
+    struct Entry {
+        size_t hash;
+        QString key;
+        std::shared_ptr<const Application> application;
+    };
+
+    std::vector<NodePtr> children;  // Branch only, FANOUT entries, null when empty
+    std::vector<Entry> entries;     // Leaf only
+
+    bool isLeaf() const
+    {
+        return children.empty();
+    }
+
+    static NodePtr build(std::vector<Entry> entries, int shift)
+    {
+        if (entries.empty()) {
+            return nullptr;
+        }
+        auto node = std::make_shared<Node>();
+        if (entries.size() <= LEAF_CAPACITY || shift >= HASH_BITS) {
+            node->entries = std::move(entries);
+            return node;
+        }
+
+        std::vector<std::vector<Entry>> buckets(FANOUT);
+        for (Entry& slot : entries) {
+            buckets[bucket(slot.hash, shift)].push_back(std::move(slot));
+        }
+        node->children.resize(FANOUT);
+        for (size_t i = 0; i < FANOUT; ++i) {
+            node->children[i] = build(std::move(buckets[i]), shift + BITS);
+        }
+        return node;
+    }
+
+    // Returns node itself when nothing changed; count is adjusted by the
+    // entries added or removed
+    static NodePtr set(const NodePtr& node, int shift, Entry slot, int& count)
+    {
+        if (!node) {
+            ++count;
+            std::vector<Entry> entries;
+            entries.push_back(std::move(slot));
+            return build(std::move(entries), shift);
+        }
+
+        if (node->isLeaf()) {
+            std::vector<Entry> entries = node->entries;
+            auto it = std::find_if(entries.begin(), entries.end(), [&slot](const Entry& existing) {
+                return existing.hash == slot.hash && existing.key == slot.key;
+            });
+            if (it != entries.end()) {
+                it->application = std::move(slot.application);
+            } else {
+                ++count;
+                entries.push_back(std::move(slot));
+            }
+            return build(std::move(entries), shift);
+        }
+
+        const size_t index = bucket(slot.hash, shift);
+        auto copy = std::make_shared<Node>(*node);
+        copy->children[index] = set(node->children[index], shift + BITS, std::move(slot), count);
+        return copy;
+    }
+
+    static NodePtr remove(const NodePtr& node, int shift, size_t hash, const QString& key, int& count)
+    {
+        if (!node) {
+            return node;
+        }
+
+        if (node->isLeaf()) {
+            auto it = std::find_if(node->entries.begin(), node->entries.end(), [hash, &key](const Entry& existing) {
+                return existing.hash == hash && existing.key == key;
+            });
+            if (it == node->entries.end()) {
+                return node;
+            }
+            --count;
+            if (node->entries.size() == 1) {
+                return nullptr;
+            }
+            auto copy = std::make_shared<Node>();
+            copy->entries.reserve(node->entries.size() - 1);
+            copy->entries.insert(copy->entries.end(), node->entries.begin(), it);
+            copy->entries.insert(copy->entries.end(), it + 1, node->entries.end());
+            return copy;
+        }
+
+        const size_t index = bucket(hash, shift);
+        NodePtr child = remove(node->children[index], shift + BITS, hash, key, count);
+        if (child == node->children[index]) {
+            return node;
+        }
+        auto copy = std::make_shared<Node>(*node);
+        copy->children[index] = std::move(child);
+        const bool empty = std::all_of(copy->children.begin(), copy->children.end(),
+                                       [](const NodePtr& c) { return !c; });
+        return empty ? nullptr : NodePtr(std::move(copy));
+    }
+};
+
+std::unique_ptr<const ApplicationSnapshot> ApplicationSnapshot::fromEntries(std::vector<Change> entries,
+                                                                            quint64 version)
+{
+    std::vector<Node::Entry> nodeEntries;
+    nodeEntries.reserve(entries.size());
+    for (Change& entry : entries) {
+        if (entry.application) {
+            const size_t hash = hashKey(entry.key);
+            nodeEntries.push_back({hash, std::move(entry.key), std::move(entry.application)});
+        }
+    }
+
+    auto snapshot = std::make_unique<ApplicationSnapshot>();
+    snapshot->m_count = static_cast<int>(nodeEntries.size());
+    snapshot->m_root = Node::build(std::move(nodeEntries), 0);
+    snapshot->m_version = version;
+    return snapshot;
+}
+
+std::unique_ptr<const ApplicationSnapshot> ApplicationSnapshot::withChanges(const std::vector<Change>& changes,
+                                                                            quint64 version) const
+{
+    auto snapshot = std::make_unique<ApplicationSnapshot>(*this);
+    for (const Change& change : changes) {
+        const size_t hash = hashKey(change.key);
+        if (change.application) {
+            snapshot->m_root = Node::set(snapshot->m_root, 0, {hash, change.key, change.application},
+                                         snapshot->m_count);
+        } else {
+            snapshot->m_root = Node::remove(snapshot->m_root, 0, hash, change.key, snapshot->m_count);
+        }
+    }
+    snapshot->m_version = version;
+    return snapshot;
+}
+
+const Application* ApplicationSnapshot::find(const QString& processName) const
+{
+    const QString key = processName.toLower();
+    const size_t hash = hashKey(key);
+    const Node* node = m_root.get();
+    for (int shift = 0; node && !node->isLeaf(); shift += BITS) {
+        node = node->children[bucket(hash, shift)].get();
+    }
+    if (!node) {
+        return nullptr;
+    }
+
+    for (const Node::Entry& slot : node->entries) {
+        if (slot.hash == hash && slot.key == key) {
+            return slot.application.get();
+        }
+    }
+
+    return nullptr;
+}
+
+bool ApplicationSnapshot::exists(const QString& processName) const
+{
+    return find(processName) != nullptr;
+}
+
+int ApplicationSnapshot::count() const
+{
+    return m_count;
+}
+
+quint64 ApplicationSnapshot::version() const
+{
+    return m_version;
+}
@@ -0,0 +1,77 @@
+#ifndef APPLICATIONSNAPSHOT_H
+#define APPLICATIONSNAPSHOT_H
+
+#include "Application.h"
+#include <QString>
+#include <memory>
+#include <vector>
+
+/**
+ * @brief Immutable copy of the repository contents at one published version
+ *
+ * Snapshots are built by the ApplicationRepository on the main thread and
+ * handed to background readers through a SnapshotPublisher. Once published
+ * a snapshot is never modified, so any number of threads can query it
+ * concurrently without synchronization.
+ *
+ * Entries live in a persistent hash trie: withChanges() copies only the
+ * path from the root to each changed entry and shares everything else with
+ * the version it was made from, so publishing one change costs O(log n)
+ * rather than a copy of the whole repository.
+ */
+class ApplicationSnapshot
+{
+public:
+    /**
+     * @brief One entry to set, or to remove when application is null
+     */
+    struct Change {
+        QString key;  // Normalized (lowercase) process name
+        std::shared_ptr<const Application> application;
+    };
+
+    ApplicationSnapshot() = default;
+
+    /**
+     * @brief Build a snapshot holding exactly the given entries
+     */
+    static std::unique_ptr<const ApplicationSnapshot> fromEntries(std::vector<Change> entries, quint64 version);
+
+    /**
+     * @brief Build the next version: this one with the changes applied
+     */
+    std::unique_ptr<const ApplicationSnapshot> withChanges(const std::vector<Change>& changes,
+                                                           quint64 version) const;
+
+    /**
+     * @brief Find an application by process name
+     * @param processName The executable name (case-insensitive)
+     * @return Pointer to the snapshot's copy, or nullptr if not found
+     */
+    const Application* find(const QString& processName) const;
+
+    /**
+     * @brief Check if an application exists in this version
+     */
+    bool exists(const QString& processName) const;
+
+    /**
+     * @brief Number of applications in this version
+     */
+    int count() const;
+
+    /**
+     * @brief Monotonically increasing version number, starting at 1
+     */
+    quint64 version() const;
+
+private:
+    struct Node;
+    using NodePtr = std::shared_ptr<const Node>;
+
+    NodePtr m_root;
+    int m_count = 0;
+    quint64 m_version = 0;
+};
+
+#endif // APPLICATIONSNAPSHOT_H
@@ -0,0 +1,267 @@
+#include "JsonReader.h"
+#include <cstdlib>
+#include <cstring>
+
+JsonReader::JsonReader(const char* begin, const char* end)
+    : m_pos(begin),
+      m_end(end),
+      m_failed(false)
+{
+}
+
+JsonReader::JsonReader(const QByteArray& data)
+    : m_pos(data.constData()),
+      m_end(data.constData() + data.size()),
+      m_failed(false)
+{
+}
+
+bool JsonReader::consume(char c)
+{
+    skipWhitespace();
+    if (!m_failed && m_pos < m_end && *m_pos == c) {
+        ++m_pos;
+        return true;
+    }
+    return false;
+}
+
+bool JsonReader::expect(char c)
+{
+    return consume(c) || fail();
+}
+
+char JsonReader::peek()
+{
+    skipWhitespace();
+    return (m_failed || m_pos >= m_end) ? '\0' : *m_pos;
+}
+
+bool JsonReader::readString(const char*& data, int& length, bool& escaped)
+{
+    if (!expect('"')) {
+        return false;
+    }
+    
+    const char* start = m_pos;
+    escaped = false;
+    while (m_pos < m_end) {
+        char c = *m_pos;
+        if (c == '"') {
+            data = start;
+            length = static_cast<int>(m_pos - start);
+            ++m_pos;
+            return true;
+        }
+        if (c == '\\') {
+            escaped = true;
+            ++m_pos;    // The escaped character can't end the string
+        }
+        ++m_pos;
+    }
+    return fail();
+}
+
+bool JsonReader::readInteger(qint64& value)
+{
+    skipWhitespace();
+    if (m_failed || m_pos >= m_end) {
+        return fail();
+    }
+    
+    const char* start = m_pos;
+    bool negative = (*m_pos == '-');
+    if (negative) {
+        ++m_pos;
+    }
+    
+    quint64 magnitude = 0;
+    const char* digits = m_pos;
+    while (m_pos < m_end && *m_pos >= '0' && *m_pos <= '9') {
+        magnitude = magnitude * 10 + static_cast<quint64>(*m_pos - '0');
+        ++m_pos;
+    }
+    if (m_pos == digits) {
+        return fail();
+    }
+    
+    // Fractions and exponents are rare here; let strtod handle them
+    if (m_pos < m_end && (*m_pos == '.' || *m_pos == 'e' || *m_pos == 'E')) {
+        while (m_pos < m_end && std::strchr("0123456789.eE+-", *m_pos)) {
+            ++m_pos;
+        }
+        QByteArray number(start, static_cast<int>(m_pos - start));
+        value = static_cast<qint64>(std::strtod(number.constData(), nullptr));
+        return true;
+    }
+    
+    value = negative ? -static_cast<qint64>(magnitude) : static_cast<qint64>(magnitude);
+    return true;
+}
+
+bool JsonReader::readBool(bool& value)
+{
+    char c = peek();
+    if (c == 't' && skipLiteral("true", 4)) {
+        value = true;
+        return true;
+    }
+    if (c == 'f' && skipLiteral("false", 5)) {
+        value = false;
+        return true;
+    }
+    return fail();
+}
+
+bool JsonReader::skipValue()
+{
+    const char* data;
+    int length;
+    bool escaped;
+    qint64 number;
+    
+    switch (peek()) {
+        case '"':
+            return readString(data, length, escaped);
+        case 't':
+            return skipLiteral("true", 4);
+        case 'f':
+            return skipLiteral("false", 5);
+        case 'n':
+            return skipLiteral("null", 4);
+        case '{':
+            expect('{');
+            while (!consume('}')) {
+                if (!readString(data, length, escaped) || !expect(':') || !skipValue()) {
+                    return false;
+                }
+                skipComma();
+            }
+            return !m_failed;
+        case '[':
+            expect('[');
+            while (!consume(']')) {
+                if (!skipValue()) {
+                    return false;
+                }
+                skipComma();
+            }
+            return !m_failed;
+        default:
+            return readInteger(number);
+    }
+}
+
+void JsonReader::skipComma()
+{
+    consume(',');
+}
+
+bool JsonReader::atEnd()
+{
+    skipWhitespace();
+    return m_pos >= m_end;
+}
+
+bool JsonReader::unescape(const char* data, int length, QByteArray& out)
+{
+    out.resize(0);
+    const char* end = data + length;
+    while (data < end) {
+        char c = *data++;
+        if (c != '\\') {
+            out.append(c);
+            continue;
+        }
+        if (data >= end) {
+            return false;
+        }
+        
+        c = *data++;
+        switch (c) {
+            case '"': out.append('"'); break;
+            case '\\': out.append('\\'); break;
+            case '/': out.append('/'); break;
+            case 'b': out.append('\b'); break;
+            case 'f': out.append('\f'); break;
+            case 'n': out.append('\n'); break;
+            case 'r': out.append('\r'); break;
+            case 't': out.append('\t'); break;
+            case 'u': {
+                auto readHex = [&data, end](uint& unit) {
+                    if (end - data < 4) {
+                        return false;
+                    }
+                    unit = 0;
+                    for (int i = 0; i < 4; ++i) {
+                        char h = *data++;
+                        unit <<= 4;
+                        if (h >= '0' && h <= '9') unit |= static_cast<uint>(h - '0');
+                        else if (h >= 'a' && h <= 'f') unit |= static_cast<uint>(h - 'a' + 10);
+                        else if (h >= 'A' && h <= 'F') unit |= static_cast<uint>(h - 'A' + 10);
+                        else return false;
+                    }
+                    return true;
+                };
+                
+                uint code;
+                if (!readHex(code)) {
+                    return false;
+                }
+                // Combine surrogate pairs written as two escapes
+                if (code >= 0xD800 && code < 0xDC00 && end - data >= 6 && data[0] == '\\' && data[1] == 'u') {
+                    data += 2;
+                    uint low;
+                    if (!readHex(low)) {
+                        return false;
+                    }
+                    code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                }
+                
+                // Re-encode the code point as UTF-8
+                if (code < 0x80) {
+                    out.append(static_cast<char>(code));
+                } else if (code < 0x800) {
+                    out.append(static_cast<char>(0xC0 | (code >> 6)));
+                    out.append(static_cast<char>(0x80 | (code & 0x3F)));
+                } else if (code < 0x10000) {
+                    out.append(static_cast<char>(0xE0 | (code >> 12)));
+                    out.append(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+                    out.append(static_cast<char>(0x80 | (code & 0x3F)));
+                } else {
+                    out.append(static_cast<char>(0xF0 | (code >> 18)));
+                    out.append(static_cast<char>(0x80 | ((code >> 12) & 0x3F)));
+                    out.append(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+                    out.append(static_cast<char>(0x80 | (code & 0x3F)));
+                }
+                break;
+            }
+            default:
+                return false;
+        }
+    }
+    return true;
+}
+
+void JsonReader::skipWhitespace()
+{
+    while (m_pos < m_end && (*m_pos == ' ' || *m_pos == '\n' || *m_pos == '\r' || *m_pos == '\t')) {
+        ++m_pos;
+    }
+}
+
+bool JsonReader::fail()
+{
+    m_failed = true;
+    return false;
+}
+
+bool JsonReader::skipLiteral(const char* literal, int length)
+{
+    skipWhitespace();
+    if (m_failed || m_end - m_pos < length || std::memcmp(m_pos, literal, length) != 0) {
+        return fail();
+    }
+    m_pos += length;
+    return true;
+}
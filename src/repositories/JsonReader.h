@@ -0,0 +1,88 @@
+#ifndef JSONREADER_H
+#define JSONREADER_H
+
+#include <QByteArray>
+#include <QtGlobal>
+
+/**
+ * @brief Minimal pull tokenizer over a UTF-8 JSON buffer
+ * 
+ * Reads values in place without building a document tree. Strings are
+ * returned as raw byte ranges into the buffer (still escaped), so keys can
+ * be compared or hashed without allocating; unescape() decodes a value when
+ * it is actually needed.
+ * 
+ * The first syntax error puts the reader into a failed state; every later
+ * call then returns false, so callers can check failed() once at the end.
+ */
+class JsonReader
+{
+public:
+    JsonReader(const char* begin, const char* end);
+    explicit JsonReader(const QByteArray& data);
+    
+    /**
+     * @brief Consume c if it is the next non-whitespace character
+     */
+    bool consume(char c);
+    
+    /**
+     * @brief Consume c or enter the failed state
+     */
+    bool expect(char c);
+    
+    /**
+     * @brief Next non-whitespace character without consuming it ('\0' at end)
+     */
+    char peek();
+    
+    /**
+     * @brief Read a string token
+     * @param data Set to the first byte after the opening quote
+     * @param length Set to the number of raw bytes before the closing quote
+     * @param escaped Set if the raw bytes contain escape sequences
+     */
+    bool readString(const char*& data, int& length, bool& escaped);
+    
+    /**
+     * @brief Read a number, truncating any fraction or exponent
+     */
+    bool readInteger(qint64& value);
+    
+    /**
+     * @brief Read true or false
+     */
+    bool readBool(bool& value);
+    
+    /**
+     * @brief Skip one value of any type, including nested objects and arrays
+     */
+    bool skipValue();
+    
+    /**
+     * @brief Skip a separating comma if present (tolerates trailing commas)
+     */
+    void skipComma();
+    
+    bool failed() const { return m_failed; }
+    bool atEnd();
+    const char* position() const { return m_pos; }
+    
+    /**
+     * @brief Decode escape sequences of a raw string token into UTF-8
+     * @param out Replaced with the decoded bytes (capacity is reused)
+     * @return false on a malformed escape sequence
+     */
+    static bool unescape(const char* data, int length, QByteArray& out);
+    
+private:
+    void skipWhitespace();
+    bool fail();
+    bool skipLiteral(const char* literal, int length);
+    
+    const char* m_pos;
+    const char* m_end;
+    bool m_failed;
+};
+
+#endif // JSONREADER_H
@@ -0,0 +1,525 @@
+#include "SessionHistoryStore.h"
+#include "EventLogger.h"
+
+#include <QDate>
+#include <QDir>
+#include <QSaveFile>
+#include <QtEndian>
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+constexpr char SEGMENT_MAGIC[4] = {'M', 'F', 'S', 'S'};
+constexpr quint16 SEGMENT_VERSION = 1;
+constexpr quint16 COLUMN_COUNT = 5;
+constexpr int HEADER_SIZE = 64;
+constexpr int JOURNAL_RECORD_SIZE = 32;
+
+// Column order inside a segment
+enum Column { AppKeyColumn, StartColumn, DurationColumn, ActiveColumn, ReasonColumn };
+
+constexpr char APP_KEYS_FILE[] = "apps.txt";
+constexpr char SEGMENT_SUFFIX[] = ".seg";
+constexpr char JOURNAL_SUFFIX[] = ".wal";
+
+const QDate EPOCH_DATE(1970, 1, 1);
+
+void appendVarint(QByteArray& out, quint64 value)
+{
+    while (value >= 0x80) {
+        out.append(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    out.append(static_cast<char>(value));
+}
+
+quint64 zigzag(qint64 value)
+{
+    return (static_cast<quint64>(value) << 1) ^ static_cast<quint64>(value >> 63);
+}
+
+qint64 unzigzag(quint64 value)
+{
+    return static_cast<qint64>(value >> 1) ^ -static_cast<qint64>(value & 1);
+}
+
+qint64 dayFromFileName(const QString& fileName, bool& ok)
+{
+    QDate date = QDate::fromString(fileName.section('.', 0, 0), Qt::ISODate);
+    ok = date.isValid();
+    return ok ? EPOCH_DATE.daysTo(date) : 0;
+}
+
+}
+
+// Construction
+
+SessionHistoryStore::SessionHistoryStore(const QString& directory)
+    : m_directory(directory.isEmpty() ? DEFAULT_DIRECTORY : directory),
+      m_journalDay(std::numeric_limits<qint64>::min())
+{
+    open();
+}
+
+SessionHistoryStore::~SessionHistoryStore()
+{
+    m_journal.close();
+}
+
+void SessionHistoryStore::open()
+{
+    QDir dir(m_directory);
+    if (!dir.exists() && !QDir().mkpath(m_directory)) {
+        MF_LOG_WARNING(History, "Failed to create session history directory: %1", m_directory);
+        return;
+    }
+
+    loadAppKeys();
+
+    // Sealed segments: only the headers are read here
+    const QStringList segmentFiles = dir.entryList({QString("*") + SEGMENT_SUFFIX}, QDir::Files);
+    for (const QString& fileName : segmentFiles) {
+        std::unique_ptr<Segment> segment(new Segment);
+        segment->path = dir.filePath(fileName);
+        if (readSegmentHeader(*segment)) {
+            m_segments.push_back(std::move(segment));
+        } else {
+            MF_LOG_WARNING(History, "Ignoring invalid session history segment: %1", segment->path);
+        }
+    }
+    std::sort(m_segments.begin(), m_segments.end(),
+              [](const std::unique_ptr<Segment>& a, const std::unique_ptr<Segment>& b) {
+                  return a->day < b->day;
+              });
+
+    // Journals: every day but the newest is finished and gets sealed
+    std::vector<qint64> journalDays;
+    const QStringList journalFiles = dir.entryList({QString("*") + JOURNAL_SUFFIX}, QDir::Files);
+    for (const QString& fileName : journalFiles) {
+        bool ok;
+        qint64 day = dayFromFileName(fileName, ok);
+        if (ok) {
+            journalDays.push_back(day);
+        }
+    }
+    std::sort(journalDays.begin(), journalDays.end());
+
+    for (std::size_t i = 0; i < journalDays.size(); ++i) {
+        qint64 day = journalDays[i];
+        std::vector<SessionRecord> records;
+        readJournal(journalPath(day), records);
+
+        if (i + 1 < journalDays.size()) {
+            if (records.empty() || writeSegment(day, records)) {
+                QFile::remove(journalPath(day));
+            }
+        } else {
+            // Cut off a torn last record, or appends would land after it misaligned
+            QFile journal(journalPath(day));
+            const qint64 intact = static_cast<qint64>(records.size()) * JOURNAL_RECORD_SIZE;
+            if (journal.size() != intact && !journal.resize(intact)) {
+                MF_LOG_WARNING(History, "Failed to truncate session history journal: %1", journal.fileName());
+            }
+            m_journalRecords = std::move(records);
+            openJournal(day);
+        }
+    }
+}
+
+// App Keys
+
+void SessionHistoryStore::loadAppKeys()
+{
+    QFile file(QDir(m_directory).filePath(APP_KEYS_FILE));
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        return;
+    }
+
+    while (!file.atEnd()) {
+        QString name = QString::fromUtf8(file.readLine()).trimmed();
+        m_appKeys.insert(name, static_cast<quint32>(m_appNames.size()));
+        m_appNames.append(name);
+    }
+}
+
+quint32 SessionHistoryStore::appKey(const QString& processName)
+{
+    QString normalized = processName.toLower();
+    auto it = m_appKeys.constFind(normalized);
+    if (it != m_appKeys.constEnd()) {
+        return it.value();
+    }
+
+    // Keys are line numbers in the file, so one is only handed out once its
+    // line is written; otherwise the next load would number names differently
+    QFile file(QDir(m_directory).filePath(APP_KEYS_FILE));
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text)) {
+        MF_LOG_WARNING(History, "Failed to write session history app keys: %1", file.fileName());
+        return ALL_APPS;
+    }
+    const qint64 sizeBefore = file.size();
+    const QByteArray line = normalized.toUtf8() + '\n';
+    if (file.write(line) != line.size() || !file.flush()) {
+        MF_LOG_WARNING(History, "Failed to write session history app keys: %1", file.fileName());
+        file.resize(sizeBefore);
+        return ALL_APPS;
+    }
+
+    quint32 key = static_cast<quint32>(m_appNames.size());
+    m_appKeys.insert(normalized, key);
+    m_appNames.append(normalized);
+    return key;
+}
+
+quint32 SessionHistoryStore::findAppKey(const QString& processName) const
+{
+    return m_appKeys.value(processName.toLower(), ALL_APPS);
+}
+
+QString SessionHistoryStore::processName(quint32 appKey) const
+{
+    return appKey < static_cast<quint32>(m_appNames.size()) ? m_appNames.at(static_cast<int>(appKey)) : QString();
+}
+
+// Appending
+
+bool SessionHistoryStore::append(const SessionRecord& record)
+{
+    SessionRecord stored = record;
+    stored.end = qMax(stored.start, stored.end);
+
+    qint64 day = dayOf(stored.end);
+    if (!m_journal.isOpen()) {
+        openJournal(day);
+    } else if (day > m_journalDay && sealJournal()) {
+        openJournal(day);
+    }
+    // A record for an earlier day (clock set back) stays in the current
+    // journal; segment headers carry their real bounds, so queries still find it
+
+    char buffer[JOURNAL_RECORD_SIZE] = {};
+    qToLittleEndian<quint32>(stored.appKey, buffer);
+    qToLittleEndian<quint32>(stored.activeSeconds, buffer + 4);
+    qToLittleEndian<qint64>(stored.start, buffer + 8);
+    qToLittleEndian<qint64>(stored.end, buffer + 16);
+    buffer[24] = static_cast<char>(stored.reason);
+
+    m_journalRecords.push_back(stored);
+
+    if (m_journal.write(buffer, JOURNAL_RECORD_SIZE) != JOURNAL_RECORD_SIZE || !m_journal.flush()) {
+        MF_LOG_WARNING(History, "Failed to append to session history journal: %1", m_journal.fileName());
+        return false;
+    }
+    return true;
+}
+
+bool SessionHistoryStore::openJournal(qint64 day)
+{
+    m_journal.close();
+    m_journal.setFileName(journalPath(day));
+    m_journalDay = day;
+    if (!m_journal.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        MF_LOG_WARNING(History, "Failed to open session history journal: %1", m_journal.fileName());
+        return false;
+    }
+    return true;
+}
+
+bool SessionHistoryStore::sealJournal()
+{
+    if (!m_journalRecords.empty() && !writeSegment(m_journalDay, m_journalRecords)) {
+        // Keep appending to the old journal; nothing is lost
+        return false;
+    }
+
+    m_journal.close();
+    QFile::remove(journalPath(m_journalDay));
+    m_journalRecords.clear();
+    return true;
+}
+
+bool SessionHistoryStore::readJournal(const QString& path, std::vector<SessionRecord>& records) const
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    // A torn last record (crash during append) is dropped; open() also
+    // truncates it from the file before appending
+    QByteArray data = file.readAll();
+    const int count = data.size() / JOURNAL_RECORD_SIZE;
+    records.reserve(records.size() + static_cast<std::size_t>(count));
+
+    for (int i = 0; i < count; ++i) {
+        const char* p = data.constData() + i * JOURNAL_RECORD_SIZE;
+        SessionRecord record;
+        record.appKey = qFromLittleEndian<quint32>(p);
+        record.activeSeconds = qFromLittleEndian<quint32>(p + 4);
+        record.start = qFromLittleEndian<qint64>(p + 8);
+        record.end = qFromLittleEndian<qint64>(p + 16);
+        record.reason = static_cast<SessionRecord::Termination>(p[24]);
+        records.push_back(record);
+    }
+    return true;
+}
+
+// Segments
+
+bool SessionHistoryStore::writeSegment(qint64 day, const std::vector<SessionRecord>& newRecords)
+{
+    // A segment for the same day can only exist if the clock was set back;
+    // fold its records into the new one
+    std::vector<SessionRecord> merged;
+    const std::vector<SessionRecord>* records = &newRecords;
+
+    auto existing = std::find_if(m_segments.begin(), m_segments.end(),
+                                 [day](const std::unique_ptr<Segment>& s) { return s->day == day; });
+    if (existing != m_segments.end()) {
+        const uchar* data = map(**existing);
+        if (data) {
+            Cursor cursor(data, (*existing)->size);
+            SessionRecord record;
+            while (cursor.next(record)) {
+                merged.push_back(record);
+            }
+        }
+        merged.insert(merged.end(), newRecords.begin(), newRecords.end());
+        records = &merged;
+    }
+
+    QByteArray columns[COLUMN_COUNT];
+    qint64 previousStart = day * SECONDS_PER_DAY;
+    qint64 minStart = std::numeric_limits<qint64>::max();
+    qint64 maxEnd = std::numeric_limits<qint64>::min();
+
+    for (const SessionRecord& record : *records) {
+        appendVarint(columns[AppKeyColumn], record.appKey);
+        appendVarint(columns[StartColumn], zigzag(record.start - previousStart));
+        appendVarint(columns[DurationColumn], static_cast<quint64>(qMax<qint64>(0, record.duration())));
+        appendVarint(columns[ActiveColumn], record.activeSeconds);
+        columns[ReasonColumn].append(static_cast<char>(record.reason));
+
+        previousStart = record.start;
+        minStart = qMin(minStart, record.start);
+        maxEnd = qMax(maxEnd, record.end);
+    }
+
+    char header[HEADER_SIZE] = {};
+    std::memcpy(header, SEGMENT_MAGIC, sizeof(SEGMENT_MAGIC));
+    qToLittleEndian<quint16>(SEGMENT_VERSION, header + 4);
+    qToLittleEndian<quint16>(COLUMN_COUNT, header + 6);
+    qToLittleEndian<qint32>(static_cast<qint32>(day), header + 8);
+    qToLittleEndian<quint32>(static_cast<quint32>(records->size()), header + 12);
+    qToLittleEndian<qint64>(minStart, header + 16);
+    qToLittleEndian<qint64>(maxEnd, header + 24);
+    for (int c = 0; c < COLUMN_COUNT; ++c) {
+        qToLittleEndian<quint32>(static_cast<quint32>(columns[c].size()), header + 32 + 4 * c);
+    }
+
+    // Unmap before the file is replaced; the entry stays until the new file
+    // is in place, and maps again on demand if that fails
+    if (existing != m_segments.end()) {
+        (*existing)->data = nullptr;
+        (*existing)->file.reset();
+    }
+
+    const QString path = segmentPath(day);
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        MF_LOG_WARNING(History, "Failed to write session history segment: %1", path);
+        return false;
+    }
+    file.write(header, HEADER_SIZE);
+    for (const QByteArray& column : columns) {
+        file.write(column);
+    }
+    if (!file.commit()) {
+        MF_LOG_WARNING(History, "Failed to write session history segment: %1", path);
+        return false;
+    }
+    if (existing != m_segments.end()) {
+        m_segments.erase(existing);
+    }
+
+    std::unique_ptr<Segment> segment(new Segment);
+    segment->path = path;
+    if (!readSegmentHeader(*segment)) {
+        return false;
+    }
+    auto pos = std::upper_bound(m_segments.begin(), m_segments.end(), day,
+                                [](qint64 d, const std::unique_ptr<Segment>& s) { return d < s->day; });
+    m_segments.insert(pos, std::move(segment));
+    return true;
+}
+
+bool SessionHistoryStore::readSegmentHeader(Segment& segment) const
+{
+    QFile file(segment.path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    char header[HEADER_SIZE];
+    if (file.read(header, HEADER_SIZE) != HEADER_SIZE
+        || std::memcmp(header, SEGMENT_MAGIC, sizeof(SEGMENT_MAGIC)) != 0
+        || qFromLittleEndian<quint16>(header + 4) != SEGMENT_VERSION
+        || qFromLittleEndian<quint16>(header + 6) != COLUMN_COUNT) {
+        return false;
+    }
+
+    qint64 columnBytes = 0;
+    for (int c = 0; c < COLUMN_COUNT; ++c) {
+        columnBytes += qFromLittleEndian<quint32>(header + 32 + 4 * c);
+    }
+
+    segment.day = qFromLittleEndian<qint32>(header + 8);
+    segment.count = qFromLittleEndian<quint32>(header + 12);
+    segment.minStart = qFromLittleEndian<qint64>(header + 16);
+    segment.maxEnd = qFromLittleEndian<qint64>(header + 24);
+    segment.size = file.size();
+    return segment.size >= HEADER_SIZE + columnBytes;
+}
+
+const uchar* SessionHistoryStore::map(Segment& segment) const
+{
+    if (segment.data) {
+        return segment.data;
+    }
+
+    segment.file.reset(new QFile(segment.path));
+    if (!segment.file->open(QIODevice::ReadOnly)) {
+        MF_LOG_WARNING(History, "Failed to open session history segment: %1", segment.path);
+        segment.file.reset();
+        return nullptr;
+    }
+    segment.size = segment.file->size();
+    segment.data = segment.file->map(0, segment.size);
+    if (!segment.data) {
+        MF_LOG_WARNING(History, "Failed to map session history segment: %1", segment.path);
+        segment.file.reset();
+    }
+    return segment.data;
+}
+
+// Queries
+
+SessionHistoryStore::Totals SessionHistoryStore::totals(qint64 from, qint64 to, quint32 appKey) const
+{
+    Totals result;
+    forEachInRange(from, to, [&](const SessionRecord& record) {
+        if (appKey != ALL_APPS && record.appKey != appKey) {
+            return;
+        }
+        ++result.sessions;
+
+        qint64 duration = record.duration();
+        qint64 overlap = qMin(record.end, to) - qMax(record.start, from);
+        if (duration <= 0 || overlap >= duration) {
+            result.activeSeconds += record.activeSeconds;
+        } else {
+            result.activeSeconds += static_cast<qint64>(record.activeSeconds) * overlap / duration;
+        }
+    });
+    return result;
+}
+
+int SessionHistoryStore::partitionCount() const
+{
+    return static_cast<int>(m_segments.size()) + (m_journalRecords.empty() ? 0 : 1);
+}
+
+qint64 SessionHistoryStore::recordCount() const
+{
+    qint64 count = static_cast<qint64>(m_journalRecords.size());
+    for (const std::unique_ptr<Segment>& segment : m_segments) {
+        count += segment->count;
+    }
+    return count;
+}
+
+qint64 SessionHistoryStore::dayOf(qint64 secsSinceEpoch)
+{
+    // Floor division, so times before the epoch land on the right day
+    qint64 day = secsSinceEpoch / SECONDS_PER_DAY;
+    return (secsSinceEpoch % SECONDS_PER_DAY < 0) ? day - 1 : day;
+}
+
+QString SessionHistoryStore::segmentPath(qint64 day) const
+{
+    return QDir(m_directory).filePath(EPOCH_DATE.addDays(day).toString(Qt::ISODate) + SEGMENT_SUFFIX);
+}
+
+QString SessionHistoryStore::journalPath(qint64 day) const
+{
+    return QDir(m_directory).filePath(EPOCH_DATE.addDays(day).toString(Qt::ISODate) + JOURNAL_SUFFIX);
+}
+
+// Cursor
+
+SessionHistoryStore::Cursor::Cursor(const uchar* data, qint64 size)
+    : m_remaining(0),
+      m_previousStart(0),
+      m_valid(false)
+{
+    if (size < HEADER_SIZE || std::memcmp(data, SEGMENT_MAGIC, sizeof(SEGMENT_MAGIC)) != 0) {
+        return;
+    }
+
+    const uchar* pos = data + HEADER_SIZE;
+    const uchar* end = data + size;
+    for (int c = 0; c < COLUMN_COUNT; ++c) {
+        quint32 bytes = qFromLittleEndian<quint32>(data + 32 + 4 * c);
+        if (bytes > static_cast<quint64>(end - pos)) {
+            return;
+        }
+        m_column[c] = pos;
+        m_columnEnd[c] = pos + bytes;
+        pos += bytes;
+    }
+
+    m_remaining = qFromLittleEndian<quint32>(data + 12);
+    m_previousStart = static_cast<qint64>(qFromLittleEndian<qint32>(data + 8)) * SECONDS_PER_DAY;
+    m_valid = true;
+}
+
+bool SessionHistoryStore::Cursor::next(SessionRecord& record)
+{
+    if (m_remaining == 0) {
+        return false;
+    }
+
+    quint64 appKey, start, duration, active;
+    if (!readVarint(m_column[AppKeyColumn], m_columnEnd[AppKeyColumn], appKey)
+        || !readVarint(m_column[StartColumn], m_columnEnd[StartColumn], start)
+        || !readVarint(m_column[DurationColumn], m_columnEnd[DurationColumn], duration)
+        || !readVarint(m_column[ActiveColumn], m_columnEnd[ActiveColumn], active)
+        || m_column[ReasonColumn] >= m_columnEnd[ReasonColumn]) {
+        m_remaining = 0;
+        m_valid = false;
+        return false;
+    }
+
+    m_previousStart += unzigzag(start);
+    record.appKey = static_cast<quint32>(appKey);
+    record.start = m_previousStart;
+    record.end = m_previousStart + static_cast<qint64>(duration);
+    record.activeSeconds = static_cast<quint32>(active);
+    record.reason = static_cast<SessionRecord::Termination>(*m_column[ReasonColumn]++);
+    --m_remaining;
+    return true;
+}
+
+bool SessionHistoryStore::Cursor::readVarint(const uchar*& pos, const uchar* end, quint64& value)
+{
+    value = 0;
+    for (int shift = 0; shift < 64 && pos < end; shift += 7) {
+        uchar byte = *pos++;
+        value |= static_cast<quint64>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,201 @@
+#ifndef SESSIONHISTORYSTORE_H
+#define SESSIONHISTORYSTORE_H
+
+#include "SessionRecord.h"
+#include <QFile>
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <limits>
+#include <memory>
+#include <vector>
+
+/**
+ * @brief Append-only history of finished sessions, partitioned by day
+ *
+ * Records are partitioned by the UTC day their session ended on, so
+ * appends always go to the newest partition:
+ *
+ * - The current day lives in "<date>.wal", a journal of fixed-width
+ *   little-endian records that is appended (and flushed) once per session,
+ *   and in memory.
+ * - Once a record for a later day arrives, the journal is sealed into
+ *   "<date>.seg": a header followed by one column per field. Starts are
+ *   zigzag deltas from the previous record; app keys, durations and active
+ *   seconds are varints; reasons are one byte each. A typical record takes
+ *   about 8 bytes instead of 32.
+ *
+ * Segment headers (day, count, earliest start, latest end) are read when
+ * the store opens. A range query skips every segment whose header does not
+ * overlap the interval, maps the others with QFile::map() on first use and
+ * decodes them in place, so the cost of a query depends on the days it
+ * covers rather than on the size of the history.
+ *
+ * Process names are mapped to small persistent keys through "apps.txt"
+ * (one name per line, key = line number).
+ *
+ * Not thread-safe; owned and used by the GUI thread.
+ */
+class SessionHistoryStore
+{
+public:
+    static constexpr const char* DEFAULT_DIRECTORY = "session_history";
+    static constexpr quint32 ALL_APPS = std::numeric_limits<quint32>::max();
+    static constexpr qint64 SECONDS_PER_DAY = 24 * 60 * 60;
+
+    /**
+     * @brief Session count and prorated active time for a range
+     */
+    struct Totals {
+        int sessions = 0;
+        qint64 activeSeconds = 0;
+    };
+
+    explicit SessionHistoryStore(const QString& directory = DEFAULT_DIRECTORY);
+    ~SessionHistoryStore();
+
+    SessionHistoryStore(const SessionHistoryStore&) = delete;
+    SessionHistoryStore& operator=(const SessionHistoryStore&) = delete;
+
+    /**
+     * @brief Persistent key for a process name, assigned on first use
+     * @return ALL_APPS if a new key could not be saved; no key is assigned
+     *         then, so a later call tries again
+     */
+    quint32 appKey(const QString& processName);
+
+    /**
+     * @brief Key for a process name, or ALL_APPS if it has none yet
+     */
+    quint32 findAppKey(const QString& processName) const;
+
+    /**
+     * @brief Process name for a key (empty if unknown)
+     */
+    QString processName(quint32 appKey) const;
+
+    /**
+     * @brief Append a finished session
+     * @return false if the journal could not be written
+     */
+    bool append(const SessionRecord& record);
+
+    /**
+     * @brief Visit every session overlapping [from, to), oldest day first
+     * @param visitor Callable taking const SessionRecord&
+     */
+    template<typename Visitor>
+    void forEachInRange(qint64 from, qint64 to, Visitor&& visitor) const;
+
+    /**
+     * @brief Sessions overlapping [from, to) and their active time
+     *
+     * Active seconds of sessions that only partly overlap the range are
+     * prorated by the overlapping share of the session's duration.
+     *
+     * @param appKey Restrict to one application, or ALL_APPS
+     */
+    Totals totals(qint64 from, qint64 to, quint32 appKey = ALL_APPS) const;
+
+    /**
+     * @brief Sealed segments plus the open journal, if it has records
+     */
+    int partitionCount() const;
+
+    /**
+     * @brief Number of stored sessions
+     */
+    qint64 recordCount() const;
+
+    const QString& directory() const { return m_directory; }
+
+    /**
+     * @brief UTC day number (days since epoch) of a timestamp
+     */
+    static qint64 dayOf(qint64 secsSinceEpoch);
+
+private:
+    /**
+     * @brief Sequential decoder over a mapped segment
+     */
+    class Cursor
+    {
+    public:
+        Cursor(const uchar* data, qint64 size);
+        bool isValid() const { return m_valid; }
+        bool next(SessionRecord& record);
+
+    private:
+        static bool readVarint(const uchar*& pos, const uchar* end, quint64& value);
+
+        const uchar* m_column[5];
+        const uchar* m_columnEnd[5];
+        quint32 m_remaining;
+        qint64 m_previousStart;
+        bool m_valid;
+    };
+
+    struct Segment {
+        qint64 day = 0;
+        quint32 count = 0;
+        qint64 minStart = 0;
+        qint64 maxEnd = 0;
+        QString path;
+        std::unique_ptr<QFile> file;    // Owns the mapping
+        const uchar* data = nullptr;
+        qint64 size = 0;
+    };
+
+    void open();
+    void loadAppKeys();
+    bool readSegmentHeader(Segment& segment) const;
+    bool readJournal(const QString& path, std::vector<SessionRecord>& records) const;
+    bool openJournal(qint64 day);
+    bool sealJournal();
+    bool writeSegment(qint64 day, const std::vector<SessionRecord>& records);
+    const uchar* map(Segment& segment) const;
+
+    QString segmentPath(qint64 day) const;
+    QString journalPath(qint64 day) const;
+
+    QString m_directory;
+
+    QStringList m_appNames;
+    QHash<QString, quint32> m_appKeys;
+
+    std::vector<std::unique_ptr<Segment>> m_segments;   // Sorted by day
+
+    QFile m_journal;
+    qint64 m_journalDay;
+    std::vector<SessionRecord> m_journalRecords;
+};
+
+template<typename Visitor>
+void SessionHistoryStore::forEachInRange(qint64 from, qint64 to, Visitor&& visitor) const
+{
+    for (const std::unique_ptr<Segment>& segment : m_segments) {
+        if (segment->count == 0 || segment->minStart >= to || segment->maxEnd <= from) {
+            continue;
+        }
+        const uchar* data = map(*segment);
+        if (!data) {
+            continue;
+        }
+
+        Cursor cursor(data, segment->size);
+        SessionRecord record;
+        while (cursor.next(record)) {
+            if (record.overlaps(from, to)) {
+                visitor(static_cast<const SessionRecord&>(record));
+            }
+        }
+    }
+
+    for (const SessionRecord& record : m_journalRecords) {
+        if (record.overlaps(from, to)) {
+            visitor(record);
+        }
+    }
+}
+
+#endif // SESSIONHISTORYSTORE_H
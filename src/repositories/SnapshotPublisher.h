@@ -0,0 +1,244 @@
+#ifndef SNAPSHOTPUBLISHER_H
+#define SNAPSHOTPUBLISHER_H
+
+#include <QtGlobal>
+#include <QMutex>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Publishes immutable versions of T to lock-free readers (RCU style)
+ *
+ * One writer thread replaces the current version with publish(). Any number
+ * of reader threads call read() and get a ReadGuard that keeps the version
+ * they saw alive until the guard is destroyed. Readers never take a lock:
+ * entering a read section claims a reader slot with one CAS and then loads
+ * the current pointer with one atomic load. Only when more than
+ * READER_SLOTS sections are open at once do the extra readers share an
+ * overflow slot behind a mutex.
+ *
+ * Reclamation is epoch based. Every publish bumps a global epoch and tags
+ * the replaced version with it. A retired version is deleted once every
+ * active reader slot holds an epoch at least as new as the tag, which
+ * proves that no reader can still hold a pointer to it.
+ *
+ * Thread Safety: read() may be called from any thread. publish() and
+ * reclaim() must only be called from the single writer thread.
+ */
+template<typename T>
+class SnapshotPublisher
+{
+public:
+    /**
+     * @brief RAII read section; the snapshot stays valid while this lives
+     */
+    class ReadGuard
+    {
+    public:
+        ReadGuard()
+            : m_owner(nullptr), m_slot(nullptr), m_snapshot(nullptr)
+        {
+        }
+
+        ReadGuard(ReadGuard&& other) noexcept
+            : m_owner(other.m_owner),
+              m_slot(std::exchange(other.m_slot, nullptr)),
+              m_snapshot(std::exchange(other.m_snapshot, nullptr))
+        {
+        }
+
+        ReadGuard& operator=(ReadGuard&& other) noexcept
+        {
+            if (this != &other) {
+                release();
+                m_owner = other.m_owner;
+                m_slot = std::exchange(other.m_slot, nullptr);
+                m_snapshot = std::exchange(other.m_snapshot, nullptr);
+            }
+            return *this;
+        }
+
+        ~ReadGuard()
+        {
+            release();
+        }
+
+        ReadGuard(const ReadGuard&) = delete;
+        ReadGuard& operator=(const ReadGuard&) = delete;
+
+        const T* get() const { return m_snapshot; }
+        const T* operator->() const { return m_snapshot; }
+        const T& operator*() const { return *m_snapshot; }
+        explicit operator bool() const { return m_snapshot != nullptr; }
+
+    private:
+        friend class SnapshotPublisher;
+
+        ReadGuard(const SnapshotPublisher* owner, std::atomic<quint64>* slot, const T* snapshot)
+            : m_owner(owner), m_slot(slot), m_snapshot(snapshot)
+        {
+        }
+
+        void release()
+        {
+            if (m_slot) {
+                m_owner->releaseSlot(m_slot);
+                m_slot = nullptr;
+            }
+        }
+
+        const SnapshotPublisher* m_owner;
+        std::atomic<quint64>* m_slot;
+        const T* m_snapshot;
+    };
+
+    SnapshotPublisher() = default;
+
+    ~SnapshotPublisher()
+    {
+        // Readers must be gone by now; free everything unconditionally
+        delete m_current.load(std::memory_order_relaxed);
+        for (const Retired& retired : m_retired) {
+            delete retired.snapshot;
+        }
+    }
+
+    SnapshotPublisher(const SnapshotPublisher&) = delete;
+    SnapshotPublisher& operator=(const SnapshotPublisher&) = delete;
+
+    /**
+     * @brief Enter a read section and return the current version
+     * @return Guard holding the snapshot (may hold nullptr before the first publish)
+     */
+    ReadGuard read() const
+    {
+        std::atomic<quint64>* slot = acquireSlot();
+        return ReadGuard(this, slot, m_current.load(std::memory_order_seq_cst));
+    }
+
+    /**
+     * @brief Replace the current version (writer thread only)
+     * @param next The new immutable version
+     */
+    void publish(std::unique_ptr<const T> next)
+    {
+        const T* previous = m_current.exchange(next.release(), std::memory_order_seq_cst);
+        quint64 retireEpoch = m_epoch.fetch_add(1, std::memory_order_seq_cst) + 1;
+        if (previous) {
+            m_retired.push_back({previous, retireEpoch});
+        }
+        reclaim();
+    }
+
+    /**
+     * @brief Delete retired versions that no reader can still observe
+     */
+    void reclaim()
+    {
+        if (m_retired.empty()) {
+            return;
+        }
+
+        quint64 oldestActive = oldestActiveEpoch();
+        auto keep = m_retired.begin();
+        for (auto it = m_retired.begin(); it != m_retired.end(); ++it) {
+            if (it->epoch <= oldestActive) {
+                delete it->snapshot;
+            } else {
+                *keep++ = *it;
+            }
+        }
+        m_retired.erase(keep, m_retired.end());
+    }
+
+    /**
+     * @brief Number of replaced versions still waiting for readers to leave
+     */
+    std::size_t retiredCount() const { return m_retired.size(); }
+
+private:
+    // Read sections that can be open at once without touching the mutex
+    static constexpr int READER_SLOTS = 64;
+
+    struct alignas(64) ReaderSlot
+    {
+        std::atomic<quint64> epoch{0};    // 0 = idle, otherwise epoch at entry
+    };
+
+    struct Retired
+    {
+        const T* snapshot;
+        quint64 epoch;
+    };
+
+    std::atomic<quint64>* acquireSlot() const
+    {
+        // Spread threads over the slots so they rarely collide
+        static std::atomic<unsigned> s_nextHint{0};
+        thread_local unsigned t_hint = s_nextHint.fetch_add(1, std::memory_order_relaxed);
+
+        for (unsigned i = t_hint; i != t_hint + READER_SLOTS; ++i) {
+            std::atomic<quint64>& slot = m_slots[i % READER_SLOTS].epoch;
+            quint64 idle = 0;
+            if (slot.load(std::memory_order_relaxed) == 0
+                && slot.compare_exchange_strong(idle, m_epoch.load(std::memory_order_seq_cst),
+                                                std::memory_order_seq_cst)) {
+                t_hint = i % READER_SLOTS;
+                return &slot;
+            }
+        }
+
+        // Every slot is taken: share the overflow slot, which keeps the
+        // epoch of its first reader until the last one leaves. Later readers
+        // see newer versions, so the older epoch only delays reclamation.
+        QMutexLocker locker(&m_overflowMutex);
+        if (m_overflowReaders++ == 0) {
+            m_overflow.epoch.store(m_epoch.load(std::memory_order_seq_cst), std::memory_order_seq_cst);
+        }
+        return &m_overflow.epoch;
+    }
+
+    void releaseSlot(std::atomic<quint64>* slot) const
+    {
+        if (slot != &m_overflow.epoch) {
+            slot->store(0, std::memory_order_release);
+            return;
+        }
+
+        QMutexLocker locker(&m_overflowMutex);
+        if (--m_overflowReaders == 0) {
+            m_overflow.epoch.store(0, std::memory_order_release);
+        }
+    }
+
+    quint64 oldestActiveEpoch() const
+    {
+        quint64 oldest = m_epoch.load(std::memory_order_seq_cst);
+        auto include = [&oldest](const ReaderSlot& slot) {
+            quint64 entered = slot.epoch.load(std::memory_order_seq_cst);
+            if (entered != 0 && entered < oldest) {
+                oldest = entered;
+            }
+        };
+        for (const ReaderSlot& slot : m_slots) {
+            include(slot);
+        }
+        include(m_overflow);
+        return oldest;
+    }
+
+    std::atomic<const T*> m_current{nullptr};
+    std::atomic<quint64> m_epoch{1};
+    mutable ReaderSlot m_slots[READER_SLOTS];
+    mutable ReaderSlot m_overflow;
+    mutable QMutex m_overflowMutex;
+    mutable int m_overflowReaders = 0;     // Guarded by m_overflowMutex
+
+    // Writer-only state
+    std::vector<Retired> m_retired;
+};
+
+#endif // SNAPSHOTPUBLISHER_H
@@ -0,0 +1,432 @@
+#include "UsageRollups.h"
+#include "EventLogger.h"
+
+#include <QDataStream>
+#include <QDate>
+#include <QDateTime>
+#include <QFile>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QThreadPool>
+#include <algorithm>
+
+namespace {
+
+constexpr quint32 FILE_MAGIC = 0x4D465255; // "MFRU"
+constexpr quint16 FILE_VERSION = 1;
+
+constexpr qint64 SECONDS_PER_HOUR = 3600;
+
+// Day 0 (1970-01-01) was a Thursday; shifting by 3 days starts weeks on Monday
+constexpr qint64 WEEK_DAY_OFFSET = 3;
+
+const QDate EPOCH_DATE(1970, 1, 1);
+
+qint64 floorDiv(qint64 a, qint64 b)
+{
+    qint64 q = a / b;
+    return (a % b < 0) ? q - 1 : q;
+}
+
+}
+
+UsageRollups::UsageRollups(const QTimeZone& zone)
+    : m_zone(zone),
+      m_nextCompaction(0),
+      m_pool(new QThreadPool)
+{
+    m_pool->setMaxThreadCount(1);
+}
+
+UsageRollups::~UsageRollups()
+{
+    waitForCompaction();
+}
+
+// Recording
+
+void UsageRollups::record(const QString& normalizedName, Application::Category category,
+                          qint64 start, qint64 end, qint64 activeSeconds)
+{
+    start = qMin(start, end);
+    activeSeconds = qMax<qint64>(0, activeSeconds);
+
+    bool scheduleCompaction = false;
+    {
+        QMutexLocker locker(&m_mutex);
+        recordInto(m_applications[normalizedName], start, end, activeSeconds);
+        recordInto(m_categories[static_cast<int>(category)], start, end, activeSeconds);
+
+        if (end >= m_nextCompaction) {
+            m_nextCompaction = end + COMPACTION_INTERVAL;
+            scheduleCompaction = true;
+        }
+    }
+
+    if (scheduleCompaction) {
+        m_pool->start([this, end]() {
+            compact(end);
+        });
+    }
+}
+
+void UsageRollups::recordInto(Series& series, qint64 start, qint64 end, qint64 activeSeconds) const
+{
+    for (int r = 0; r < RESOLUTION_COUNT; ++r) {
+        Resolution resolution = static_cast<Resolution>(r);
+        std::vector<Bucket>& level = series.levels[r];
+
+        if (end <= start) {
+            add(level, static_cast<qint32>(bucketIndex(resolution, end)),
+                static_cast<quint32>(activeSeconds), 1);
+            continue;
+        }
+
+        // Spread the active time over the buckets the session overlaps; the
+        // last one takes the rounding remainder and the session itself
+        const qint64 duration = end - start;
+        const qint64 first = bucketIndex(resolution, start);
+        const qint64 last = bucketIndex(resolution, end - 1);
+        qint64 remaining = activeSeconds;
+
+        for (qint64 index = first; index <= last; ++index) {
+            qint64 share = remaining;
+            if (index < last) {
+                qint64 from = qMax(start, indexStart(resolution, index));
+                qint64 to = qMin(end, indexStart(resolution, index + 1));
+                share = activeSeconds * (to - from) / duration;
+            }
+            remaining -= share;
+            add(level, static_cast<qint32>(index), static_cast<quint32>(share), index == last ? 1 : 0);
+        }
+    }
+}
+
+void UsageRollups::add(std::vector<Bucket>& level, qint32 index, quint32 seconds, quint32 sessions)
+{
+    // Sessions arrive roughly in time order, so the last bucket is the usual target
+    if (!level.empty() && level.back().index == index) {
+        level.back().seconds += seconds;
+        level.back().sessions += sessions;
+        return;
+    }
+    if (level.empty() || level.back().index < index) {
+        level.push_back(Bucket{index, seconds, sessions});
+        return;
+    }
+
+    auto it = std::lower_bound(level.begin(), level.end(), index,
+                               [](const Bucket& b, qint32 i) { return b.index < i; });
+    if (it != level.end() && it->index == index) {
+        it->seconds += seconds;
+        it->sessions += sessions;
+    } else {
+        level.insert(it, Bucket{index, seconds, sessions});
+    }
+}
+
+// Queries
+
+UsageRollups::Usage UsageRollups::appUsage(const QString& normalizedName, Resolution resolution, qint64 time) const
+{
+    return appUsage(normalizedName, resolution, time, time + 1);
+}
+
+UsageRollups::Usage UsageRollups::categoryUsage(Application::Category category, Resolution resolution, qint64 time) const
+{
+    return categoryUsage(category, resolution, time, time + 1);
+}
+
+UsageRollups::Usage UsageRollups::appUsage(const QString& normalizedName, Resolution resolution,
+                                           qint64 from, qint64 to) const
+{
+    QMutexLocker locker(&m_mutex);
+    auto it = m_applications.constFind(normalizedName);
+    return it == m_applications.constEnd() ? Usage() : lookup(it.value(), resolution, from, to);
+}
+
+UsageRollups::Usage UsageRollups::categoryUsage(Application::Category category, Resolution resolution,
+                                                qint64 from, qint64 to) const
+{
+    QMutexLocker locker(&m_mutex);
+    return lookup(m_categories[static_cast<int>(category)], resolution, from, to);
+}
+
+UsageRollups::Usage UsageRollups::lookup(const Series& series, Resolution resolution, qint64 from, qint64 to) const
+{
+    Usage usage;
+    if (from >= to) {
+        return usage;
+    }
+
+    const std::vector<Bucket>& level = series.levels[static_cast<int>(resolution)];
+    const qint64 first = bucketIndex(resolution, from);
+    const qint64 last = bucketIndex(resolution, to - 1);
+
+    // Check the newest bucket first; most queries are about the current period
+    auto it = level.end();
+    if (level.empty() || level.back().index < first) {
+        return usage;
+    }
+    if (level.back().index > first) {
+        it = std::lower_bound(level.begin(), level.end(), first,
+                              [](const Bucket& b, qint64 i) { return b.index < i; });
+    } else {
+        it = level.end() - 1;
+    }
+
+    for (; it != level.end() && it->index <= last; ++it) {
+        usage.seconds += it->seconds;
+        usage.sessions += static_cast<int>(it->sessions);
+    }
+    return usage;
+}
+
+// Compaction
+
+void UsageRollups::compact(qint64 now)
+{
+    // Collect the keys first and prune one series per lock, so recording on
+    // the GUI thread never waits for more than one series
+    QList<QString> names;
+    {
+        QMutexLocker locker(&m_mutex);
+        names = m_applications.keys();
+    }
+
+    int removed = 0;
+    for (const QString& name : names) {
+        QMutexLocker locker(&m_mutex);
+        auto it = m_applications.find(name);
+        if (it == m_applications.end()) {
+            continue;
+        }
+        removed += prune(it.value(), now);
+    }
+
+    for (Series& series : m_categories) {
+        QMutexLocker locker(&m_mutex);
+        removed += prune(series, now);
+    }
+
+    if (removed > 0) {
+        MF_LOG_DEBUG(Repository, "Usage rollups: dropped %1 expired buckets", removed);
+    }
+}
+
+int UsageRollups::prune(Series& series, qint64 now) const
+{
+    int removed = 0;
+    const qint64 horizons[] = {HOUR_RETENTION, DAY_RETENTION};
+    for (int r = 0; r < 2; ++r) {
+        Resolution resolution = static_cast<Resolution>(r);
+        std::vector<Bucket>& level = series.levels[r];
+
+        // Buckets that ended before the horizon
+        const qint64 oldest = bucketIndex(resolution, now - horizons[r]);
+        auto keep = std::lower_bound(level.begin(), level.end(), oldest,
+                                     [](const Bucket& b, qint64 i) { return b.index < i; });
+        if (keep != level.begin()) {
+            removed += static_cast<int>(keep - level.begin());
+            level.erase(level.begin(), keep);
+            if (level.capacity() > 2 * level.size() + 16) {
+                level.shrink_to_fit();
+            }
+        }
+    }
+    return removed;
+}
+
+void UsageRollups::waitForCompaction()
+{
+    m_pool->waitForDone();
+}
+
+int UsageRollups::bucketCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    int count = 0;
+    for (const Series& series : m_applications) {
+        for (const std::vector<Bucket>& level : series.levels) {
+            count += static_cast<int>(level.size());
+        }
+    }
+    for (const Series& series : m_categories) {
+        for (const std::vector<Bucket>& level : series.levels) {
+            count += static_cast<int>(level.size());
+        }
+    }
+    return count;
+}
+
+void UsageRollups::clear()
+{
+    waitForCompaction();
+    QMutexLocker locker(&m_mutex);
+    m_applications.clear();
+    m_categories = {};
+    m_nextCompaction = 0;
+}
+
+// Persistence
+
+namespace {
+
+template<typename Level>
+void writeLevels(QDataStream& out, const Level& levels)
+{
+    for (const auto& level : levels) {
+        out << static_cast<quint32>(level.size());
+        for (const auto& bucket : level) {
+            out << bucket.index << bucket.seconds << bucket.sessions;
+        }
+    }
+}
+
+template<typename Level>
+bool readLevels(QDataStream& in, Level& levels)
+{
+    for (auto& level : levels) {
+        quint32 count = 0;
+        in >> count;
+        if (in.status() != QDataStream::Ok || count > (1u << 24)) {
+            return false;
+        }
+        level.resize(count);
+        for (quint32 i = 0; i < count; ++i) {
+            in >> level[i].index >> level[i].seconds >> level[i].sessions;
+            if (i > 0 && level[i].index <= level[i - 1].index) {
+                return false;
+            }
+        }
+    }
+    return in.status() == QDataStream::Ok;
+}
+
+}
+
+bool UsageRollups::save(const QString& path) const
+{
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        MF_LOG_WARNING(Repository, "Failed to write usage rollups: %1", path);
+        return false;
+    }
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_6_0);
+    {
+        QMutexLocker locker(&m_mutex);
+        out << FILE_MAGIC << FILE_VERSION << static_cast<quint32>(m_applications.size());
+        for (auto it = m_applications.constBegin(); it != m_applications.constEnd(); ++it) {
+            out << it.key();
+            writeLevels(out, it.value().levels);
+        }
+        for (const Series& series : m_categories) {
+            writeLevels(out, series.levels);
+        }
+    }
+
+    return file.commit();
+}
+
+bool UsageRollups::load(const QString& path)
+{
+    QFile file(path);
+    if (!file.exists()) {
+        clear();
+        return true;
+    }
+    if (!file.open(QIODevice::ReadOnly)) {
+        MF_LOG_WARNING(Repository, "Failed to open usage rollups: %1", path);
+        return false;
+    }
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_6_0);
+
+    quint32 magic = 0;
+    quint16 version = 0;
+    quint32 count = 0;
+    in >> magic >> version >> count;
+    if (magic != FILE_MAGIC || version != FILE_VERSION) {
+        MF_LOG_WARNING(Repository, "Invalid usage rollups file: %1", path);
+        return false;
+    }
+
+    // Decode into fresh tables so a bad file leaves the current ones intact
+    QHash<QString, Series> applications;
+    std::array<Series, Application::CATEGORY_COUNT> categories;
+    applications.reserve(static_cast<qsizetype>(count));
+    for (quint32 i = 0; i < count; ++i) {
+        QString name;
+        in >> name;
+        if (!readLevels(in, applications[name].levels)) {
+            MF_LOG_WARNING(Repository, "Invalid usage rollups file: %1", path);
+            return false;
+        }
+    }
+    for (Series& series : categories) {
+        if (!readLevels(in, series.levels)) {
+            MF_LOG_WARNING(Repository, "Invalid usage rollups file: %1", path);
+            return false;
+        }
+    }
+
+    waitForCompaction();
+    QMutexLocker locker(&m_mutex);
+    m_applications.swap(applications);
+    m_categories.swap(categories);
+    m_nextCompaction = 0;
+    return true;
+}
+
+// Buckets
+
+qint64 UsageRollups::bucketIndex(Resolution resolution, qint64 time) const
+{
+    switch (resolution) {
+        case Resolution::Hour:
+            return floorDiv(time, SECONDS_PER_HOUR);
+        case Resolution::Day:
+            return dayIndex(time);
+        case Resolution::Week:
+            return floorDiv(dayIndex(time) + WEEK_DAY_OFFSET, 7);
+    }
+    return 0;
+}
+
+qint64 UsageRollups::bucketStart(Resolution resolution, qint64 time) const
+{
+    return indexStart(resolution, bucketIndex(resolution, time));
+}
+
+const QTimeZone& UsageRollups::timeZone() const
+{
+    return m_zone;
+}
+
+qint64 UsageRollups::indexStart(Resolution resolution, qint64 index) const
+{
+    switch (resolution) {
+        case Resolution::Hour:
+            return index * SECONDS_PER_HOUR;
+        case Resolution::Day:
+            return dayStart(index);
+        case Resolution::Week:
+            return dayStart(index * 7 - WEEK_DAY_OFFSET);
+    }
+    return 0;
+}
+
+qint64 UsageRollups::dayIndex(qint64 time) const
+{
+    // Calendar date in the zone, counted from 1970-01-01
+    return EPOCH_DATE.daysTo(QDateTime::fromSecsSinceEpoch(time, m_zone).date());
+}
+
+qint64 UsageRollups::dayStart(qint64 day) const
+{
+    // Local midnight; where a DST jump skips it, the first moment of the day
+    return EPOCH_DATE.addDays(day).startOfDay(m_zone).toSecsSinceEpoch();
+}
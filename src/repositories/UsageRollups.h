@@ -0,0 +1,152 @@
+#ifndef USAGEROLLUPS_H
+#define USAGEROLLUPS_H
+
+#include "Application.h"
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QTimeZone>
+#include <array>
+#include <memory>
+#include <vector>
+
+class QThreadPool;
+
+/**
+ * @brief Hour, day and week usage totals per application and per category
+ *
+ * record() adds a finished session to one bucket per resolution (a session
+ * that spans several buckets is split in proportion to its overlap), so
+ * every resolution is always up to date and a lookup is one search in a
+ * short sorted vector - usually just a check of its last element, because
+ * budget checks and dashboards ask about the current period.
+ *
+ * Fine buckets are only kept for a retention horizon (HOUR_RETENTION and
+ * DAY_RETENTION). The coarser resolutions already hold their totals, so
+ * downsampling amounts to dropping expired buckets; compact() does that
+ * and is scheduled on a background thread about once per
+ * COMPACTION_INTERVAL of recorded time. Week buckets are kept forever.
+ *
+ * Sessions count towards the category the application had when they were
+ * recorded; recategorizing an application does not move its history.
+ *
+ * Day and week buckets follow the calendar of the rollups' time zone (the
+ * system zone unless one is passed in): a day runs from local midnight to
+ * local midnight, so it can be 23 or 25 hours long across a DST change,
+ * and weeks start on Monday. Hour buckets are UTC hours, which are local
+ * hours too except in zones with a fractional offset.
+ *
+ * All methods are thread-safe.
+ */
+class UsageRollups
+{
+public:
+    enum class Resolution {
+        Hour,
+        Day,
+        Week
+    };
+    static constexpr int RESOLUTION_COUNT = 3;
+
+    static constexpr qint64 HOUR_RETENTION = 14 * 24 * 3600;      // Two weeks of hours
+    static constexpr qint64 DAY_RETENTION = 400 * 24 * 3600;      // Over a year of days
+    static constexpr qint64 COMPACTION_INTERVAL = 6 * 3600;
+
+    /**
+     * @brief Total active time and finished sessions in a bucket or range
+     */
+    struct Usage {
+        qint64 seconds = 0;
+        int sessions = 0;
+    };
+
+    /**
+     * @param zone Time zone whose calendar days and weeks the buckets follow
+     */
+    explicit UsageRollups(const QTimeZone& zone = QTimeZone::systemTimeZone());
+    ~UsageRollups();
+
+    UsageRollups(const UsageRollups&) = delete;
+    UsageRollups& operator=(const UsageRollups&) = delete;
+
+    /**
+     * @brief Add a finished session
+     * @param normalizedName The application's normalized process name
+     * @param category The application's current category
+     * @param start Session start, seconds since epoch
+     * @param end Session end, seconds since epoch; the session counts here
+     * @param activeSeconds Time spent in the session, spread over [start, end)
+     */
+    void record(const QString& normalizedName, Application::Category category,
+                qint64 start, qint64 end, qint64 activeSeconds);
+
+    /**
+     * @brief Usage in the bucket containing time
+     */
+    Usage appUsage(const QString& normalizedName, Resolution resolution, qint64 time) const;
+    Usage categoryUsage(Application::Category category, Resolution resolution, qint64 time) const;
+
+    /**
+     * @brief Usage in all buckets overlapping [from, to)
+     */
+    Usage appUsage(const QString& normalizedName, Resolution resolution, qint64 from, qint64 to) const;
+    Usage categoryUsage(Application::Category category, Resolution resolution, qint64 from, qint64 to) const;
+
+    /**
+     * @brief Drop hour and day buckets that ended before their horizon
+     * @param now Reference time, seconds since epoch
+     */
+    void compact(qint64 now);
+
+    /**
+     * @brief Wait for a scheduled background compaction to finish
+     */
+    void waitForCompaction();
+
+    /**
+     * @brief Number of buckets held, over all series and resolutions
+     */
+    int bucketCount() const;
+
+    void clear();
+
+    bool save(const QString& path) const;
+    bool load(const QString& path);
+
+    /**
+     * @brief Start of the bucket containing time
+     */
+    qint64 bucketStart(Resolution resolution, qint64 time) const;
+
+    const QTimeZone& timeZone() const;
+
+private:
+    struct Bucket {
+        qint32 index;       // Buckets since epoch at this resolution
+        quint32 seconds;
+        quint32 sessions;
+    };
+
+    struct Series {
+        std::array<std::vector<Bucket>, RESOLUTION_COUNT> levels;
+    };
+
+    qint64 bucketIndex(Resolution resolution, qint64 time) const;
+    qint64 indexStart(Resolution resolution, qint64 index) const;
+    qint64 dayIndex(qint64 time) const;
+    qint64 dayStart(qint64 day) const;
+    static void add(std::vector<Bucket>& level, qint32 index, quint32 seconds, quint32 sessions);
+    void recordInto(Series& series, qint64 start, qint64 end, qint64 activeSeconds) const;
+    Usage lookup(const Series& series, Resolution resolution, qint64 from, qint64 to) const;
+    int prune(Series& series, qint64 now) const;
+
+    const QTimeZone m_zone;
+    mutable QMutex m_mutex;
+    QHash<QString, Series> m_applications;
+    std::array<Series, Application::CATEGORY_COUNT> m_categories;
+    qint64 m_nextCompaction;
+
+    std::unique_ptr<QThreadPool> m_pool;
+};
+
+#endif // USAGEROLLUPS_H
@@ -2,7 +2,10 @@
 #include "Application.h"
 #include "ApplicationRepository.h"
 #include "CategorizationManager.h"
-#include <QDebug>
+#include "EventLogger.h"
+#include "services/metrics/DetectionLatency.h"
+#include "services/metrics/Metrics.h"
+#include "services/metrics/TraceSpans.h"
 
 ProcessEventDispatcher::ProcessEventDispatcher(ApplicationRepository* appRepo,
                                                CategorizationManager* catManager,
@@ -16,13 +19,18 @@ ProcessEventDispatcher::ProcessEventDispatcher(ApplicationRepository* appRepo,
     Q_ASSERT(catManager != nullptr);
     
     // Log initialization for debugging
-    qDebug() << "ProcessEventDispatcher initialized";
+    MF_LOG_DEBUG(Dispatch, "ProcessEventDispatcher initialized");
 }
 
 void ProcessEventDispatcher::onProcessStarted(DWORD pid, const QString& processName)
 {
+    // Closes the arrow from the monitor tick that emitted processStarted
+    MF_TRACE_SPAN("onProcessStarted");
+    MF_TRACE_FLOW_END("processStarted", pid);
+    DetectionLatency::delivered(pid);
+
     // TODO: Log the event for debugging
-    qDebug() << "Process started:" << processName << "PID:" << pid;
+    MF_LOG_DEBUG(Dispatch, "Process started: %1 PID: %2", processName, pid);
     
     // TODO: Delegate to private method for clarity
     identifyAndDispatch(pid, processName);
@@ -31,7 +39,7 @@ void ProcessEventDispatcher::onProcessStarted(DWORD pid, const QString& processN
 void ProcessEventDispatcher::onProcessTerminated(DWORD pid)
 {
     // Log the termination
-    qDebug() << "Process terminated: PID" << pid;
+    MF_LOG_DEBUG(Dispatch, "Process terminated: PID %1", pid);
     
     // TODO: Simply forward the termination event
     // Domain consumers will handle based on their tracked PIDs
@@ -40,14 +48,39 @@ void ProcessEventDispatcher::onProcessTerminated(DWORD pid)
 
 void ProcessEventDispatcher::identifyAndDispatch(DWORD pid, const QString& processName)
 {
+    static LatencyHistogram& dispatchTime = MetricsRegistry::histogram(
+        "mindfulness_dispatch_seconds", "Time to look up and route one started process");
+    static Counter& uncategorizedCount = MetricsRegistry::counter(
+        "mindfulness_dispatch_uncategorized_total", "Started processes with no known application");
+    static Counter& gameCount = MetricsRegistry::counter(
+        "mindfulness_dispatch_games_total", "Started processes routed as games");
+    static Counter& workCount = MetricsRegistry::counter(
+        "mindfulness_dispatch_work_total", "Started processes routed as work applications");
+    ScopedLatency timing(dispatchTime);
+    MF_TRACE_SPAN("identifyAndDispatch");
+
     // Query the repository for this application
-    Application* app = m_appRepository->find(processName);
+    ApplicationId appId;
+    Application* app = nullptr;
+    {
+        MF_TRACE_SPAN("repository lookup");
+        appId = m_appRepository->findId(processName);
+        app = m_appRepository->get(appId);
+    }
     
+    // Only games are timed past this point
+    const bool game = app && (app->getCategory() == Application::Category::Game ||
+                              app->getCategory() == Application::Category::Leisure);
+    if (!game) {
+        DetectionLatency::forget(pid);
+    }
+
     // If application not found, check for uncategorized handling
     if (!app) {
+        uncategorizedCount.add();
         // Check if already pending categorization
         if (!m_categorizationManager->isAwaitingCategorization(processName)) {
-            qDebug() << "Uncategorized application found:" << processName;
+            MF_LOG_DEBUG(Dispatch, "Uncategorized application found: %1", processName);
             emit uncategorizedAppDetected(processName);
         }
         return;
@@ -57,29 +90,32 @@ void ProcessEventDispatcher::identifyAndDispatch(DWORD pid, const QString& proce
     switch (app->getCategory()) {
         case Application::Category::Game:
         case Application::Category::Leisure:
-            qDebug() << "Game detected:" << processName;
-            emit gameDetected(pid, processName, app);
+            MF_LOG_DEBUG(Dispatch, "Game detected: %1", processName);
+            gameCount.add();
+            DetectionLatency::dispatched(pid);
+            emit gameDetected(pid, processName, appId);
             break;
             
         case Application::Category::Work:
         case Application::Category::Productivity:
-            qDebug() << "Work application detected:" << processName;
-            emit workApplicationDetected(pid, processName, app);
+            MF_LOG_DEBUG(Dispatch, "Work application detected: %1", processName);
+            workCount.add();
+            emit workApplicationDetected(pid, processName, appId);
             break;
             
         case Application::Category::Social:
             // TODO: Future implementation for social apps
-            qDebug() << "Social application detected:" << processName;
+            MF_LOG_DEBUG(Dispatch, "Social application detected: %1", processName);
             break;
             
         case Application::Category::Utility:
         case Application::Category::System:
             // System utilities typically don't need tracking
-            qDebug() << "System/Utility detected, ignoring:" << processName;
+            MF_LOG_DEBUG(Dispatch, "System/Utility detected, ignoring: %1", processName);
             break;
             
         default:
-            qWarning() << "Unknown category for application:" << processName;
+            MF_LOG_WARNING(Dispatch, "Unknown category for application: %1", processName);
             break;
     }
 }
\ No newline at end of file
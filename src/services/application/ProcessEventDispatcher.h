@@ -3,7 +3,8 @@
 
 #include <QObject>
 #include <QString>
-#include <windows.h> // For DWORD
+#include "services/utils/PlatformTypes.h" // For DWORD
+#include "ApplicationId.h"
 
 // Forward declarations
 class Application;
@@ -56,17 +57,21 @@ signals:
      * @brief Emitted when a known game or leisure application starts
      * @param pid Process ID
      * @param processName Executable name
-     * @param app Application entity (never null)
+     * @param appId Handle to the Application entity; resolve with
+     *              ApplicationRepository::get(), which returns nullptr once
+     *              the entry has been removed
      */
-    void gameDetected(DWORD pid, const QString& processName, Application* app);
+    void gameDetected(DWORD pid, const QString& processName, ApplicationId appId);
     
     /**
      * @brief Emitted when a known work/productivity application starts
      * @param pid Process ID
      * @param processName Executable name
-     * @param app Application entity (never null)
+     * @param appId Handle to the Application entity; resolve with
+     *              ApplicationRepository::get(), which returns nullptr once
+     *              the entry has been removed
      */
-    void workApplicationDetected(DWORD pid, const QString& processName, Application* app);
+    void workApplicationDetected(DWORD pid, const QString& processName, ApplicationId appId);
     
     /**
      * @brief Emitted when an uncategorized application is detected
@@ -0,0 +1,365 @@
+#include "DeadlineScheduler.h"
+#include "TimeSource.h"
+
+#include <QTimer>
+#include <QtAlgorithms>
+#include <limits>
+
+namespace {
+
+constexpr quint64 SLOT_MASK = DeadlineScheduler::SLOTS_PER_LEVEL - 1;
+
+constexpr int shiftOf(int level)
+{
+    return level * DeadlineScheduler::SLOT_BITS;
+}
+
+constexpr qint64 WHEEL_SPAN = qint64(1) << shiftOf(DeadlineScheduler::LEVELS);
+
+quint64 rotateRight(quint64 value, int bits)
+{
+    bits &= 63;
+    return bits == 0 ? value : (value >> bits) | (value << (64 - bits));
+}
+
+/**
+ * @brief Distance (1..64) from slot position to the next occupied slot after it
+ */
+int distanceToNext(quint64 occupied, int position)
+{
+    return static_cast<int>(qCountTrailingZeroBits(rotateRight(occupied, position + 1))) + 1;
+}
+
+}
+
+DeadlineScheduler::DeadlineScheduler(TimeSource* time, QObject *parent)
+    : QObject(parent),
+      m_time(time ? time : TimeSource::system()),
+      m_timer(nullptr),
+      m_current(m_time->elapsed()),
+      m_pending(0),
+      m_wakeups(0)
+{
+    m_slots.fill(-1);
+    m_occupied.fill(0);
+
+    // One timer for every deadline, armed for the next one only. Coarse
+    // timers may fire 5% early, which would mean a wasted wakeup.
+    m_timer = new QTimer(this);
+    m_timer->setSingleShot(true);
+    m_timer->setTimerType(Qt::PreciseTimer);
+    connect(m_timer, &QTimer::timeout, this, &DeadlineScheduler::onTimeout);
+
+    m_time->attach(this);
+}
+
+DeadlineScheduler::~DeadlineScheduler()
+{
+    m_time->detach(this);
+    m_timer->stop();
+}
+
+qint64 DeadlineScheduler::now() const
+{
+    return m_time->elapsed();
+}
+
+TimeSource* DeadlineScheduler::timeSource() const
+{
+    return m_time;
+}
+
+// Scheduling
+
+DeadlineScheduler::Handle DeadlineScheduler::schedule(qint64 deadline, std::function<void()> callback)
+{
+    int index;
+    if (!m_freeEntries.empty()) {
+        index = m_freeEntries.back();
+        m_freeEntries.pop_back();
+    } else {
+        index = static_cast<int>(m_entries.size());
+        m_entries.push_back(Entry{0, nullptr, 1, -1, -1, -1});
+    }
+
+    Entry& entry = m_entries[index];
+    entry.deadline = deadline;
+    entry.callback = std::move(callback);
+    insert(index);
+    ++m_pending;
+
+    // Only an earlier deadline than the armed one needs the timer moved
+    if (!m_timer->isActive() || deadline < now() + m_timer->remainingTime()) {
+        rearm();
+    }
+    return (static_cast<Handle>(entry.generation) << 32) | static_cast<quint32>(index);
+}
+
+DeadlineScheduler::Handle DeadlineScheduler::scheduleIn(qint64 delay, std::function<void()> callback)
+{
+    return schedule(now() + qMax<qint64>(0, delay), std::move(callback));
+}
+
+bool DeadlineScheduler::cancel(Handle handle)
+{
+    const quint32 index = static_cast<quint32>(handle);
+    const quint32 generation = static_cast<quint32>(handle >> 32);
+    if (index >= m_entries.size()) {
+        return false;
+    }
+
+    Entry& entry = m_entries[index];
+    if (entry.slot == -1 || entry.generation != generation) {
+        return false;
+    }
+
+    // Collected entries are already off the wheel; advanceTo() skips them
+    const qint64 deadline = entry.deadline;
+    if (entry.slot != DUE_SLOT) {
+        unlink(static_cast<int>(index));
+    }
+    release(static_cast<int>(index));
+
+    // Move the timer on if it was armed for this deadline
+    if (m_timer->isActive() && deadline <= now() + m_timer->remainingTime()) {
+        rearm();
+    }
+    return true;
+}
+
+// Wheel
+
+void DeadlineScheduler::insert(int index)
+{
+    Entry& entry = m_entries[index];
+
+    // Late deadlines go into the current slot and run on the next pass;
+    // ones past the top level's range wait in its last slot
+    qint64 tick = qMax(entry.deadline, m_current);
+    const qint64 delta = tick - m_current;
+    if (delta >= WHEEL_SPAN) {
+        tick = m_current + WHEEL_SPAN - 1;
+    }
+
+    int level = 0;
+    while (level < LEVELS - 1 && delta >= (qint64(1) << shiftOf(level + 1))) {
+        ++level;
+    }
+
+    const int position = static_cast<int>((static_cast<quint64>(tick) >> shiftOf(level)) & SLOT_MASK);
+    const int slot = level * SLOTS_PER_LEVEL + position;
+
+    entry.slot = slot;
+    entry.prev = -1;
+    entry.next = m_slots[slot];
+    if (entry.next >= 0) {
+        m_entries[entry.next].prev = index;
+    }
+    m_slots[slot] = index;
+    m_occupied[level] |= quint64(1) << position;
+}
+
+void DeadlineScheduler::unlink(int index)
+{
+    Entry& entry = m_entries[index];
+    if (entry.prev >= 0) {
+        m_entries[entry.prev].next = entry.next;
+    } else {
+        m_slots[entry.slot] = entry.next;
+    }
+    if (entry.next >= 0) {
+        m_entries[entry.next].prev = entry.prev;
+    }
+
+    if (m_slots[entry.slot] < 0) {
+        m_occupied[entry.slot / SLOTS_PER_LEVEL] &= ~(quint64(1) << (entry.slot % SLOTS_PER_LEVEL));
+    }
+    entry.slot = -1;
+}
+
+void DeadlineScheduler::cascade(int level)
+{
+    const int position = static_cast<int>((static_cast<quint64>(m_current) >> shiftOf(level)) & SLOT_MASK);
+    const int slot = level * SLOTS_PER_LEVEL + position;
+
+    int index = m_slots[slot];
+    m_slots[slot] = -1;
+    m_occupied[level] &= ~(quint64(1) << position);
+
+    // Re-file relative to the new position; they land on lower levels
+    while (index >= 0) {
+        int next = m_entries[index].next;
+        insert(index);
+        index = next;
+    }
+}
+
+void DeadlineScheduler::collectSlot(int slot, std::vector<Handle>& due)
+{
+    int index = m_slots[slot];
+    m_slots[slot] = -1;
+    m_occupied[0] &= ~(quint64(1) << slot);
+
+    // Entries stay allocated, and cancellable, until their callback runs
+    while (index >= 0) {
+        Entry& entry = m_entries[index];
+        int next = entry.next;
+        entry.slot = DUE_SLOT;
+        due.push_back((static_cast<Handle>(entry.generation) << 32) | static_cast<quint32>(index));
+        index = next;
+    }
+}
+
+void DeadlineScheduler::release(int index)
+{
+    Entry& entry = m_entries[index];
+    entry.callback = nullptr;
+    entry.slot = -1;
+    ++entry.generation;
+    m_freeEntries.push_back(index);
+    --m_pending;
+}
+
+qint64 DeadlineScheduler::nextEventTick() const
+{
+    // Earliest tick after the current one at which a level-0 slot is due
+    // or a higher level slot has to be cascaded
+    qint64 best = -1;
+    for (int level = 0; level < LEVELS; ++level) {
+        if (!m_occupied[level]) {
+            continue;
+        }
+        const qint64 block = m_current >> shiftOf(level);
+        const int position = static_cast<int>(static_cast<quint64>(block) & SLOT_MASK);
+        const qint64 tick = (block + distanceToNext(m_occupied[level], position)) << shiftOf(level);
+        if (best < 0 || tick < best) {
+            best = tick;
+        }
+    }
+    return best;
+}
+
+qint64 DeadlineScheduler::nextDeadline() const
+{
+    if (m_pending == 0) {
+        return -1;
+    }
+
+    const int currentPosition = static_cast<int>(static_cast<quint64>(m_current) & SLOT_MASK);
+    if (m_occupied[0] & (quint64(1) << currentPosition)) {
+        return m_current;
+    }
+
+    // Level-0 slots hold exact ticks
+    qint64 best = -1;
+    if (m_occupied[0]) {
+        best = m_current + distanceToNext(m_occupied[0], currentPosition);
+    }
+
+    // Higher slots only bound their entries from below, so look inside the
+    // ones that start before the best deadline found so far
+    for (int level = 1; level < LEVELS; ++level) {
+        const qint64 block = m_current >> shiftOf(level);
+        const int position = static_cast<int>(static_cast<quint64>(block) & SLOT_MASK);
+        quint64 remaining = m_occupied[level];
+        int offset = 0;
+        while (remaining) {
+            const int distance = distanceToNext(remaining, (position + offset) & static_cast<int>(SLOT_MASK));
+            offset += distance;
+            const qint64 start = (block + offset) << shiftOf(level);
+            if (best >= 0 && start >= best) {
+                break;
+            }
+
+            const int slotPosition = (position + offset) & static_cast<int>(SLOT_MASK);
+            for (int index = m_slots[level * SLOTS_PER_LEVEL + slotPosition]; index >= 0; index = m_entries[index].next) {
+                if (best < 0 || m_entries[index].deadline < best) {
+                    best = m_entries[index].deadline;
+                }
+            }
+            remaining &= ~(quint64(1) << slotPosition);
+        }
+    }
+    return best;
+}
+
+int DeadlineScheduler::advanceTo(qint64 time)
+{
+    // Reuse the last pass's buffer so a steady tick doesn't allocate; a
+    // nested pass (from a callback) just starts with an empty one
+    std::vector<Handle> due;
+    due.swap(m_due);
+
+    collectSlot(static_cast<int>(static_cast<quint64>(m_current) & SLOT_MASK), due);
+    for (;;) {
+        const qint64 next = nextEventTick();
+        if (next < 0 || next > time) {
+            break;
+        }
+
+        m_current = next;
+        for (int level = LEVELS - 1; level >= 1; --level) {
+            if ((m_current & ((qint64(1) << shiftOf(level)) - 1)) == 0) {
+                cascade(level);
+            }
+        }
+        collectSlot(static_cast<int>(static_cast<quint64>(m_current) & SLOT_MASK), due);
+    }
+    m_current = qMax(m_current, time);
+
+    // The wheel is consistent again; callbacks may schedule and cancel,
+    // including entries collected here that have not run yet
+    int ran = 0;
+    for (Handle handle : due) {
+        const int index = static_cast<int>(static_cast<quint32>(handle));
+        Entry& entry = m_entries[index];
+        if (entry.slot != DUE_SLOT || entry.generation != static_cast<quint32>(handle >> 32)) {
+            continue;
+        }
+        std::function<void()> callback = std::move(entry.callback);
+        release(index);
+        callback();
+        ++ran;
+    }
+
+    rearm();
+    due.clear();
+    if (due.capacity() > m_due.capacity()) {
+        m_due.swap(due);
+    }
+    return ran;
+}
+
+void DeadlineScheduler::rearm()
+{
+    if (m_time->isVirtual()) {
+        return;
+    }
+
+    const qint64 next = nextDeadline();
+    if (next < 0) {
+        m_timer->stop();
+        return;
+    }
+
+    const qint64 delay = qBound<qint64>(0, next - now(), std::numeric_limits<int>::max());
+    m_timer->start(static_cast<int>(delay));
+}
+
+void DeadlineScheduler::onTimeout()
+{
+    ++m_wakeups;
+    advanceTo(now());
+}
+
+// Statistics
+
+int DeadlineScheduler::pendingCount() const
+{
+    return m_pending;
+}
+
+quint64 DeadlineScheduler::wakeups() const
+{
+    return m_wakeups;
+}
@@ -0,0 +1,144 @@
+#ifndef DEADLINESCHEDULER_H
+#define DEADLINESCHEDULER_H
+
+#include <QObject>
+#include <QtGlobal>
+#include <array>
+#include <functional>
+#include <vector>
+
+// Forward declarations
+class QTimer;
+class TimeSource;
+
+/**
+ * @brief One-shot deadlines for all sessions, driven by a single timer
+ *
+ * Deadlines live in a hierarchical timing wheel: LEVELS wheels of
+ * SLOTS_PER_LEVEL slots, where a slot on level l spans SLOTS_PER_LEVEL^l
+ * milliseconds. A deadline is filed on the lowest level whose range covers
+ * it and moves down a level (is "cascaded") when the wheel reaches its
+ * slot, so scheduling and cancelling are O(1) no matter how many deadlines
+ * are pending. Deadlines past the top level's range wait in its last slot
+ * and are re-filed each time it comes round.
+ *
+ * Each level keeps a 64-bit occupancy mask, so the next deadline is found
+ * with a few bit scans. The QTimer is armed once for exactly that time:
+ * the thread only wakes up when a deadline is actually due, however many
+ * sessions are running.
+ *
+ * Times are milliseconds on the scheduler's TimeSource (now()); with the
+ * system source its MonotonicClock policy decides whether deadlines move
+ * out by the time the machine spent asleep. Under a virtual TimeSource the
+ * QTimer is never armed and the source calls advanceTo() itself. Otherwise
+ * the timer only says when to look: each expiry
+ * runs what is due by now() and re-arms for the rest, so a timer that
+ * fires early or late after a resume costs one extra wakeup, not a missed
+ * or premature deadline. Callbacks run on the scheduler's thread, after
+ * the wheel has been updated, so they may schedule and cancel freely;
+ * cancelling a deadline that is due in the same pass but has not run yet
+ * still stops it.
+ */
+class DeadlineScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Handle of a scheduled deadline; 0 is never a valid handle
+     */
+    using Handle = quint64;
+
+    static constexpr int SLOT_BITS = 6;
+    static constexpr int SLOTS_PER_LEVEL = 1 << SLOT_BITS;
+    static constexpr int LEVELS = 6;        // 2^36 ms, a bit over two years
+
+    /**
+     * @param time Clock to schedule against (not owned); TimeSource::system() if null
+     */
+    explicit DeadlineScheduler(TimeSource* time = nullptr, QObject *parent = nullptr);
+    ~DeadlineScheduler();
+
+    /**
+     * @brief Current time in milliseconds (monotonic, starts near 0)
+     */
+    qint64 now() const;
+
+    TimeSource* timeSource() const;
+
+    /**
+     * @brief Run callback once at the given time
+     * @param deadline Milliseconds on the now() clock; past deadlines run on the next pass
+     */
+    Handle schedule(qint64 deadline, std::function<void()> callback);
+
+    /**
+     * @brief Run callback once after delay milliseconds
+     */
+    Handle scheduleIn(qint64 delay, std::function<void()> callback);
+
+    /**
+     * @brief Cancel a pending deadline
+     * @return false if it already ran, was cancelled or the handle is invalid
+     */
+    bool cancel(Handle handle);
+
+    /**
+     * @brief Earliest pending deadline, or -1 if there is none
+     */
+    qint64 nextDeadline() const;
+
+    /**
+     * @brief Run every deadline at or before time
+     *
+     * Called by the timer with now(). Exposed so tests and simulations can
+     * drive the wheel through long periods without waiting.
+     *
+     * @return Number of callbacks run
+     */
+    int advanceTo(qint64 time);
+
+    int pendingCount() const;
+
+    /**
+     * @brief Number of timer expirations handled so far
+     */
+    quint64 wakeups() const;
+
+private slots:
+    void onTimeout();
+
+private:
+    struct Entry {
+        qint64 deadline;
+        std::function<void()> callback;
+        quint32 generation;
+        int prev;               // Neighbours in the slot's list, -1 at the ends
+        int next;
+        int slot;               // level * SLOTS_PER_LEVEL + index, DUE_SLOT once collected, -1 when free
+    };
+
+    static constexpr int DUE_SLOT = -2;
+
+    void insert(int index);
+    void unlink(int index);
+    void cascade(int level);
+    void collectSlot(int slot, std::vector<Handle>& due);
+    void release(int index);
+    qint64 nextEventTick() const;
+    void rearm();
+
+    TimeSource* m_time;
+    QTimer* m_timer;
+    qint64 m_current;           // Last processed tick
+
+    std::vector<Entry> m_entries;
+    std::vector<int> m_freeEntries;
+    std::vector<Handle> m_due;  // Spare buffer for advanceTo()
+    std::array<int, LEVELS * SLOTS_PER_LEVEL> m_slots;
+    std::array<quint64, LEVELS> m_occupied;
+    int m_pending;
+    quint64 m_wakeups;
+};
+
+#endif // DEADLINESCHEDULER_H
@@ -0,0 +1,46 @@
+#include "MonotonicClock.h"
+
+#ifdef Q_OS_WIN
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+MonotonicClock::MonotonicClock(SuspendPolicy policy)
+    : m_policy(policy),
+      m_origin(now(policy))
+{
+}
+
+qint64 MonotonicClock::elapsed() const
+{
+    return now(m_policy) - m_origin;
+}
+
+void MonotonicClock::restart()
+{
+    m_origin = now(m_policy);
+}
+
+qint64 MonotonicClock::now(SuspendPolicy policy)
+{
+#ifdef Q_OS_WIN
+    if (policy == SuspendPolicy::ExcludeSuspend) {
+        // Interrupt time minus time spent suspended, in 100 ns units
+        ULONGLONG unbiased = 0;
+        QueryUnbiasedInterruptTime(&unbiased);
+        return static_cast<qint64>(unbiased / 10000);
+    }
+    return static_cast<qint64>(GetTickCount64());
+#else
+    clockid_t id = CLOCK_MONOTONIC;
+#ifdef CLOCK_BOOTTIME
+    if (policy == SuspendPolicy::IncludeSuspend) {
+        id = CLOCK_BOOTTIME;
+    }
+#endif
+    timespec ts;
+    clock_gettime(id, &ts);
+    return static_cast<qint64>(ts.tv_sec) * 1000 + ts.tv_nsec / 1000000;
+#endif
+}
\ No newline at end of file
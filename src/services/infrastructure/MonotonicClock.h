@@ -0,0 +1,54 @@
+#ifndef MONOTONICCLOCK_H
+#define MONOTONICCLOCK_H
+
+#include <QtGlobal>
+
+/**
+ * @brief Millisecond clock that never jumps, with an explicit suspend policy
+ *
+ * Wall-clock time moves with NTP corrections, time zone and daylight saving
+ * changes, and a countdown that is decremented once per timer tick loses
+ * time whenever the event loop stalls. Session time is therefore measured
+ * as the difference of two readings of this clock, and anything derived
+ * from it (time left, time played) is computed when asked for.
+ *
+ * The policy decides what happens to time spent in sleep or hibernation:
+ *
+ * - ExcludeSuspend (CLOCK_MONOTONIC, QueryUnbiasedInterruptTime) stops
+ *   while the machine is suspended. Nobody can play on a sleeping machine,
+ *   so this is what session limits use: closing the lid pauses the limit.
+ * - IncludeSuspend (CLOCK_BOOTTIME, GetTickCount64) keeps counting, for
+ *   deadlines that have to hold in real elapsed time.
+ *
+ * Readings are only comparable between clocks with the same policy.
+ */
+class MonotonicClock
+{
+public:
+    enum class SuspendPolicy {
+        ExcludeSuspend,
+        IncludeSuspend
+    };
+
+    explicit MonotonicClock(SuspendPolicy policy = SuspendPolicy::ExcludeSuspend);
+
+    SuspendPolicy policy() const { return m_policy; }
+
+    /**
+     * @brief Milliseconds since the clock was created (or restart() was called)
+     */
+    qint64 elapsed() const;
+
+    void restart();
+
+    /**
+     * @brief Raw reading in milliseconds from an unspecified origin
+     */
+    static qint64 now(SuspendPolicy policy);
+
+private:
+    SuspendPolicy m_policy;
+    qint64 m_origin;
+};
+
+#endif // MONOTONICCLOCK_H
\ No newline at end of file
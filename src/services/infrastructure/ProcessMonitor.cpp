@@ -1,52 +1,132 @@
 #include "ProcessMonitor.h"
 #include "ApplicationRepository.h"
-#include "../utils/ProcessUtils.h"
+#include "DeadlineScheduler.h"
+#include "ProcessSource.h"
+#include "services/metrics/DetectionLatency.h"
+#include "services/metrics/Metrics.h"
+#include "services/metrics/TraceSpans.h"
+#if defined(MF_TRACK_ALLOCATIONS)
+#include "services/metrics/AllocationTracker.h"
+#endif
 
-#include <QTimer>
 #include <QHash>
 #include <QDebug>
 
-#include <windows.h>
-#include <psapi.h>
 #include <vector>
 
-ProcessMonitor::ProcessMonitor(QObject *parent)
+ProcessMonitor::ProcessMonitor(const ApplicationRepository* appRepo, TimeSource* time,
+                               ProcessSource* source, QObject *parent)
     : QObject(parent),
-      m_monitorTimer(nullptr)
+      m_appRepository(appRepo),
+      m_processSource(source ? source : ProcessSource::system()),
+      m_scheduler(nullptr),
+      m_pollHandle(0),
+      m_nextPoll(0),
+      m_polls(0),
+      m_pollInterval(POLL_INTERVAL_MS),
+      m_throttled(false)
 {
-    // 1. Create the timer that will drive the monitor loop
-    m_monitorTimer = new QTimer(this);
+    // The scheduler is a child, so it moves to the monitor thread with us
+    m_scheduler = new DeadlineScheduler(time, this);
 
-    // 2. Connect the timer's timeout to our main loop function
-    connect(m_monitorTimer, &QTimer::timeout, this, &ProcessMonitor::runMonitorLoop);
-
-    // Note: We don't start the timer here. AppController will call
+    // Note: We don't start polling here. AppController will call
     // startMonitor() after moving this object to the background thread
 }
 
 ProcessMonitor::~ProcessMonitor()
 {
-    if(m_monitorTimer){
-        m_monitorTimer->stop();
-    }
+    stopMonitor();
 }
 
 void ProcessMonitor::startMonitor()
 {
-    // Start the timer. It will now emit timeout() every 2000ms.
-    m_monitorTimer->start(2000); // 2-second interval
+    if (m_pollHandle) {
+        return;
+    }
+    SpanTracer::setThreadName("monitor");
+    m_nextPoll = m_scheduler->now() + m_pollInterval;
+    scheduleNextPoll();
 }
 
 void ProcessMonitor::stopMonitor()
 {
-    m_monitorTimer->stop();
+    if (m_pollHandle) {
+        m_scheduler->cancel(m_pollHandle);
+        m_pollHandle = 0;
+    }
+}
+
+bool ProcessMonitor::isThrottled() const
+{
+    return m_throttled;
+}
+
+int ProcessMonitor::pollInterval() const
+{
+    return m_pollInterval;
+}
+
+void ProcessMonitor::setThrottled(bool throttled)
+{
+    static Gauge& intervalGauge = MetricsRegistry::gauge(
+        "mindfulness_monitor_poll_interval_ms", "Current time between monitor polls");
+    if (throttled == m_throttled) {
+        return;
+    }
+    m_throttled = throttled;
+    m_pollInterval = throttled ? THROTTLED_POLL_INTERVAL_MS : POLL_INTERVAL_MS;
+    intervalGauge.set(m_pollInterval);
+
+    // A pending poll further out than the new interval comes forward
+    if (m_pollHandle) {
+        m_scheduler->cancel(m_pollHandle);
+        m_nextPoll = qMin(m_nextPoll, m_scheduler->now() + m_pollInterval);
+        scheduleNextPoll();
+    }
+}
+
+void ProcessMonitor::scheduleNextPoll()
+{
+    m_pollHandle = m_scheduler->schedule(m_nextPoll, [this]() {
+        // Keep a fixed rate, but skip polls missed while suspended or stalled
+        m_nextPoll = qMax(m_nextPoll + m_pollInterval, m_scheduler->now() + 1);
+        scheduleNextPoll();
+        runMonitorLoop();
+    });
 }
 
 void ProcessMonitor::runMonitorLoop()
 {
+    static LatencyHistogram& tickTime = MetricsRegistry::histogram(
+        "mindfulness_monitor_tick_seconds", "Time spent in one monitor poll");
+    static Counter& startedCount = MetricsRegistry::counter(
+        "mindfulness_monitor_processes_started_total", "New processes signalled to the main thread");
+    static Counter& skippedCount = MetricsRegistry::counter(
+        "mindfulness_monitor_processes_skipped_total", "New system or utility processes not signalled");
+    static Counter& terminatedCount = MetricsRegistry::counter(
+        "mindfulness_monitor_processes_terminated_total", "Process exits signalled to the main thread");
+    static Gauge& runningGauge = MetricsRegistry::gauge(
+        "mindfulness_monitor_processes_running", "Processes in the active process map");
+    static Gauge& deferredGauge = MetricsRegistry::gauge(
+        "mindfulness_monitor_processes_deferred", "Untracked processes held back by the last throttled poll");
+    ScopedLatency timing(tickTime);
+    MF_TRACE_SPAN("monitor tick");
+#if defined(MF_TRACK_ALLOCATIONS)
+    static Gauge& tickAllocations = MetricsRegistry::gauge(
+        "mindfulness_monitor_tick_allocations", "operator new calls in the last monitor poll");
+    AllocationScope allocations;
+#endif
+
+    // Processes found by the first poll were running before we were, so
+    // how long they took to be found says nothing about detection latency
+    const bool timeDetection = m_polls++ > 0;
+
     // 1. Update our persistent map (m_activeProcessMap) in-place.
     //    This is the fast, pass-by-reference call.
-    ProcessUtils::updateActiveProcessMap(m_activeProcessMap);
+    {
+        MF_TRACE_SPAN("update process map");
+        m_processSource->update(m_activeProcessMap);
+    }
 
     // 2. Check for closed applications.
     //    This loop checks our "processed" list (m_knownRunningPIDs)
@@ -58,6 +138,8 @@ void ProcessMonitor::runMonitorLoop()
             // This process *was* known, but is now closed.
             // Remove it from teh "known" list so we can detect it again if it relaunches
             it = m_knownRunningPIDs.erase(it);
+            terminatedCount.add();
+            DetectionLatency::forget(knownPID);
             emit processTerminated(knownPID);
         } else{
             ++it;
@@ -68,6 +150,18 @@ void ProcessMonitor::runMonitorLoop()
     //    This loop checks the "live" list (m_activeProcessMap)
     //    against our "processed" list (m_knownRunningPIDs).
 
+    //    Known applications are looked up in the repository's published
+    //    snapshot, which this thread can read without locking.
+    ApplicationRepository::SnapshotGuard snapshot;
+    if (m_appRepository) {
+        snapshot = m_appRepository->readSnapshot();
+    }
+
+    //    While throttled, processes the repository does not know are left
+    //    for the first poll after it (see setThrottled()). This only defers
+    //    signalling them: update() above has already resolved their names.
+    qint64 deferred = 0;
+
     //    We use the C++11 compatible iterator method.
     auto map_it = m_activeProcessMap.constBegin();
     auto map_end = m_activeProcessMap.constEnd();
@@ -85,12 +179,38 @@ void ProcessMonitor::runMonitorLoop()
         // --- This is a NEW process ---
         // (It's in m_activeProcessMap but not in m_knownRunningPIDs)
 
+        const Application* app = snapshot ? snapshot->find(appName) : nullptr;
+        if (m_throttled && !app) {
+            ++deferred;
+            ++map_it;
+            continue;
+        }
+
         // 1. Add it to our "processed" list so we don't spam signals
         m_knownRunningPIDs.insert(pid);
 
-        // 2. Emit processStarted
+        // 2. System and utility apps are never acted on, so don't
+        //    wake the main thread for them.
+        if (app && (app->getCategory() == Application::Category::System ||
+                    app->getCategory() == Application::Category::Utility)) {
+            skippedCount.add();
+            ++map_it;
+            continue;
+        }
+
+        // 3. Emit processStarted
+        startedCount.add();
+        if (timeDetection) {
+            DetectionLatency::enumerated(pid, m_processSource->startedAt(pid));
+        }
+        MF_TRACE_FLOW_BEGIN("processStarted", pid);
         emit processStarted(pid, appName);
         
         ++map_it; // Move to the next item.
     }
+    runningGauge.set(m_activeProcessMap.size());
+    deferredGauge.set(deferred);
+#if defined(MF_TRACK_ALLOCATIONS)
+    tickAllocations.set(static_cast<qint64>(allocations.stats().allocations));
+#endif
 }
\ No newline at end of file
@@ -5,24 +5,56 @@
 #include <QSet>
 #include <QHash>
 #include <QString>
-#include <windows.h> // For DWORD
+#include "services/utils/PlatformTypes.h" // For DWORD
 
 // Forward declarations
 class QThread;
-class QTimer;
+class ApplicationRepository;
+class DeadlineScheduler;
+class ProcessSource;
+class TimeSource;
 
 class ProcessMonitor : public QObject
 {
     Q_OBJECT
 
 public:
-    explicit ProcessMonitor(QObject *parent = nullptr);
+    /**
+     * @param appRepo Repository whose published snapshot is used to skip
+     * untracked applications on the monitor thread (optional, not owned)
+     * @param time Clock that paces the polling (not owned); TimeSource::system() if null
+     * @param source Process list to poll (not owned); ProcessSource::system() if null
+     * @param parent Must be nullptr so the monitor can be moved to its thread
+     */
+    explicit ProcessMonitor(const ApplicationRepository* appRepo = nullptr, TimeSource* time = nullptr,
+                            ProcessSource* source = nullptr, QObject *parent = nullptr);
+
+    static constexpr int POLL_INTERVAL_MS = 2000;
+    static constexpr int THROTTLED_POLL_INTERVAL_MS = 3 * POLL_INTERVAL_MS;
     ~ProcessMonitor();
 
+    bool isThrottled() const;
+    int pollInterval() const;
+
 public slots:
     void startMonitor();
     void stopMonitor();
 
+    /**
+     * @brief Poll less often and hold back untracked processes, or stop doing so
+     *
+     * While throttled (see ResourceWatchdog) the monitor polls every
+     * THROTTLED_POLL_INTERVAL_MS, and new processes the repository does not
+     * know are neither signalled nor marked as seen: the first poll after
+     * the throttle is lifted reports the ones still running.
+     *
+     * Each poll still enumerates every process and resolves the names of
+     * new ones, since the name is what tells a known application from an
+     * unknown one. Only the longer interval makes polling cheaper; holding
+     * processes back saves the main thread's work on them, not ours.
+     */
+    void setThrottled(bool throttled);
+
 private slots:
     void runMonitorLoop();
 
@@ -31,8 +63,16 @@ signals:
     void processTerminated(DWORD pid);
 
 private:
-    
-    QTimer* m_monitorTimer;
+    void scheduleNextPoll();
+
+    const ApplicationRepository* m_appRepository; // Snapshot reads only (not owned)
+    ProcessSource* m_processSource;               // Not owned
+    DeadlineScheduler* m_scheduler;               // Moves to the monitor thread with us
+    quint64 m_pollHandle;                         // Pending poll, 0 when stopped
+    qint64 m_nextPoll;
+    quint64 m_polls;                              // Completed polls; the first finds nothing new
+    int m_pollInterval;
+    bool m_throttled;
     QSet<DWORD> m_knownRunningPIDs;
     QHash<DWORD, QString> m_activeProcessMap;
 };
@@ -0,0 +1,39 @@
+#include "ProcessSource.h"
+#include "../utils/ProcessUtils.h"
+
+// ProcessSource
+
+ProcessSource::~ProcessSource() = default;
+
+QHash<DWORD, DWORD> ProcessSource::parentPids(const QList<DWORD>&) const
+{
+    return QHash<DWORD, DWORD>();
+}
+
+qint64 ProcessSource::startedAt(DWORD) const
+{
+    return -1;
+}
+
+ProcessSource* ProcessSource::system()
+{
+    static SystemProcessSource source;
+    return &source;
+}
+
+// SystemProcessSource
+
+void SystemProcessSource::update(QHash<DWORD, QString>& processes)
+{
+    ProcessUtils::updateActiveProcessMap(processes);
+}
+
+QHash<DWORD, DWORD> SystemProcessSource::parentPids(const QList<DWORD>& pids) const
+{
+    return ProcessUtils::parentProcessIds(pids);
+}
+
+qint64 SystemProcessSource::startedAt(DWORD pid) const
+{
+    return ProcessUtils::processStartedAt(pid);
+}
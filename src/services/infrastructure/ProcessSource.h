@@ -0,0 +1,65 @@
+#ifndef PROCESSSOURCE_H
+#define PROCESSSOURCE_H
+
+#include <QHash>
+#include <QList>
+#include <QString>
+#include "services/utils/PlatformTypes.h" // For DWORD
+
+/**
+ * @brief Where ProcessMonitor gets the list of running processes from
+ *
+ * The real source asks the operating system through ProcessUtils. Tests
+ * and simulations substitute a scripted one (tests/mocks/MockProcessSource.h)
+ * to drive the monitor, dispatcher and session pipeline without real
+ * processes.
+ */
+class ProcessSource
+{
+public:
+    virtual ~ProcessSource();
+
+    /**
+     * @brief Bring a pid -> executable name map up to date
+     *
+     * Exited processes are removed and new ones added with their lower-case
+     * executable name. Entries whose pid is still running are left alone, so
+     * a pid reused between two updates keeps its old name.
+     */
+    virtual void update(QHash<DWORD, QString>& processes) = 0;
+
+    /**
+     * @brief Pid of the process that started each of pids
+     *
+     * Pids whose parent is unknown are left out; the default knows none.
+     * Only asked for by trace recording, for the processes the last
+     * update() added.
+     */
+    virtual QHash<DWORD, DWORD> parentPids(const QList<DWORD>& pids) const;
+
+    /**
+     * @brief When pid started, on the ScopedLatency::now() clock
+     *
+     * -1 if unknown, which is all the default knows. Asked once per
+     * signalled process, to measure how long detection took.
+     */
+    virtual qint64 startedAt(DWORD pid) const;
+
+    /**
+     * @brief The operating system's process list
+     */
+    static ProcessSource* system();
+};
+
+/**
+ * @brief ProcessSource backed by ProcessUtils
+ */
+class SystemProcessSource : public ProcessSource
+{
+public:
+    void update(QHash<DWORD, QString>& processes) override;
+    QHash<DWORD, DWORD> parentPids(const QList<DWORD>& pids) const override;
+    qint64 startedAt(DWORD pid) const override;
+};
+
+#endif // PROCESSSOURCE_H
\ No newline at end of file
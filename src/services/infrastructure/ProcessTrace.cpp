@@ -0,0 +1,396 @@
+#include "ProcessTrace.h"
+#include "TimeSource.h"
+#include "EventLogger.h"
+
+#include <QtEndian>
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+void appendVarint(QByteArray& out, quint64 value)
+{
+    while (value >= 0x80) {
+        out.append(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    out.append(static_cast<char>(value));
+}
+
+// Names and counts larger than this mean the record is damaged
+constexpr quint64 MAX_NAME_BYTES = 4096;
+constexpr quint64 MAX_RECORD_ENTRIES = 1 << 20;
+
+}
+
+// ProcessTraceWriter
+
+ProcessTraceWriter::~ProcessTraceWriter()
+{
+    close();
+}
+
+bool ProcessTraceWriter::open(const QString& path, qint64 startSecsSinceEpoch)
+{
+    close();
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        MF_LOG_WARNING(Process, "Failed to create process trace: %1", path);
+        return false;
+    }
+
+    char header[HEADER_SIZE] = {};
+    std::memcpy(header, MAGIC, sizeof(MAGIC));
+    qToLittleEndian<quint16>(VERSION, header + 4);
+    qToLittleEndian<qint64>(startSecsSinceEpoch, header + 8);
+    m_file.write(header, HEADER_SIZE);
+    m_file.flush();
+
+    m_names.clear();
+    m_previousTime = 0;
+    return true;
+}
+
+void ProcessTraceWriter::close()
+{
+    if (m_file.isOpen()) {
+        m_file.close();
+    }
+}
+
+bool ProcessTraceWriter::isOpen() const
+{
+    return m_file.isOpen();
+}
+
+bool ProcessTraceWriter::write(const ProcessTraceRecord& record)
+{
+    if (!m_file.isOpen()) {
+        return false;
+    }
+
+    m_buffer.clear();
+    appendVarint(m_buffer, static_cast<quint64>(qMax<qint64>(0, record.time - m_previousTime)));
+    m_previousTime = qMax(m_previousTime, record.time);
+
+    appendVarint(m_buffer, static_cast<quint64>(record.exited.size()));
+    DWORD previous = 0;
+    for (DWORD pid : record.exited) {
+        appendVarint(m_buffer, pid - previous);
+        previous = pid;
+    }
+
+    appendVarint(m_buffer, static_cast<quint64>(record.started.size()));
+    previous = 0;
+    for (const ProcessTraceRecord::Start& start : record.started) {
+        appendVarint(m_buffer, start.pid - previous);
+        appendVarint(m_buffer, start.parentPid);
+        previous = start.pid;
+
+        auto name = m_names.constFind(start.name);
+        if (name != m_names.constEnd()) {
+            appendVarint(m_buffer, name.value());
+        } else {
+            const quint32 index = static_cast<quint32>(m_names.size());
+            const QByteArray utf8 = start.name.toUtf8();
+            appendVarint(m_buffer, index);
+            appendVarint(m_buffer, static_cast<quint64>(utf8.size()));
+            m_buffer.append(utf8);
+            m_names.insert(start.name, index);
+        }
+    }
+
+    if (m_file.write(m_buffer) != m_buffer.size() || !m_file.flush()) {
+        MF_LOG_WARNING(Process, "Failed to write process trace: %1", m_file.fileName());
+        close();
+        return false;
+    }
+    return true;
+}
+
+qint64 ProcessTraceWriter::bytesWritten() const
+{
+    return m_file.isOpen() ? m_file.pos() : 0;
+}
+
+// ProcessTraceReader
+
+bool ProcessTraceReader::open(const QString& path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        m_data.clear();
+        m_pos = 0;
+        return fail("cannot open " + path);
+    }
+    return load(file.readAll());
+}
+
+bool ProcessTraceReader::load(const QByteArray& data)
+{
+    m_data = data;
+    m_pos = ProcessTraceWriter::HEADER_SIZE;
+    m_names.clear();
+    m_time = 0;
+    m_damaged = false;
+    m_error.clear();
+
+    if (m_data.size() < ProcessTraceWriter::HEADER_SIZE
+        || std::memcmp(m_data.constData(), ProcessTraceWriter::MAGIC, sizeof(ProcessTraceWriter::MAGIC)) != 0) {
+        m_pos = static_cast<int>(m_data.size());
+        return fail("not a process trace");
+    }
+    if (qFromLittleEndian<quint16>(m_data.constData() + 4) != ProcessTraceWriter::VERSION) {
+        m_pos = static_cast<int>(m_data.size());
+        return fail("unsupported process trace version");
+    }
+    m_startSecs = qFromLittleEndian<qint64>(m_data.constData() + 8);
+    return true;
+}
+
+bool ProcessTraceReader::next(ProcessTraceRecord& record)
+{
+    record.exited.clear();
+    record.started.clear();
+    if (m_pos >= m_data.size()) {
+        return false;
+    }
+
+    quint64 delta = 0;
+    quint64 count = 0;
+    if (!readVarint(delta) || !readVarint(count) || count > MAX_RECORD_ENTRIES) {
+        return fail("damaged record");
+    }
+    m_time += static_cast<qint64>(delta);
+    record.time = m_time;
+
+    quint64 pid = 0;
+    for (quint64 i = 0; i < count; ++i) {
+        quint64 pidDelta = 0;
+        if (!readVarint(pidDelta)) {
+            return fail("damaged record");
+        }
+        pid += pidDelta;
+        record.exited.append(static_cast<DWORD>(pid));
+    }
+
+    if (!readVarint(count) || count > MAX_RECORD_ENTRIES) {
+        return fail("damaged record");
+    }
+    pid = 0;
+    for (quint64 i = 0; i < count; ++i) {
+        quint64 pidDelta = 0;
+        quint64 parent = 0;
+        quint64 index = 0;
+        if (!readVarint(pidDelta) || !readVarint(parent) || !readVarint(index)
+            || index > static_cast<quint64>(m_names.size())) {
+            return fail("damaged record");
+        }
+        if (index == static_cast<quint64>(m_names.size())) {
+            quint64 length = 0;
+            if (!readVarint(length) || length > MAX_NAME_BYTES
+                || length > static_cast<quint64>(m_data.size() - m_pos)) {
+                return fail("damaged record");
+            }
+            m_names.append(QString::fromUtf8(m_data.constData() + m_pos, static_cast<int>(length)));
+            m_pos += static_cast<int>(length);
+        }
+        pid += pidDelta;
+        record.started.append(ProcessTraceRecord::Start{
+            static_cast<DWORD>(pid), static_cast<DWORD>(parent), m_names[static_cast<int>(index)]});
+    }
+    return true;
+}
+
+bool ProcessTraceReader::isDamaged() const
+{
+    return m_damaged;
+}
+
+qint64 ProcessTraceReader::startSecsSinceEpoch() const
+{
+    return m_startSecs;
+}
+
+QString ProcessTraceReader::errorString() const
+{
+    return m_error;
+}
+
+bool ProcessTraceReader::readVarint(quint64& value)
+{
+    value = 0;
+    for (int shift = 0; shift < 64 && m_pos < m_data.size(); shift += 7) {
+        const uchar byte = static_cast<uchar>(m_data[m_pos++]);
+        value |= static_cast<quint64>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ProcessTraceReader::fail(const QString& error)
+{
+    // Nothing after a damaged record can be trusted
+    m_damaged = true;
+    m_error = error;
+    m_pos = static_cast<int>(m_data.size());
+    return false;
+}
+
+// RecordingProcessSource
+
+RecordingProcessSource::RecordingProcessSource(ProcessSource* source, TimeSource* time)
+    : m_source(source ? source : ProcessSource::system()),
+      m_time(time ? time : TimeSource::system()),
+      m_origin(0)
+{
+}
+
+bool RecordingProcessSource::open(const QString& path)
+{
+    m_origin = m_time->elapsed();
+    m_previous.clear();
+    return m_writer.open(path, m_time->currentSecsSinceEpoch());
+}
+
+void RecordingProcessSource::update(QHash<DWORD, QString>& processes)
+{
+    m_source->update(processes);
+    if (!m_writer.isOpen()) {
+        return;
+    }
+
+    m_record.exited.clear();
+    m_record.started.clear();
+    for (auto it = m_previous.begin(); it != m_previous.end();) {
+        if (!processes.contains(it.key())) {
+            m_record.exited.append(it.key());
+            it = m_previous.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    QList<DWORD> started;
+    for (auto it = processes.constBegin(); it != processes.constEnd(); ++it) {
+        if (!m_previous.contains(it.key())) {
+            started.append(it.key());
+            m_previous.insert(it.key(), it.value());
+        }
+    }
+
+    if (m_record.exited.isEmpty() && started.isEmpty()) {
+        return;
+    }
+
+    std::sort(m_record.exited.begin(), m_record.exited.end());
+    std::sort(started.begin(), started.end());
+    const QHash<DWORD, DWORD> parents = m_source->parentPids(started);
+    for (DWORD pid : started) {
+        m_record.started.append(ProcessTraceRecord::Start{pid, parents.value(pid, 0), processes.value(pid)});
+    }
+    m_record.time = m_time->elapsed() - m_origin;
+    m_writer.write(m_record);
+}
+
+QHash<DWORD, DWORD> RecordingProcessSource::parentPids(const QList<DWORD>& pids) const
+{
+    return m_source->parentPids(pids);
+}
+
+qint64 RecordingProcessSource::startedAt(DWORD pid) const
+{
+    return m_source->startedAt(pid);
+}
+
+const ProcessTraceWriter& RecordingProcessSource::writer() const
+{
+    return m_writer;
+}
+
+// ReplayProcessSource
+
+ReplayProcessSource::ReplayProcessSource(const ProcessTraceReader& trace, TimeSource* time)
+    : m_trace(trace),
+      m_time(time ? time : TimeSource::system()),
+      m_origin(m_time->elapsed())
+{
+    m_hasNext = m_trace.next(m_next);
+}
+
+void ReplayProcessSource::update(QHash<DWORD, QString>& processes)
+{
+    applyDue();
+
+    auto it = processes.begin();
+    while (it != processes.end()) {
+        if (!m_running.contains(it.key())) {
+            it = processes.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    for (auto running = m_running.constBegin(); running != m_running.constEnd(); ++running) {
+        if (!processes.contains(running.key())) {
+            processes.insert(running.key(), running.value());
+        }
+    }
+}
+
+QHash<DWORD, DWORD> ReplayProcessSource::parentPids(const QList<DWORD>& pids) const
+{
+    QHash<DWORD, DWORD> parents;
+    for (DWORD pid : pids) {
+        auto parent = m_parents.constFind(pid);
+        if (parent != m_parents.constEnd()) {
+            parents.insert(pid, parent.value());
+        }
+    }
+    return parents;
+}
+
+qint64 ReplayProcessSource::nextDue() const
+{
+    return m_hasNext ? m_origin + m_next.time : -1;
+}
+
+bool ReplayProcessSource::finished() const
+{
+    return !m_hasNext;
+}
+
+bool ReplayProcessSource::isDamaged() const
+{
+    return m_trace.isDamaged();
+}
+
+int ReplayProcessSource::recordsApplied() const
+{
+    return m_applied;
+}
+
+int ReplayProcessSource::runningCount() const
+{
+    return m_running.size();
+}
+
+void ReplayProcessSource::applyDue()
+{
+    const qint64 now = m_time->elapsed();
+    while (m_hasNext && m_origin + m_next.time <= now) {
+        for (DWORD pid : m_next.exited) {
+            m_running.remove(pid);
+            m_parents.remove(pid);
+        }
+        for (const ProcessTraceRecord::Start& start : m_next.started) {
+            m_running.insert(start.pid, start.name);
+            if (start.parentPid) {
+                m_parents.insert(start.pid, start.parentPid);
+            }
+        }
+        ++m_applied;
+        m_hasNext = m_trace.next(m_next);
+    }
+}
@@ -0,0 +1,207 @@
+#ifndef PROCESSTRACE_H
+#define PROCESSTRACE_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include "ProcessSource.h"
+
+// Forward declarations
+class TimeSource;
+
+/**
+ * @brief What changed in the process list between two polls
+ */
+struct ProcessTraceRecord
+{
+    struct Start {
+        DWORD pid;
+        DWORD parentPid;    // 0 if unknown
+        QString name;
+    };
+
+    qint64 time = 0;        // Milliseconds since recording started
+    QList<DWORD> exited;
+    QList<Start> started;
+};
+
+/**
+ * @brief Writes a process trace: the process list as a sequence of diffs
+ *
+ * A trace is a 16-byte header ("MFPT", version, reserved, wall-clock start
+ * in seconds since epoch) followed by one record per poll that changed
+ * anything:
+ *
+ *   varint  time delta from the previous record (ms)
+ *   varint  exit count,  then each exited pid as a varint delta from the
+ *           previous one (modulo 2^32, so sorted pids take the least room)
+ *   varint  start count, then per start: pid delta, parent pid and name
+ *           index as varints
+ *
+ * Names are interned: an index equal to the number of names seen so far
+ * introduces a new one, followed by its UTF-8 length and bytes. A steady
+ * poll writes nothing and a typical start takes five or six bytes, so a day
+ * of ordinary desktop use stays in the tens of kilobytes.
+ *
+ * Every record is flushed as it is written; a trace cut short by a crash
+ * reads up to its last complete record.
+ */
+class ProcessTraceWriter
+{
+public:
+    static constexpr char MAGIC[4] = {'M', 'F', 'P', 'T'};
+    static constexpr quint16 VERSION = 1;
+    static constexpr int HEADER_SIZE = 16;
+
+    ProcessTraceWriter() = default;
+    ~ProcessTraceWriter();
+
+    ProcessTraceWriter(const ProcessTraceWriter&) = delete;
+    ProcessTraceWriter& operator=(const ProcessTraceWriter&) = delete;
+
+    /**
+     * @brief Create (or truncate) path and write the header
+     */
+    bool open(const QString& path, qint64 startSecsSinceEpoch);
+    void close();
+    bool isOpen() const;
+
+    /**
+     * @brief Append a record; times must not go backwards
+     */
+    bool write(const ProcessTraceRecord& record);
+
+    qint64 bytesWritten() const;
+
+private:
+    QFile m_file;
+    QHash<QString, quint32> m_names;
+    QByteArray m_buffer;
+    qint64 m_previousTime = 0;
+};
+
+/**
+ * @brief Reads a trace written by ProcessTraceWriter, one record at a time
+ */
+class ProcessTraceReader
+{
+public:
+    /**
+     * @brief Read the whole trace into memory and check its header
+     */
+    bool open(const QString& path);
+    bool load(const QByteArray& data);
+
+    /**
+     * @return false at the end of the trace or at a damaged record
+     */
+    bool next(ProcessTraceRecord& record);
+
+    /**
+     * @brief Whether reading stopped at a damaged or truncated record
+     */
+    bool isDamaged() const;
+
+    qint64 startSecsSinceEpoch() const;
+    QString errorString() const;
+
+private:
+    bool readVarint(quint64& value);
+    bool fail(const QString& error);
+
+    QByteArray m_data;
+    int m_pos = 0;
+    QStringList m_names;
+    qint64 m_time = 0;
+    qint64 m_startSecs = 0;
+    bool m_damaged = false;
+    QString m_error;
+};
+
+/**
+ * @brief ProcessSource that records what another source reports
+ *
+ * Passes every update() through and writes the difference from the
+ * previous one to a trace, asking the wrapped source for the parents of
+ * the new processes. The first update records every process already
+ * running, so a replay starts from the same list. Use from the monitor
+ * thread only.
+ */
+class RecordingProcessSource : public ProcessSource
+{
+public:
+    /**
+     * @param source Source to record (not owned)
+     * @param time Clock for the record times (not owned); TimeSource::system() if null
+     */
+    RecordingProcessSource(ProcessSource* source, TimeSource* time = nullptr);
+
+    /**
+     * @brief Start writing to path; false (and nothing recorded) if it cannot be created
+     */
+    bool open(const QString& path);
+
+    void update(QHash<DWORD, QString>& processes) override;
+    QHash<DWORD, DWORD> parentPids(const QList<DWORD>& pids) const override;
+    qint64 startedAt(DWORD pid) const override;
+
+    const ProcessTraceWriter& writer() const;
+
+private:
+    ProcessSource* m_source;
+    TimeSource* m_time;
+    ProcessTraceWriter m_writer;
+    qint64 m_origin;
+    QHash<DWORD, QString> m_previous;
+    ProcessTraceRecord m_record;    // Reused so steady polls allocate nothing
+};
+
+/**
+ * @brief ProcessSource that plays a recorded trace back
+ *
+ * Record times are mapped onto the given clock, starting at its time when
+ * the source is created: each update() applies every record due by then
+ * and reports the resulting list. With a virtual clock the replay runs as
+ * fast as the clock is advanced (see tests/mocks/TraceReplayDriver.h).
+ * Processes keep the names and parents they were recorded with, so the
+ * pipeline sees exactly the churn seen in production.
+ */
+class ReplayProcessSource : public ProcessSource
+{
+public:
+    ReplayProcessSource(const ProcessTraceReader& trace, TimeSource* time = nullptr);
+
+    void update(QHash<DWORD, QString>& processes) override;
+    QHash<DWORD, DWORD> parentPids(const QList<DWORD>& pids) const override;
+
+    /**
+     * @brief Clock time at which the next record is due, -1 once all are applied
+     */
+    qint64 nextDue() const;
+    bool finished() const;
+
+    /**
+     * @brief Whether the replay stopped early at a damaged record
+     */
+    bool isDamaged() const;
+
+    int recordsApplied() const;
+    int runningCount() const;
+
+private:
+    void applyDue();
+
+    ProcessTraceReader m_trace;
+    TimeSource* m_time;
+    qint64 m_origin;
+    ProcessTraceRecord m_next;
+    bool m_hasNext;
+    int m_applied = 0;
+    QHash<DWORD, QString> m_running;
+    QHash<DWORD, DWORD> m_parents;
+};
+
+#endif // PROCESSTRACE_H
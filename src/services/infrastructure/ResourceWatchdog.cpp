@@ -0,0 +1,162 @@
+#include "ResourceWatchdog.h"
+#include "DeadlineScheduler.h"
+#include "EventLogger.h"
+#include "services/metrics/Metrics.h"
+
+namespace {
+
+QString megabytes(qint64 bytes)
+{
+    return QString::number(static_cast<double>(bytes) / (1024.0 * 1024.0), 'f', 1) + " MB";
+}
+
+QString percent(double value)
+{
+    return QString::number(value, 'f', 2) + "%";
+}
+
+}
+
+ResourceWatchdog::ResourceWatchdog(const Budget& budget, TimeSource* time, Sampler sampler, QObject* parent)
+    : QObject(parent),
+      m_budget(budget),
+      m_sampler(sampler ? std::move(sampler) : Sampler(&ProcessUtils::selfResourceUsage)),
+      m_scheduler(new DeadlineScheduler(time, this)),
+      m_sampleHandle(0),
+      m_lastSampleTime(-1),
+      m_lastCpuNs(-1),
+      m_cpuPercent(-1.0),
+      m_rssBytes(-1),
+      m_overCount(0),
+      m_underCount(0),
+      m_throttled(false)
+{
+}
+
+ResourceWatchdog::~ResourceWatchdog()
+{
+    stop();
+}
+
+void ResourceWatchdog::start()
+{
+    if (m_sampleHandle) {
+        return;
+    }
+    sample();
+    scheduleNextSample();
+}
+
+void ResourceWatchdog::stop()
+{
+    if (m_sampleHandle) {
+        m_scheduler->cancel(m_sampleHandle);
+        m_sampleHandle = 0;
+    }
+}
+
+bool ResourceWatchdog::isThrottled() const
+{
+    return m_throttled;
+}
+
+const ResourceWatchdog::Budget& ResourceWatchdog::budget() const
+{
+    return m_budget;
+}
+
+double ResourceWatchdog::cpuPercent() const
+{
+    return m_cpuPercent;
+}
+
+qint64 ResourceWatchdog::rssBytes() const
+{
+    return m_rssBytes;
+}
+
+void ResourceWatchdog::scheduleNextSample()
+{
+    m_sampleHandle = m_scheduler->scheduleIn(SAMPLE_INTERVAL_MS, [this]() {
+        scheduleNextSample();
+        sample();
+    });
+}
+
+void ResourceWatchdog::sample()
+{
+    static Gauge& cpuGauge = MetricsRegistry::gauge(
+        "mindfulness_self_cpu_permille", "Our own CPU use over the last watchdog sample, per mille of one core");
+    static Gauge& rssGauge = MetricsRegistry::gauge(
+        "mindfulness_self_rss_bytes", "Our own resident set at the last watchdog sample");
+
+    const ProcessUtils::ResourceUsage usage = m_sampler();
+    const qint64 now = m_scheduler->now();
+    if (usage.cpuNs >= 0 && m_lastCpuNs >= 0 && now > m_lastSampleTime) {
+        m_cpuPercent = 100.0 * static_cast<double>(usage.cpuNs - m_lastCpuNs)
+                     / (static_cast<double>(now - m_lastSampleTime) * 1e6);
+        cpuGauge.set(static_cast<qint64>(m_cpuPercent * 10.0));
+    }
+    m_lastCpuNs = usage.cpuNs;
+    m_lastSampleTime = now;
+    m_rssBytes = usage.rssBytes;
+    if (m_rssBytes >= 0) {
+        rssGauge.set(m_rssBytes);
+    }
+
+    // Unknown figures and disabled budgets count as within budget
+    const bool cpuKnown = m_cpuPercent >= 0 && m_budget.cpuPercent > 0;
+    const bool rssKnown = m_rssBytes >= 0 && m_budget.rssBytes > 0;
+    const bool cpuOver = cpuKnown && m_cpuPercent > m_budget.cpuPercent;
+    const bool rssOver = rssKnown && m_rssBytes > m_budget.rssBytes;
+    const bool wellUnder = (!cpuKnown || m_cpuPercent <= m_budget.cpuPercent * RECOVER_FRACTION)
+                        && (!rssKnown || m_rssBytes <= m_budget.rssBytes * RECOVER_FRACTION);
+
+    if (!m_throttled) {
+        m_overCount = cpuOver || rssOver ? m_overCount + 1 : 0;
+        if (m_overCount >= THROTTLE_AFTER) {
+            QString over;
+            if (cpuOver) {
+                over = "CPU " + percent(m_cpuPercent) + " > " + percent(m_budget.cpuPercent);
+            }
+            if (rssOver) {
+                over += (over.isEmpty() ? "" : ", ") + QString("RSS ") + megabytes(m_rssBytes)
+                      + " > " + megabytes(m_budget.rssBytes);
+            }
+            setThrottled(true, over);
+        }
+    } else {
+        m_underCount = wellUnder ? m_underCount + 1 : 0;
+        if (m_underCount >= RECOVER_AFTER) {
+            setThrottled(false, "CPU " + percent(qMax(0.0, m_cpuPercent))
+                                + ", RSS " + megabytes(qMax<qint64>(0, m_rssBytes)));
+        }
+    }
+}
+
+void ResourceWatchdog::setThrottled(bool throttled, const QString& reason)
+{
+    static Gauge& throttledGauge = MetricsRegistry::gauge(
+        "mindfulness_watchdog_throttled", "1 while the resource watchdog has the monitor throttled");
+    static Counter& throttleCount = MetricsRegistry::counter(
+        "mindfulness_watchdog_throttles_total", "Times our own usage went over budget and throttled us");
+    static Counter& recoveryCount = MetricsRegistry::counter(
+        "mindfulness_watchdog_recoveries_total", "Times the throttle was lifted after usage dropped");
+
+    m_throttled = throttled;
+    m_overCount = 0;
+    m_underCount = 0;
+    throttledGauge.set(throttled ? 1 : 0);
+
+    // Logged while receivers leave the log at its usual levels: before
+    // throttling raises the floor, after recovery lowers it again
+    if (throttled) {
+        throttleCount.add();
+        MF_LOG_WARNING(General, "Over resource budget (%1), throttling", reason);
+        emit throttleChanged(true, reason);
+    } else {
+        recoveryCount.add();
+        emit throttleChanged(false, reason);
+        MF_LOG_INFO(General, "Back within resource budget (%1), no longer throttled", reason);
+    }
+}
@@ -0,0 +1,87 @@
+#ifndef RESOURCEWATCHDOG_H
+#define RESOURCEWATCHDOG_H
+
+#include <QObject>
+#include <QString>
+#include <functional>
+#include "services/utils/ProcessUtils.h" // For ResourceUsage
+
+class DeadlineScheduler;
+class TimeSource;
+
+/**
+ * @class ResourceWatchdog
+ * @brief Keeps an eye on our own CPU time and memory, and says when to back off
+ *
+ * Every SAMPLE_INTERVAL_MS it samples this process's CPU time and resident
+ * set. THROTTLE_AFTER samples in a row over either budget throttle; the
+ * throttle is lifted after RECOVER_AFTER samples in a row within
+ * RECOVER_FRACTION of both, so a throttled monitor that has just got
+ * cheaper does not bounce straight back. Each transition is logged, counted
+ * in the metrics and signalled through throttleChanged(); acting on it is
+ * up to the receivers (AppController throttles the monitor and raises the
+ * log floor).
+ */
+class ResourceWatchdog : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Budget {
+        double cpuPercent = 2.0;                // Of one core; 0 or less: no CPU budget
+        qint64 rssBytes = 200ll * 1024 * 1024;  // 0 or less: no memory budget
+    };
+
+    using Sampler = std::function<ProcessUtils::ResourceUsage()>;
+
+    static constexpr int SAMPLE_INTERVAL_MS = 5000;
+    static constexpr int THROTTLE_AFTER = 2;
+    static constexpr int RECOVER_AFTER = 3;
+    static constexpr double RECOVER_FRACTION = 0.75;
+
+    /**
+     * @param budget Limits to stay within
+     * @param time Clock that paces the sampling (not owned); TimeSource::system() if null
+     * @param sampler Usage source; ProcessUtils::selfResourceUsage() if empty
+     */
+    explicit ResourceWatchdog(const Budget& budget, TimeSource* time = nullptr,
+                              Sampler sampler = Sampler(), QObject* parent = nullptr);
+    ~ResourceWatchdog();
+
+    void start();
+    void stop();
+
+    bool isThrottled() const;
+    const Budget& budget() const;
+
+    /**
+     * @brief CPU use between the last two samples, percent of one core; -1 before that
+     */
+    double cpuPercent() const;
+    qint64 rssBytes() const;
+
+signals:
+    /**
+     * @param reason What was over budget, or the usage that let it recover
+     */
+    void throttleChanged(bool throttled, const QString& reason);
+
+private:
+    void scheduleNextSample();
+    void sample();
+    void setThrottled(bool throttled, const QString& reason);
+
+    Budget m_budget;
+    Sampler m_sampler;
+    DeadlineScheduler* m_scheduler;
+    quint64 m_sampleHandle;         // Pending sample, 0 when stopped
+    qint64 m_lastSampleTime;        // ms, -1 before the first sample
+    qint64 m_lastCpuNs;
+    double m_cpuPercent;
+    qint64 m_rssBytes;
+    int m_overCount;
+    int m_underCount;
+    bool m_throttled;
+};
+
+#endif // RESOURCEWATCHDOG_H
@@ -0,0 +1,68 @@
+#include "TimeSource.h"
+
+#include <QDateTime>
+#include <atomic>
+
+namespace {
+
+std::atomic<TimeSource*> g_current{nullptr};
+
+}
+
+// TimeSource
+
+TimeSource::~TimeSource() = default;
+
+bool TimeSource::isVirtual() const
+{
+    return false;
+}
+
+void TimeSource::attach(DeadlineScheduler* scheduler)
+{
+    Q_UNUSED(scheduler);
+}
+
+void TimeSource::detach(DeadlineScheduler* scheduler)
+{
+    Q_UNUSED(scheduler);
+}
+
+TimeSource* TimeSource::system()
+{
+    static SystemTimeSource source;
+    return &source;
+}
+
+TimeSource* TimeSource::current()
+{
+    TimeSource* source = g_current.load(std::memory_order_acquire);
+    return source ? source : system();
+}
+
+void TimeSource::setCurrent(TimeSource* source)
+{
+    g_current.store(source, std::memory_order_release);
+}
+
+// SystemTimeSource
+
+SystemTimeSource::SystemTimeSource(MonotonicClock::SuspendPolicy policy)
+    : m_clock(policy)
+{
+}
+
+qint64 SystemTimeSource::elapsed() const
+{
+    return m_clock.elapsed();
+}
+
+qint64 SystemTimeSource::currentSecsSinceEpoch() const
+{
+    return QDateTime::currentSecsSinceEpoch();
+}
+
+MonotonicClock::SuspendPolicy SystemTimeSource::suspendPolicy() const
+{
+    return m_clock.policy();
+}
\ No newline at end of file
@@ -0,0 +1,89 @@
+#ifndef TIMESOURCE_H
+#define TIMESOURCE_H
+
+#include <QtGlobal>
+#include "MonotonicClock.h"
+
+// Forward declarations
+class DeadlineScheduler;
+
+/**
+ * @brief Where the application gets the time from
+ *
+ * Everything that reads a clock goes through a TimeSource: DeadlineScheduler
+ * (and with it GameSession and the process monitor's polling) for monotonic
+ * time, Application and ApplicationRepository for wall-clock timestamps.
+ * The real implementation is SystemTimeSource; tests substitute a virtual
+ * clock (tests/mocks/MockTimeSource.h) that is advanced by hand, so hours of
+ * sessions, warnings and limits run in milliseconds.
+ *
+ * Schedulers attach() themselves to their source. A real source leaves
+ * waking them to their own QTimer; a virtual one (isVirtual()) drives them
+ * by calling DeadlineScheduler::advanceTo() as its time moves on.
+ *
+ * Objects that are handed a source use that one. Application entities are
+ * too small and too many to carry a pointer, so they and the repository
+ * indexing them read the process-wide current() source.
+ */
+class TimeSource
+{
+public:
+    virtual ~TimeSource();
+
+    /**
+     * @brief Monotonic milliseconds from an arbitrary origin
+     */
+    virtual qint64 elapsed() const = 0;
+
+    /**
+     * @brief Wall-clock time, seconds since epoch
+     */
+    virtual qint64 currentSecsSinceEpoch() const = 0;
+
+    /**
+     * @brief Whether time only moves when the owner advances it
+     */
+    virtual bool isVirtual() const;
+
+    virtual void attach(DeadlineScheduler* scheduler);
+    virtual void detach(DeadlineScheduler* scheduler);
+
+    /**
+     * @brief The real clock, pausing while the machine is suspended
+     */
+    static TimeSource* system();
+
+    /**
+     * @brief The source read by Application and ApplicationRepository
+     *
+     * system() unless a test has installed another one with setCurrent().
+     */
+    static TimeSource* current();
+
+    /**
+     * @brief Install a process-wide source; nullptr restores system()
+     *
+     * The source must outlive every use. Not meant to be changed while
+     * other threads are creating or updating applications.
+     */
+    static void setCurrent(TimeSource* source);
+};
+
+/**
+ * @brief TimeSource backed by MonotonicClock and the system wall clock
+ */
+class SystemTimeSource : public TimeSource
+{
+public:
+    explicit SystemTimeSource(MonotonicClock::SuspendPolicy policy = MonotonicClock::SuspendPolicy::ExcludeSuspend);
+
+    qint64 elapsed() const override;
+    qint64 currentSecsSinceEpoch() const override;
+
+    MonotonicClock::SuspendPolicy suspendPolicy() const;
+
+private:
+    MonotonicClock m_clock;
+};
+
+#endif // TIMESOURCE_H
\ No newline at end of file
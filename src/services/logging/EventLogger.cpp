@@ -1,59 +1,327 @@
 #include "EventLogger.h"
-#include <QFile>
-#include <QTextStream>
+#include "LogRing.h"
+#include "LogSegments.h"
+#include "StructuredLog.h"
+#include "services/metrics/Metrics.h"
 #include <QDateTime>
 #include <QDebug>
+#include <QLoggingCategory>
 
-// We need a persistent file handle
-// A static variable in the .cpp file is a simple way to achieve this
-static QFile g_logFile;
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <thread>
 
-void EventLogger::messageHandler(QtMsgType type, const QMessageLogContext &context, const QString &msg)
+namespace {
+
+// Records the writer formats per batch at most, so a flood still gets
+// written (and waiters woken) in bounded steps
+constexpr int BATCH_SIZE = 256;
+
+// Taken by the next install()
+std::atomic<qint64> g_segmentSize{EventLogger::SEGMENT_SIZE};
+std::atomic<qint64> g_diskBudget{EventLogger::DISK_BUDGET};
+
+class LogBackend
 {
-    // 1. Format the log message
-    QString timestamp = QDateTime::currentDateTime().toString("yyyy-MM-dd hh:mm:ss.zzz");
-    QString level;
-    switch (type) {
-        case QtDebugMsg:    level = "DEBUG"; break;
-        case QtInfoMsg:     level = "INFO"; break;
-        case QtWarningMsg:  level = "WARN"; break;
-        case QtCriticalMsg: level = "CRITICAL"; break;
-        case QtFatalMsg:    level = "FATAL"; break;
+public:
+    ~LogBackend()
+    {
+        stop();
+    }
+
+    void start(const QString& filePath, bool console, const QString& binaryPath)
+    {
+        stop();
+        // The previous run's log is rotated out, not erased
+        if (!m_log.open(filePath, g_segmentSize.load(), g_diskBudget.load())) {
+            fprintf(stderr, "Failed to open log file: %s\n", qPrintable(m_log.errorString()));
+        }
+        if (!binaryPath.isEmpty() && !m_binary.open(binaryPath, QDateTime::currentMSecsSinceEpoch())) {
+            fprintf(stderr, "Failed to open binary log file: %s\n", qPrintable(binaryPath));
+        }
+        m_console = console;
+        m_running.store(true, std::memory_order_release);
+        m_thread = std::thread([this]() { run(); });
+    }
+
+    void stop()
+    {
+        if (!m_thread.joinable()) {
+            return;
+        }
+        m_running.store(false, std::memory_order_release);
+        m_wake.notify_one();
+        m_thread.join();
+        m_log.close();
+        m_binary.close();
+    }
+
+    bool isRunning() const
+    {
+        return m_running.load(std::memory_order_acquire);
+    }
+
+    void push(LogRecord&& record)
+    {
+        const bool urgent = record.type != QtDebugMsg && record.type != QtInfoMsg;
+        if (!m_ring.tryPush(std::move(record))) {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        // Quiet messages wait for the writer's next round; warnings and a
+        // filling ring wake it now. notify_one takes no lock.
+        if (urgent || m_ring.pushed() - m_written.load(std::memory_order_relaxed) > RING_HALF) {
+            m_wake.notify_one();
+        }
+    }
+
+    void flush()
+    {
+        const quint64 target = m_ring.pushed();
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_wake.notify_one();
+        m_flushed.wait(lock, [this, target]() {
+            return m_written.load(std::memory_order_acquire) >= target || !isRunning();
+        });
+    }
+
+    quint64 dropped() const
+    {
+        return m_dropped.load(std::memory_order_relaxed);
     }
 
-    // [LEVEL] [Timestamp] [File:Line] Message
-    QString formattedMsg = QString("[%1] [%2] [%3:%4] %5\n")
-                               .arg(level)
-                               .arg(timestamp)
-                               .arg(context.file ? context.file : "N/A")
-                               .arg(context.line)
-                               .arg(msg);
+private:
+    static constexpr quint64 RING_HALF = EventLogger::RING_CAPACITY / 2;
 
-    // 2. Write to the console (standard output)
-    fprintf(stdout, "%s", formattedMsg.toLocal8Bit().constData());
-    fflush(stdout);
+    void run()
+    {
+        LogRecord record;
+        QString batch;
+        quint64 reportedDrops = m_dropped.load(std::memory_order_relaxed);
 
-    // 3. Write to the log file
-    if (g_logFile.isOpen()) {
-        QTextStream out(&g_logFile);
-        out << formattedMsg;
+        for (;;) {
+            // Read before draining, so nothing pushed before a stop is missed
+            const bool running = m_running.load(std::memory_order_acquire);
+
+            int count = 0;
+            batch.clear();
+            bool binary = false;
+            while (count < BATCH_SIZE && m_ring.tryPop(record)) {
+                // Structured events are only rendered if there is no binary log
+                if (record.format && m_binary.isOpen()) {
+                    m_binary.append(record);
+                    binary = true;
+                } else {
+                    format(record, batch);
+                }
+                for (QString& text : record.texts) {
+                    text.clear();
+                }
+                ++count;
+            }
+
+            const quint64 drops = m_dropped.load(std::memory_order_relaxed);
+            if (drops != reportedDrops) {
+                LogRecord note;
+                note.type = QtWarningMsg;
+                note.time = QDateTime::currentMSecsSinceEpoch();
+                note.texts[0] = QString("EventLogger: %1 messages dropped, ring full").arg(drops - reportedDrops);
+                format(note, batch);
+                m_droppedTotal.add(drops - reportedDrops);
+                if (m_binary.isOpen()) {
+                    m_binary.appendDropped(drops - reportedDrops);
+                    binary = true;
+                }
+                reportedDrops = drops;
+            }
+
+            if (!batch.isEmpty() || binary) {
+                ScopedLatency timing(m_writeTime);
+                if (!batch.isEmpty()) {
+                    write(batch);
+                }
+                if (binary) {
+                    m_binary.flush();
+                }
+            }
+            if (count > 0) {
+                m_messagesTotal.add(static_cast<quint64>(count));
+                m_written.fetch_add(static_cast<quint64>(count), std::memory_order_release);
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_flushed.notify_all();
+                continue;
+            }
+            if (!running) {
+                break;
+            }
+
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_flushed.notify_all();
+            m_wake.wait_for(lock, std::chrono::milliseconds(EventLogger::FLUSH_INTERVAL_MS));
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_flushed.notify_all();
+    }
+
+    void format(const LogRecord& record, QString& out)
+    {
+        const char* level = "DEBUG";
+        switch (record.type) {
+            case QtDebugMsg:    level = "DEBUG"; break;
+            case QtInfoMsg:     level = "INFO"; break;
+            case QtWarningMsg:  level = "WARN"; break;
+            case QtCriticalMsg: level = "CRITICAL"; break;
+            case QtFatalMsg:    level = "FATAL"; break;
+        }
+
+        // Rendering a date is the expensive part; it only changes once a second
+        const qint64 second = record.time / 1000;
+        if (second != m_cachedSecond) {
+            m_cachedSecond = second;
+            m_cachedTimestamp = QDateTime::fromMSecsSinceEpoch(second * 1000).toString("yyyy-MM-dd hh:mm:ss.");
+        }
+
+        // [LEVEL] [Timestamp] [File:Line] Message
+        out += QLatin1Char('[');
+        out += QLatin1String(level);
+        out += QLatin1String("] [");
+        out += m_cachedTimestamp;
+        out += QString::number(record.time % 1000).rightJustified(3, QLatin1Char('0'));
+        out += QLatin1String("] [");
+        out += QLatin1String(record.file ? record.file : "N/A");
+        out += QLatin1Char(':');
+        out += QString::number(record.line);
+        out += QLatin1String("] ");
+        out += record.message();
+        out += QLatin1Char('\n');
+    }
+
+    void write(const QString& batch)
+    {
+        if (m_console) {
+            const QByteArray local = batch.toLocal8Bit();
+            fwrite(local.constData(), 1, static_cast<size_t>(local.size()), stdout);
+            fflush(stdout);
+        }
+        if (m_log.isOpen()) {
+            m_log.write(batch.toUtf8());
+            m_log.flush();
+        }
     }
+
+    LogRing<LogRecord, EventLogger::RING_CAPACITY> m_ring;
+    std::atomic<quint64> m_written{0};
+    std::atomic<quint64> m_dropped{0};
+    std::atomic<bool> m_running{false};
+
+    // Only for sleeping: the writer between rounds, flush() until written
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_flushed;
+    std::thread m_thread;
+
+    // Registered here so the registry outlives this singleton
+    Counter& m_messagesTotal = MetricsRegistry::counter(
+        "mindfulness_log_messages_total", "Messages taken off the log ring by the writer");
+    Counter& m_droppedTotal = MetricsRegistry::counter(
+        "mindfulness_log_dropped_total", "Messages dropped because the log ring was full");
+    LatencyHistogram& m_writeTime = MetricsRegistry::histogram(
+        "mindfulness_log_write_seconds", "Time to write and flush one batch");
+
+    // Writer thread only
+    LogSegments m_log;
+    StructuredLogWriter m_binary;
+    bool m_console = true;
+    qint64 m_cachedSecond = -1;
+    QString m_cachedTimestamp;
+};
+
+LogBackend& backend()
+{
+    static LogBackend instance;
+    return instance;
+}
+
+QtMessageHandler g_previousHandler = nullptr;
+
+}
+
+void EventLogger::messageHandler(QtMsgType type, const QMessageLogContext &context, const QString &msg)
+{
+    LogRecord record;
+    record.type = type;
+    record.line = context.line;
+    record.file = context.file;
+    record.texts[0] = msg;
+    submit(std::move(record));
 }
 
-void EventLogger::install()
+bool EventLogger::isEnabled(QtMsgType type)
 {
-    // 1. Set the log file path
-    g_logFile.setFileName("mindfulness.log");
-    
-    // 2. Open the file
-    // We use WriteOnly | Append so we don't erase the log on every start
-    if (!g_logFile.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text)) {
-        qWarning() << "Failed to open log file:" << g_logFile.errorString();
+    return QLoggingCategory::defaultCategory()->isEnabled(type);
+}
+
+void EventLogger::submit(LogRecord&& record)
+{
+    LogBackend& logger = backend();
+    if (!logger.isRunning()) {
+        // Not installed (tests, tools): let Qt's handler print it
+        QMessageLogContext context(record.file, record.line, nullptr, "default");
+        qt_message_output(record.type, context, record.message());
+        return;
+    }
+
+    const bool fatal = record.type == QtFatalMsg;
+    record.time = QDateTime::currentMSecsSinceEpoch();
+    logger.push(std::move(record));
+
+    // Qt aborts as soon as we return
+    if (fatal) {
+        logger.flush();
     }
+}
+
+void EventLogger::install(const QString& filePath, bool console, const QString& binaryPath)
+{
+    // 1. Start the writer thread, which opens the log files
+    backend().start(filePath, console, binaryPath);
 
-    // 3. Install our custom handler
+    // 2. Install our custom handler
     // qInstallMessageHandler is the Qt function that does all the work
-    qInstallMessageHandler(EventLogger::messageHandler);
+    QtMessageHandler previous = qInstallMessageHandler(EventLogger::messageHandler);
+    if (previous != EventLogger::messageHandler) {
+        g_previousHandler = previous;
+    }
 
     qInfo() << "--- EventLogger installed. Application starting. ---";
-}
\ No newline at end of file
+}
+
+void EventLogger::setSegmentLimits(qint64 segmentSize, qint64 diskBudget)
+{
+    g_segmentSize.store(segmentSize);
+    g_diskBudget.store(diskBudget);
+}
+
+void EventLogger::shutdown()
+{
+    if (!backend().isRunning()) {
+        return;
+    }
+    // Messages logged from here on go to the previous handler
+    qInstallMessageHandler(g_previousHandler);
+    g_previousHandler = nullptr;
+    backend().stop();
+}
+
+void EventLogger::flush()
+{
+    backend().flush();
+}
+
+quint64 EventLogger::droppedCount()
+{
+    return backend().dropped();
+}
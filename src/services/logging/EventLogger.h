@@ -1,7 +1,11 @@
 #ifndef EVENTLOGGER_H
 #define EVENTLOGGER_H
 
+#include <QString>
 #include <QtGlobal>
+#include "LogCategory.h"
+#include "LogSegments.h"
+#include "StructuredLog.h"
 
 /**
  * @class EventLogger
@@ -9,19 +13,161 @@
  *
  * This class redirects all Qt logging output (qDebug, qWarning, etc.)
  * to both the console and a persistent log file ("mindfulness.log").
+ * The file is kept as LogSegments: fixed-size preallocated segments,
+ * rotated and compressed in the background, within a total disk budget,
+ * so a long-running process never grows its log without bound.
+ *
+ * The handler itself does as little as possible on the calling thread: it
+ * takes a timestamp and pushes the message (a reference to Qt's already
+ * built QString) into a lock-free LogRing. A dedicated writer thread
+ * drains the ring, formats the lines and writes them in batches, with one
+ * console flush and one file flush per batch. Callers never block on I/O
+ * or on each other; when the ring is full the message is dropped and
+ * counted, and the writer reports the number of drops in the log.
+ *
+ * Fatal messages are written out before the handler returns, so they are
+ * never lost to the abort that follows.
+ *
+ * Hot paths can skip Qt's message formatting altogether with MF_LOG_EVENT:
+ * the call site's format string stays a literal, the arguments are copied
+ * raw into the ring and nothing is rendered on the calling thread. The
+ * writer renders such events into the text log, or, if a binary log was
+ * opened, appends them to it in the StructuredLogWriter format for the
+ * logdecode tool to render later. Without an installed logger they are
+ * rendered on the spot and handed to Qt's message handler.
+ *
+ * Application code logs through the category macros (MF_LOG_DEBUG and
+ * friends), which filter on a compile-time minimum level (MF_LOG_MIN_LEVEL)
+ * and LogFilter's runtime per-category flags instead of Qt's categories.
  */
 class EventLogger
 {
 public:
+    static constexpr const char* DEFAULT_FILE = "mindfulness.log";
+    static constexpr const char* DEFAULT_BINARY_FILE = "mindfulness.blog";
+    static constexpr int RING_CAPACITY = 8192;
+    static constexpr int FLUSH_INTERVAL_MS = 50;    // Longest a quiet message waits
+    static constexpr qint64 SEGMENT_SIZE = LogSegments::DEFAULT_SEGMENT_SIZE;
+    static constexpr qint64 DISK_BUDGET = LogSegments::DEFAULT_DISK_BUDGET;
+
     /**
-     * @brief Installs the custom message handler.
+     * @brief Installs the custom message handler and starts the writer thread.
      * This should be called *once* at the very beginning of main().
+     * @param filePath Active log segment; the previous run's file and
+     * older segments are rotated out beside it
+     * @param console Whether lines are also written to standard output
+     * @param binaryPath Binary log for structured events, truncated; if
+     * empty they are rendered into the text log
      */
-    static void install();
+    static void install(const QString& filePath = DEFAULT_FILE, bool console = true,
+                        const QString& binaryPath = QString());
+
+    /**
+     * @brief Segment size and disk budget (bytes) for the next install()
+     */
+    static void setSegmentLimits(qint64 segmentSize = SEGMENT_SIZE, qint64 diskBudget = DISK_BUDGET);
+
+    /**
+     * @brief Writes everything still queued, stops the writer thread and
+     * restores the previous message handler. Call at the end of main().
+     */
+    static void shutdown();
+
+    /**
+     * @brief Blocks until every message logged before the call is written
+     */
+    static void flush();
+
+    /**
+     * @brief Messages dropped because the ring was full
+     */
+    static quint64 droppedCount();
+
+    /**
+     * @brief Queue a structured event; use the MF_LOG_* macros rather than calling this
+     */
+    template<typename... Args>
+    static void log(const LogFormat& site, const char* format, const Args&... args)
+    {
+        static_assert(sizeof...(Args) <= LogRecord::MAX_ARGS, "Too many structured log arguments");
+        static_assert((0 + ... + int(StructuredLog::isText<Args>())) <= LogRecord::MAX_TEXT_ARGS,
+                      "Too many text arguments in a structured log event");
+
+        LogRecord record;
+        record.type = site.level;
+        record.line = site.line;
+        record.file = site.file;
+        record.format = &site;
+        record.formatText = format;
+        site.id();
+        (StructuredLog::capture(record, args), ...);
+        submit(std::move(record));
+    }
+
+    /**
+     * @brief Filter rules of Qt's default logging category, as for qDebug()
+     */
+    static bool isEnabled(QtMsgType type);
 
 private:
+    static void submit(LogRecord&& record);
+
     // This is the function that will actually handle all log messages
     static void messageHandler(QtMsgType type, const QMessageLogContext &context, const QString &msg);
 };
 
-#endif // LOGGER_H
\ No newline at end of file
+/**
+ * @brief Log a structured event: MF_LOG_EVENT(QtDebugMsg, "Process started: %1 PID: %2", name, pid)
+ *
+ * The format is a string literal with %1..%9 placeholders; arguments are
+ * integers, enums, floating point values, bools or strings (at most
+ * LogRecord::MAX_ARGS, of which LogRecord::MAX_TEXT_ARGS strings).
+ */
+#define MF_LOG_EVENT(level, ...) \
+    do { \
+        if (EventLogger::isEnabled(level)) { \
+            static const LogFormat mfLogSite_(level, __FILE__, __LINE__); \
+            EventLogger::log(mfLogSite_, __VA_ARGS__); \
+        } \
+    } while (0)
+
+#define MF_LOG_AT_(category, rank, level, ...) \
+    do { \
+        if (LogFilter::isEnabled(LogCategory::category, rank)) { \
+            static const LogFormat mfLogSite_(level, __FILE__, __LINE__); \
+            EventLogger::log(mfLogSite_, __VA_ARGS__); \
+        } \
+    } while (0)
+
+/**
+ * @brief Structured events in a LogCategory: MF_LOG_DEBUG(Dispatch, "Game detected: %1", name)
+ *
+ * Same format and arguments as MF_LOG_EVENT. Below MF_LOG_MIN_LEVEL a call
+ * expands to nothing and its arguments are never evaluated; above it, a
+ * call disabled in LogFilter costs one relaxed atomic load.
+ */
+#if MF_LOG_MIN_LEVEL <= MF_LOG_LEVEL_DEBUG
+#define MF_LOG_DEBUG(category, ...) MF_LOG_AT_(category, MF_LOG_LEVEL_DEBUG, QtDebugMsg, __VA_ARGS__)
+#else
+#define MF_LOG_DEBUG(category, ...) do {} while (0)
+#endif
+
+#if MF_LOG_MIN_LEVEL <= MF_LOG_LEVEL_INFO
+#define MF_LOG_INFO(category, ...) MF_LOG_AT_(category, MF_LOG_LEVEL_INFO, QtInfoMsg, __VA_ARGS__)
+#else
+#define MF_LOG_INFO(category, ...) do {} while (0)
+#endif
+
+#if MF_LOG_MIN_LEVEL <= MF_LOG_LEVEL_WARNING
+#define MF_LOG_WARNING(category, ...) MF_LOG_AT_(category, MF_LOG_LEVEL_WARNING, QtWarningMsg, __VA_ARGS__)
+#else
+#define MF_LOG_WARNING(category, ...) do {} while (0)
+#endif
+
+#if MF_LOG_MIN_LEVEL <= MF_LOG_LEVEL_CRITICAL
+#define MF_LOG_CRITICAL(category, ...) MF_LOG_AT_(category, MF_LOG_LEVEL_CRITICAL, QtCriticalMsg, __VA_ARGS__)
+#else
+#define MF_LOG_CRITICAL(category, ...) do {} while (0)
+#endif
+
+#endif // LOGGER_H
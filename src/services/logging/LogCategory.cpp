@@ -0,0 +1,95 @@
+#include "LogCategory.h"
+
+#include <QMutex>
+#include <QMutexLocker>
+#include <QStringList>
+
+namespace {
+
+const char* const CATEGORY_NAMES[LogFilter::CATEGORY_COUNT] = {
+    "general", "process", "dispatch", "repository", "history", "ui"
+};
+
+int parseLevel(const QString& text)
+{
+    if (text == "debug")    return MF_LOG_LEVEL_DEBUG;
+    if (text == "info")     return MF_LOG_LEVEL_INFO;
+    if (text == "warning")  return MF_LOG_LEVEL_WARNING;
+    if (text == "critical") return MF_LOG_LEVEL_CRITICAL;
+    if (text == "off")      return LogFilter::LEVEL_OFF;
+    return -1;
+}
+
+// Serialises writers, so the configured levels and the floor are always
+// combined from their latest values; readers never take it
+QMutex& filterMutex()
+{
+    static QMutex mutex;
+    return mutex;
+}
+
+}
+
+void LogFilter::setMinimumLevel(LogCategory category, int level)
+{
+    QMutexLocker locker(&filterMutex());
+    const int index = static_cast<int>(category);
+    s_configured[index] = maskFrom(qBound(0, level, LEVEL_OFF));
+    s_levels[index].store(s_configured[index] & maskFrom(s_floor.load(std::memory_order_relaxed)),
+                          std::memory_order_relaxed);
+}
+
+void LogFilter::setFloor(int level)
+{
+    QMutexLocker locker(&filterMutex());
+    const int clamped = qBound(0, level, LEVEL_OFF);
+    s_floor.store(clamped, std::memory_order_relaxed);
+    for (int i = 0; i < CATEGORY_COUNT; ++i) {
+        s_levels[i].store(s_configured[i] & maskFrom(clamped), std::memory_order_relaxed);
+    }
+}
+
+int LogFilter::floor()
+{
+    return s_floor.load(std::memory_order_relaxed);
+}
+
+bool LogFilter::configure(const QString& rules)
+{
+    bool ok = true;
+    const QStringList parts = QString(rules).replace(';', ',').split(',', Qt::SkipEmptyParts);
+    for (const QString& part : parts) {
+        const QStringList rule = part.trimmed().toLower().split('=');
+        const int level = rule.size() == 2 ? parseLevel(rule[1].trimmed()) : -1;
+        if (level < 0) {
+            ok = false;
+            continue;
+        }
+
+        const QString category = rule[0].trimmed();
+        bool matched = false;
+        for (int i = 0; i < CATEGORY_COUNT; ++i) {
+            if (category == "*" || category == CATEGORY_NAMES[i]) {
+                setMinimumLevel(static_cast<LogCategory>(i), level);
+                matched = true;
+            }
+        }
+        ok = ok && matched;
+    }
+    return ok;
+}
+
+void LogFilter::reset()
+{
+    QMutexLocker locker(&filterMutex());
+    s_floor.store(MF_LOG_LEVEL_DEBUG, std::memory_order_relaxed);
+    for (int i = 0; i < CATEGORY_COUNT; ++i) {
+        s_configured[i] = ALL_LEVELS;
+        s_levels[i].store(ALL_LEVELS, std::memory_order_relaxed);
+    }
+}
+
+const char* LogFilter::name(LogCategory category)
+{
+    return CATEGORY_NAMES[static_cast<int>(category)];
+}
@@ -0,0 +1,111 @@
+#ifndef LOGCATEGORY_H
+#define LOGCATEGORY_H
+
+#include <QString>
+#include <QtGlobal>
+#include <atomic>
+
+// Severity ranks for filtering; QtMsgType's values are not in severity order
+#define MF_LOG_LEVEL_DEBUG    0
+#define MF_LOG_LEVEL_INFO     1
+#define MF_LOG_LEVEL_WARNING  2
+#define MF_LOG_LEVEL_CRITICAL 3
+
+// Category log calls below this level compile to nothing, arguments and
+// all. Release builds drop debug messages unless the build says otherwise
+// (CMake: -DMINDFULNESS_LOG_MIN_LEVEL=WARNING, for example).
+#ifndef MF_LOG_MIN_LEVEL
+#if defined(QT_NO_DEBUG)
+#define MF_LOG_MIN_LEVEL MF_LOG_LEVEL_INFO
+#else
+#define MF_LOG_MIN_LEVEL MF_LOG_LEVEL_DEBUG
+#endif
+#endif
+
+/**
+ * @brief The part of the application a log message comes from
+ */
+enum class LogCategory : quint8 {
+    General,
+    Process,        // Process monitoring, traces
+    Dispatch,       // ProcessEventDispatcher, categorization
+    Repository,     // Application repository, import, rollups
+    History,        // Session history store
+    Ui
+};
+
+/**
+ * @class LogFilter
+ * @brief Runtime enable flags per log category and level.
+ *
+ * Each category has one atomic word with a bit per level, so the check in
+ * front of every MF_LOG_* call is a single relaxed load and a bit test.
+ * Flags may be changed from any thread at any time; a call racing with a
+ * change may go either way. Critical messages can be turned off like the
+ * others; fatal ones always get through.
+ */
+class LogFilter
+{
+public:
+    static constexpr int CATEGORY_COUNT = 6;
+    static constexpr int LEVEL_OFF = MF_LOG_LEVEL_CRITICAL + 1;
+
+    static bool isEnabled(LogCategory category, int level)
+    {
+        return (s_levels[static_cast<int>(category)].load(std::memory_order_relaxed) >> level) & 1u;
+    }
+
+    /**
+     * @brief Enable level and everything more severe in category;
+     * LEVEL_OFF disables it entirely
+     */
+    static void setMinimumLevel(LogCategory category, int level);
+
+    /**
+     * @brief Apply rules such as "repository=warning,process=off,*=info"
+     *
+     * Rules are separated by commas or semicolons and applied in order;
+     * "*" stands for every category. Levels are debug, info, warning,
+     * critical and off.
+     * @return false if a rule was not understood; the others still apply
+     */
+    static bool configure(const QString& rules);
+
+    /**
+     * @brief Also drop everything below level, whatever the categories allow
+     *
+     * Sheds log volume for a while (the resource watchdog does, while
+     * throttled) without losing the configured levels: they apply again,
+     * including changes made meanwhile, once the floor is back at
+     * MF_LOG_LEVEL_DEBUG.
+     */
+    static void setFloor(int level);
+    static int floor();
+
+    /**
+     * @brief Everything enabled again and no floor, as at startup
+     */
+    static void reset();
+
+    static const char* name(LogCategory category);
+
+private:
+    static constexpr quint32 ALL_LEVELS = (1u << LEVEL_OFF) - 1;
+
+    static quint32 maskFrom(int level)
+    {
+        return ALL_LEVELS & ~((1u << level) - 1);
+    }
+
+    // What the checks read: the configured levels with the floor applied
+    static inline std::atomic<quint32> s_levels[CATEGORY_COUNT] = {
+        ALL_LEVELS, ALL_LEVELS, ALL_LEVELS, ALL_LEVELS, ALL_LEVELS, ALL_LEVELS
+    };
+    // Written under the filter's mutex
+    static inline quint32 s_configured[CATEGORY_COUNT] = {
+        ALL_LEVELS, ALL_LEVELS, ALL_LEVELS, ALL_LEVELS, ALL_LEVELS, ALL_LEVELS
+    };
+    static inline std::atomic<int> s_floor{MF_LOG_LEVEL_DEBUG};
+};
+
+#endif // LOGCATEGORY_H
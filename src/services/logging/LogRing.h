@@ -0,0 +1,101 @@
+#ifndef LOGRING_H
+#define LOGRING_H
+
+#include <QtGlobal>
+#include <atomic>
+#include <memory>
+#include <utility>
+
+/**
+ * @brief Bounded multi-producer, single-consumer queue for log records
+ *
+ * A fixed ring of CAPACITY slots, each with a sequence number (after
+ * Vyukov's bounded queue). A producer claims the next position with one
+ * CAS on the head and publishes its record by storing the slot's sequence;
+ * the consumer takes records in position order without touching the head.
+ * Neither side ever blocks: a producer that finds the ring full gets false
+ * back and the caller decides what to do (the logger counts a drop).
+ *
+ * The head and the consumer position sit on separate cache lines, so
+ * producers on different threads only contend on the one CAS.
+ *
+ * Thread Safety: tryPush() from any number of threads; tryPop() from one
+ * consumer thread only.
+ */
+template<typename T, int CAPACITY>
+class LogRing
+{
+    static_assert(CAPACITY > 1 && (CAPACITY & (CAPACITY - 1)) == 0, "CAPACITY must be a power of two");
+
+public:
+    LogRing()
+        : m_slots(new Slot[CAPACITY])
+    {
+        for (int i = 0; i < CAPACITY; ++i) {
+            m_slots[i].sequence.store(static_cast<quint64>(i), std::memory_order_relaxed);
+        }
+    }
+
+    LogRing(const LogRing&) = delete;
+    LogRing& operator=(const LogRing&) = delete;
+
+    static constexpr int capacity() { return CAPACITY; }
+
+    /**
+     * @return false, leaving value untouched, if the ring is full
+     */
+    bool tryPush(T&& value)
+    {
+        quint64 position = m_head.load(std::memory_order_relaxed);
+        for (;;) {
+            Slot& slot = m_slots[position & MASK];
+            const quint64 sequence = slot.sequence.load(std::memory_order_acquire);
+            const qint64 lag = static_cast<qint64>(sequence - position);
+            if (lag == 0) {
+                if (m_head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    slot.value = std::move(value);
+                    slot.sequence.store(position + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (lag < 0) {
+                return false;       // The consumer has not freed this slot yet
+            } else {
+                position = m_head.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /**
+     * @return false if the next record has not been published yet
+     */
+    bool tryPop(T& value)
+    {
+        Slot& slot = m_slots[m_tail & MASK];
+        if (slot.sequence.load(std::memory_order_acquire) != m_tail + 1) {
+            return false;
+        }
+        value = std::move(slot.value);
+        slot.sequence.store(m_tail + CAPACITY, std::memory_order_release);
+        ++m_tail;
+        return true;
+    }
+
+    /**
+     * @brief Records pushed so far (approximate while producers are active)
+     */
+    quint64 pushed() const { return m_head.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr quint64 MASK = CAPACITY - 1;
+
+    struct Slot {
+        std::atomic<quint64> sequence;
+        T value;
+    };
+
+    std::unique_ptr<Slot[]> m_slots;
+    alignas(64) std::atomic<quint64> m_head{0};
+    alignas(64) quint64 m_tail = 0;
+};
+
+#endif // LOGRING_H
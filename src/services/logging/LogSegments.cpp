@@ -0,0 +1,259 @@
+#include "LogSegments.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QRegularExpression>
+#include <QSaveFile>
+#include <QThreadPool>
+#include <algorithm>
+#include <cstdio>
+
+namespace {
+
+struct Segment {
+    quint64 sequence;
+    QString path;
+};
+
+QString segmentName(const QString& path, quint64 sequence)
+{
+    const QFileInfo info(path);
+    QString name = info.completeBaseName() + '.' + QString("%1").arg(sequence, 6, 10, QChar('0'));
+    if (!info.suffix().isEmpty()) {
+        name += '.' + info.suffix();
+    }
+    return info.dir().filePath(name);
+}
+
+// Closed segments, compressed or not, oldest first
+std::vector<Segment> listSegments(const QString& path)
+{
+    const QFileInfo info(path);
+    QString pattern = '^' + QRegularExpression::escape(info.completeBaseName()) + "\\.(\\d+)";
+    if (!info.suffix().isEmpty()) {
+        pattern += "\\." + QRegularExpression::escape(info.suffix());
+    }
+    pattern += "(" + QRegularExpression::escape(LogSegments::COMPRESSED_SUFFIX) + ")?$";
+    const QRegularExpression expression(pattern);
+
+    std::vector<Segment> segments;
+    const QDir dir = info.dir();
+    for (const QString& name : dir.entryList(QDir::Files)) {
+        const QRegularExpressionMatch match = expression.match(name);
+        if (match.hasMatch()) {
+            segments.push_back({match.captured(1).toULongLong(), dir.filePath(name)});
+        }
+    }
+    std::sort(segments.begin(), segments.end(), [](const Segment& a, const Segment& b) {
+        return a.sequence != b.sequence ? a.sequence < b.sequence : a.path < b.path;
+    });
+    return segments;
+}
+
+// A segment left by a crash still has its preallocated zeros
+QByteArray trimmed(QByteArray data)
+{
+    int end = data.size();
+    while (end > 0 && data[end - 1] == '\0') {
+        --end;
+    }
+    data.truncate(end);
+    return data;
+}
+
+}
+
+LogSegments::LogSegments()
+    : m_pool(new QThreadPool)
+{
+    m_pool->setMaxThreadCount(1);
+}
+
+LogSegments::~LogSegments()
+{
+    close();
+}
+
+bool LogSegments::open(const QString& path, qint64 segmentSize, qint64 diskBudget)
+{
+    close();
+    m_path = path;
+    m_segmentSize = std::max<qint64>(segmentSize, 1);
+    m_diskBudget = diskBudget;
+    m_rotations = 0;
+
+    const std::vector<Segment> existing = listSegments(path);
+    m_nextSequence = existing.empty() ? 1 : existing.back().sequence + 1;
+
+    // Left uncompressed by an earlier run that stopped mid-way
+    for (const Segment& segment : existing) {
+        if (!segment.path.endsWith(COMPRESSED_SUFFIX)) {
+            scheduleCompression(segment.path);
+        }
+    }
+
+    // The previous run's log becomes the newest closed segment
+    if (QFileInfo(path).size() > 0) {
+        const QString closed = segmentName(path, m_nextSequence++);
+        if (QFile::rename(path, closed)) {
+            scheduleCompression(closed);
+        }
+    }
+
+    // The budget may be smaller than last time
+    m_pool->start([path, segmentSize = m_segmentSize, diskBudget]() {
+        evict(path, segmentSize, diskBudget);
+    });
+    return openActive();
+}
+
+void LogSegments::close()
+{
+    if (m_file.isOpen()) {
+        trimActive();
+        m_file.close();
+    }
+    waitForCompression();
+}
+
+bool LogSegments::isOpen() const
+{
+    return m_file.isOpen();
+}
+
+QString LogSegments::errorString() const
+{
+    return m_file.errorString();
+}
+
+bool LogSegments::write(const QByteArray& data)
+{
+    if (!m_file.isOpen()) {
+        return false;
+    }
+    if (m_used > 0 && m_used + data.size() > m_segmentSize && !rotate()) {
+        return false;
+    }
+    const qint64 written = m_file.write(data);
+    if (written > 0) {
+        m_used += written;
+    }
+    return written == data.size();
+}
+
+void LogSegments::flush()
+{
+    if (m_file.isOpen()) {
+        m_file.flush();
+    }
+}
+
+int LogSegments::rotations() const
+{
+    return m_rotations;
+}
+
+void LogSegments::waitForCompression()
+{
+    m_pool->waitForDone();
+}
+
+QStringList LogSegments::segments(const QString& path)
+{
+    QStringList paths;
+    for (const Segment& segment : listSegments(path)) {
+        paths.append(segment.path);
+    }
+    return paths;
+}
+
+QByteArray LogSegments::readSegment(const QString& segmentPath)
+{
+    QFile file(segmentPath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QByteArray();
+    }
+    const QByteArray data = file.readAll();
+    if (segmentPath.endsWith(COMPRESSED_SUFFIX)) {
+        return qUncompress(data);
+    }
+    return trimmed(data);
+}
+
+bool LogSegments::openActive()
+{
+    m_file.setFileName(m_path);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return false;
+    }
+    // Claim the whole segment up front; appends then only fill it in
+    m_file.resize(m_segmentSize);
+    m_used = 0;
+    return true;
+}
+
+void LogSegments::trimActive()
+{
+    m_file.flush();
+    m_file.resize(m_used);
+}
+
+bool LogSegments::rotate()
+{
+    trimActive();
+    m_file.close();
+
+    const QString closed = segmentName(m_path, m_nextSequence++);
+    if (QFile::rename(m_path, closed)) {
+        ++m_rotations;
+        scheduleCompression(closed);
+    }
+    // If the rename failed the active segment is simply started over
+    return openActive();
+}
+
+void LogSegments::scheduleCompression(const QString& segmentPath)
+{
+    m_pool->start([segmentPath, path = m_path, segmentSize = m_segmentSize, diskBudget = m_diskBudget]() {
+        compress(segmentPath);
+        evict(path, segmentSize, diskBudget);
+    });
+}
+
+void LogSegments::compress(const QString& segmentPath)
+{
+    QFile in(segmentPath);
+    if (!in.open(QIODevice::ReadOnly)) {
+        return;
+    }
+    const QByteArray data = trimmed(in.readAll());
+    in.close();
+    if (data.isEmpty()) {
+        QFile::remove(segmentPath);
+        return;
+    }
+
+    // Not through the logger: this runs underneath it
+    QSaveFile out(segmentPath + COMPRESSED_SUFFIX);
+    if (!out.open(QIODevice::WriteOnly) || out.write(qCompress(data)) < 0 || !out.commit()) {
+        fprintf(stderr, "Failed to compress log segment: %s\n", qPrintable(segmentPath));
+        return;
+    }
+    QFile::remove(segmentPath);
+}
+
+void LogSegments::evict(const QString& path, qint64 segmentSize, qint64 diskBudget)
+{
+    const std::vector<Segment> segments = listSegments(path);
+    qint64 total = std::max(segmentSize, QFileInfo(path).size());
+    for (const Segment& segment : segments) {
+        total += QFileInfo(segment.path).size();
+    }
+    for (const Segment& segment : segments) {
+        if (total <= diskBudget) {
+            break;
+        }
+        total -= QFileInfo(segment.path).size();
+        QFile::remove(segment.path);
+    }
+}
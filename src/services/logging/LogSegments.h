@@ -0,0 +1,95 @@
+#ifndef LOGSEGMENTS_H
+#define LOGSEGMENTS_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+#include <QStringList>
+#include <QtGlobal>
+#include <memory>
+
+class QThreadPool;
+
+/**
+ * @brief A text log kept as fixed-size segments within a disk budget
+ *
+ * Lines are written to the active segment, path itself (mindfulness.log),
+ * which is preallocated to the segment size when opened so appends never
+ * grow the file. When the next write would not fit, the segment is
+ * trimmed to what was written, renamed to mindfulness.000042.log and a
+ * fresh one is started. A background thread then compresses the closed
+ * segment (qCompress, to mindfulness.000042.log.qz) and deletes the oldest
+ * closed segments until the active segment plus all closed ones fit in
+ * the disk budget.
+ *
+ * Whatever is in path when it is opened (the previous run's log) is
+ * closed as a segment first. A segment left by a crash still has its
+ * preallocated tail of zero bytes; compression drops it.
+ *
+ * Written from one thread (EventLogger's writer); closed segments are
+ * only touched by the compression thread.
+ */
+class LogSegments
+{
+public:
+    static constexpr qint64 DEFAULT_SEGMENT_SIZE = 4 * 1024 * 1024;
+    static constexpr qint64 DEFAULT_DISK_BUDGET = 64 * 1024 * 1024;
+    static constexpr const char* COMPRESSED_SUFFIX = ".qz";
+
+    LogSegments();
+    ~LogSegments();
+
+    bool open(const QString& path, qint64 segmentSize = DEFAULT_SEGMENT_SIZE,
+              qint64 diskBudget = DEFAULT_DISK_BUDGET);
+
+    /**
+     * @brief Trims the active segment and waits for pending compression
+     */
+    void close();
+    bool isOpen() const;
+    QString errorString() const;
+
+    /**
+     * @brief Append data, rotating first if it would not fit
+     */
+    bool write(const QByteArray& data);
+    void flush();
+
+    int rotations() const;
+
+    /**
+     * @brief Blocks until closed segments are compressed and evicted
+     */
+    void waitForCompression();
+
+    /**
+     * @brief Closed segments of the log at path, oldest first
+     */
+    static QStringList segments(const QString& path);
+
+    /**
+     * @brief The text of a closed segment, compressed or not
+     */
+    static QByteArray readSegment(const QString& segmentPath);
+
+private:
+    bool openActive();
+    void trimActive();
+    bool rotate();
+    void scheduleCompression(const QString& segmentPath);
+
+    // Compression thread
+    static void compress(const QString& segmentPath);
+    static void evict(const QString& path, qint64 segmentSize, qint64 diskBudget);
+
+    QString m_path;
+    QFile m_file;
+    qint64 m_segmentSize = DEFAULT_SEGMENT_SIZE;
+    qint64 m_diskBudget = DEFAULT_DISK_BUDGET;
+    qint64 m_used = 0;
+    quint64 m_nextSequence = 1;
+    int m_rotations = 0;
+    std::unique_ptr<QThreadPool> m_pool;
+};
+
+#endif // LOGSEGMENTS_H
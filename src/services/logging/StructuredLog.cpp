@@ -0,0 +1,452 @@
+#include "StructuredLog.h"
+
+#include <QDateTime>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QtEndian>
+#include <cstring>
+
+namespace {
+
+void appendVarint(QByteArray& out, quint64 value)
+{
+    while (value >= 0x80) {
+        out.append(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    out.append(static_cast<char>(value));
+}
+
+quint64 zigzag(qint64 value)
+{
+    return (static_cast<quint64>(value) << 1) ^ static_cast<quint64>(value >> 63);
+}
+
+qint64 unzigzag(quint64 value)
+{
+    return static_cast<qint64>(value >> 1) ^ -static_cast<qint64>(value & 1);
+}
+
+void appendText(QByteArray& out, const QByteArray& utf8)
+{
+    appendVarint(out, static_cast<quint64>(utf8.size()));
+    out.append(utf8);
+}
+
+const char* levelName(QtMsgType type)
+{
+    switch (type) {
+        case QtDebugMsg:    return "DEBUG";
+        case QtInfoMsg:     return "INFO";
+        case QtWarningMsg:  return "WARN";
+        case QtCriticalMsg: return "CRITICAL";
+        case QtFatalMsg:    return "FATAL";
+    }
+    return "DEBUG";
+}
+
+// Texts longer than this, or more args than a record holds, mean damage
+constexpr quint64 MAX_TEXT_BYTES = 1 << 20;
+constexpr quint64 MAX_DEFINITIONS = 1 << 20;
+
+constexpr char DROPPED_FORMAT[] = "EventLogger: %1 messages dropped, ring full";
+
+}
+
+// LogRecord
+
+QString LogRecord::message() const
+{
+    if (!format) {
+        return texts[0];
+    }
+    QStringList rendered;
+    for (int i = 0; i < argCount; ++i) {
+        const LogArg& arg = args[i];
+        switch (arg.type) {
+            case LogArg::Type::Int:    rendered.append(QString::number(arg.i)); break;
+            case LogArg::Type::UInt:   rendered.append(QString::number(arg.u)); break;
+            case LogArg::Type::Double: rendered.append(QString::number(arg.d)); break;
+            case LogArg::Type::Bool:   rendered.append(arg.u ? "true" : "false"); break;
+            case LogArg::Type::Text:   rendered.append(texts[arg.u]); break;
+        }
+    }
+    return StructuredLog::render(QString::fromUtf8(formatText), rendered);
+}
+
+// StructuredLog
+
+QString StructuredLog::render(const QString& format, const QStringList& args)
+{
+    QString out;
+    out.reserve(format.size() + 16 * args.size());
+    for (int i = 0; i < format.size(); ++i) {
+        const QChar c = format[i];
+        if (c == QChar('%') && i + 1 < format.size() && format[i + 1].isDigit()) {
+            const int index = format[i + 1].unicode() - '1';
+            if (index >= 0 && index < args.size()) {
+                out += args[index];
+                ++i;
+                continue;
+            }
+        }
+        out += c;
+    }
+    return out;
+}
+
+// StructuredLogWriter
+
+bool StructuredLogWriter::open(const QString& path, qint64 startMSecsSinceEpoch)
+{
+    close();
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return false;
+    }
+
+    char header[HEADER_SIZE] = {};
+    std::memcpy(header, MAGIC, sizeof(MAGIC));
+    qToLittleEndian<quint16>(VERSION, header + 4);
+    qToLittleEndian<qint64>(startMSecsSinceEpoch, header + 8);
+    m_file.write(header, HEADER_SIZE);
+
+    m_buffer.clear();
+    m_defined.clear();
+    m_previousTime = startMSecsSinceEpoch;
+    return true;
+}
+
+void StructuredLogWriter::close()
+{
+    if (m_file.isOpen()) {
+        flush();
+        m_file.close();
+    }
+}
+
+bool StructuredLogWriter::isOpen() const
+{
+    return m_file.isOpen();
+}
+
+void StructuredLogWriter::append(const LogRecord& record)
+{
+    const quint32 id = record.format->id();
+    if (id >= m_defined.size()) {
+        m_defined.resize(id + 1, false);
+    }
+    if (!m_defined[id]) {
+        m_buffer.append(static_cast<char>(DEFINITION));
+        appendVarint(m_buffer, id);
+        m_buffer.append(static_cast<char>(record.type));
+        appendVarint(m_buffer, static_cast<quint64>(qMax(0, record.line)));
+        appendText(m_buffer, QByteArray(record.file ? record.file : ""));
+        appendText(m_buffer, QByteArray(record.formatText));
+        m_buffer.append(static_cast<char>(record.argCount));
+        for (int i = 0; i < record.argCount; ++i) {
+            m_buffer.append(static_cast<char>(record.args[i].type));
+        }
+        m_defined[id] = true;
+    }
+
+    m_buffer.append(static_cast<char>(EVENT));
+    appendVarint(m_buffer, id);
+    appendVarint(m_buffer, zigzag(record.time - m_previousTime));
+    m_previousTime = record.time;
+
+    for (int i = 0; i < record.argCount; ++i) {
+        const LogArg& arg = record.args[i];
+        switch (arg.type) {
+            case LogArg::Type::Int:
+                appendVarint(m_buffer, zigzag(arg.i));
+                break;
+            case LogArg::Type::UInt:
+                appendVarint(m_buffer, arg.u);
+                break;
+            case LogArg::Type::Double: {
+                char bytes[8];
+                qToLittleEndian<double>(arg.d, bytes);
+                m_buffer.append(bytes, 8);
+                break;
+            }
+            case LogArg::Type::Bool:
+                m_buffer.append(static_cast<char>(arg.u ? 1 : 0));
+                break;
+            case LogArg::Type::Text:
+                appendText(m_buffer, record.texts[arg.u].toUtf8());
+                break;
+        }
+    }
+}
+
+void StructuredLogWriter::appendDropped(quint64 count)
+{
+    m_buffer.append(static_cast<char>(DROPPED));
+    appendVarint(m_buffer, count);
+}
+
+bool StructuredLogWriter::flush()
+{
+    if (!m_file.isOpen()) {
+        return false;
+    }
+    bool ok = true;
+    if (!m_buffer.isEmpty()) {
+        ok = m_file.write(m_buffer) == m_buffer.size();
+        m_buffer.clear();
+    }
+    return m_file.flush() && ok;
+}
+
+qint64 StructuredLogWriter::bytesWritten() const
+{
+    return m_file.isOpen() ? m_file.pos() : 0;
+}
+
+// StructuredLogReader
+
+QString StructuredLogReader::Value::toString() const
+{
+    switch (type) {
+        case LogArg::Type::Int:    return QString::number(i);
+        case LogArg::Type::UInt:   return QString::number(u);
+        case LogArg::Type::Double: return QString::number(d);
+        case LogArg::Type::Bool:   return u ? "true" : "false";
+        case LogArg::Type::Text:   return text;
+    }
+    return QString();
+}
+
+QJsonValue StructuredLogReader::Value::toJson() const
+{
+    switch (type) {
+        case LogArg::Type::Int:    return QJsonValue(i);
+        case LogArg::Type::UInt:   return QJsonValue(static_cast<qint64>(u));
+        case LogArg::Type::Double: return QJsonValue(d);
+        case LogArg::Type::Bool:   return QJsonValue(u != 0);
+        case LogArg::Type::Text:   return QJsonValue(text);
+    }
+    return QJsonValue();
+}
+
+QString StructuredLogReader::Event::message() const
+{
+    QStringList rendered;
+    for (const Value& value : args) {
+        rendered.append(value.toString());
+    }
+    return StructuredLog::render(format, rendered);
+}
+
+bool StructuredLogReader::open(const QString& path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        m_data.clear();
+        return fail("cannot open " + path);
+    }
+    return load(file.readAll());
+}
+
+bool StructuredLogReader::load(const QByteArray& data)
+{
+    m_data = data;
+    m_pos = StructuredLogWriter::HEADER_SIZE;
+    m_definitions.clear();
+    m_damaged = false;
+    m_error.clear();
+
+    if (m_data.size() < StructuredLogWriter::HEADER_SIZE
+        || std::memcmp(m_data.constData(), StructuredLogWriter::MAGIC, sizeof(StructuredLogWriter::MAGIC)) != 0) {
+        return fail("not a binary log");
+    }
+    if (qFromLittleEndian<quint16>(m_data.constData() + 4) != StructuredLogWriter::VERSION) {
+        return fail("unsupported binary log version");
+    }
+    m_time = qFromLittleEndian<qint64>(m_data.constData() + 8);
+    return true;
+}
+
+bool StructuredLogReader::next(Event& event)
+{
+    while (m_pos < m_data.size()) {
+        const quint8 tag = static_cast<quint8>(m_data[m_pos++]);
+
+        if (tag == StructuredLogWriter::DEFINITION) {
+            quint64 id = 0;
+            quint64 line = 0;
+            if (!readVarint(id) || id > MAX_DEFINITIONS || m_pos >= m_data.size()) {
+                return fail("damaged definition");
+            }
+            Definition definition;
+            definition.level = static_cast<QtMsgType>(static_cast<quint8>(m_data[m_pos++]));
+            if (!readVarint(line) || !readText(definition.file) || !readText(definition.format)
+                || m_pos >= m_data.size()) {
+                return fail("damaged definition");
+            }
+            definition.line = static_cast<int>(line);
+            const int count = static_cast<quint8>(m_data[m_pos++]);
+            if (count > LogRecord::MAX_ARGS || count > m_data.size() - m_pos) {
+                return fail("damaged definition");
+            }
+            for (int i = 0; i < count; ++i) {
+                const quint8 type = static_cast<quint8>(m_data[m_pos++]);
+                if (type > static_cast<quint8>(LogArg::Type::Text)) {
+                    return fail("damaged definition");
+                }
+                definition.types.append(static_cast<LogArg::Type>(type));
+            }
+            definition.defined = true;
+            if (id >= m_definitions.size()) {
+                m_definitions.resize(id + 1);
+            }
+            m_definitions[id] = definition;
+            continue;
+        }
+
+        if (tag == StructuredLogWriter::DROPPED) {
+            quint64 count = 0;
+            if (!readVarint(count)) {
+                return fail("damaged record");
+            }
+            event.time = m_time;
+            event.level = QtWarningMsg;
+            event.file.clear();
+            event.line = 0;
+            event.format = DROPPED_FORMAT;
+            event.args = {Value{LogArg::Type::UInt, 0, count, 0.0, QString()}};
+            return true;
+        }
+
+        if (tag != StructuredLogWriter::EVENT) {
+            return fail("unknown record");
+        }
+
+        quint64 id = 0;
+        quint64 delta = 0;
+        if (!readVarint(id) || id >= m_definitions.size() || !m_definitions[id].defined
+            || !readVarint(delta)) {
+            return fail("damaged event");
+        }
+        const Definition& definition = m_definitions[id];
+        m_time += unzigzag(delta);
+
+        event.time = m_time;
+        event.level = definition.level;
+        event.file = definition.file;
+        event.line = definition.line;
+        event.format = definition.format;
+        event.args.clear();
+        for (LogArg::Type type : definition.types) {
+            Value value{type, 0, 0, 0.0, QString()};
+            bool ok = true;
+            switch (type) {
+                case LogArg::Type::Int: {
+                    quint64 raw = 0;
+                    ok = readVarint(raw);
+                    value.i = unzigzag(raw);
+                    break;
+                }
+                case LogArg::Type::UInt:
+                    ok = readVarint(value.u);
+                    break;
+                case LogArg::Type::Double:
+                    ok = m_data.size() - m_pos >= 8;
+                    if (ok) {
+                        value.d = qFromLittleEndian<double>(m_data.constData() + m_pos);
+                        m_pos += 8;
+                    }
+                    break;
+                case LogArg::Type::Bool:
+                    ok = m_pos < m_data.size();
+                    if (ok) {
+                        value.u = m_data[m_pos++] ? 1 : 0;
+                    }
+                    break;
+                case LogArg::Type::Text:
+                    ok = readText(value.text);
+                    break;
+            }
+            if (!ok) {
+                return fail("damaged event");
+            }
+            event.args.append(value);
+        }
+        return true;
+    }
+    return false;
+}
+
+bool StructuredLogReader::isDamaged() const
+{
+    return m_damaged;
+}
+
+QString StructuredLogReader::errorString() const
+{
+    return m_error;
+}
+
+QString StructuredLogReader::toText(const Event& event)
+{
+    // [LEVEL] [Timestamp] [File:Line] Message
+    return QString("[%1] [%2] [%3:%4] %5")
+        .arg(levelName(event.level))
+        .arg(QDateTime::fromMSecsSinceEpoch(event.time).toString("yyyy-MM-dd hh:mm:ss.zzz"))
+        .arg(event.file.isEmpty() ? QString("N/A") : event.file)
+        .arg(event.line)
+        .arg(event.message());
+}
+
+QByteArray StructuredLogReader::toJson(const Event& event)
+{
+    QJsonArray args;
+    for (const Value& value : event.args) {
+        args.append(value.toJson());
+    }
+
+    QJsonObject object;
+    object["time"] = QDateTime::fromMSecsSinceEpoch(event.time).toString(Qt::ISODateWithMs);
+    object["level"] = levelName(event.level);
+    object["file"] = event.file;
+    object["line"] = event.line;
+    object["format"] = event.format;
+    object["args"] = args;
+    object["message"] = event.message();
+    return QJsonDocument(object).toJson(QJsonDocument::Compact);
+}
+
+bool StructuredLogReader::readVarint(quint64& value)
+{
+    value = 0;
+    for (int shift = 0; shift < 64 && m_pos < m_data.size(); shift += 7) {
+        const uchar byte = static_cast<uchar>(m_data[m_pos++]);
+        value |= static_cast<quint64>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool StructuredLogReader::readText(QString& text)
+{
+    quint64 length = 0;
+    if (!readVarint(length) || length > MAX_TEXT_BYTES || length > static_cast<quint64>(m_data.size() - m_pos)) {
+        return false;
+    }
+    text = QString::fromUtf8(m_data.constData() + m_pos, static_cast<int>(length));
+    m_pos += static_cast<int>(length);
+    return true;
+}
+
+bool StructuredLogReader::fail(const QString& error)
+{
+    // Nothing after a damaged record can be trusted
+    m_damaged = true;
+    m_error = error;
+    m_pos = static_cast<int>(m_data.size());
+    return false;
+}
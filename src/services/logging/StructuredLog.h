@@ -0,0 +1,263 @@
+#ifndef STRUCTUREDLOG_H
+#define STRUCTUREDLOG_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QJsonValue>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <QtGlobal>
+#include <atomic>
+#include <type_traits>
+#include <vector>
+
+/**
+ * @brief One structured log call site
+ *
+ * MF_LOG_EVENT keeps a static instance per call site. Its id is handed out
+ * on first use, so ids are only meaningful within one process run; a
+ * binary log defines each id (with its format string, file and line) the
+ * first time it is used in that file.
+ */
+class LogFormat
+{
+public:
+    constexpr LogFormat(QtMsgType level, const char* file, int line)
+        : level(level), file(file), line(line), m_id(0)
+    {
+    }
+
+    quint32 id() const
+    {
+        quint32 id = m_id.load(std::memory_order_acquire);
+        if (id == 0) {
+            const quint32 fresh = s_nextId.fetch_add(1, std::memory_order_relaxed) + 1;
+            if (m_id.compare_exchange_strong(id, fresh, std::memory_order_acq_rel)) {
+                id = fresh;
+            }
+        }
+        return id;
+    }
+
+    const QtMsgType level;
+    const char* const file;
+    const int line;
+
+private:
+    mutable std::atomic<quint32> m_id;
+    static inline std::atomic<quint32> s_nextId{0};
+};
+
+/**
+ * @brief A raw argument of a structured log event
+ */
+struct LogArg
+{
+    enum class Type : quint8 {
+        Int,
+        UInt,
+        Double,
+        Bool,
+        Text        // Index into LogRecord::texts
+    };
+
+    Type type;
+    union {
+        qint64 i;
+        quint64 u;
+        double d;
+    };
+};
+
+/**
+ * @brief A queued log message: Qt's text, or a structured event's raw arguments
+ */
+struct LogRecord
+{
+    static constexpr int MAX_ARGS = 4;
+    static constexpr int MAX_TEXT_ARGS = 2;
+
+    QtMsgType type = QtDebugMsg;
+    int line = 0;
+    qint64 time = 0;                    // ms since epoch
+    const char* file = nullptr;         // __FILE__ literal, lives forever
+    const LogFormat* format = nullptr;  // Set for structured events
+    const char* formatText = nullptr;   // Their format string literal
+    quint8 argCount = 0;
+    quint8 textCount = 0;
+    LogArg args[MAX_ARGS];
+    QString texts[MAX_TEXT_ARGS];       // texts[0] is a plain message's text
+
+    /**
+     * @brief The message text, rendering a structured event's format
+     */
+    QString message() const;
+};
+
+namespace StructuredLog
+{
+    /**
+     * @brief Replace %1..%9 in format with args, like chained QString::arg()
+     */
+    QString render(const QString& format, const QStringList& args);
+
+    // Argument capture for EventLogger::log(); copies the value, or takes a
+    // reference to a QString's shared data, without any formatting
+    template<typename T>
+    void capture(LogRecord& record, const T& value)
+    {
+        LogArg& arg = record.args[record.argCount++];
+        if constexpr (std::is_same_v<T, bool>) {
+            arg.type = LogArg::Type::Bool;
+            arg.u = value ? 1 : 0;
+        } else if constexpr (std::is_floating_point_v<T>) {
+            arg.type = LogArg::Type::Double;
+            arg.d = static_cast<double>(value);
+        } else if constexpr (std::is_enum_v<T>) {
+            arg.type = LogArg::Type::Int;
+            arg.i = static_cast<qint64>(value);
+        } else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+            arg.type = LogArg::Type::Int;
+            arg.i = static_cast<qint64>(value);
+        } else if constexpr (std::is_integral_v<T>) {
+            arg.type = LogArg::Type::UInt;
+            arg.u = static_cast<quint64>(value);
+        } else {
+            static_assert(std::is_convertible_v<T, QString>, "Unsupported structured log argument");
+            arg.type = LogArg::Type::Text;
+            arg.u = record.textCount;
+            record.texts[record.textCount++] = value;
+        }
+    }
+
+    template<typename T>
+    constexpr bool isText()
+    {
+        return !std::is_arithmetic_v<T> && !std::is_enum_v<T>;
+    }
+}
+
+/**
+ * @brief Writes structured events to a compact binary log
+ *
+ * The file is a 16-byte header ("MFBL", version, reserved, start time in
+ * ms since epoch) followed by records, each starting with a one-byte tag:
+ *
+ *   DEFINITION  varint id, level byte, varint line, file and format as
+ *               varint length + UTF-8, arg count, one type byte per arg
+ *   EVENT       varint id, varint time delta from the previous event (ms,
+ *               zigzag), then the args in their defined types: varints
+ *               for integers (zigzag if signed), 8 bytes for doubles, one
+ *               byte for bools, varint length + UTF-8 for text
+ *   DROPPED     varint number of messages lost to a full ring
+ *
+ * A definition is written the first time an id appears in the file, so a
+ * typical "Process started" event takes about a dozen bytes instead of a
+ * hundred-odd characters of text. Rendering is left to
+ * StructuredLogReader (and the logdecode tool).
+ *
+ * Writes go to an internal buffer; flush() writes it out. Used by the
+ * logger's writer thread only.
+ */
+class StructuredLogWriter
+{
+public:
+    static constexpr char MAGIC[4] = {'M', 'F', 'B', 'L'};
+    static constexpr quint16 VERSION = 1;
+    static constexpr int HEADER_SIZE = 16;
+
+    enum Tag : quint8 {
+        DEFINITION = 1,
+        EVENT = 2,
+        DROPPED = 3
+    };
+
+    bool open(const QString& path, qint64 startMSecsSinceEpoch);
+    void close();
+    bool isOpen() const;
+
+    void append(const LogRecord& record);
+    void appendDropped(quint64 count);
+    bool flush();
+
+    qint64 bytesWritten() const;
+
+private:
+    QFile m_file;
+    QByteArray m_buffer;
+    std::vector<bool> m_defined;
+    qint64 m_previousTime = 0;
+};
+
+/**
+ * @brief Reads a binary log written by StructuredLogWriter
+ */
+class StructuredLogReader
+{
+public:
+    struct Value {
+        LogArg::Type type;
+        qint64 i = 0;
+        quint64 u = 0;
+        double d = 0.0;
+        QString text;
+
+        QString toString() const;
+        QJsonValue toJson() const;
+    };
+
+    struct Event {
+        qint64 time = 0;                // ms since epoch
+        QtMsgType level = QtDebugMsg;
+        QString file;
+        int line = 0;
+        QString format;
+        QList<Value> args;
+
+        QString message() const;
+    };
+
+    bool open(const QString& path);
+    bool load(const QByteArray& data);
+
+    /**
+     * @return false at the end of the log or at a damaged record
+     */
+    bool next(Event& event);
+    bool isDamaged() const;
+    QString errorString() const;
+
+    /**
+     * @brief The line the text handler would have written for event
+     */
+    static QString toText(const Event& event);
+
+    /**
+     * @brief event as one line of JSON (no trailing newline)
+     */
+    static QByteArray toJson(const Event& event);
+
+private:
+    struct Definition {
+        bool defined = false;
+        QtMsgType level = QtDebugMsg;
+        QString file;
+        int line = 0;
+        QString format;
+        QList<LogArg::Type> types;
+    };
+
+    bool readVarint(quint64& value);
+    bool readText(QString& text);
+    bool fail(const QString& error);
+
+    QByteArray m_data;
+    int m_pos = 0;
+    qint64 m_time = 0;
+    std::vector<Definition> m_definitions;
+    bool m_damaged = false;
+    QString m_error;
+};
+
+#endif // STRUCTUREDLOG_H
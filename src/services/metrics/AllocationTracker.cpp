@@ -0,0 +1,154 @@
+#include "AllocationTracker.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+// Constant-initialised, so touching them from operator new is safe on any
+// thread at any point of its life
+thread_local AllocationStats t_stats;
+
+std::atomic<quint64> g_allocations{0};
+std::atomic<quint64> g_frees{0};
+std::atomic<quint64> g_bytes{0};
+
+#if defined(MF_TRACK_ALLOCATIONS)
+
+void countAllocation(std::size_t size)
+{
+    ++t_stats.allocations;
+    t_stats.bytes += size;
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    g_bytes.fetch_add(size, std::memory_order_relaxed);
+}
+
+void countFree(void* p)
+{
+    if (p) {
+        ++t_stats.frees;
+        g_frees.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void* allocate(std::size_t size)
+{
+    countAllocation(size);
+    return std::malloc(size ? size : 1);
+}
+
+void* allocateAligned(std::size_t size, std::align_val_t alignment)
+{
+    countAllocation(size);
+    const std::size_t align = static_cast<std::size_t>(alignment);
+#if defined(_MSC_VER)
+    return _aligned_malloc(size ? size : 1, align);
+#else
+    // aligned_alloc wants a multiple of the alignment
+    const std::size_t rounded = ((size ? size : 1) + align - 1) / align * align;
+    return std::aligned_alloc(align, rounded);
+#endif
+}
+
+void release(void* p)
+{
+    countFree(p);
+    std::free(p);
+}
+
+void releaseAligned(void* p)
+{
+    countFree(p);
+#if defined(_MSC_VER)
+    _aligned_free(p);
+#else
+    std::free(p);
+#endif
+}
+
+#endif
+
+}
+
+AllocationStats AllocationTracker::thisThread()
+{
+    return t_stats;
+}
+
+AllocationStats AllocationTracker::total()
+{
+    return {g_allocations.load(std::memory_order_relaxed),
+            g_frees.load(std::memory_order_relaxed),
+            g_bytes.load(std::memory_order_relaxed)};
+}
+
+#if defined(MF_TRACK_ALLOCATIONS)
+
+void* operator new(std::size_t size)
+{
+    if (void* p = allocate(size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+    if (void* p = allocate(size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    return allocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    return allocate(size);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+    if (void* p = allocateAligned(size, alignment)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment)
+{
+    if (void* p = allocateAligned(size, alignment)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    return allocateAligned(size, alignment);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    return allocateAligned(size, alignment);
+}
+
+void operator delete(void* p) noexcept { release(p); }
+void operator delete[](void* p) noexcept { release(p); }
+void operator delete(void* p, std::size_t) noexcept { release(p); }
+void operator delete[](void* p, std::size_t) noexcept { release(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { release(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { release(p); }
+
+void operator delete(void* p, std::align_val_t) noexcept { releaseAligned(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { releaseAligned(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { releaseAligned(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { releaseAligned(p); }
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept { releaseAligned(p); }
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept { releaseAligned(p); }
+
+#endif
@@ -0,0 +1,75 @@
+#ifndef ALLOCATIONTRACKER_H
+#define ALLOCATIONTRACKER_H
+
+#include <QtGlobal>
+
+/**
+ * @brief Allocations made through operator new, and bytes requested
+ */
+struct AllocationStats
+{
+    quint64 allocations = 0;
+    quint64 frees = 0;
+    quint64 bytes = 0;
+
+    AllocationStats operator-(const AllocationStats& other) const
+    {
+        return {allocations - other.allocations, frees - other.frees, bytes - other.bytes};
+    }
+};
+
+/**
+ * @class AllocationTracker
+ * @brief Counts every operator new/delete, per thread and for the process
+ *
+ * Only in the allocation-tracking build (MF_TRACK_ALLOCATIONS, set by the
+ * MINDFULNESS_TRACK_ALLOCATIONS CMake option and always by the allocation
+ * budget tests): AllocationTracker.cpp then replaces the global operator
+ * new and delete. Otherwise nothing is hooked and every count stays zero.
+ *
+ * Memory Qt containers take straight from malloc (QString, QByteArray and
+ * QList data) does not go through operator new and is not counted; node
+ * and span allocations (QHash, QSet, QMap), QObjects, queued signal events
+ * and their argument copies are.
+ */
+class AllocationTracker
+{
+public:
+#if defined(MF_TRACK_ALLOCATIONS)
+    static constexpr bool ENABLED = true;
+#else
+    static constexpr bool ENABLED = false;
+#endif
+
+    /**
+     * @brief Everything the calling thread has allocated so far
+     */
+    static AllocationStats thisThread();
+
+    /**
+     * @brief Everything every thread has allocated so far
+     */
+    static AllocationStats total();
+};
+
+/**
+ * @brief What the calling thread allocates between construction and stats()
+ */
+class AllocationScope
+{
+public:
+    AllocationScope()
+        : m_start(AllocationTracker::thisThread())
+    {
+    }
+
+    AllocationStats stats() const
+    {
+        return AllocationTracker::thisThread() - m_start;
+    }
+
+private:
+    const AllocationStats m_start;
+};
+
+#endif // ALLOCATIONTRACKER_H
@@ -0,0 +1,141 @@
+#include "DetectionLatency.h"
+#include "Metrics.h"
+
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+
+namespace {
+
+struct Stamp {
+    qint64 startedAt = -1;
+    qint64 enumerated = 0;
+    qint64 delivered = 0;
+    qint64 dispatched = 0;
+};
+
+struct Tracker {
+    LatencyHistogram& enumeration = MetricsRegistry::histogram(
+        "mindfulness_detection_enumeration_seconds", "Process start to the monitor poll that found it");
+    LatencyHistogram& delivery = MetricsRegistry::histogram(
+        "mindfulness_detection_delivery_seconds", "processStarted emitted to the dispatcher running it");
+    LatencyHistogram& dispatch = MetricsRegistry::histogram(
+        "mindfulness_detection_dispatch_seconds", "Dispatcher receiving a process to gameDetected");
+    LatencyHistogram& sessionStart = MetricsRegistry::histogram(
+        "mindfulness_detection_session_start_seconds", "gameDetected to the session manager handling it");
+    LatencyHistogram& total = MetricsRegistry::histogram(
+        "mindfulness_detection_total_seconds", "Process start to gameDetected");
+    Counter& dropped = MetricsRegistry::counter(
+        "mindfulness_detection_untimed_total", "Signalled processes not timed because the table was full");
+
+    QMutex mutex;
+    QHash<DWORD, Stamp> pending;
+};
+
+Tracker& tracker()
+{
+    static Tracker instance;
+    return instance;
+}
+
+}
+
+void DetectionLatency::enumerated(DWORD pid, qint64 startedAt)
+{
+    Tracker& t = tracker();
+    const qint64 now = ScopedLatency::now();
+    if (startedAt >= 0) {
+        t.enumeration.record(now - startedAt);
+    }
+
+    QMutexLocker locker(&t.mutex);
+    if (t.pending.size() >= MAX_PENDING && !t.pending.contains(pid)) {
+        t.dropped.add();
+        return;
+    }
+    Stamp& stamp = t.pending[pid];
+    stamp = Stamp();
+    stamp.startedAt = startedAt;
+    stamp.enumerated = now;
+}
+
+void DetectionLatency::delivered(DWORD pid)
+{
+    Tracker& t = tracker();
+    const qint64 now = ScopedLatency::now();
+    QMutexLocker locker(&t.mutex);
+    auto it = t.pending.find(pid);
+    if (it == t.pending.end() || it->delivered != 0) {
+        return;
+    }
+    it->delivered = now;
+    t.delivery.record(now - it->enumerated);
+}
+
+void DetectionLatency::dispatched(DWORD pid)
+{
+    Tracker& t = tracker();
+    const qint64 now = ScopedLatency::now();
+    QMutexLocker locker(&t.mutex);
+    auto it = t.pending.find(pid);
+    if (it == t.pending.end() || it->delivered == 0 || it->dispatched != 0) {
+        return;
+    }
+    it->dispatched = now;
+    t.dispatch.record(now - it->delivered);
+    if (it->startedAt >= 0) {
+        t.total.record(now - it->startedAt);
+    }
+}
+
+void DetectionLatency::sessionStarted(DWORD pid)
+{
+    Tracker& t = tracker();
+    const qint64 now = ScopedLatency::now();
+    QMutexLocker locker(&t.mutex);
+    auto it = t.pending.find(pid);
+    if (it == t.pending.end()) {
+        return;
+    }
+    if (it->dispatched != 0) {
+        t.sessionStart.record(now - it->dispatched);
+    }
+    t.pending.erase(it);
+}
+
+void DetectionLatency::forget(DWORD pid)
+{
+    Tracker& t = tracker();
+    QMutexLocker locker(&t.mutex);
+    t.pending.remove(pid);
+}
+
+LatencyHistogram& DetectionLatency::histogram(Stage stage)
+{
+    Tracker& t = tracker();
+    switch (stage) {
+        case Stage::Enumeration:
+            return t.enumeration;
+        case Stage::Delivery:
+            return t.delivery;
+        case Stage::Dispatch:
+            return t.dispatch;
+        case Stage::SessionStart:
+            return t.sessionStart;
+        case Stage::Total:
+            break;
+    }
+    return t.total;
+}
+
+void DetectionLatency::reset()
+{
+    Tracker& t = tracker();
+    QMutexLocker locker(&t.mutex);
+    t.pending.clear();
+    t.enumeration.reset();
+    t.delivery.reset();
+    t.dispatch.reset();
+    t.sessionStart.reset();
+    t.total.reset();
+}
@@ -0,0 +1,70 @@
+#ifndef DETECTIONLATENCY_H
+#define DETECTIONLATENCY_H
+
+#include "services/utils/PlatformTypes.h" // For DWORD
+#include <QtGlobal>
+
+class LatencyHistogram;
+
+/**
+ * @class DetectionLatency
+ * @brief How long after a process starts it reaches each stage of detection
+ *
+ * The monitor stamps every process it signals with the kernel's start time
+ * and the time it saw it; the dispatcher and session manager add theirs as
+ * the event passes through. Each step lands in its own histogram:
+ *
+ *   Enumeration   process start -> monitor poll that found it
+ *   Delivery      processStarted emitted -> dispatcher slot running
+ *   Dispatch      dispatcher slot running -> gameDetected emitted
+ *   SessionStart  gameDetected emitted -> session manager done with it
+ *   Total         process start -> gameDetected emitted
+ *
+ * Enumeration and Total need a start time from the ProcessSource, so
+ * scripted sources only fill the other three. Stamps live in a small table
+ * keyed by pid (mutex-guarded, touched once per stage per signalled
+ * process); a pid is dropped when it finishes, is not a game, or exits.
+ */
+class DetectionLatency
+{
+public:
+    enum class Stage { Enumeration, Delivery, Dispatch, SessionStart, Total };
+
+    // Beyond this many in-flight stamps new processes are not timed
+    static constexpr int MAX_PENDING = 4096;
+
+    /**
+     * @brief Monitor thread: pid was found and is about to be signalled
+     * @param startedAt Kernel start time (ScopedLatency::now() clock), -1 if unknown
+     */
+    static void enumerated(DWORD pid, qint64 startedAt);
+
+    /**
+     * @brief Dispatcher: processStarted for pid has arrived
+     */
+    static void delivered(DWORD pid);
+
+    /**
+     * @brief Dispatcher: gameDetected for pid is about to be emitted
+     */
+    static void dispatched(DWORD pid);
+
+    /**
+     * @brief Session manager: it has handled gameDetected for pid
+     */
+    static void sessionStarted(DWORD pid);
+
+    /**
+     * @brief Stop timing pid (not a game, or it exited)
+     */
+    static void forget(DWORD pid);
+
+    static LatencyHistogram& histogram(Stage stage);
+
+    /**
+     * @brief Drop every stamp and empty the histograms
+     */
+    static void reset();
+};
+
+#endif // DETECTIONLATENCY_H
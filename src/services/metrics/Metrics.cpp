@@ -0,0 +1,239 @@
+#include "Metrics.h"
+
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <memory>
+#include <vector>
+
+namespace {
+
+// Histogram export: le = 2^k ns for k in this range (1.024 us .. 68.7 s)
+constexpr int FIRST_BUCKET_EXPONENT = 10;
+constexpr int LAST_BUCKET_EXPONENT = 36;
+
+struct Entry {
+    enum class Type { Counter, Gauge, Histogram };
+
+    QByteArray name;
+    QByteArray help;
+    Type type;
+    std::unique_ptr<Counter> counter;
+    std::unique_ptr<Gauge> gauge;
+    std::unique_ptr<LatencyHistogram> histogram;
+};
+
+struct Registry {
+    QMutex mutex;
+    std::vector<std::unique_ptr<Entry>> entries;    // In registration order
+};
+
+Registry& registry()
+{
+    static Registry instance;
+    return instance;
+}
+
+Entry& entryFor(const char* name, const char* help, Entry::Type type)
+{
+    Registry& reg = registry();
+    QMutexLocker locker(&reg.mutex);
+    for (const std::unique_ptr<Entry>& entry : reg.entries) {
+        if (entry->name == name) {
+            Q_ASSERT_X(entry->type == type, "MetricsRegistry", name);
+            return *entry;
+        }
+    }
+
+    std::unique_ptr<Entry> entry(new Entry);
+    entry->name = name;
+    entry->help = help;
+    entry->type = type;
+    switch (type) {
+        case Entry::Type::Counter:   entry->counter.reset(new Counter); break;
+        case Entry::Type::Gauge:     entry->gauge.reset(new Gauge); break;
+        case Entry::Type::Histogram: entry->histogram.reset(new LatencyHistogram); break;
+    }
+    reg.entries.push_back(std::move(entry));
+    return *reg.entries.back();
+}
+
+QByteArray seconds(quint64 nanoseconds)
+{
+    return QByteArray::number(static_cast<double>(nanoseconds) / 1e9, 'g', 12);
+}
+
+}
+
+// Counter
+
+quint64 Counter::value() const
+{
+    quint64 total = 0;
+    for (const Shard& shard : m_shards) {
+        total += shard.value.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+void Counter::reset()
+{
+    for (Shard& shard : m_shards) {
+        shard.value.store(0, std::memory_order_relaxed);
+    }
+}
+
+// LatencyHistogram
+
+quint64 LatencyHistogram::count() const
+{
+    return m_count.load(std::memory_order_relaxed);
+}
+
+quint64 LatencyHistogram::sum() const
+{
+    return m_sum.load(std::memory_order_relaxed);
+}
+
+quint64 LatencyHistogram::percentile(double q) const
+{
+    // Bucket counts are read one by one, so use their own total
+    quint64 counts[BUCKETS];
+    quint64 total = 0;
+    for (int i = 0; i < BUCKETS; ++i) {
+        counts[i] = m_buckets[i].load(std::memory_order_relaxed);
+        total += counts[i];
+    }
+    if (total == 0) {
+        return 0;
+    }
+
+    const double clamped = qBound(0.0, q, 1.0);
+    const quint64 rank = qMax<quint64>(1, static_cast<quint64>(clamped * static_cast<double>(total) + 0.5));
+    quint64 seen = 0;
+    for (int i = 0; i < BUCKETS; ++i) {
+        seen += counts[i];
+        if (seen >= rank) {
+            return bucketUpperBound(i);
+        }
+    }
+    return bucketUpperBound(BUCKETS - 1);
+}
+
+quint64 LatencyHistogram::countBelow(quint64 limit) const
+{
+    const int end = limit > 0 ? bucketOf(limit) : 0;
+    quint64 below = 0;
+    for (int i = 0; i < end; ++i) {
+        below += m_buckets[i].load(std::memory_order_relaxed);
+    }
+    return below;
+}
+
+void LatencyHistogram::reset()
+{
+    for (std::atomic<quint64>& bucket : m_buckets) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    m_count.store(0, std::memory_order_relaxed);
+    m_sum.store(0, std::memory_order_relaxed);
+}
+
+quint64 LatencyHistogram::bucketLowerBound(int bucket)
+{
+    if (bucket < SUB_BUCKETS) {
+        return static_cast<quint64>(bucket);
+    }
+    const int shift = bucket / SUB_BUCKETS - 1;
+    const quint64 sub = static_cast<quint64>(bucket % SUB_BUCKETS);
+    return (SUB_BUCKETS + sub) << shift;
+}
+
+quint64 LatencyHistogram::bucketUpperBound(int bucket)
+{
+    if (bucket < SUB_BUCKETS) {
+        return static_cast<quint64>(bucket);
+    }
+    const int shift = bucket / SUB_BUCKETS - 1;
+    return bucketLowerBound(bucket) + ((quint64(1) << shift) - 1);
+}
+
+// MetricsRegistry
+
+Counter& MetricsRegistry::counter(const char* name, const char* help)
+{
+    return *entryFor(name, help, Entry::Type::Counter).counter;
+}
+
+Gauge& MetricsRegistry::gauge(const char* name, const char* help)
+{
+    return *entryFor(name, help, Entry::Type::Gauge).gauge;
+}
+
+LatencyHistogram& MetricsRegistry::histogram(const char* name, const char* help)
+{
+    return *entryFor(name, help, Entry::Type::Histogram).histogram;
+}
+
+QByteArray MetricsRegistry::toPrometheus()
+{
+    Registry& reg = registry();
+    QMutexLocker locker(&reg.mutex);
+
+    QByteArray out;
+    for (const std::unique_ptr<Entry>& entry : reg.entries) {
+        const QByteArray& name = entry->name;
+        out += "# HELP " + name + ' ' + entry->help + '\n';
+        switch (entry->type) {
+            case Entry::Type::Counter:
+                out += "# TYPE " + name + " counter\n";
+                out += name + ' ' + QByteArray::number(entry->counter->value()) + '\n';
+                break;
+            case Entry::Type::Gauge:
+                out += "# TYPE " + name + " gauge\n";
+                out += name + ' ' + QByteArray::number(entry->gauge->value()) + '\n';
+                break;
+            case Entry::Type::Histogram: {
+                const LatencyHistogram& histogram = *entry->histogram;
+                // Count first: buckets recorded after it may make a bucket
+                // exceed +Inf by a few, never the other way round
+                const quint64 count = histogram.count();
+                const quint64 sum = histogram.sum();
+                out += "# TYPE " + name + " histogram\n";
+                for (int k = FIRST_BUCKET_EXPONENT; k <= LAST_BUCKET_EXPONENT; ++k) {
+                    const quint64 limit = quint64(1) << k;
+                    const quint64 below = qMin(histogram.countBelow(limit), count);
+                    out += name + "_bucket{le=\"" + seconds(limit) + "\"} " + QByteArray::number(below) + '\n';
+                }
+                out += name + "_bucket{le=\"+Inf\"} " + QByteArray::number(count) + '\n';
+                out += name + "_sum " + seconds(sum) + '\n';
+                out += name + "_count " + QByteArray::number(count) + '\n';
+                break;
+            }
+        }
+    }
+    return out;
+}
+
+bool MetricsRegistry::writeSnapshot(const QString& path)
+{
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    file.write(toPrometheus());
+    return file.commit();
+}
+
+void MetricsRegistry::resetAll()
+{
+    Registry& reg = registry();
+    QMutexLocker locker(&reg.mutex);
+    for (const std::unique_ptr<Entry>& entry : reg.entries) {
+        switch (entry->type) {
+            case Entry::Type::Counter:   entry->counter->reset(); break;
+            case Entry::Type::Gauge:     entry->gauge->set(0); break;
+            case Entry::Type::Histogram: entry->histogram->reset(); break;
+        }
+    }
+}
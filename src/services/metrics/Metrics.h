@@ -0,0 +1,198 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <QByteArray>
+#include <QString>
+#include <QtGlobal>
+#include <atomic>
+#include <chrono>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+/**
+ * @brief A monotonically increasing count, sharded to keep threads apart
+ *
+ * Each thread adds to one of SHARDS cache-line-sized slots (picked once
+ * per thread), so counting is an uncontended relaxed add on a line no
+ * other core is writing. value() sums the shards.
+ */
+class Counter
+{
+public:
+    static constexpr int SHARDS = 16;
+
+    void add(quint64 n = 1)
+    {
+        m_shards[shardIndex()].value.fetch_add(n, std::memory_order_relaxed);
+    }
+
+    quint64 value() const;
+    void reset();
+
+private:
+    struct alignas(64) Shard {
+        std::atomic<quint64> value{0};
+    };
+
+    static int shardIndex()
+    {
+        static std::atomic<int> s_nextShard{0};
+        thread_local const int shard = s_nextShard.fetch_add(1, std::memory_order_relaxed) % SHARDS;
+        return shard;
+    }
+
+    Shard m_shards[SHARDS];
+};
+
+/**
+ * @brief A value that goes up and down (queue depth, running processes)
+ */
+class Gauge
+{
+public:
+    void set(qint64 value) { m_value.store(value, std::memory_order_relaxed); }
+    void add(qint64 delta) { m_value.fetch_add(delta, std::memory_order_relaxed); }
+    qint64 value() const { return m_value.load(std::memory_order_relaxed); }
+
+private:
+    alignas(64) std::atomic<qint64> m_value{0};
+};
+
+/**
+ * @brief HDR-style histogram of durations in nanoseconds
+ *
+ * Log-linear buckets: each power of two is split into SUB_BUCKETS equal
+ * parts, so any recorded value is known to within 1/SUB_BUCKETS (12.5%)
+ * over the whole 64-bit range, in a fixed 4 KiB of counters. Recording is
+ * a count-leading-zeros, a shift and three relaxed adds.
+ */
+class LatencyHistogram
+{
+public:
+    static constexpr int SUB_BUCKET_BITS = 3;
+    static constexpr int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+    static constexpr int BUCKETS = (64 - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+    void record(qint64 nanoseconds)
+    {
+        const quint64 value = nanoseconds > 0 ? static_cast<quint64>(nanoseconds) : 0;
+        m_buckets[bucketOf(value)].fetch_add(1, std::memory_order_relaxed);
+        m_count.fetch_add(1, std::memory_order_relaxed);
+        m_sum.fetch_add(value, std::memory_order_relaxed);
+    }
+
+    quint64 count() const;
+    quint64 sum() const;            // ns
+
+    /**
+     * @brief Upper bound of the bucket holding quantile q (0..1), in ns
+     */
+    quint64 percentile(double q) const;
+
+    /**
+     * @brief Number of recorded values below limit; exact when limit is a power of two
+     */
+    quint64 countBelow(quint64 limit) const;
+
+    void reset();
+
+    static int bucketOf(quint64 value)
+    {
+        if (value < SUB_BUCKETS) {
+            return static_cast<int>(value);
+        }
+        const int exponent = 63 - countLeadingZeros(value);
+        const int shift = exponent - SUB_BUCKET_BITS;
+        const int sub = static_cast<int>((value >> shift) & (SUB_BUCKETS - 1));
+        return (shift + 1) * SUB_BUCKETS + sub;
+    }
+
+    static quint64 bucketLowerBound(int bucket);
+    static quint64 bucketUpperBound(int bucket);
+
+private:
+    static int countLeadingZeros(quint64 value)
+    {
+#if defined(_MSC_VER)
+        unsigned long index = 0;
+        _BitScanReverse64(&index, value);
+        return 63 - static_cast<int>(index);
+#else
+        return __builtin_clzll(value);
+#endif
+    }
+
+    std::atomic<quint64> m_buckets[BUCKETS] = {};
+    alignas(64) std::atomic<quint64> m_count{0};
+    std::atomic<quint64> m_sum{0};
+};
+
+/**
+ * @brief Records the lifetime of a scope into a LatencyHistogram
+ */
+class ScopedLatency
+{
+public:
+    explicit ScopedLatency(LatencyHistogram& histogram)
+        : m_histogram(histogram), m_start(now())
+    {
+    }
+
+    ~ScopedLatency()
+    {
+        m_histogram.record(now() - m_start);
+    }
+
+    static qint64 now()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+private:
+    LatencyHistogram& m_histogram;
+    const qint64 m_start;
+};
+
+/**
+ * @class MetricsRegistry
+ * @brief Process-wide named metrics, rendered in the Prometheus text format.
+ *
+ * Call sites look their metric up once and keep the reference:
+ *
+ *     static Counter& ticks = MetricsRegistry::counter("mindfulness_monitor_ticks_total", "...");
+ *     ticks.add();
+ *
+ * Registering is locked and slow; recording never touches the registry.
+ * Asking for an existing name returns the same metric. Metrics live
+ * until the process exits.
+ *
+ * Histograms are exported with power-of-two second buckets from 1 us to
+ * about 69 s (fixed, so series stay comparable across scrapes).
+ */
+class MetricsRegistry
+{
+public:
+    static Counter& counter(const char* name, const char* help);
+    static Gauge& gauge(const char* name, const char* help);
+    static LatencyHistogram& histogram(const char* name, const char* help);
+
+    /**
+     * @brief Every registered metric in the Prometheus text exposition format
+     */
+    static QByteArray toPrometheus();
+
+    /**
+     * @brief Replace path with a fresh snapshot
+     */
+    static bool writeSnapshot(const QString& path);
+
+    /**
+     * @brief Zero every metric (tests and benchmarks)
+     */
+    static void resetAll();
+};
+
+#endif // METRICS_H
@@ -0,0 +1,37 @@
+#include "MetricsServer.h"
+#include "Metrics.h"
+
+#include <QLocalServer>
+#include <QLocalSocket>
+
+MetricsServer::MetricsServer(QObject* parent)
+    : QObject(parent),
+      m_server(new QLocalServer(this))
+{
+    connect(m_server, &QLocalServer::newConnection, this, &MetricsServer::onNewConnection);
+}
+
+MetricsServer::~MetricsServer()
+{
+    m_server->close();
+}
+
+bool MetricsServer::listen(const QString& name)
+{
+    QLocalServer::removeServer(name);
+    return m_server->listen(name);
+}
+
+QString MetricsServer::errorString() const
+{
+    return m_server->errorString();
+}
+
+void MetricsServer::onNewConnection()
+{
+    while (QLocalSocket* socket = m_server->nextPendingConnection()) {
+        connect(socket, &QLocalSocket::disconnected, socket, &QObject::deleteLater);
+        socket->write(MetricsRegistry::toPrometheus());
+        socket->disconnectFromServer();
+    }
+}
@@ -0,0 +1,38 @@
+#ifndef METRICSSERVER_H
+#define METRICSSERVER_H
+
+#include <QObject>
+#include <QString>
+
+class QLocalServer;
+
+/**
+ * @brief Serves MetricsRegistry snapshots on a local socket
+ *
+ * Every connection gets the current Prometheus text and is closed, so
+ * `socat - UNIX-CONNECT:<socket>` (or a named pipe client on Windows)
+ * prints the metrics. Lives on the main thread; a snapshot takes the
+ * registry lock only to walk its list.
+ */
+class MetricsServer : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit MetricsServer(QObject* parent = nullptr);
+    ~MetricsServer();
+
+    /**
+     * @param name Socket path or pipe name; a stale socket left by a crash is removed
+     */
+    bool listen(const QString& name);
+    QString errorString() const;
+
+private slots:
+    void onNewConnection();
+
+private:
+    QLocalServer* m_server;
+};
+
+#endif // METRICSSERVER_H
@@ -0,0 +1,245 @@
+#include "TraceSpans.h"
+
+#include <QCoreApplication>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+namespace {
+
+enum class Kind : int { Span, FlowBegin, FlowEnd };
+
+// Fields are atomics so an export may read a slot while its owner rewrites it
+struct Event {
+    std::atomic<const char*> name{nullptr};
+    std::atomic<qint64> start{0};
+    std::atomic<qint64> end{0};
+    std::atomic<quint64> id{0};
+    std::atomic<int> kind{0};
+};
+
+struct Copy {
+    const char* name;
+    qint64 start;
+    qint64 end;
+    quint64 id;
+    Kind kind;
+};
+
+/**
+ * One per recording thread, written only by that thread. claimed is bumped
+ * before a slot is overwritten and written after, so a reader that finds
+ * claimed has moved past a slot it copied knows the copy may be torn.
+ */
+struct ThreadBuffer {
+    explicit ThreadBuffer(int threadId)
+        : tid(threadId), events(new Event[SpanTracer::THREAD_CAPACITY])
+    {
+    }
+
+    const int tid;
+    QByteArray name;                        // Registry mutex
+    std::atomic<quint64> claimed{0};
+    std::atomic<quint64> written{0};
+    std::atomic<quint64> discarded{0};      // Indices below this were cleared
+    std::unique_ptr<Event[]> events;
+};
+
+// Buffers outlive their threads, so a trace still shows the monitor thread
+// after it has finished
+struct Registry {
+    QMutex mutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+};
+
+Registry& registry()
+{
+    static Registry instance;
+    return instance;
+}
+
+thread_local ThreadBuffer* t_buffer = nullptr;
+thread_local const char* t_threadName = nullptr;
+
+ThreadBuffer& threadBuffer()
+{
+    if (Q_UNLIKELY(!t_buffer)) {
+        Registry& reg = registry();
+        QMutexLocker locker(&reg.mutex);
+        const int tid = static_cast<int>(reg.buffers.size()) + 1;
+        std::unique_ptr<ThreadBuffer> buffer(new ThreadBuffer(tid));
+        buffer->name = t_threadName ? QByteArray(t_threadName) : "thread " + QByteArray::number(tid);
+        t_buffer = buffer.get();
+        reg.buffers.push_back(std::move(buffer));
+    }
+    return *t_buffer;
+}
+
+void record(const char* name, qint64 start, qint64 end, quint64 id, Kind kind)
+{
+    ThreadBuffer& buffer = threadBuffer();
+    const quint64 index = buffer.written.load(std::memory_order_relaxed);
+    buffer.claimed.store(index + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    Event& event = buffer.events[index % SpanTracer::THREAD_CAPACITY];
+    event.name.store(name, std::memory_order_relaxed);
+    event.start.store(start, std::memory_order_relaxed);
+    event.end.store(end, std::memory_order_relaxed);
+    event.id.store(id, std::memory_order_relaxed);
+    event.kind.store(static_cast<int>(kind), std::memory_order_relaxed);
+    buffer.written.store(index + 1, std::memory_order_release);
+}
+
+// The buffer's events that survived copying intact, oldest first
+std::vector<Copy> copyEvents(const ThreadBuffer& buffer)
+{
+    const quint64 capacity = SpanTracer::THREAD_CAPACITY;
+    const quint64 written = buffer.written.load(std::memory_order_acquire);
+    const quint64 discarded = buffer.discarded.load(std::memory_order_relaxed);
+    quint64 first = std::max(discarded, written > capacity ? written - capacity : 0);
+
+    std::vector<Copy> copies;
+    copies.reserve(static_cast<size_t>(written - std::min(first, written)));
+    for (quint64 index = first; index < written; ++index) {
+        const Event& event = buffer.events[index % capacity];
+        copies.push_back({event.name.load(std::memory_order_relaxed),
+                          event.start.load(std::memory_order_relaxed),
+                          event.end.load(std::memory_order_relaxed),
+                          event.id.load(std::memory_order_relaxed),
+                          static_cast<Kind>(event.kind.load(std::memory_order_relaxed))});
+    }
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    const quint64 claimed = buffer.claimed.load(std::memory_order_relaxed);
+    const quint64 intact = claimed > capacity ? claimed - capacity : 0;
+    if (intact > first) {
+        const quint64 torn = std::min<quint64>(intact - first, copies.size());
+        copies.erase(copies.begin(), copies.begin() + static_cast<std::ptrdiff_t>(torn));
+    }
+    return copies;
+}
+
+// Chrome wants microseconds; keep the nanoseconds as exact decimals
+QByteArray micros(qint64 nanoseconds)
+{
+    const qint64 value = std::max<qint64>(nanoseconds, 0);
+    return QByteArray::number(value / 1000) + '.' + QByteArray::number(value % 1000).rightJustified(3, '0');
+}
+
+QByteArray quoted(const char* text)
+{
+    QByteArray out = "\"";
+    for (const char* c = text; *c; ++c) {
+        if (*c == '"' || *c == '\\') {
+            out += '\\';
+        }
+        out += *c;
+    }
+    out += '"';
+    return out;
+}
+
+}
+
+void SpanTracer::setEnabled(bool enabled)
+{
+    s_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+void SpanTracer::setThreadName(const char* name)
+{
+    t_threadName = name;
+    if (t_buffer) {
+        QMutexLocker locker(&registry().mutex);
+        t_buffer->name = name;
+    }
+}
+
+void SpanTracer::clear()
+{
+    Registry& reg = registry();
+    QMutexLocker locker(&reg.mutex);
+    for (const std::unique_ptr<ThreadBuffer>& buffer : reg.buffers) {
+        buffer->discarded.store(buffer->written.load(std::memory_order_acquire), std::memory_order_relaxed);
+    }
+}
+
+QByteArray SpanTracer::toChromeJson(qint64 windowNs)
+{
+    const qint64 cutoff = windowNs > 0 ? now() - windowNs : 0;
+    const QByteArray pid = QByteArray::number(QCoreApplication::applicationPid());
+
+    Registry& reg = registry();
+    QMutexLocker locker(&reg.mutex);
+
+    QByteArray out = "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    bool first = true;
+    auto append = [&out, &first](const QByteArray& event) {
+        if (!first) {
+            out += ",\n";
+        }
+        out += event;
+        first = false;
+    };
+
+    for (const std::unique_ptr<ThreadBuffer>& buffer : reg.buffers) {
+        const QByteArray tid = QByteArray::number(buffer->tid);
+        append("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" + pid + ",\"tid\":" + tid +
+               ",\"args\":{\"name\":" + quoted(buffer->name.constData()) + "}}");
+
+        for (const Copy& event : copyEvents(*buffer)) {
+            if (event.end < cutoff) {
+                continue;
+            }
+            QByteArray json = "{\"name\":" + quoted(event.name) + ",\"cat\":\"mindfulness\"";
+            switch (event.kind) {
+                case Kind::Span:
+                    json += ",\"ph\":\"X\",\"ts\":" + micros(event.start) + ",\"dur\":" + micros(event.end - event.start);
+                    break;
+                case Kind::FlowBegin:
+                    json += ",\"ph\":\"s\",\"id\":" + QByteArray::number(event.id) + ",\"ts\":" + micros(event.start);
+                    break;
+                case Kind::FlowEnd:
+                    json += ",\"ph\":\"f\",\"bp\":\"e\",\"id\":" + QByteArray::number(event.id) + ",\"ts\":" + micros(event.start);
+                    break;
+            }
+            json += ",\"pid\":" + pid + ",\"tid\":" + tid + '}';
+            append(json);
+        }
+    }
+    out += "]}\n";
+    return out;
+}
+
+bool SpanTracer::writeChromeTrace(const QString& path, qint64 windowNs)
+{
+    const QByteArray json = toChromeJson(windowNs);
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    file.write(json);
+    return file.commit();
+}
+
+qint64 SpanTracer::now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void SpanTracer::recordSpan(const char* name, qint64 start, qint64 end)
+{
+    record(name, start, end, 0, Kind::Span);
+}
+
+void SpanTracer::recordFlow(const char* name, quint64 id, bool begin)
+{
+    const qint64 timestamp = now();
+    record(name, timestamp, timestamp, id, begin ? Kind::FlowBegin : Kind::FlowEnd);
+}
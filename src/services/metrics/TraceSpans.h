@@ -0,0 +1,116 @@
+#ifndef TRACESPANS_H
+#define TRACESPANS_H
+
+#include <QByteArray>
+#include <QString>
+#include <QtGlobal>
+#include <atomic>
+
+/**
+ * @class SpanTracer
+ * @brief Scoped timing spans kept per thread, exported as Chrome trace-event JSON
+ *
+ * Spans show where a slow tick went: enumeration, name resolution, the hop
+ * from the monitor thread to the main thread, dispatch, repository lookups,
+ * dialog creation. Mark a scope with MF_TRACE_SPAN("name") and a cross-thread
+ * handoff with MF_TRACE_FLOW_BEGIN/END on either side; the resulting file
+ * opens in Perfetto (ui.perfetto.dev) or chrome://tracing.
+ *
+ * Each thread records into its own ring of THREAD_CAPACITY events, created
+ * the first time it records while tracing is on, so recording never takes a
+ * lock and only the most recent events per thread are kept. Export can run
+ * on any thread at any time; events overwritten while they are being copied
+ * are dropped from that export rather than torn.
+ *
+ * While tracing is off, a span costs one relaxed load and a branch that is
+ * never taken. Names must be string literals: only the pointer is kept.
+ */
+class SpanTracer
+{
+public:
+    static constexpr int THREAD_CAPACITY = 16384;
+
+    static bool isEnabled()
+    {
+        return s_enabled.load(std::memory_order_relaxed);
+    }
+
+    static void setEnabled(bool enabled);
+
+    /**
+     * @brief Name the calling thread in exported traces ("main", "monitor")
+     */
+    static void setThreadName(const char* name);
+
+    /**
+     * @brief Forget everything recorded so far, on every thread
+     */
+    static void clear();
+
+    /**
+     * @brief The recorded events as a Chrome trace-event JSON document
+     * @param windowNs Only events that ended in the last windowNs; 0 for all
+     */
+    static QByteArray toChromeJson(qint64 windowNs = 0);
+
+    /**
+     * @brief Replace path with toChromeJson(windowNs)
+     */
+    static bool writeChromeTrace(const QString& path, qint64 windowNs = 0);
+
+    /**
+     * @brief Monotonic nanoseconds, the same clock as ScopedLatency
+     */
+    static qint64 now();
+
+    // Used by TraceSpan and the flow macros
+    static void recordSpan(const char* name, qint64 start, qint64 end);
+    static void recordFlow(const char* name, quint64 id, bool begin);
+
+private:
+    static inline std::atomic<bool> s_enabled{false};
+};
+
+/**
+ * @brief Records its own lifetime as a span, if tracing was on when it began
+ */
+class TraceSpan
+{
+public:
+    explicit TraceSpan(const char* name)
+        : m_name(name), m_start(0)
+    {
+        if (Q_UNLIKELY(SpanTracer::isEnabled())) {
+            m_start = SpanTracer::now();
+        }
+    }
+
+    ~TraceSpan()
+    {
+        if (Q_UNLIKELY(m_start != 0)) {
+            SpanTracer::recordSpan(m_name, m_start, SpanTracer::now());
+        }
+    }
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+private:
+    const char* m_name;
+    qint64 m_start;
+};
+
+#define MF_TRACE_CONCAT_(a, b) a##b
+#define MF_TRACE_CONCAT(a, b) MF_TRACE_CONCAT_(a, b)
+
+// Span from here to the end of the enclosing scope
+#define MF_TRACE_SPAN(name) TraceSpan MF_TRACE_CONCAT(traceSpan_, __LINE__)(name)
+
+// An arrow from the span enclosing BEGIN to the span enclosing END with the
+// same name and id, typically on another thread
+#define MF_TRACE_FLOW_BEGIN(name, id) \
+    do { if (Q_UNLIKELY(SpanTracer::isEnabled())) SpanTracer::recordFlow(name, id, true); } while (0)
+#define MF_TRACE_FLOW_END(name, id) \
+    do { if (Q_UNLIKELY(SpanTracer::isEnabled())) SpanTracer::recordFlow(name, id, false); } while (0)
+
+#endif // TRACESPANS_H
@@ -0,0 +1,16 @@
+#ifndef PLATFORMTYPES_H
+#define PLATFORMTYPES_H
+
+#include <QtGlobal>
+
+// DWORD is the process id type used throughout the monitor pipeline. Only
+// ProcessUtils talks to the OS; everything else just passes ids around, so
+// other platforms (the headless test and simulation builds on Linux) get a
+// plain 32-bit equivalent instead of <windows.h>.
+#if defined(Q_OS_WIN)
+#include <windows.h>
+#else
+typedef quint32 DWORD;
+#endif
+
+#endif // PLATFORMTYPES_H
\ No newline at end of file
@@ -1,9 +1,34 @@
 #include "ProcessUtils.h"
-#include <psapi.h>
+#include "services/metrics/Metrics.h"
+#include "services/metrics/TraceSpans.h"
 #include <QSet>
 #include <QString>
 #include <QHash>
 
+namespace {
+
+    // Per updateActiveProcessMap() call, for both backends
+    struct ScanMetrics {
+        LatencyHistogram& scanTime = MetricsRegistry::histogram(
+            "mindfulness_process_scan_seconds", "Time to refresh the active process map");
+        Counter& resolved = MetricsRegistry::counter(
+            "mindfulness_process_names_resolved_total", "New PIDs whose executable name was read");
+        Counter& unresolved = MetricsRegistry::counter(
+            "mindfulness_process_names_unresolved_total", "New PIDs whose name could not be read");
+    };
+
+    ScanMetrics& scanMetrics(){
+        static ScanMetrics metrics;
+        return metrics;
+    }
+
+}
+
+#if defined(Q_OS_WIN)
+
+#include <psapi.h>
+#include <tlhelp32.h>
+
 #pragma comment(lib, "Psapi.lib")
 
 namespace ProcessUtils{
@@ -66,6 +91,10 @@ namespace ProcessUtils{
     }
 
     void updateActiveProcessMap(QHash<DWORD, QString>& currentMap){
+        ScanMetrics& metrics = scanMetrics();
+        ScopedLatency timing(metrics.scanTime);
+        MF_TRACE_SPAN("enumerate processes");
+
         // 1. Get a "snapshot" of all currently running PIDs
         DWORD aProcesses[1024], cbNeeded;
         if(!EnumProcesses(aProcesses, sizeof(aProcesses), &cbNeeded)){
@@ -82,36 +111,225 @@ namespace ProcessUtils{
             }
         }
 
-        // 3. Check for CLOSED processes (in our map, but not in the snapshot)
-        //    We must use an iterator to safely remove items from a QHash while looping
-        auto it = currentMap.begin();
-        while(it != currentMap.end()){
-            if(!currentPIDsSet.contains(it.key())){
-                // THis PID is in our map, but not running anymore.
-                // Erase it from the map we were passed (m_activeProcessMap).
-                it = currentMap.erase(it);
-            } else{
-                // This PID is still running, move to the next item.
-                ++it;
+        // 3. Drop CLOSED processes and name the NEW ones
+        const SnapshotDiff diff = applySnapshot(currentMap, currentPIDsSet, [](DWORD pid){
+            MF_TRACE_SPAN("resolve name");
+            QString qName;
+            HANDLE hProcess = OpenProcess(PROCESS_QUERY_INFORMATION | PROCESS_VM_READ,
+                                            FALSE, pid);
+            if(hProcess != NULL){
+                wchar_t szProcessName[MAX_PATH];
+                if(GetModuleBaseNameW(hProcess, NULL, szProcessName, sizeof(szProcessName) / sizeof(wchar_t))){
+                    qName = QString::fromWCharArray(szProcessName).toLower();
+                }
+                CloseHandle(hProcess);
             }
+            return qName;
+        });
+        metrics.resolved.add(diff.resolved);
+        metrics.unresolved.add(diff.unresolved);
+    }
+
+    QHash<DWORD, DWORD> parentProcessIds(const QList<DWORD>& pids){
+        QHash<DWORD, DWORD> parents;
+
+        // Parents are only listed in a toolhelp snapshot of all processes,
+        // so take one for the whole batch
+        HANDLE hSnapshot = CreateToolhelp32Snapshot(TH32CS_SNAPPROCESS, 0);
+        if(hSnapshot == INVALID_HANDLE_VALUE){
+            return parents;
         }
 
-        // 4. Check for NEW processes (in the snapshot, but not in our map)
-        for (DWORD pid : currentPIDsSet){
-            if(!currentMap.contains(pid)){
-                // This is a new process. Get its name and add it to our map.
-                HANDLE hProcess = OpenProcess(PROCESS_QUERY_INFORMATION | PROCESS_VM_READ,
-                                                FALSE, pid);
-                if(hProcess != NULL){
-                    wchar_t szProcessName[MAX_PATH];
-                    if(GetModuleBaseNameW(hProcess, NULL, szProcessName, sizeof(szProcessName) / sizeof(wchar_t))){
-                        QString qName = QString::fromWCharArray(szProcessName).toLower();
-                        // Add the new process to the map we were passed (m_activeProcessMap).
-                        currentMap.insert(pid, qName);
-                    }
-                    CloseHandle(hProcess);
+        const QSet<DWORD> wanted(pids.begin(), pids.end());
+        PROCESSENTRY32W entry;
+        entry.dwSize = sizeof(entry);
+        if(Process32FirstW(hSnapshot, &entry)){
+            do{
+                if(wanted.contains(entry.th32ProcessID)){
+                    parents.insert(entry.th32ProcessID, entry.th32ParentProcessID);
                 }
+            } while(Process32NextW(hSnapshot, &entry));
+        }
+        CloseHandle(hSnapshot);
+        return parents;
+    }
+
+    qint64 processStartedAt(DWORD pid){
+        HANDLE hProcess = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, pid);
+        if(hProcess == NULL){
+            return -1;
+        }
+        FILETIME creation, exitTime, kernelTime, userTime;
+        const BOOL ok = GetProcessTimes(hProcess, &creation, &exitTime, &kernelTime, &userTime);
+        CloseHandle(hProcess);
+        if(!ok){
+            return -1;
+        }
+
+        // Creation time is wall clock (100 ns units), so take the age against
+        // the wall clock and place it on the steady one
+        FILETIME now;
+        GetSystemTimePreciseAsFileTime(&now);
+        auto ticks = [](const FILETIME& time){
+            return (static_cast<qint64>(time.dwHighDateTime) << 32) | time.dwLowDateTime;
+        };
+        const qint64 ageNs = qMax<qint64>(0, ticks(now) - ticks(creation)) * 100;
+        return ScopedLatency::now() - ageNs;
+    }
+
+    ResourceUsage selfResourceUsage(){
+        ResourceUsage usage;
+        FILETIME creation, exitTime, kernelTime, userTime;
+        if(GetProcessTimes(GetCurrentProcess(), &creation, &exitTime, &kernelTime, &userTime)){
+            auto ticks = [](const FILETIME& time){
+                return (static_cast<qint64>(time.dwHighDateTime) << 32) | time.dwLowDateTime;
+            };
+            usage.cpuNs = (ticks(kernelTime) + ticks(userTime)) * 100;
+        }
+        PROCESS_MEMORY_COUNTERS counters;
+        if(GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))){
+            usage.rssBytes = static_cast<qint64>(counters.WorkingSetSize);
+        }
+        return usage;
+    }
+} // namespace ProcessUtils
+
+#else
+
+// Elsewhere the process list comes from /proc, so the monitor can run (and
+// be tested) headless on Linux
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace ProcessUtils{
+
+    namespace {
+
+        QSet<DWORD> runningPids(){
+            QSet<DWORD> pids;
+            const QStringList entries = QDir("/proc").entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+            for(const QString& entry : entries){
+                bool ok = false;
+                DWORD pid = entry.toUInt(&ok);
+                if(ok && pid != 0){
+                    pids.insert(pid);
+                }
+            }
+            return pids;
+        }
+
+        QString processName(DWORD pid){
+            // The executable's name, like GetModuleBaseNameW; comm (cut to
+            // 15 characters) when the link is not readable
+            const QString base = QString("/proc/%1/").arg(pid);
+            QString name = QFileInfo(QFileInfo(base + "exe").symLinkTarget()).fileName();
+            if(name.isEmpty()){
+                QFile comm(base + "comm");
+                if(comm.open(QIODevice::ReadOnly)){
+                    name = QString::fromUtf8(comm.readAll()).trimmed();
+                }
+            }
+            return name.toLower();
+        }
+
+    }
+
+    bool terminateProcess(DWORD pid) {
+        return kill(static_cast<pid_t>(pid), SIGKILL) == 0;
+    }
+
+    QHash<DWORD, QString> getActiveProcesses(){
+        QHash<DWORD, QString> processMap;
+        for(DWORD pid : runningPids()){
+            QString name = processName(pid);
+            if(!name.isEmpty()){
+                processMap.insert(pid, name);
+            }
+        }
+        return processMap;
+    }
+
+    void updateActiveProcessMap(QHash<DWORD, QString>& currentMap){
+        ScanMetrics& metrics = scanMetrics();
+        ScopedLatency timing(metrics.scanTime);
+        MF_TRACE_SPAN("enumerate processes");
+        const QSet<DWORD> currentPIDsSet = runningPids();
+        const SnapshotDiff diff = applySnapshot(currentMap, currentPIDsSet, [](DWORD pid){
+            MF_TRACE_SPAN("resolve name");
+            return processName(pid);
+        });
+        metrics.resolved.add(diff.resolved);
+        metrics.unresolved.add(diff.unresolved);
+    }
+
+    QHash<DWORD, DWORD> parentProcessIds(const QList<DWORD>& pids){
+        QHash<DWORD, DWORD> parents;
+        for(DWORD pid : pids){
+            // Fourth field of stat; the second (comm) is in parentheses and
+            // may itself contain spaces or ')', so count from the last ')'
+            QFile stat(QString("/proc/%1/stat").arg(pid));
+            if(!stat.open(QIODevice::ReadOnly)){
+                continue;
+            }
+            const QByteArray line = stat.readAll();
+            const QList<QByteArray> fields = line.mid(line.lastIndexOf(')') + 1).simplified().split(' ');
+            if(fields.size() > 1){
+                parents.insert(pid, fields[1].toUInt());
+            }
+        }
+        return parents;
+    }
+
+    qint64 processStartedAt(DWORD pid){
+#if defined(CLOCK_BOOTTIME)
+        // starttime, the 22nd field of stat, in clock ticks after boot (so
+        // only 10 ms resolution). Boot-relative like CLOCK_BOOTTIME, which
+        // gives the age to place on the steady clock.
+        QFile stat(QString("/proc/%1/stat").arg(pid));
+        if(!stat.open(QIODevice::ReadOnly)){
+            return -1;
+        }
+        const QByteArray line = stat.readAll();
+        const QList<QByteArray> fields = line.mid(line.lastIndexOf(')') + 1).simplified().split(' ');
+        const long ticksPerSecond = sysconf(_SC_CLK_TCK);
+        bool ok = false;
+        const qint64 ticks = fields.size() > 19 ? fields[19].toLongLong(&ok) : 0;
+        timespec boot;
+        if(!ok || ticksPerSecond <= 0 || clock_gettime(CLOCK_BOOTTIME, &boot) != 0){
+            return -1;
+        }
+        const qint64 startedNs = ticks / ticksPerSecond * 1000000000LL
+                               + ticks % ticksPerSecond * 1000000000LL / ticksPerSecond;
+        const qint64 bootNs = static_cast<qint64>(boot.tv_sec) * 1000000000LL + boot.tv_nsec;
+        return ScopedLatency::now() - qMax<qint64>(0, bootNs - startedNs);
+#else
+        Q_UNUSED(pid);
+        return -1;
+#endif
+    }
+
+    ResourceUsage selfResourceUsage(){
+        ResourceUsage usage;
+        timespec cpu;
+        if(clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &cpu) == 0){
+            usage.cpuNs = static_cast<qint64>(cpu.tv_sec) * 1000000000LL + cpu.tv_nsec;
+        }
+        // Second field of statm: resident pages
+        QFile statm("/proc/self/statm");
+        if(statm.open(QIODevice::ReadOnly)){
+            const QList<QByteArray> fields = statm.readAll().simplified().split(' ');
+            bool ok = false;
+            const qint64 pages = fields.size() > 1 ? fields[1].toLongLong(&ok) : 0;
+            if(ok){
+                usage.rssBytes = pages * sysconf(_SC_PAGESIZE);
             }
         }
+        return usage;
     }
-} // namespace ProcessUtils
\ No newline at end of file
+} // namespace ProcessUtils
+
+#endif
\ No newline at end of file
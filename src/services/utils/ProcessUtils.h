@@ -1,10 +1,12 @@
 #ifndef PROCESSUTILS_H
 #define PROCESSUTILS_H
 
-#include <windows.h> // For DWORD
+#include "services/utils/PlatformTypes.h" // For DWORD
 #include <QSet>
 #include <QString>
 #include <QHash>
+#include <QList>
+#include <utility>
 
 namespace ProcessUtils
 {
@@ -13,6 +15,60 @@ namespace ProcessUtils
     QHash<DWORD, QString> getActiveProcesses();
 
     void updateActiveProcessMap(QHash<DWORD, QString>& currentMap);
+
+    struct SnapshotDiff {
+        quint64 resolved = 0;       // New pids added to the map
+        quint64 unresolved = 0;     // New pids whose name came back empty
+    };
+
+    // The platform-independent half of updateActiveProcessMap(): drops pids
+    // that are no longer running and adds new ones under resolveName(pid),
+    // unless that is empty. Separate so it can run on synthetic snapshots.
+    template<typename ResolveName>
+    SnapshotDiff applySnapshot(QHash<DWORD, QString>& currentMap, const QSet<DWORD>& runningPids,
+                               ResolveName&& resolveName)
+    {
+        SnapshotDiff diff;
+
+        // Closed: in our map, but not in the snapshot
+        auto it = currentMap.begin();
+        while(it != currentMap.end()){
+            if(!runningPids.contains(it.key())){
+                it = currentMap.erase(it);
+            } else{
+                ++it;
+            }
+        }
+
+        // New: in the snapshot, but not in our map
+        for(DWORD pid : runningPids){
+            if(!currentMap.contains(pid)){
+                QString name = resolveName(pid);
+                if(!name.isEmpty()){
+                    currentMap.insert(pid, std::move(name));
+                    ++diff.resolved;
+                } else{
+                    ++diff.unresolved;
+                }
+            }
+        }
+        return diff;
+    }
+
+    // Parent pid of each of pids; exited processes are left out
+    QHash<DWORD, DWORD> parentProcessIds(const QList<DWORD>& pids);
+
+    // When the kernel started pid, on the ScopedLatency::now() clock; -1 if
+    // it has exited or cannot be queried
+    qint64 processStartedAt(DWORD pid);
+
+    struct ResourceUsage {
+        qint64 cpuNs = -1;          // User and kernel CPU time so far, -1 if unknown
+        qint64 rssBytes = -1;       // Resident set (working set on Windows), -1 if unknown
+    };
+
+    // What this process has used, for the resource watchdog
+    ResourceUsage selfResourceUsage();
 }
 
 #endif // PROCESSUTILS_H
\ No newline at end of file
@@ -1,13 +1,13 @@
 #include "CategorizeDialog.h"
 #include "ApplicationRepository.h"
 #include "Application.h"
+#include "EventLogger.h"
 
 #include <QLabel>
 #include <QComboBox>
 #include <QPushButton>
 #include <QVBoxLayout>
 #include <QDialogButtonBox>
-#include <QDebug>
 
 CategorizeDialog::CategorizeDialog(const QString& processName, ApplicationRepository* appRepo, QWidget *parent)
     : QDialog(parent),
@@ -22,7 +22,7 @@ CategorizeDialog::CategorizeDialog(const QString& processName, ApplicationReposi
     m_application = m_appRepository->findOrCreate(processName);
 
     if (!m_application) {
-        qWarning() << "CategorizeDialog: Could not find or create Application object for" << processName;
+        MF_LOG_WARNING(Ui, "CategorizeDialog: Could not find or create Application object for %1", processName);
         // Don't create the dialog if the app object is null
         reject(); // Close immediately
         return;
@@ -85,7 +85,7 @@ void CategorizeDialog::onSave()
         // (We assume the repo has a method to save a single app)
         m_appRepository->save(m_application);
         
-        qDebug() << "Categorized" << m_application->getProcessName() << "as" << Application::categoryToString(selectedCategory);
+        MF_LOG_DEBUG(Ui, "Categorized %1 as %2", m_application->getProcessName(), Application::categoryToString(selectedCategory));
     }
 
     // 4. Close the dialog
@@ -5,11 +5,7 @@
 #include <QVBoxLayout>
 #include <QListWidgetItem>
 
-ConfigWindow::ConfigWindow(
-    QList<Application*>& games, 
-    QList<Application*>& otherApps, 
-    QWidget *parent
-)
+ConfigWindow::ConfigWindow(QWidget *parent)
     : QWidget(parent),
       m_gameListWidget(nullptr),
       m_appListWidget(nullptr),
@@ -43,12 +39,8 @@ ConfigWindow::ConfigWindow(
     mainLayout->addWidget(m_gameBox);
     mainLayout->addWidget(m_appBox);
 
-    // --- 3. Populate Lists with Data ---
-    // Call the helper function to fill the two list widgets
-    populateList(m_gameListWidget, games);
-    populateList(m_appListWidget, otherApps);
-
-    // --- 4. Set Window Properties ---
+    // --- 3. Set Window Properties ---
+    // The owner fills the lists through addGame() / addOtherApplication()
     setLayout(mainLayout);
     setWindowTitle("Mindfulness - Application Configuration");
     resize(500, 600); // Set a reasonable default size
@@ -60,47 +52,48 @@ ConfigWindow::~ConfigWindow()
     // automatically deleted by Qt. No manual cleanup needed.
 }
 
+void ConfigWindow::addGame(const Application& app)
+{
+    addItem(m_gameListWidget, app);
+}
+
+void ConfigWindow::addOtherApplication(const Application& app)
+{
+    addItem(m_appListWidget, app);
+}
+
 /**
- * @brief Private helper to populate a QListWidget with Application data.
+ * @brief Private helper to append one Application to a QListWidget.
  */
-void ConfigWindow::populateList(
-    QListWidget* listWidget, 
-    QList<Application*>& applications
-)
+void ConfigWindow::addItem(QListWidget* listWidget, const Application& app)
 {
-    listWidget->clear();
-
-    for (const Application* appPtr : applications) 
-    {
-        auto app = *appPtr;
-        // Use the Display Name, but fall back to the process name
-        QString displayName = app.getDisplayName();
-        if (displayName.isEmpty()) {
-            displayName = app.getProcessName();
-        }
-
-        // Create the list item
-        QListWidgetItem* item = new QListWidgetItem(displayName);
-
-        // Add a detailed tooltip with stats from the Application object
-        QString tooltip = QString(
-            "Process: %1\n"
-            "Category: %2\n"
-            "Total Use: %3 minutes (%4 sessions)\n"
-            "First Seen: %5"
-        )
-        .arg(app.getProcessName())
-        .arg(Application::categoryToString(app.getCategory()))
-        .arg(app.getTotalMinutesUsed())
-        .arg(app.getTotalSessions())
-        .arg(app.getFirstSeen().toString(Qt::ISODate));
-        
-        item->setToolTip(tooltip);
-
-        // Per the "passive component" requirement, items are read-only.
-        // We ensure the checkable flag is OFF.
-        item->setFlags(item->flags() & ~Qt::ItemIsUserCheckable);
-
-        listWidget->addItem(item);
+    // Use the Display Name, but fall back to the process name
+    QString displayName = app.getDisplayName();
+    if (displayName.isEmpty()) {
+        displayName = app.getProcessName();
     }
+
+    // Create the list item
+    QListWidgetItem* item = new QListWidgetItem(displayName);
+
+    // Add a detailed tooltip with stats from the Application object
+    QString tooltip = QString(
+        "Process: %1\n"
+        "Category: %2\n"
+        "Total Use: %3 minutes (%4 sessions)\n"
+        "First Seen: %5"
+    )
+    .arg(app.getProcessName())
+    .arg(Application::categoryToString(app.getCategory()))
+    .arg(app.getTotalMinutesUsed())
+    .arg(app.getTotalSessions())
+    .arg(app.getFirstSeen().toString(Qt::ISODate));
+    
+    item->setToolTip(tooltip);
+
+    // Per the "passive component" requirement, items are read-only.
+    // We ensure the checkable flag is OFF.
+    item->setFlags(item->flags() & ~Qt::ItemIsUserCheckable);
+
+    listWidget->addItem(item);
 }
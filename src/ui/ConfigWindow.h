@@ -2,7 +2,6 @@
 #define CONFIGWINDOW_H
 
 #include <QWidget>
-#include <QList>
 #include "Application.h" // Include the new domain entity
 
 // Forward declarations for UI elements
@@ -14,8 +13,9 @@ class QGroupBox;
  * @brief A passive presentation window that displays lists of categorized applications.
  *
  * This window is a "dumb" component. It does not fetch, scan, or save
- * any data. It simply displays the two lists of Application objects
- * that it is given in its constructor.
+ * any data. It simply displays the Application objects that its owner
+ * hands to addGame() and addOtherApplication(), typically straight from
+ * an ApplicationRepository::forEach() walk.
  */
 class ConfigWindow : public QWidget
 {
@@ -23,26 +23,32 @@ class ConfigWindow : public QWidget
 
 public:
     /**
-     * @brief Constructs the configuration window.
-     * @param games A list of Applications categorized as "Game" or "Leisure".
-     * @param otherApps A list of all other categorized Applications (Work, Util, etc.).
+     * @brief Constructs the (empty) configuration window.
      * @param parent The parent widget.
      */
-    explicit ConfigWindow(
-        QList<Application*>& games, 
-        QList<Application*>& otherApps, 
-        QWidget *parent = nullptr
-    );
+    explicit ConfigWindow(QWidget *parent = nullptr);
     
     ~ConfigWindow();
 
+    /**
+     * @brief Adds an Application categorized as "Game" or "Leisure".
+     * @param app The application to display. Only read during the call.
+     */
+    void addGame(const Application& app);
+
+    /**
+     * @brief Adds an Application of any other category (Work, Util, etc.).
+     * @param app The application to display. Only read during the call.
+     */
+    void addOtherApplication(const Application& app);
+
 private:
     /**
-     * @brief Private helper to populate a QListWidget with Application data.
+     * @brief Private helper to append one Application to a QListWidget.
      * @param listWidget The UI widget to fill.
-     * @param applications The list of Application objects to display.
+     * @param app The Application to display (read in place, not copied).
      */
-    void populateList(QListWidget* listWidget, QList<Application*>& applications);
+    void addItem(QListWidget* listWidget, const Application& app);
 
     // --- UI Elements ---
     QListWidget* m_gameListWidget;
@@ -0,0 +1,249 @@
+#include <QtTest/QtTest>
+#include "domain/Application.h"
+#include "repositories/ApplicationCodecs.h"
+#include "repositories/JsonReader.h"
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <vector>
+
+/**
+ * @class BenchApplicationCodecs
+ * @brief Round-trip checks and throughput for every Application codec.
+ *
+ * The codecs compared are:
+ * 1. "QJsonObject" - Application::toJson/fromJson through QJsonDocument,
+ *    the path load/saveAll used before the generated codecs.
+ * 2. "json"   - ApplicationJsonCodec (generated from ApplicationFields).
+ * 3. "cbor"   - ApplicationCborCodec.
+ * 4. "binary" - ApplicationBinaryCodec.
+ *
+ * Each codec encodes and decodes the same APP_COUNT applications. The
+ * round-trip test requires every decoded record to match its source field
+ * for field; the benchmarks time one full encode or decode pass and report
+ * MB/s and records/s with qInfo().
+ */
+class BenchApplicationCodecs : public QObject
+{
+    Q_OBJECT
+
+private:
+    static constexpr int APP_COUNT = 20000;
+
+    enum Codec {
+        QJsonObjectCodec,
+        JsonCodec,
+        CborCodec,
+        BinaryCodec
+    };
+
+    std::vector<Application> m_apps;
+
+    static QByteArray encodeAll(Codec codec, const std::vector<Application>& apps)
+    {
+        QByteArray out;
+        switch (codec) {
+            case QJsonObjectCodec: {
+                QJsonArray array;
+                for (const Application& app : apps) {
+                    array.append(app.toJson());
+                }
+                out = QJsonDocument(array).toJson(QJsonDocument::Compact);
+                break;
+            }
+            case JsonCodec: {
+                ApplicationJsonCodec json;
+                out.append('[');
+                for (const Application& app : apps) {
+                    if (out.size() > 1) {
+                        out.append(',');
+                    }
+                    json.encode(app, out);
+                }
+                out.append(']');
+                break;
+            }
+            case CborCodec: {
+                ApplicationCborCodec cbor;
+                for (const Application& app : apps) {
+                    cbor.encode(app, out);
+                }
+                break;
+            }
+            case BinaryCodec: {
+                ApplicationBinaryCodec binary;
+                ApplicationBinaryCodec::encodeHeader(out, static_cast<quint32>(apps.size()));
+                for (const Application& app : apps) {
+                    binary.encode(app, out);
+                }
+                break;
+            }
+        }
+        return out;
+    }
+
+    static bool decodeAll(Codec codec, const QByteArray& data, std::vector<Application>& apps)
+    {
+        apps.clear();
+        const char* pos = data.constData();
+        const char* end = pos + data.size();
+
+        switch (codec) {
+            case QJsonObjectCodec: {
+                QJsonDocument doc = QJsonDocument::fromJson(data);
+                for (const QJsonValue& value : doc.array()) {
+                    apps.push_back(Application::fromJson(value.toObject()));
+                }
+                return doc.isArray();
+            }
+            case JsonCodec: {
+                ApplicationJsonCodec json;
+                JsonReader reader(data);
+                Application app;
+                reader.expect('[');
+                while (!reader.consume(']')) {
+                    if (!json.decode(reader, app)) {
+                        return false;
+                    }
+                    apps.push_back(app);
+                    reader.skipComma();
+                }
+                return !reader.failed();
+            }
+            case CborCodec: {
+                ApplicationCborCodec cbor;
+                Application app;
+                while (pos < end) {
+                    if (!cbor.decode(pos, end, app)) {
+                        return false;
+                    }
+                    apps.push_back(app);
+                }
+                return true;
+            }
+            case BinaryCodec: {
+                ApplicationBinaryCodec binary;
+                Application app;
+                quint32 count;
+                if (!ApplicationBinaryCodec::decodeHeader(pos, end, count)) {
+                    return false;
+                }
+                for (quint32 i = 0; i < count; ++i) {
+                    if (!binary.decode(pos, end, app)) {
+                        return false;
+                    }
+                    apps.push_back(app);
+                }
+                return pos == end;
+            }
+        }
+        return false;
+    }
+
+    static void addCodecRows()
+    {
+        QTest::addColumn<int>("codec");
+        QTest::newRow("QJsonObject") << static_cast<int>(QJsonObjectCodec);
+        QTest::newRow("json") << static_cast<int>(JsonCodec);
+        QTest::newRow("cbor") << static_cast<int>(CborCodec);
+        QTest::newRow("binary") << static_cast<int>(BinaryCodec);
+    }
+
+    static void report(const char* what, qint64 bytes, qint64 nsecs)
+    {
+        double secs = qMax<qint64>(1, nsecs) / 1e9;
+        qInfo().noquote() << what << QTest::currentDataTag() << ":"
+                          << QString::number(bytes / secs / (1024 * 1024), 'f', 1) << "MB/s,"
+                          << QString::number(APP_COUNT / secs, 'f', 0) << "records/s,"
+                          << bytes << "bytes";
+    }
+
+private slots:
+    void initTestCase() {
+        QDateTime now = QDateTime::currentDateTimeUtc();
+        m_apps.reserve(APP_COUNT);
+        for (int i = 0; i < APP_COUNT; ++i) {
+            QJsonObject json;
+            json["processName"] = QString("app%1.exe").arg(i);
+            json["displayName"] = (i % 7 == 0) ? QString("Café \"%1\"").arg(i) : QString("App %1").arg(i);
+            json["category"] = Application::categoryToString(
+                static_cast<Application::Category>(i % Application::CATEGORY_COUNT));
+            json["firstSeen"] = now.addDays(-(i % 1000)).toString(Qt::ISODate);
+            json["lastSeen"] = now.addSecs(-i).toString(Qt::ISODate);
+            json["totalSessions"] = i % 500;
+            json["totalMinutesUsed"] = i * 3;
+            json["longestSession"] = i % 240;
+            json["customTimeLimit"] = (i % 5 == 0) ? 90 : -1;
+            json["warningStrategy"] = i % 4;
+            json["requiresPrompt"] = (i % 3 != 0);
+            SessionLengthSketch lengths;
+            for (int s = 0; s < i % 40; ++s) {
+                lengths.add(5 + (i * 7 + s * 13) % 180);
+            }
+            json["sessionLengths"] = QString::fromLatin1(lengths.toBytes().toBase64());
+            m_apps.push_back(Application::fromJson(json));
+        }
+    }
+
+    void test_roundTrip_data() {
+        addCodecRows();
+    }
+
+    void test_roundTrip() {
+        QFETCH(int, codec);
+
+        QByteArray encoded = encodeAll(static_cast<Codec>(codec), m_apps);
+        std::vector<Application> decoded;
+        QVERIFY(decodeAll(static_cast<Codec>(codec), encoded, decoded));
+        QCOMPARE(decoded.size(), m_apps.size());
+
+        for (std::size_t i = 0; i < m_apps.size(); ++i) {
+            QCOMPARE(decoded[i].toJson(), m_apps[i].toJson());
+        }
+    }
+
+    void bench_encode_data() {
+        addCodecRows();
+    }
+
+    void bench_encode() {
+        QFETCH(int, codec);
+
+        QByteArray encoded;
+        QElapsedTimer timer;
+        qint64 nsecs = 0;
+        QBENCHMARK {
+            timer.start();
+            encoded = encodeAll(static_cast<Codec>(codec), m_apps);
+            nsecs = timer.nsecsElapsed();
+        }
+        report("encode", encoded.size(), nsecs);
+    }
+
+    void bench_decode_data() {
+        addCodecRows();
+    }
+
+    void bench_decode() {
+        QFETCH(int, codec);
+
+        QByteArray encoded = encodeAll(static_cast<Codec>(codec), m_apps);
+        std::vector<Application> decoded;
+        decoded.reserve(APP_COUNT);
+
+        QElapsedTimer timer;
+        qint64 nsecs = 0;
+        QBENCHMARK {
+            timer.start();
+            decodeAll(static_cast<Codec>(codec), encoded, decoded);
+            nsecs = timer.nsecsElapsed();
+        }
+        QCOMPARE(static_cast<int>(decoded.size()), APP_COUNT);
+        report("decode", encoded.size(), nsecs);
+    }
+};
+
+QTEST_MAIN(BenchApplicationCodecs)
+#include "bench_ApplicationCodecs.moc"
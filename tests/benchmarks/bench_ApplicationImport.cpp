@@ -0,0 +1,135 @@
+#include <QtTest/QtTest>
+#include "domain/Application.h"
+#include "repositories/ApplicationCodecs.h"
+#include "repositories/ApplicationImporter.h"
+#include <QBuffer>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include <QThread>
+
+/**
+ * @class BenchApplicationImport
+ * @brief Throughput and scaling of the streaming applications.json importer.
+ *
+ * A document in the repository's file layout is generated once in memory
+ * (APP_COUNT applications, roughly 50 MB) and imported through a QBuffer, so
+ * the numbers measure scanning and decoding rather than disk speed.
+ *
+ * 1. test_import_matches_input - chunk boundaries must not lose, duplicate
+ *    or reorder records, for tiny and default chunk sizes.
+ * 2. bench_import_threads - import with 1, 2, 4, ... up to
+ *    QThread::idealThreadCount() workers; reports MB/s and the speedup
+ *    over one worker. With a fixed chunk size, memory held for undecoded
+ *    input stays near 2 * workers * chunk size regardless of file size.
+ */
+class BenchApplicationImport : public QObject
+{
+    Q_OBJECT
+
+private:
+    static constexpr int APP_COUNT = 200000;
+
+    QByteArray m_document;
+    double m_singleThreadMBps = 0;
+
+    static QByteArray buildDocument(int count)
+    {
+        QDateTime now = QDateTime::currentDateTimeUtc();
+        ApplicationJsonCodec codec;
+        QByteArray out = "{\n    \"version\": 1,\n    \"lastModified\": \"";
+        out.append(now.toString(Qt::ISODate).toUtf8());
+        out.append("\",\n    \"applications\": [\n");
+        for (int i = 0; i < count; ++i) {
+            QJsonObject json;
+            json["processName"] = QString("import%1.exe").arg(i);
+            json["displayName"] = QString("Imported \"%1\"").arg(i);
+            json["category"] = Application::categoryToString(
+                static_cast<Application::Category>(i % Application::CATEGORY_COUNT));
+            json["firstSeen"] = now.addDays(-(i % 1000)).toString(Qt::ISODate);
+            json["lastSeen"] = now.addSecs(-i).toString(Qt::ISODate);
+            json["totalSessions"] = i % 500;
+            json["totalMinutesUsed"] = i * 3;
+
+            out.append("        ");
+            codec.encode(Application::fromJson(json), out);
+            out.append(i + 1 < count ? ",\n" : "\n");
+        }
+        out.append("    ]\n}\n");
+        return out;
+    }
+
+    static bool importBuffer(const QByteArray& document, ApplicationImporter& importer)
+    {
+        QBuffer buffer;
+        buffer.setData(document);
+        buffer.open(QIODevice::ReadOnly);
+        return importer.importDevice(buffer);
+    }
+
+private slots:
+    void initTestCase() {
+        m_document = buildDocument(APP_COUNT);
+        qInfo() << "Document:" << m_document.size() / (1024 * 1024) << "MB," << APP_COUNT << "applications";
+    }
+
+    void test_import_matches_input_data() {
+        QTest::addColumn<int>("chunkBytes");
+        QTest::newRow("1 KB chunks") << 1024;
+        QTest::newRow("default chunks") << static_cast<int>(ApplicationImporter::DEFAULT_CHUNK_BYTES);
+    }
+
+    void test_import_matches_input() {
+        QFETCH(int, chunkBytes);
+
+        const int count = 20000;
+        ApplicationImporter importer(chunkBytes);
+        QVERIFY(importBuffer(buildDocument(count), importer));
+        QCOMPARE(importer.count(), count);
+        QVERIFY(importer.chunkCount() > 1);
+
+        int expected = 0;
+        bool inOrder = true;
+        importer.forEach([&](const Application& app) {
+            inOrder = inOrder && app.getProcessName() == QString("import%1.exe").arg(expected);
+            ++expected;
+        });
+        QVERIFY(inOrder);
+    }
+
+    void bench_import_threads_data() {
+        QTest::addColumn<int>("threads");
+        for (int threads = 1; threads < QThread::idealThreadCount(); threads *= 2) {
+            QTest::newRow(qPrintable(QString("%1 threads").arg(threads))) << threads;
+        }
+        QTest::newRow(qPrintable(QString("%1 threads").arg(QThread::idealThreadCount())))
+            << QThread::idealThreadCount();
+    }
+
+    void bench_import_threads() {
+        QFETCH(int, threads);
+
+        ApplicationImporter importer(ApplicationImporter::DEFAULT_CHUNK_BYTES, threads);
+        QElapsedTimer timer;
+        qint64 nsecs = 0;
+        bool ok = false;
+        QBENCHMARK {
+            timer.start();
+            ok = importBuffer(m_document, importer);
+            nsecs = timer.nsecsElapsed();
+        }
+        QVERIFY(ok);
+        QCOMPARE(importer.count(), APP_COUNT);
+
+        double mbps = m_document.size() / (qMax<qint64>(1, nsecs) / 1e9) / (1024 * 1024);
+        if (threads == 1) {
+            m_singleThreadMBps = mbps;
+        }
+        qInfo().noquote() << threads << "threads:" << QString::number(mbps, 'f', 1) << "MB/s,"
+                          << importer.chunkCount() << "chunks, speedup"
+                          << QString::number(m_singleThreadMBps > 0 ? mbps / m_singleThreadMBps : 0, 'f', 2);
+    }
+};
+
+QTEST_MAIN(BenchApplicationImport)
+#include "bench_ApplicationImport.moc"
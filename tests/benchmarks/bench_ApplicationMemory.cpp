@@ -0,0 +1,145 @@
+#include <QtTest/QtTest>
+#include "repositories/ApplicationRepository.h"
+#include "domain/Application.h"
+#include "domain/StringPool.h"
+#include <QTemporaryDir>
+#include <QHash>
+#include <QDateTime>
+#include <memory>
+
+#if defined(Q_OS_WIN)
+#include <windows.h>
+#include <psapi.h>
+#elif defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+/**
+ * @class BenchApplicationMemory
+ * @brief Reports memory per application for a 1M entry catalog.
+ *
+ * Three layouts are measured with the same names:
+ * 1. The previous Application layout (two QStrings, two QDateTimes, ints,
+ *    bool) behind a shared_ptr in a QHash - the "before" number.
+ * 2. The compact Application in the same container, which isolates the
+ *    record layout change.
+ * 3. A full ApplicationRepository, which adds the secondary indexes and
+ *    the published snapshot on top of (2).
+ *
+ * Results are printed with qInfo() and reported as the benchmark result
+ * (bytes per application).
+ */
+class BenchApplicationMemory : public QObject
+{
+    Q_OBJECT
+
+private:
+    static constexpr int APP_COUNT = 1000000;
+
+    /**
+     * @brief Field-for-field copy of the previous Application layout
+     */
+    struct LegacyApplication {
+        QString processName;
+        QString displayName;
+        Application::Category category;
+        QDateTime firstSeen;
+        QDateTime lastSeen;
+        int totalSessions;
+        int totalMinutesUsed;
+        int longestSession;
+        int customTimeLimit;
+        Application::WarningStrategy warningStrategy;
+        bool requiresPrompt;
+    };
+
+    static qint64 heapInUse() {
+#if defined(Q_OS_WIN)
+        PROCESS_MEMORY_COUNTERS_EX counters;
+        GetProcessMemoryInfo(GetCurrentProcess(),
+                             reinterpret_cast<PROCESS_MEMORY_COUNTERS*>(&counters),
+                             sizeof(counters));
+        return static_cast<qint64>(counters.PrivateUsage);
+#elif defined(__GLIBC__)
+        struct mallinfo2 info = mallinfo2();
+        return static_cast<qint64>(info.uordblks + info.hblkhd);
+#else
+        return -1;
+#endif
+    }
+
+    static QString nameFor(int i) {
+        return QString("Application%1.exe").arg(i);
+    }
+
+    void report(const char* label, qint64 bytes) {
+        double perApp = static_cast<double>(bytes) / APP_COUNT;
+        qInfo().noquote() << label << ":" << QString::number(perApp, 'f', 1)
+                          << "bytes/application at" << APP_COUNT << "entries";
+        QTest::setBenchmarkResult(perApp, QTest::BytesAllocated);
+    }
+
+private slots:
+    void initTestCase() {
+        if (heapInUse() < 0) {
+            QSKIP("No heap statistics on this platform");
+        }
+        qInfo() << "sizeof(Application) =" << sizeof(Application)
+                << "| sizeof(previous layout) =" << sizeof(LegacyApplication);
+    }
+
+    void bench_previousLayout() {
+        qint64 before = heapInUse();
+        {
+            QHash<QString, std::shared_ptr<LegacyApplication>> applications;
+            QDateTime now = QDateTime::currentDateTime();
+            for (int i = 0; i < APP_COUNT; ++i) {
+                QString name = nameFor(i);
+                auto app = std::make_unique<LegacyApplication>(LegacyApplication{
+                    name.toLower(), name, Application::Category::Uncategorized,
+                    now, now, 0, 0, 0, -1, Application::WarningStrategy::Standard, true
+                });
+                applications[name.toLower()] = std::move(app);
+            }
+            report("previous layout", heapInUse() - before);
+        }
+    }
+
+    void bench_compactLayout() {
+        qint64 before = heapInUse();
+        {
+            QHash<QString, std::shared_ptr<Application>> applications;
+            for (int i = 0; i < APP_COUNT; ++i) {
+                QString name = nameFor(i);
+                auto app = std::make_unique<Application>(name);
+                QString key = app->getProcessName();
+                applications[key] = std::move(app);
+            }
+            // Pooled names stay resident; include them so the comparison is fair
+            report("compact layout", heapInUse() - before);
+        }
+    }
+
+    void bench_fullRepository() {
+        QTemporaryDir tempDir;
+        QVERIFY(tempDir.isValid());
+
+        qint64 before = heapInUse();
+        {
+            ApplicationRepository repo(tempDir.filePath("bench_memory.json"));
+            {
+                ApplicationRepository::BatchUpdate batch(&repo);
+                for (int i = 0; i < APP_COUNT; ++i) {
+                    repo.findOrCreate(nameFor(i));
+                }
+            }
+            // Names were already pooled by bench_compactLayout, so this
+            // delta is the repository structures alone
+            report("repository incl. indexes and snapshot", heapInUse() - before);
+            repo.clear();
+        }
+    }
+};
+
+QTEST_MAIN(BenchApplicationMemory)
+#include "bench_ApplicationMemory.moc"
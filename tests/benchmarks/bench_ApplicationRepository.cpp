@@ -0,0 +1,156 @@
+#include <QtTest/QtTest>
+#include "repositories/ApplicationRepository.h"
+#include "domain/Application.h"
+#include <QTemporaryDir>
+#include <QJsonObject>
+#include <QDateTime>
+#include <memory>
+
+/**
+ * @class BenchApplicationRepository
+ * @brief Benchmarks for ApplicationRepository queries at catalog scale.
+ *
+ * The repository is filled once with APP_COUNT applications spread over
+ * all categories, with lastSeen spread over the past year and session
+ * counts spread over 0-99. Each benchmark then measures a single query
+ * or entity change against that data set.
+ */
+class BenchApplicationRepository : public QObject
+{
+    Q_OBJECT
+
+private:
+    static constexpr int APP_COUNT = 100000;
+
+    QTemporaryDir m_tempDir;
+    std::unique_ptr<ApplicationRepository> m_repo;
+
+private slots:
+    void initTestCase() {
+        QVERIFY(m_tempDir.isValid());
+        m_repo = std::make_unique<ApplicationRepository>(m_tempDir.filePath("bench_apps.json"));
+
+        QDateTime now = QDateTime::currentDateTime();
+        for (int i = 0; i < APP_COUNT; ++i) {
+            QJsonObject json;
+            json["processName"] = QString("app%1.exe").arg(i);
+            json["displayName"] = QString("App %1").arg(i);
+            // 1% games, the rest spread over the remaining categories
+            Application::Category category = (i % 100 == 0)
+                ? Application::Category::Game
+                : static_cast<Application::Category>(2 + i % (Application::CATEGORY_COUNT - 2));
+            json["category"] = Application::categoryToString(category);
+            json["firstSeen"] = now.addDays(-365).toString(Qt::ISODate);
+            json["lastSeen"] = now.addSecs(-static_cast<qint64>(i % 365) * 86400 - i).toString(Qt::ISODate);
+            json["totalSessions"] = i % 100;
+
+            Application app = Application::fromJson(json);
+            m_repo->save(&app);
+        }
+        QCOMPARE(m_repo->count(), APP_COUNT);
+    }
+
+    void cleanupTestCase() {
+        // Don't spend the teardown writing 100k records back to disk
+        m_repo->clear();
+        m_repo.reset();
+    }
+
+    // --- Category Queries ---
+
+    void bench_findByCategory_small() {
+        QBENCHMARK {
+            QList<Application*> games = m_repo->findByCategory(Application::Category::Game);
+            Q_UNUSED(games);
+        }
+    }
+
+    void bench_findByCategory_large() {
+        QBENCHMARK {
+            QList<Application*> work = m_repo->findByCategory(Application::Category::Work);
+            Q_UNUSED(work);
+        }
+    }
+
+    /**
+     * @brief The split the config window used to do by hand, for comparison.
+     */
+    void bench_fullScanCategorySplit() {
+        QBENCHMARK {
+            QList<Application*> gameApps;
+            for (Application* app : m_repo->findAll()) {
+                if (app->getCategory() == Application::Category::Game) {
+                    gameApps.append(app);
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief The same bucket walked in place, without building a list.
+     */
+    void bench_forEach_categorySmall() {
+        ApplicationQuery games = ApplicationQuery().inCategories({Application::Category::Game});
+        QBENCHMARK {
+            int minutes = 0;
+            m_repo->forEach(games, [&minutes](const Application& app) {
+                minutes += app.getTotalMinutesUsed();
+            });
+            Q_UNUSED(minutes);
+        }
+    }
+
+    /**
+     * @brief Category AND lastSeen window AND session threshold.
+     */
+    void bench_forEach_composedFilter() {
+        qint64 cutoff = QDateTime::currentSecsSinceEpoch() - 30 * 86400;
+        ApplicationQuery query = ApplicationQuery()
+            .excludingCategories({Application::Category::Game})
+            .seenSince(cutoff)
+            .withMinSessions(50);
+        QBENCHMARK {
+            int matches = m_repo->count(query);
+            Q_UNUSED(matches);
+        }
+    }
+
+    // --- Top-N Queries ---
+
+    void bench_findRecentlyUsed_top10() {
+        QBENCHMARK {
+            QList<Application*> recent = m_repo->findRecentlyUsed(7, 10);
+            Q_UNUSED(recent);
+        }
+    }
+
+    void bench_findFrequentlyUsed_top10() {
+        QBENCHMARK {
+            QList<Application*> frequent = m_repo->findFrequentlyUsed(50, 10);
+            Q_UNUSED(frequent);
+        }
+    }
+
+    // --- Index Maintenance ---
+
+    void bench_setCategory_reindex() {
+        Application* app = m_repo->find("app1.exe");
+        QVERIFY(app != nullptr);
+        bool toggle = false;
+        QBENCHMARK {
+            app->setCategory(toggle ? Application::Category::Work : Application::Category::Social);
+            toggle = !toggle;
+        }
+    }
+
+    void bench_recordSessionStart_reindex() {
+        Application* app = m_repo->find("app2.exe");
+        QVERIFY(app != nullptr);
+        QBENCHMARK {
+            app->recordSessionStart();
+        }
+    }
+};
+
+QTEST_MAIN(BenchApplicationRepository)
+#include "bench_ApplicationRepository.moc"
@@ -0,0 +1,99 @@
+#include <QtTest/QtTest>
+#include "services/infrastructure/DeadlineScheduler.h"
+#include <QRandomGenerator>
+
+/**
+ * @class BenchDeadlineScheduler
+ * @brief Scheduling cost and wakeup count of DeadlineScheduler.
+ *
+ * Each session registers the deadlines GameSession does: three warnings
+ * and the time limit. The first benchmarks schedule and cancel them for
+ * SESSION_COUNT sessions at once, which should cost the same per session
+ * however many are pending. The last one drives a simulated day through
+ * advanceTo() and compares the number of passes the wheel needs with the
+ * 86,400 wakeups a one-second countdown per session would cost.
+ */
+class BenchDeadlineScheduler : public QObject
+{
+    Q_OBJECT
+
+private:
+    static constexpr int SESSION_COUNT = 100000;
+    static constexpr qint64 MINUTE = 60000;
+    static constexpr qint64 DAY = 24 * 60 * MINUTE;
+
+    static void scheduleSession(DeadlineScheduler& scheduler, qint64 start, int minutes,
+                                QList<DeadlineScheduler::Handle>& handles, int& events)
+    {
+        const qint64 end = start + minutes * MINUTE;
+        for (int warning : {15, 10, 5}) {
+            if (warning < minutes) {
+                handles.append(scheduler.schedule(end - warning * MINUTE, [&events]() { ++events; }));
+            }
+        }
+        handles.append(scheduler.schedule(end, [&events]() { ++events; }));
+    }
+
+private slots:
+    void bench_schedule() {
+        QRandomGenerator random(42);
+        int events = 0;
+        QBENCHMARK {
+            DeadlineScheduler scheduler;
+            QList<DeadlineScheduler::Handle> handles;
+            handles.reserve(SESSION_COUNT * 4);
+            for (int i = 0; i < SESSION_COUNT; ++i) {
+                scheduleSession(scheduler, scheduler.now(), 20 + random.bounded(160), handles, events);
+            }
+            QCOMPARE(scheduler.pendingCount(), handles.size());
+        }
+    }
+
+    void bench_schedule_cancel() {
+        QRandomGenerator random(42);
+        int events = 0;
+        QBENCHMARK {
+            DeadlineScheduler scheduler;
+            QList<DeadlineScheduler::Handle> handles;
+            handles.reserve(SESSION_COUNT * 4);
+            for (int i = 0; i < SESSION_COUNT; ++i) {
+                scheduleSession(scheduler, scheduler.now(), 20 + random.bounded(160), handles, events);
+            }
+            for (DeadlineScheduler::Handle handle : handles) {
+                scheduler.cancel(handle);
+            }
+            QCOMPARE(scheduler.pendingCount(), 0);
+        }
+    }
+
+    void bench_simulated_day() {
+        // 200 sessions of 20 minutes to 3 hours, started at random times
+        QRandomGenerator random(7);
+        DeadlineScheduler scheduler;
+        QList<DeadlineScheduler::Handle> handles;
+        int events = 0;
+        const qint64 base = scheduler.now();
+        for (int i = 0; i < 200; ++i) {
+            scheduleSession(scheduler, base + random.bounded(DAY - 3 * 60 * MINUTE),
+                            20 + random.bounded(160), handles, events);
+        }
+
+        int passes = 0;
+        QElapsedTimer timer;
+        timer.start();
+        for (qint64 next = scheduler.nextDeadline(); next >= 0; next = scheduler.nextDeadline()) {
+            scheduler.advanceTo(next);
+            ++passes;
+        }
+        const qint64 elapsed = timer.nsecsElapsed();
+
+        QCOMPARE(events, handles.size());
+        QVERIFY(passes <= events);
+        qInfo() << events << "deadlines in" << passes << "passes,"
+                << elapsed / 1000 << "us; per-second countdowns would wake"
+                << 86400 << "times per session";
+    }
+};
+
+QTEST_MAIN(BenchDeadlineScheduler)
+#include "bench_DeadlineScheduler.moc"
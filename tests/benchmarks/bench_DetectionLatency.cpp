@@ -0,0 +1,159 @@
+#include <QtTest/QtTest>
+#include "services/infrastructure/ProcessMonitor.h"
+#include "services/infrastructure/TimeSource.h"
+#include "services/application/ProcessEventDispatcher.h"
+#include "managers/CategorizationManager.h"
+#include "managers/GameSessionManager.h"
+#include "repositories/ApplicationRepository.h"
+#include "domain/Application.h"
+#include "services/logging/EventLogger.h"
+#include "services/metrics/DetectionLatency.h"
+#include "services/metrics/Metrics.h"
+#include <QElapsedTimer>
+#include <QFile>
+#include <QProcess>
+#include <QRandomGenerator>
+#include <QTemporaryDir>
+#include <QThread>
+#include <QTimer>
+#include <memory>
+#include <vector>
+
+/**
+ * @class BenchDetectionLatency
+ * @brief Time from a real process starting to gameDetected, stage by stage.
+ *
+ * Launches real child processes (a copy of sleep under a name registered
+ * as a game) while the real ProcessMonitor polls the system process list
+ * on its own thread, wired to the dispatcher and session manager as in
+ * AppController. Launches are spread at random over the poll interval, so
+ * the enumeration stage samples every phase of the poll.
+ *
+ * Reports p50/p99 for each DetectionLatency stage, and runs once with an
+ * idle main thread and once with one that stalls regularly, which shows up
+ * in the delivery stage. Enumeration also counts any other process the
+ * system started meanwhile. Linux only: it needs /proc and real time.
+ */
+class BenchDetectionLatency : public QObject
+{
+    Q_OBJECT
+
+private:
+    static constexpr int POLL = ProcessMonitor::POLL_INTERVAL_MS;
+    static constexpr int LAUNCHES = 20;
+    static constexpr char GAME_NAME[] = "mindfulness-latency-game";
+
+    QTemporaryDir m_dir;
+    QString m_game;
+
+    static QString millis(quint64 nanoseconds)
+    {
+        return QString::number(static_cast<double>(nanoseconds) / 1e6, 'f', 1);
+    }
+
+    static void report(const char* label, DetectionLatency::Stage stage)
+    {
+        const LatencyHistogram& histogram = DetectionLatency::histogram(stage);
+        qInfo().noquote() << "  " << label << "ms p50/p99:" << millis(histogram.percentile(0.5))
+                          << "/" << millis(histogram.percentile(0.99))
+                          << "(" << histogram.count() << "samples )";
+    }
+
+private slots:
+    void initTestCase() {
+#if !defined(Q_OS_LINUX)
+        QSKIP("Launches real processes and reads /proc; Linux only");
+#endif
+        QVERIFY(m_dir.isValid());
+        LogFilter::configure("*=info");
+
+        // The monitor names processes after their executable; copy() keeps
+        // the execute permission
+        m_game = m_dir.filePath(GAME_NAME);
+        QVERIFY(QFile::copy("/bin/sleep", m_game));
+    }
+
+    void bench_exec_to_game_detected_data() {
+        QTest::addColumn<int>("stallMs");
+        QTest::newRow("idle main thread") << 0;
+        QTest::newRow("main thread stalls 40ms every 100ms") << 40;
+    }
+
+    void bench_exec_to_game_detected() {
+        QFETCH(int, stallMs);
+        DetectionLatency::reset();
+
+        ApplicationRepository repo(m_dir.filePath(QString("apps-%1.json").arg(stallMs)));
+        Application app(GAME_NAME, Application::Category::Game);
+        repo.save(&app);
+        repo.publishSnapshot();
+
+        CategorizationManager categorization(&repo);
+        ProcessEventDispatcher dispatcher(&repo, &categorization);
+        GameSessionManager sessions(&repo, nullptr, TimeSource::system());
+
+        QThread thread;
+        ProcessMonitor* monitor = new ProcessMonitor(&repo, TimeSource::system());
+        monitor->moveToThread(&thread);
+        connect(monitor, &ProcessMonitor::processStarted,
+                &dispatcher, &ProcessEventDispatcher::onProcessStarted);
+        connect(monitor, &ProcessMonitor::processTerminated,
+                &dispatcher, &ProcessEventDispatcher::onProcessTerminated);
+        connect(&dispatcher, &ProcessEventDispatcher::gameDetected,
+                &sessions, &GameSessionManager::onGameDetected);
+        connect(&thread, &QThread::started, monitor, &ProcessMonitor::startMonitor);
+        connect(&thread, &QThread::finished, monitor, &QObject::deleteLater);
+
+        int detected = 0;
+        connect(&dispatcher, &ProcessEventDispatcher::gameDetected, this,
+                [&detected](DWORD, const QString& name) { detected += name == GAME_NAME ? 1 : 0; });
+
+        QTimer stall;
+        connect(&stall, &QTimer::timeout, this, [stallMs]() {
+            QElapsedTimer busy;
+            busy.start();
+            while (busy.elapsed() < stallMs) {
+            }
+        });
+        if (stallMs > 0) {
+            stall.start(100);
+        }
+
+        thread.start();
+        // Let the first poll take the processes already running
+        QTest::qWait(POLL + POLL / 2);
+
+        std::vector<std::unique_ptr<QProcess>> children;
+        for (int i = 0; i < LAUNCHES; ++i) {
+            QTest::qWait(static_cast<int>(QRandomGenerator::global()->bounded(POLL)));
+            std::unique_ptr<QProcess> child(new QProcess);
+            child->start(m_game, {"600"});
+            QVERIFY(child->waitForStarted());
+            children.push_back(std::move(child));
+        }
+        QTRY_COMPARE_WITH_TIMEOUT(detected, LAUNCHES, 3 * POLL);
+
+        stall.stop();
+        thread.quit();
+        thread.wait();
+        for (const std::unique_ptr<QProcess>& child : children) {
+            child->kill();
+            child->waitForFinished();
+        }
+
+        const LatencyHistogram& total = DetectionLatency::histogram(DetectionLatency::Stage::Total);
+        QCOMPARE(total.count(), quint64(LAUNCHES));
+
+        qInfo().noquote() << QTest::currentDataTag() << ":" << LAUNCHES << "launches";
+        report("enumeration  ", DetectionLatency::Stage::Enumeration);
+        report("delivery     ", DetectionLatency::Stage::Delivery);
+        report("dispatch     ", DetectionLatency::Stage::Dispatch);
+        report("session start", DetectionLatency::Stage::SessionStart);
+        report("exec to game ", DetectionLatency::Stage::Total);
+        QTest::setBenchmarkResult(static_cast<double>(total.percentile(0.99)) / 1e6,
+                                  QTest::WalltimeMilliseconds);
+    }
+};
+
+QTEST_GUILESS_MAIN(BenchDetectionLatency)
+#include "bench_DetectionLatency.moc"
@@ -0,0 +1,152 @@
+#include <QtTest/QtTest>
+#include "services/logging/EventLogger.h"
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QTemporaryDir>
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+/**
+ * @class BenchEventLogger
+ * @brief qDebug throughput and caller-side latency through EventLogger.
+ *
+ * 1, 2, 4 and 8 threads each log MESSAGES_PER_THREAD lines shaped like
+ * the dispatcher's "Process started" line, in bursts of BURST with a
+ * short pause in between (closer to real use than one flood, which only
+ * measures how fast the ring fills). Each call is timed on the calling
+ * thread; that is what the monitor and GUI threads pay per message.
+ * Throughput counts until the last line is on disk (console output off).
+ *
+ * Drops are reported, not failed: they are the designed behaviour when
+ * producers outrun the disk.
+ *
+ * bench_formats logs the same line from one thread as a qDebug() call, as
+ * an MF_LOG_EVENT rendered into the text log, and as an MF_LOG_EVENT into
+ * the binary log, and compares caller time and bytes on disk.
+ */
+class BenchEventLogger : public QObject
+{
+    Q_OBJECT
+
+private:
+    static constexpr int MESSAGES_PER_THREAD = 20000;
+    static constexpr int BURST = 500;
+
+    static qint64 percentile(std::vector<qint64>& values, double q)
+    {
+        if (values.empty()) {
+            return 0;
+        }
+        std::sort(values.begin(), values.end());
+        return values[static_cast<size_t>(q * static_cast<double>(values.size() - 1))];
+    }
+
+private slots:
+    void bench_threads_data() {
+        QTest::addColumn<int>("threads");
+        for (int threads : {1, 2, 4, 8}) {
+            QTest::newRow(qPrintable(QString("%1 threads").arg(threads))) << threads;
+        }
+    }
+
+    void bench_threads() {
+        QFETCH(int, threads);
+
+        QTemporaryDir dir;
+        EventLogger::install(dir.filePath("bench.log"), false);
+        const quint64 droppedBefore = EventLogger::droppedCount();
+
+        std::vector<std::vector<qint64>> latencies(static_cast<size_t>(threads));
+        std::vector<std::thread> workers;
+        QElapsedTimer total;
+        total.start();
+        for (int t = 0; t < threads; ++t) {
+            workers.emplace_back([t, &latencies]() {
+                std::vector<qint64>& mine = latencies[static_cast<size_t>(t)];
+                mine.reserve(MESSAGES_PER_THREAD);
+                QElapsedTimer call;
+                for (int i = 0; i < MESSAGES_PER_THREAD; ++i) {
+                    const quint32 pid = static_cast<quint32>(t * MESSAGES_PER_THREAD + i);
+                    call.start();
+                    qDebug() << "Process started:" << "game.exe" << "PID:" << pid;
+                    mine.push_back(call.nsecsElapsed());
+                    if ((i + 1) % BURST == 0) {
+                        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                    }
+                }
+            });
+        }
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+        EventLogger::flush();
+        const qint64 elapsed = total.nsecsElapsed();
+        const quint64 dropped = EventLogger::droppedCount() - droppedBefore;
+        EventLogger::shutdown();
+
+        std::vector<qint64> all;
+        for (const std::vector<qint64>& mine : latencies) {
+            all.insert(all.end(), mine.begin(), mine.end());
+        }
+        const int messages = threads * MESSAGES_PER_THREAD;
+        const double perSecond = elapsed > 0 ? messages * 1e9 / static_cast<double>(elapsed) : 0.0;
+
+        qInfo().noquote() << threads << "threads," << messages << "messages," << dropped << "dropped";
+        qInfo().noquote() << "  throughput:" << QString::number(perSecond, 'f', 0) << "messages/s";
+        qInfo().noquote() << "  caller latency ns p50/p99/p99.9/max:" << percentile(all, 0.5) << "/"
+                          << percentile(all, 0.99) << "/" << percentile(all, 0.999) << "/" << percentile(all, 1.0);
+        QTest::setBenchmarkResult(perSecond, QTest::Events);
+    }
+
+    void bench_formats_data() {
+        QTest::addColumn<int>("mode");
+        QTest::newRow("qDebug text") << 0;
+        QTest::newRow("structured text") << 1;
+        QTest::newRow("structured binary") << 2;
+    }
+
+    void bench_formats() {
+        QFETCH(int, mode);
+
+        QTemporaryDir dir;
+        const QString textPath = dir.filePath("bench.log");
+        const QString binaryPath = dir.filePath("bench.blog");
+        EventLogger::install(textPath, false, mode == 2 ? binaryPath : QString());
+        const quint64 droppedBefore = EventLogger::droppedCount();
+
+        const QString name("game.exe");
+        QElapsedTimer total;
+        qint64 callNs = 0;
+        for (int i = 0; i < MESSAGES_PER_THREAD; ++i) {
+            const quint32 pid = static_cast<quint32>(i);
+            total.start();
+            if (mode == 0) {
+                qDebug() << "Process started:" << name << "PID:" << pid;
+            } else {
+                MF_LOG_EVENT(QtDebugMsg, "Process started: %1 PID: %2", name, pid);
+            }
+            callNs += total.nsecsElapsed();
+            if ((i + 1) % BURST == 0) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+        EventLogger::flush();
+        const quint64 dropped = EventLogger::droppedCount() - droppedBefore;
+        EventLogger::shutdown();
+
+        // Not counting the install banner
+        QFile text(textPath);
+        text.open(QIODevice::ReadOnly);
+        const qint64 banner = text.readLine().size();
+        const qint64 bytes = text.size() - banner + (mode == 2 ? QFileInfo(binaryPath).size() : 0);
+        const double nsPerCall = static_cast<double>(callNs) / MESSAGES_PER_THREAD;
+        qInfo().noquote() << QTest::currentDataTag() << ":" << QString::number(nsPerCall, 'f', 1)
+                          << "ns/call," << QString::number(static_cast<double>(bytes) / MESSAGES_PER_THREAD, 'f', 1)
+                          << "bytes/message," << dropped << "dropped";
+        QTest::setBenchmarkResult(nsPerCall, QTest::WalltimeNanoseconds);
+    }
+};
+
+QTEST_GUILESS_MAIN(BenchEventLogger)
+#include "bench_EventLogger.moc"
@@ -0,0 +1,374 @@
+#include <QtTest/QtTest>
+#include "services/infrastructure/ProcessMonitor.h"
+#include "services/application/ProcessEventDispatcher.h"
+#include "services/utils/ProcessUtils.h"
+#include "managers/CategorizationManager.h"
+#include "repositories/ApplicationRepository.h"
+#include "domain/Application.h"
+#include "services/logging/EventLogger.h"
+#include "../mocks/MockProcessSource.h"
+#include "../mocks/MockTimeSource.h"
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QSysInfo>
+#include <QTemporaryDir>
+#include <memory>
+#include <vector>
+
+/**
+ * @class BenchHotPaths
+ * @brief The core hot paths in one run, written out as JSON for comparison.
+ *
+ * Built and run by the mindfulness_bench target. Each benchmark repeats
+ * its operation for at least MIN_TIME_MS and records ns per operation:
+ *
+ * 1. snapshot_diff - ProcessUtils::applySnapshot() on synthetic process
+ *    lists with CHURN_PERCENT of pids replaced between snapshots.
+ * 2. monitor_tick - ProcessMonitor::runMonitorLoop() over a MockProcessSource
+ *    with the same churn, the repository snapshot holding every name.
+ * 3. repository - find, findOrCreate, saveAll and load (construction from
+ *    the saved file) at 1k to 1M entries.
+ * 4. application_json - Application::toJson and fromJson.
+ * 5. dispatch - identifyAndDispatch() (through onProcessStarted) for known
+ *    games and for names the repository has never seen.
+ * 6. event_logger - MF_LOG_INFO lines per second until they are on disk.
+ *
+ * Results go to MINDFULNESS_BENCH_JSON (default mindfulness_bench.json in
+ * the working directory) as {"context": {...}, "results": [...]}, with one
+ * result per benchmark and size: name, size, iterations, ns_per_op and
+ * ops_per_sec. The context records the Qt version, OS, CPU and build type
+ * so runs from different machines are not mistaken for a regression.
+ */
+class BenchHotPaths : public QObject
+{
+    Q_OBJECT
+
+private:
+    static constexpr qint64 MIN_TIME_MS = 200;
+    static constexpr int CHURN_PERCENT = 5;
+    static constexpr int LOG_MESSAGES = 200000;
+
+    QTemporaryDir m_tempDir;
+    QJsonArray m_results;
+
+    // Repeats operation until MIN_TIME_MS has passed; ns per call
+    template<typename Operation>
+    static double measure(Operation operation, qint64& iterations)
+    {
+        QElapsedTimer timer;
+        timer.start();
+        iterations = 0;
+        qint64 batch = 1;
+        while (timer.elapsed() < MIN_TIME_MS) {
+            for (qint64 i = 0; i < batch; ++i) {
+                operation(iterations + i);
+            }
+            iterations += batch;
+            batch *= 2;
+        }
+        return static_cast<double>(timer.nsecsElapsed()) / static_cast<double>(iterations);
+    }
+
+    void report(const QString& name, int size, qint64 iterations, double nsPerOp)
+    {
+        QJsonObject result;
+        result["name"] = name;
+        result["size"] = size;
+        result["iterations"] = iterations;
+        result["ns_per_op"] = nsPerOp;
+        result["ops_per_sec"] = nsPerOp > 0 ? 1e9 / nsPerOp : 0.0;
+        m_results.append(result);
+
+        qInfo().noquote() << name << size << ":" << QString::number(nsPerOp, 'f', 1) << "ns/op";
+        QTest::setBenchmarkResult(nsPerOp, QTest::WalltimeNanoseconds);
+    }
+
+    template<typename Operation>
+    void run(const QString& name, int size, Operation operation)
+    {
+        qint64 iterations = 0;
+        const double ns = measure(operation, iterations);
+        report(name, size, iterations, ns);
+    }
+
+    static QString processName(int i)
+    {
+        return QString("app%1.exe").arg(i);
+    }
+
+    static Application::Category categoryOf(int i)
+    {
+        // 1% games, the rest spread over the remaining categories
+        return (i % 100 == 0)
+            ? Application::Category::Game
+            : static_cast<Application::Category>(2 + i % (Application::CATEGORY_COUNT - 2));
+    }
+
+    static void fill(ApplicationRepository& repository, int count)
+    {
+        for (int i = 0; i < count; ++i) {
+            Application app(processName(i), categoryOf(i));
+            repository.save(&app);
+        }
+    }
+
+    // Two process lists of count pids that differ in CHURN_PERCENT of them
+    static void snapshots(int count, QSet<DWORD>& first, QSet<DWORD>& second)
+    {
+        const int churn = qMax(1, count * CHURN_PERCENT / 100);
+        for (int i = 0; i < count; ++i) {
+            first.insert(static_cast<DWORD>(4 * (i + 1)));
+            second.insert(static_cast<DWORD>(4 * (i < churn ? count + i + 1 : i + 1)));
+        }
+    }
+
+    static void sizes(std::initializer_list<int> values)
+    {
+        QTest::addColumn<int>("size");
+        for (int size : values) {
+            QTest::newRow(qPrintable(QString::number(size))) << size;
+        }
+    }
+
+private slots:
+    void initTestCase() {
+        QVERIFY(m_tempDir.isValid());
+        // Dispatch and monitor debug lines would otherwise dominate their timings
+        LogFilter::configure("*=info");
+    }
+
+    void cleanupTestCase() {
+        QJsonObject context;
+        context["qt"] = QString(qVersion());
+        context["os"] = QSysInfo::prettyProductName();
+        context["cpu"] = QSysInfo::currentCpuArchitecture();
+        context["threads"] = QThread::idealThreadCount();
+#if defined(QT_NO_DEBUG)
+        context["build"] = QString("release");
+#else
+        context["build"] = QString("debug");
+#endif
+        context["date"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+
+        QJsonObject root;
+        root["context"] = context;
+        root["results"] = m_results;
+
+        QString path = qEnvironmentVariable("MINDFULNESS_BENCH_JSON");
+        if (path.isEmpty()) {
+            path = "mindfulness_bench.json";
+        }
+        QSaveFile file(path);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write(QJsonDocument(root).toJson());
+        QVERIFY(file.commit());
+        qInfo().noquote() << "Results written to" << path;
+    }
+
+    void bench_snapshot_diff_data() {
+        sizes({100, 1000, 10000});
+    }
+
+    void bench_snapshot_diff() {
+        QFETCH(int, size);
+        QSet<DWORD> first;
+        QSet<DWORD> second;
+        snapshots(size, first, second);
+        const QString name("synthetic.exe");
+
+        QHash<DWORD, QString> map;
+        ProcessUtils::applySnapshot(map, first, [&name](DWORD) { return name; });
+        QCOMPARE(map.size(), size);
+
+        // Alternate, so every call drops and resolves the churned pids
+        run("snapshot_diff", size, [&](qint64 i) {
+            ProcessUtils::applySnapshot(map, (i & 1) ? first : second, [&name](DWORD) { return name; });
+        });
+        QCOMPARE(map.size(), size);
+    }
+
+    void bench_monitor_tick_data() {
+        sizes({100, 1000, 10000});
+    }
+
+    void bench_monitor_tick() {
+        QFETCH(int, size);
+        ApplicationRepository repository(m_tempDir.filePath("tick.json"));
+        fill(repository, size);
+        repository.publishSnapshot();
+
+        QSet<DWORD> first;
+        QSet<DWORD> second;
+        snapshots(size, first, second);
+
+        MockProcessSource source;
+        MockTimeSource time;
+        ProcessMonitor monitor(&repository, &time, &source);
+        int started = 0;
+        connect(&monitor, &ProcessMonitor::processStarted, this, [&started]() { ++started; });
+
+        auto show = [&source, size](const QSet<DWORD>& pids) {
+            source.clear();
+            int i = 0;
+            for (DWORD pid : pids) {
+                source.spawn(pid, processName(i++ % size));
+            }
+        };
+
+        // Flip the mock between the two lists; only the flip is untimed
+        show(first);
+        QMetaObject::invokeMethod(&monitor, "runMonitorLoop", Qt::DirectConnection);
+        qint64 iterations = 0;
+        qint64 elapsed = 0;
+        QElapsedTimer timer;
+        timer.start();
+        while (timer.elapsed() < MIN_TIME_MS * 4) {
+            show((iterations & 1) ? first : second);
+            QElapsedTimer tick;
+            tick.start();
+            QMetaObject::invokeMethod(&monitor, "runMonitorLoop", Qt::DirectConnection);
+            elapsed += tick.nsecsElapsed();
+            ++iterations;
+        }
+        QVERIFY(started > 0);
+        report("monitor_tick", size, iterations, static_cast<double>(elapsed) / static_cast<double>(iterations));
+    }
+
+    void bench_repository_data() {
+        sizes({1000, 10000, 100000, 1000000});
+    }
+
+    void bench_repository() {
+        QFETCH(int, size);
+        const QString path = m_tempDir.filePath(QString("repository_%1.json").arg(size));
+        auto repository = std::make_unique<ApplicationRepository>(path);
+        fill(*repository, size);
+        QCOMPARE(repository->count(), size);
+
+        // Names are built up front so the timings are the lookups alone
+        const int probes = 4096;
+        QStringList names;
+        QStringList missing;
+        for (int i = 0; i < probes; ++i) {
+            names.append(processName(static_cast<int>((quint64(i) * 2654435761u) % size)));
+            missing.append(QString("missing%1.exe").arg(i));
+        }
+
+        run("repository_find", size, [&](qint64 i) {
+            Application* app = repository->find(names[static_cast<int>(i % probes)]);
+            Q_UNUSED(app);
+        });
+        run("repository_find_missing", size, [&](qint64 i) {
+            Application* app = repository->find(missing[static_cast<int>(i % probes)]);
+            Q_UNUSED(app);
+        });
+        run("repository_findOrCreate_existing", size, [&](qint64 i) {
+            Application* app = repository->findOrCreate(names[static_cast<int>(i % probes)]);
+            Q_UNUSED(app);
+        });
+
+        // Creating grows the catalog, so it gets a bounded, untimed cleanup
+        QElapsedTimer timer;
+        timer.start();
+        for (const QString& name : missing) {
+            repository->findOrCreate(name);
+        }
+        report("repository_findOrCreate_new", size, probes, static_cast<double>(timer.nsecsElapsed()) / probes);
+        for (const QString& name : missing) {
+            repository->remove(name);
+        }
+
+        // Whole-file operations take long enough to time once each
+        timer.restart();
+        QVERIFY(repository->saveAll());
+        report("repository_saveAll", size, 1, static_cast<double>(timer.nsecsElapsed()));
+
+        // The constructor loads; that and the first snapshot is what startup pays
+        timer.restart();
+        auto loaded = std::make_unique<ApplicationRepository>(path);
+        report("repository_load", size, 1, static_cast<double>(timer.nsecsElapsed()));
+        QCOMPARE(loaded->count(), size);
+
+        // Don't spend the teardown writing the catalog back to disk
+        loaded->clear();
+        repository->clear();
+    }
+
+    void bench_application_json() {
+        const int count = 10000;
+        std::vector<Application> applications;
+        std::vector<QJsonObject> documents;
+        applications.reserve(count);
+        documents.reserve(count);
+        for (int i = 0; i < count; ++i) {
+            Application app(processName(i), categoryOf(i));
+            app.setDisplayName(QString("App %1").arg(i));
+            app.recordSessionEnd(i % 120);
+            applications.push_back(app);
+            documents.push_back(app.toJson());
+        }
+
+        run("application_toJson", count, [&](qint64 i) {
+            QJsonObject json = applications[static_cast<size_t>(i % count)].toJson();
+            Q_UNUSED(json);
+        });
+        run("application_fromJson", count, [&](qint64 i) {
+            Application app = Application::fromJson(documents[static_cast<size_t>(i % count)]);
+            Q_UNUSED(app);
+        });
+    }
+
+    void bench_dispatch_data() {
+        sizes({1000, 100000});
+    }
+
+    void bench_dispatch() {
+        QFETCH(int, size);
+        ApplicationRepository repository(m_tempDir.filePath("dispatch.json"));
+        fill(repository, size);
+        CategorizationManager categorization(&repository);
+        ProcessEventDispatcher dispatcher(&repository, &categorization);
+        int games = 0;
+        connect(&dispatcher, &ProcessEventDispatcher::gameDetected, this, [&games]() { ++games; });
+
+        // Every hundredth application is a game
+        run("dispatch_game", size, [&](qint64 i) {
+            dispatcher.onProcessStarted(static_cast<DWORD>(i), processName(static_cast<int>((i * 100) % size)));
+        });
+        QVERIFY(games > 0);
+
+        const QString unknown("neverseen.exe");
+        run("dispatch_uncategorized", size, [&](qint64 i) {
+            dispatcher.onProcessStarted(static_cast<DWORD>(i), unknown);
+        });
+
+        repository.clear();
+    }
+
+    void bench_event_logger() {
+        const QString path = m_tempDir.filePath("bench.log");
+        EventLogger::install(path, false);
+
+        QElapsedTimer timer;
+        timer.start();
+        for (int i = 0; i < LOG_MESSAGES; ++i) {
+            MF_LOG_INFO(Dispatch, "Process started: %1 PID: %2", QStringLiteral("game.exe"), i);
+        }
+        const qint64 callerNs = timer.nsecsElapsed();
+        const quint64 dropped = EventLogger::droppedCount();
+        EventLogger::shutdown();
+        const qint64 totalNs = timer.nsecsElapsed();
+
+        report("event_logger_caller", LOG_MESSAGES, LOG_MESSAGES, static_cast<double>(callerNs) / LOG_MESSAGES);
+        report("event_logger_on_disk", LOG_MESSAGES, LOG_MESSAGES, static_cast<double>(totalNs) / LOG_MESSAGES);
+        if (dropped > 0) {
+            qInfo() << "event_logger dropped" << dropped << "of" << LOG_MESSAGES;
+        }
+    }
+};
+
+QTEST_GUILESS_MAIN(BenchHotPaths)
+#include "bench_HotPaths.moc"
@@ -0,0 +1,110 @@
+#include <QtTest/QtTest>
+#include "services/metrics/Metrics.h"
+#include "services/metrics/TraceSpans.h"
+#include <QElapsedTimer>
+#include <thread>
+#include <vector>
+
+/**
+ * @class BenchMetrics
+ * @brief What recording a metric costs the instrumented code.
+ *
+ * Counter adds, histogram records and a ScopedLatency (two clock reads
+ * plus a record) in a tight loop on 1, 2, 4 and 8 threads, all hitting the
+ * same metric as the monitor, dispatcher and logger threads would.
+ * Reported as ns per operation on each thread. Trace spans are measured
+ * with tracing off (the cost every instrumented scope always pays) and on.
+ */
+class BenchMetrics : public QObject
+{
+    Q_OBJECT
+
+private:
+    static constexpr int OPERATIONS = 2000000;
+
+    template<typename Operation>
+    static double nsPerOperation(int threads, Operation operation)
+    {
+        std::vector<qint64> elapsed(static_cast<size_t>(threads));
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threads; ++t) {
+            workers.emplace_back([t, &elapsed, &operation]() {
+                QElapsedTimer timer;
+                timer.start();
+                for (int i = 0; i < OPERATIONS; ++i) {
+                    operation(i);
+                }
+                elapsed[static_cast<size_t>(t)] = timer.nsecsElapsed();
+            });
+        }
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+        qint64 total = 0;
+        for (qint64 ns : elapsed) {
+            total += ns;
+        }
+        return static_cast<double>(total) / (static_cast<double>(threads) * OPERATIONS);
+    }
+
+    static void report(const char* what, int threads, double ns)
+    {
+        qInfo().noquote() << what << threads << "threads:" << QString::number(ns, 'f', 2) << "ns/op";
+        QTest::setBenchmarkResult(ns, QTest::WalltimeNanoseconds);
+    }
+
+private slots:
+    void bench_counter_data() {
+        QTest::addColumn<int>("threads");
+        for (int threads : {1, 2, 4, 8}) {
+            QTest::newRow(qPrintable(QString("%1 threads").arg(threads))) << threads;
+        }
+    }
+
+    void bench_counter() {
+        QFETCH(int, threads);
+        Counter& counter = MetricsRegistry::counter("bench_counter_total", "Benchmark counter");
+        counter.reset();
+        const double ns = nsPerOperation(threads, [&counter](int) { counter.add(); });
+        QCOMPARE(counter.value(), quint64(threads) * OPERATIONS);
+        report("Counter::add", threads, ns);
+    }
+
+    void bench_histogram_data() {
+        bench_counter_data();
+    }
+
+    void bench_histogram() {
+        QFETCH(int, threads);
+        LatencyHistogram& histogram = MetricsRegistry::histogram("bench_histogram_seconds", "Benchmark histogram");
+        histogram.reset();
+        const double ns = nsPerOperation(threads, [&histogram](int i) { histogram.record(1000 + (i & 0xFFFF)); });
+        QCOMPARE(histogram.count(), quint64(threads) * OPERATIONS);
+        report("LatencyHistogram::record", threads, ns);
+    }
+
+    void bench_scoped_latency() {
+        LatencyHistogram& histogram = MetricsRegistry::histogram("bench_scope_seconds", "Benchmark scopes");
+        histogram.reset();
+        const double ns = nsPerOperation(1, [&histogram](int) { ScopedLatency timing(histogram); });
+        report("ScopedLatency", 1, ns);
+    }
+
+    void bench_trace_span_data() {
+        QTest::addColumn<bool>("enabled");
+        QTest::newRow("disabled") << false;
+        QTest::newRow("enabled") << true;
+    }
+
+    void bench_trace_span() {
+        QFETCH(bool, enabled);
+        SpanTracer::clear();
+        SpanTracer::setEnabled(enabled);
+        const double ns = nsPerOperation(1, [](int) { MF_TRACE_SPAN("bench span"); });
+        SpanTracer::setEnabled(false);
+        report(enabled ? "TraceSpan (enabled)" : "TraceSpan (disabled)", 1, ns);
+    }
+};
+
+QTEST_GUILESS_MAIN(BenchMetrics)
+#include "bench_Metrics.moc"
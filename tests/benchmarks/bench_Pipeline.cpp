@@ -0,0 +1,154 @@
+#include <QtTest/QtTest>
+#include "services/infrastructure/ProcessMonitor.h"
+#include "services/application/ProcessEventDispatcher.h"
+#include "managers/CategorizationManager.h"
+#include "managers/GameSessionManager.h"
+#include "repositories/ApplicationRepository.h"
+#include "domain/Application.h"
+#include "services/logging/EventLogger.h"
+#include "services/metrics/AllocationTracker.h"
+#include "../mocks/MockProcessSource.h"
+#include "../mocks/MockTimeSource.h"
+#include <QDir>
+#include <QElapsedTimer>
+#include <QTemporaryDir>
+#include <algorithm>
+#include <vector>
+
+/**
+ * @class BenchPipeline
+ * @brief Plays process scenarios through monitor, dispatcher and managers.
+ *
+ * Every *.scenario file in tests/scenarios (see ProcessScenario in
+ * tests/mocks/MockProcessSource.h for the format) runs against the real
+ * ProcessMonitor, ProcessEventDispatcher, CategorizationManager and
+ * GameSessionManager, wired as in AppController but on one thread, with a
+ * MockProcessSource for the process list and a MockTimeSource for time.
+ * Nothing needs Windows or a display.
+ *
+ * The script starts 1 ms after a poll, so script steps and polls never share
+ * a tick. The clock is advanced to just before each poll (running the
+ * script) and then onto the poll, which is what gets measured:
+ *
+ * - throughput: process events (starts and exits) per second of tick time
+ * - tick time: real time for one poll and everything it triggers
+ * - detection latency: virtual time from spawn to processStarted, bounded by
+ *   the poll interval
+ * - allocations per tick (operator new only, see AllocationTracker)
+ *
+ * Every spawned process has to be reported by the next poll, which makes
+ * the benchmark usable as a headless regression check.
+ */
+class BenchPipeline : public QObject
+{
+    Q_OBJECT
+
+private:
+    static constexpr int POLL = ProcessMonitor::POLL_INTERVAL_MS;
+
+    static qint64 percentile(std::vector<qint64> values, double q)
+    {
+        if (values.empty()) {
+            return 0;
+        }
+        std::sort(values.begin(), values.end());
+        return values[static_cast<size_t>(q * static_cast<double>(values.size() - 1))];
+    }
+
+private slots:
+    void initTestCase() {
+        // The dispatcher logs every event; that is not what is measured here
+        LogFilter::configure("*=info");
+    }
+
+    void bench_scenario_data() {
+        QTest::addColumn<QString>("path");
+        const QDir dir(SCENARIO_DIR);
+        const QStringList files = dir.entryList({"*.scenario"}, QDir::Files, QDir::Name);
+        for (const QString& file : files) {
+            QTest::newRow(qPrintable(file)) << dir.filePath(file);
+        }
+    }
+
+    void bench_scenario() {
+        QFETCH(QString, path);
+        ProcessScenario scenario;
+        QString error;
+        QVERIFY2(scenario.load(path, &error), qPrintable(error));
+
+        QTemporaryDir dir;
+        MockTimeSource time;
+        ScopedTimeSource installed(&time);
+        MockProcessSource processes;
+
+        ApplicationRepository repo(dir.filePath("apps.json"));
+        CategorizationManager categorization(&repo);
+        ProcessEventDispatcher dispatcher(&repo, &categorization);
+        GameSessionManager sessions(&repo, nullptr, &time);
+        ProcessMonitor monitor(&repo, &time, &processes);
+
+        int started = 0;
+        int terminated = 0;
+        int dispatched = 0;
+        std::vector<qint64> detection;
+
+        connect(&monitor, &ProcessMonitor::processStarted,
+                &dispatcher, &ProcessEventDispatcher::onProcessStarted);
+        connect(&monitor, &ProcessMonitor::processTerminated,
+                &dispatcher, &ProcessEventDispatcher::onProcessTerminated);
+        connect(&dispatcher, &ProcessEventDispatcher::gameDetected,
+                &sessions, &GameSessionManager::onGameDetected);
+        connect(&dispatcher, &ProcessEventDispatcher::gameDetected, this, [&]() { ++dispatched; });
+        connect(&dispatcher, &ProcessEventDispatcher::workApplicationDetected, this, [&]() { ++dispatched; });
+        connect(&dispatcher, &ProcessEventDispatcher::uncategorizedAppDetected, this, [&]() { ++dispatched; });
+        connect(&monitor, &ProcessMonitor::processTerminated, this, [&]() { ++terminated; });
+
+        monitor.startMonitor();
+        time.advance(1);
+        ScenarioPlayer player(scenario, time, processes, &repo);
+        connect(&monitor, &ProcessMonitor::processStarted, this, [&](DWORD pid) {
+            ++started;
+            detection.push_back(time.elapsed() - player.spawnedAt(pid));
+        });
+
+        std::vector<qint64> tickNanos;
+        std::vector<qint64> tickAllocations;
+        QElapsedTimer timer;
+        for (qint64 poll = POLL; !player.finished() || poll <= player.end() + POLL; poll += POLL) {
+            time.advanceTo(poll - 1);
+
+            const AllocationScope allocations;
+            timer.start();
+            time.advanceTo(poll);
+            tickNanos.push_back(timer.nsecsElapsed());
+            tickAllocations.push_back(static_cast<qint64>(allocations.stats().allocations));
+        }
+
+        // Spawns are seen at most once (pids reused between two polls are
+        // not seen at all) and always by the next poll
+        QVERIFY(started > 0);
+        QVERIFY(started <= player.spawned());
+        QVERIFY(percentile(detection, 1.0) <= POLL);
+
+        qint64 totalNanos = 0;
+        for (qint64 nanos : tickNanos) {
+            totalNanos += nanos;
+        }
+        const int events = started + terminated;
+        const double perSecond = totalNanos > 0 ? events * 1e9 / static_cast<double>(totalNanos) : 0.0;
+
+        qInfo().noquote() << QFileInfo(path).fileName() << ":" << tickNanos.size() << "ticks,"
+                          << started << "starts," << terminated << "exits," << dispatched << "dispatched";
+        qInfo().noquote() << "  throughput:" << QString::number(perSecond, 'f', 0) << "events/s";
+        qInfo().noquote() << "  tick time us p50/p99/max:" << percentile(tickNanos, 0.5) / 1000
+                          << "/" << percentile(tickNanos, 0.99) / 1000 << "/" << percentile(tickNanos, 1.0) / 1000;
+        qInfo().noquote() << "  detection latency ms p50/p99/max:" << percentile(detection, 0.5)
+                          << "/" << percentile(detection, 0.99) << "/" << percentile(detection, 1.0);
+        qInfo().noquote() << "  allocations per tick p50/p99/max:" << percentile(tickAllocations, 0.5)
+                          << "/" << percentile(tickAllocations, 0.99) << "/" << percentile(tickAllocations, 1.0);
+        QTest::setBenchmarkResult(perSecond, QTest::Events);
+    }
+};
+
+QTEST_GUILESS_MAIN(BenchPipeline)
+#include "bench_Pipeline.moc"
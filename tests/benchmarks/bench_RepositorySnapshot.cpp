@@ -0,0 +1,148 @@
+#include <QtTest/QtTest>
+#include "repositories/ApplicationRepository.h"
+#include "domain/Application.h"
+#include <QTemporaryDir>
+#include <QThread>
+#include <QElapsedTimer>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+/**
+ * @class BenchRepositorySnapshot
+ * @brief Contention benchmark for lock-free snapshot reads.
+ *
+ * N reader threads call readSnapshot()->find() in a tight loop while the
+ * main thread keeps mutating the repository in batches and publishing new
+ * versions. QBENCHMARK measures the writer side (one batch + publish);
+ * reader throughput for the same run is reported with qInfo().
+ *
+ * bench_singleMutation publishes one change at a time against repositories
+ * of growing size; with unchanged entries shared between versions its cost
+ * should grow with the trie depth, not with the repository.
+ */
+class BenchRepositorySnapshot : public QObject
+{
+    Q_OBJECT
+
+private:
+    static constexpr int APP_COUNT = 10000;
+    static constexpr int CHANGES_PER_BATCH = 16;
+
+    QTemporaryDir m_tempDir;
+    std::unique_ptr<ApplicationRepository> m_repo;
+    QStringList m_names;
+
+private slots:
+    void initTestCase() {
+        QVERIFY(m_tempDir.isValid());
+        m_repo = std::make_unique<ApplicationRepository>(m_tempDir.filePath("bench_snapshot.json"));
+
+        ApplicationRepository::BatchUpdate batch(m_repo.get());
+        for (int i = 0; i < APP_COUNT; ++i) {
+            m_names.append(QString("app%1.exe").arg(i));
+            m_repo->findOrCreate(m_names.last());
+        }
+    }
+
+    void cleanupTestCase() {
+        m_repo->clear();
+        m_repo.reset();
+    }
+
+    void bench_findUnderMutation_data() {
+        QTest::addColumn<int>("readers");
+        QTest::newRow("1 reader") << 1;
+        QTest::newRow("2 readers") << 2;
+        QTest::newRow("4 readers") << 4;
+        QTest::newRow("8 readers") << 8;
+    }
+
+    void bench_findUnderMutation() {
+        QFETCH(int, readers);
+
+        std::atomic<bool> stop{false};
+        std::atomic<qint64> totalReads{0};
+        std::vector<QThread*> threads;
+
+        for (int r = 0; r < readers; ++r) {
+            QThread* thread = QThread::create([this, r, &stop, &totalReads]() {
+                qint64 reads = 0;
+                int index = r * 7919;
+                while (!stop.load(std::memory_order_relaxed)) {
+                    ApplicationRepository::SnapshotGuard snapshot = m_repo->readSnapshot();
+                    const Application* app = snapshot->find(m_names.at(index % APP_COUNT));
+                    if (app) {
+                        ++reads;
+                    }
+                    index += 31;
+                }
+                totalReads.fetch_add(reads, std::memory_order_relaxed);
+            });
+            thread->start();
+            threads.push_back(thread);
+        }
+
+        QElapsedTimer elapsed;
+        elapsed.start();
+
+        int cursor = 0;
+        QBENCHMARK {
+            ApplicationRepository::BatchUpdate batch(m_repo.get());
+            for (int i = 0; i < CHANGES_PER_BATCH; ++i) {
+                Application* app = m_repo->find(m_names.at(cursor++ % APP_COUNT));
+                app->setCategory(app->getCategory() == Application::Category::Game
+                                     ? Application::Category::Work
+                                     : Application::Category::Game);
+            }
+        }
+
+        stop.store(true);
+        for (QThread* thread : threads) {
+            thread->wait();
+            delete thread;
+        }
+
+        qint64 msecs = qMax<qint64>(1, elapsed.elapsed());
+        qInfo() << readers << "reader(s):" << totalReads.load() * 1000 / msecs
+                << "find() calls/s total while publishing";
+    }
+
+    void bench_singleMutation_data() {
+        QTest::addColumn<int>("size");
+        QTest::newRow("1k apps") << 1000;
+        QTest::newRow("10k apps") << 10000;
+        QTest::newRow("100k apps") << 100000;
+        QTest::newRow("1M apps") << 1000000;
+    }
+
+    void bench_singleMutation() {
+        QFETCH(int, size);
+
+        ApplicationRepository repo(m_tempDir.filePath(QString("bench_mutation_%1.json").arg(size)));
+        QStringList names;
+        {
+            ApplicationRepository::BatchUpdate batch(&repo);
+            for (int i = 0; i < size; ++i) {
+                names.append(QString("app%1.exe").arg(i));
+                repo.findOrCreate(names.last());
+            }
+        }
+
+        int cursor = 0;
+        QBENCHMARK {
+            Application* app = repo.find(names.at(cursor));
+            cursor = (cursor + 7919) % size;
+            app->setCategory(app->getCategory() == Application::Category::Game
+                                 ? Application::Category::Work
+                                 : Application::Category::Game);
+            repo.publishSnapshot();
+        }
+
+        QCOMPARE(repo.readSnapshot()->count(), size);
+        repo.clear();
+    }
+};
+
+QTEST_MAIN(BenchRepositorySnapshot)
+#include "bench_RepositorySnapshot.moc"
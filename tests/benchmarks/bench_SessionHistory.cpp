@@ -0,0 +1,107 @@
+#include <QtTest/QtTest>
+#include "repositories/SessionHistoryStore.h"
+#include <QDirIterator>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QTemporaryDir>
+
+/**
+ * @class BenchSessionHistory
+ * @brief Append and range-query throughput of SessionHistoryStore.
+ *
+ * RECORD_COUNT sessions spread over DAY_COUNT days (about 5,500 per day,
+ * far more than a real user produces, to reach millions of records) are
+ * appended once in initTestCase(). The benchmarks then query one day, one
+ * week and the whole history, which shows that cost follows the number of
+ * overlapping segments. Disk use per record is reported after sealing.
+ */
+class BenchSessionHistory : public QObject
+{
+    Q_OBJECT
+
+private:
+    static constexpr int RECORD_COUNT = 2000000;
+    static constexpr int DAY_COUNT = 365;
+    static constexpr int APP_COUNT = 200;
+    static constexpr qint64 DAY = SessionHistoryStore::SECONDS_PER_DAY;
+    static constexpr qint64 BASE = 20000 * DAY;
+
+    QTemporaryDir m_dir;
+    std::unique_ptr<SessionHistoryStore> m_store;
+
+    static qint64 directorySize(const QString& path)
+    {
+        qint64 total = 0;
+        QDirIterator it(path, QDir::Files);
+        while (it.hasNext()) {
+            total += QFileInfo(it.next()).size();
+        }
+        return total;
+    }
+
+    void benchRange(qint64 from, qint64 to)
+    {
+        SessionHistoryStore::Totals totals;
+        QBENCHMARK {
+            totals = m_store->totals(from, to);
+        }
+        QVERIFY(totals.sessions > 0);
+        qInfo() << totals.sessions << "sessions," << totals.activeSeconds / 3600 << "hours";
+    }
+
+private slots:
+    void initTestCase() {
+        m_store.reset(new SessionHistoryStore(m_dir.path()));
+        for (int app = 0; app < APP_COUNT; ++app) {
+            m_store->appKey(QString("app%1.exe").arg(app));
+        }
+
+        const qint64 spacing = DAY * DAY_COUNT / RECORD_COUNT;
+        QElapsedTimer timer;
+        timer.start();
+        for (int i = 0; i < RECORD_COUNT; ++i) {
+            SessionRecord record;
+            record.appKey = static_cast<quint32>(i % APP_COUNT);
+            record.start = BASE + i * spacing;
+            record.end = record.start + 60 + (i % 7200);
+            record.activeSeconds = static_cast<quint32>(record.end - record.start - (i % 60));
+            record.reason = static_cast<SessionRecord::Termination>(i % 3);
+            m_store->append(record);
+        }
+        qint64 msecs = qMax<qint64>(1, timer.elapsed());
+
+        // Reopen so every finished day is read back from its segment
+        m_store.reset(new SessionHistoryStore(m_dir.path()));
+        QCOMPARE(m_store->recordCount(), static_cast<qint64>(RECORD_COUNT));
+
+        qInfo() << "Appended" << RECORD_COUNT << "records in" << msecs << "ms ("
+                << RECORD_COUNT * 1000 / msecs << "records/s)";
+        qInfo() << "Partitions:" << m_store->partitionCount() << ", on disk:"
+                << QString::number(double(directorySize(m_dir.path())) / RECORD_COUNT, 'f', 2)
+                << "bytes/record";
+    }
+
+    void bench_query_day() {
+        benchRange(BASE + 100 * DAY, BASE + 101 * DAY);
+    }
+
+    void bench_query_week() {
+        benchRange(BASE + 100 * DAY, BASE + 107 * DAY);
+    }
+
+    void bench_query_all() {
+        benchRange(BASE, BASE + (DAY_COUNT + 1) * DAY);
+    }
+
+    void bench_query_one_app_week() {
+        quint32 key = m_store->findAppKey("app7.exe");
+        SessionHistoryStore::Totals totals;
+        QBENCHMARK {
+            totals = m_store->totals(BASE + 100 * DAY, BASE + 107 * DAY, key);
+        }
+        QVERIFY(totals.sessions > 0);
+    }
+};
+
+QTEST_MAIN(BenchSessionHistory)
+#include "bench_SessionHistory.moc"
@@ -0,0 +1,126 @@
+#include <QtTest/QtTest>
+#include "domain/Application.h"
+#include "domain/GameSession.h"
+#include "repositories/ApplicationRepository.h"
+#include "services/infrastructure/DeadlineScheduler.h"
+#include "../mocks/MockTimeSource.h"
+#include <QElapsedTimer>
+#include <QRandomGenerator>
+#include <QTemporaryDir>
+#include <memory>
+
+/**
+ * @class BenchSessionSimulation
+ * @brief Replays a day of game sessions on the virtual clock.
+ *
+ * SESSION_COUNT sessions of APP_COUNT games start at random times over 24
+ * simulated hours. Each one runs through GameSession exactly as in the
+ * application: warnings and the time limit come from the shared
+ * DeadlineScheduler, and finished sessions update their Application, the
+ * repository indexes and the usage rollups. A share of the sessions is
+ * closed by the player before the limit.
+ *
+ * The whole day has to replay in well under a second of real time, which
+ * is what makes policy changes testable without waiting for the clock.
+ */
+class BenchSessionSimulation : public QObject
+{
+    Q_OBJECT
+
+private:
+    static constexpr int SESSION_COUNT = 2000;
+    static constexpr int APP_COUNT = 50;
+    static constexpr qint64 MINUTE = 60000;
+    static constexpr qint64 DAY = 24 * 60 * MINUTE;
+
+    struct Totals {
+        int warnings = 0;
+        int limitsReached = 0;
+        int closedEarly = 0;
+    };
+
+    static void replayDay(MockTimeSource& time, ApplicationRepository& repo, Totals& totals)
+    {
+        QRandomGenerator random(2024);
+        DeadlineScheduler scheduler(&time);
+        std::vector<std::unique_ptr<GameSession>> sessions;
+        sessions.reserve(SESSION_COUNT);
+
+        auto finish = [&repo, &time](GameSession* session) {
+            if (Application* app = repo.find(session->processName())) {
+                app->recordSessionEnd(session->startedAt(), time.currentSecsSinceEpoch(),
+                                      session->activeSeconds());
+            }
+        };
+
+        const qint64 dayStart = time.elapsed();
+        for (int i = 0; i < SESSION_COUNT; ++i) {
+            const QString name = QString("game%1.exe").arg(random.bounded(APP_COUNT));
+            const int limit = 20 + random.bounded(100);
+            const int played = random.bounded(limit + 30);     // Past the limit: stopped by it
+            const qint64 start = dayStart + random.bounded(DAY);
+
+            scheduler.schedule(start, [&, name, limit, played]() {
+                Application* app = repo.findOrCreate(name);
+                app->setCategory(Application::Category::Game);
+                app->recordSessionStart();
+
+                const size_t index = sessions.size();
+                sessions.emplace_back(new GameSession(static_cast<DWORD>(index + 1), name, &scheduler));
+                GameSession* session = sessions.back().get();
+                QObject::connect(session, &GameSession::warningIssued, [&totals]() { ++totals.warnings; });
+                QObject::connect(session, &GameSession::sessionFinished, [&, session]() {
+                    ++totals.limitsReached;
+                    finish(session);
+                });
+                session->setWarningMinutes(app->getWarningMinutes(limit));
+                session->startCountdown(limit);
+
+                if (played < limit) {
+                    scheduler.scheduleIn(played * MINUTE, [&, session, index]() {
+                        ++totals.closedEarly;
+                        finish(session);
+                        sessions[index].reset();    // Cancels its remaining deadlines
+                    });
+                }
+            });
+        }
+
+        time.advance(DAY + 3 * 60 * MINUTE);
+        QCOMPARE(scheduler.pendingCount(), 0);
+    }
+
+private slots:
+    void bench_replay_day() {
+        QTemporaryDir dir;
+        MockTimeSource time;
+        ScopedTimeSource installed(&time);
+        ApplicationRepository repo(dir.filePath("apps.json"));
+
+        Totals totals;
+        QElapsedTimer timer;
+        timer.start();
+        replayDay(time, repo, totals);
+        const qint64 elapsed = timer.elapsed();
+
+        QCOMPARE(totals.limitsReached + totals.closedEarly, SESSION_COUNT);
+        QVERIFY(totals.warnings > 0);
+        QVERIFY2(elapsed < 1000, qPrintable(QString("replay took %1 ms").arg(elapsed)));
+
+        int sessions = 0;
+        repo.forEach([&sessions](const Application& app) {
+            sessions += app.getTotalSessions();
+        });
+        QCOMPARE(sessions, SESSION_COUNT);
+
+        const UsageRollups::Usage day = repo.usageRollups().categoryUsage(
+            Application::Category::Game, UsageRollups::Resolution::Week,
+            MockTimeSource::DEFAULT_EPOCH, time.currentSecsSinceEpoch() + 1);
+        qInfo() << SESSION_COUNT << "sessions," << totals.warnings << "warnings,"
+                << totals.limitsReached << "limits reached," << day.seconds / 3600 << "hours played,"
+                << "replayed in" << elapsed << "ms";
+    }
+};
+
+QTEST_MAIN(BenchSessionSimulation)
+#include "bench_SessionSimulation.moc"
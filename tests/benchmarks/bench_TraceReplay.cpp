@@ -0,0 +1,149 @@
+#include <QtTest/QtTest>
+#include "services/infrastructure/ProcessMonitor.h"
+#include "services/infrastructure/ProcessTrace.h"
+#include "services/application/ProcessEventDispatcher.h"
+#include "managers/CategorizationManager.h"
+#include "managers/GameSessionManager.h"
+#include "repositories/ApplicationRepository.h"
+#include "services/logging/EventLogger.h"
+#include "../mocks/MockProcessSource.h"
+#include "../mocks/MockTimeSource.h"
+#include "../mocks/TraceReplayDriver.h"
+#include <QDir>
+#include <QTemporaryDir>
+
+/**
+ * @class BenchTraceReplay
+ * @brief Replays process traces through monitor, dispatcher and managers.
+ *
+ * Set MINDFULNESS_TRACE to a trace recorded in production (run the
+ * application with MINDFULNESS_PROCESS_TRACE=<file>) to replay it. Without
+ * one, each scenario in tests/scenarios is first recorded into a trace by
+ * running it through a RecordingProcessSource, which also checks that
+ * recording and replay agree.
+ *
+ * MINDFULNESS_REPLAY_SPEED sets the pace: 0 (the default) as fast as
+ * possible, 1 real time, n n times faster. The pipeline is wired as in
+ * bench_Pipeline and reports events, records replayed and events per
+ * second of wall time, so dispatcher and repository changes can be
+ * compared against real workloads offline.
+ */
+class BenchTraceReplay : public QObject
+{
+    Q_OBJECT
+
+private:
+    static constexpr int POLL = ProcessMonitor::POLL_INTERVAL_MS;
+
+    QTemporaryDir m_dir;
+
+    // Record a scenario the way the application records the live process list
+    static int recordScenario(const QString& scenarioPath, const QString& tracePath, QString* error)
+    {
+        ProcessScenario scenario;
+        if (!scenario.load(scenarioPath, error)) {
+            return -1;
+        }
+
+        QTemporaryDir dir;
+        MockTimeSource time;
+        ScopedTimeSource installed(&time);
+        ApplicationRepository repo(dir.filePath("apps.json"));
+        MockProcessSource processes;
+        RecordingProcessSource recorder(&processes, &time);
+        if (!recorder.open(tracePath)) {
+            *error = "cannot create " + tracePath;
+            return -1;
+        }
+
+        // No repository, so every start counts: the replay's repository
+        // starts out empty and filters nothing either
+        ProcessMonitor monitor(nullptr, &time, &recorder);
+        int started = 0;
+        connect(&monitor, &ProcessMonitor::processStarted, [&started]() { ++started; });
+        monitor.startMonitor();
+        time.advance(1);
+        ScenarioPlayer player(scenario, time, processes, &repo);
+        time.advanceTo(player.end() + 2 * POLL);
+        return started;
+    }
+
+private slots:
+    void initTestCase() {
+        LogFilter::configure("*=info");
+    }
+
+    void bench_replay_data() {
+        QTest::addColumn<QString>("path");
+        QTest::addColumn<int>("expectedStarts");
+
+        const QString trace = qEnvironmentVariable("MINDFULNESS_TRACE");
+        if (!trace.isEmpty()) {
+            QTest::newRow(qPrintable(QFileInfo(trace).fileName())) << trace << -1;
+            return;
+        }
+
+        const QDir dir(SCENARIO_DIR);
+        const QStringList files = dir.entryList({"*.scenario"}, QDir::Files, QDir::Name);
+        for (const QString& file : files) {
+            const QString path = m_dir.filePath(QFileInfo(file).completeBaseName() + ".trace");
+            QString error;
+            const int started = recordScenario(dir.filePath(file), path, &error);
+            QVERIFY2(started >= 0, qPrintable(error));
+            QTest::newRow(qPrintable(file)) << path << started;
+        }
+    }
+
+    void bench_replay() {
+        QFETCH(QString, path);
+        QFETCH(int, expectedStarts);
+
+        ProcessTraceReader trace;
+        QVERIFY2(trace.open(path), qPrintable(trace.errorString()));
+
+        QTemporaryDir dir;
+        MockTimeSource time(trace.startSecsSinceEpoch());
+        ScopedTimeSource installed(&time);
+        ReplayProcessSource replay(trace, &time);
+
+        ApplicationRepository repo(dir.filePath("apps.json"));
+        CategorizationManager categorization(&repo);
+        ProcessEventDispatcher dispatcher(&repo, &categorization);
+        GameSessionManager sessions(&repo, nullptr, &time);
+        ProcessMonitor monitor(&repo, &time, &replay);
+
+        int started = 0;
+        int terminated = 0;
+        connect(&monitor, &ProcessMonitor::processStarted,
+                &dispatcher, &ProcessEventDispatcher::onProcessStarted);
+        connect(&monitor, &ProcessMonitor::processTerminated,
+                &dispatcher, &ProcessEventDispatcher::onProcessTerminated);
+        connect(&dispatcher, &ProcessEventDispatcher::gameDetected,
+                &sessions, &GameSessionManager::onGameDetected);
+        connect(&monitor, &ProcessMonitor::processStarted, this, [&]() { ++started; });
+        connect(&monitor, &ProcessMonitor::processTerminated, this, [&]() { ++terminated; });
+
+        bool ok = false;
+        const double speed = qEnvironmentVariable("MINDFULNESS_REPLAY_SPEED").toDouble(&ok);
+        TraceReplayDriver driver(time, replay, ok ? speed : 0.0);
+        monitor.startMonitor();
+        const qint64 wall = driver.run(2 * POLL);
+
+        QVERIFY(replay.finished());
+        QVERIFY(!replay.isDamaged());
+        if (expectedStarts >= 0) {
+            QCOMPARE(started, expectedStarts);
+        }
+
+        const int events = started + terminated;
+        const double perSecond = wall > 0 ? events * 1000.0 / static_cast<double>(wall) : 0.0;
+        qInfo().noquote() << QFileInfo(path).fileName() << ":" << replay.recordsApplied() << "records over"
+                          << time.elapsed() / 1000 << "s," << started << "starts," << terminated << "exits,"
+                          << QFileInfo(path).size() << "bytes";
+        qInfo().noquote() << "  replayed in" << wall << "ms:" << QString::number(perSecond, 'f', 0) << "events/s";
+        QTest::setBenchmarkResult(perSecond, QTest::Events);
+    }
+};
+
+QTEST_GUILESS_MAIN(BenchTraceReplay)
+#include "bench_TraceReplay.moc"
@@ -0,0 +1,271 @@
+#ifndef MOCKPROCESSSOURCE_H
+#define MOCKPROCESSSOURCE_H
+
+#include "domain/Application.h"
+#include "repositories/ApplicationRepository.h"
+#include "services/infrastructure/DeadlineScheduler.h"
+#include "services/infrastructure/ProcessSource.h"
+#include "MockTimeSource.h"
+#include <QFile>
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+/**
+ * @brief Scripted process list for ProcessMonitor
+ *
+ * spawn() and exit() change the "running" processes; the monitor sees the
+ * change on its next poll, with the same semantics as the real source: a
+ * pid that exits and is reused between two polls keeps its old name.
+ */
+class MockProcessSource : public ProcessSource
+{
+public:
+    void update(QHash<DWORD, QString>& processes) override
+    {
+        ++m_updates;
+        auto it = processes.begin();
+        while (it != processes.end()) {
+            if (!m_running.contains(it.key())) {
+                it = processes.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        for (auto running = m_running.constBegin(); running != m_running.constEnd(); ++running) {
+            if (!processes.contains(running.key())) {
+                processes.insert(running.key(), running.value());
+            }
+        }
+    }
+
+    QHash<DWORD, DWORD> parentPids(const QList<DWORD>& pids) const override
+    {
+        QHash<DWORD, DWORD> parents;
+        for (DWORD pid : pids) {
+            if (m_parents.contains(pid)) {
+                parents.insert(pid, m_parents.value(pid));
+            }
+        }
+        return parents;
+    }
+
+    void spawn(DWORD pid, const QString& name, DWORD parent = 0)
+    {
+        m_running.insert(pid, name.toLower());
+        if (parent) {
+            m_parents.insert(pid, parent);
+        } else {
+            m_parents.remove(pid);
+        }
+    }
+    void exit(DWORD pid) { m_running.remove(pid); m_parents.remove(pid); }
+    void clear() { m_running.clear(); m_parents.clear(); }
+
+    int runningCount() const { return m_running.size(); }
+    int updateCount() const { return m_updates; }
+
+private:
+    QHash<DWORD, QString> m_running;
+    QHash<DWORD, DWORD> m_parents;
+    int m_updates = 0;
+};
+
+/**
+ * @brief A timed script of process and catalog changes
+ *
+ * One command per line; '#' starts a comment. Commands take effect at the
+ * script clock, which starts at 0 and only moves with wait:
+ *
+ *   wait <ms>                          move the script clock forward
+ *   app <name> <category>              create or recategorize an application
+ *   spawn <pid> <name>                 start a process
+ *   exit <pid>                         end a process
+ *   burst <count> <firstPid> <name>    start count processes with consecutive
+ *                                      pids; %1 in name becomes 0..count-1
+ *   exitburst <count> <firstPid>       end count consecutive pids
+ *
+ * Category names are those of Application::categoryToString().
+ */
+class ProcessScenario
+{
+public:
+    enum class Op {
+        App,
+        Spawn,
+        Exit,
+        Burst,
+        ExitBurst
+    };
+
+    struct Step {
+        qint64 at;
+        Op op;
+        DWORD pid;
+        int count;
+        QString name;
+        Application::Category category;
+    };
+
+    QList<Step> steps;
+    qint64 duration = 0;
+
+    /**
+     * @return false with a message naming the line if the script is malformed
+     */
+    bool parse(const QString& text, QString* error = nullptr)
+    {
+        steps.clear();
+        duration = 0;
+
+        const QStringList lines = text.split('\n');
+        for (int i = 0; i < lines.size(); ++i) {
+            const QString line = lines[i].section('#', 0, 0).trimmed();
+            if (line.isEmpty()) {
+                continue;
+            }
+
+            const QStringList words = line.split(' ', Qt::SkipEmptyParts);
+            const QString& command = words[0];
+            bool ok = true;
+            Step step{duration, Op::Spawn, 0, 1, QString(), Application::Category::Uncategorized};
+
+            if (command == "wait" && words.size() == 2) {
+                duration += words[1].toLongLong(&ok);
+                if (ok) {
+                    continue;
+                }
+            } else if (command == "app" && words.size() == 3) {
+                step.op = Op::App;
+                step.name = words[1];
+                step.category = Application::categoryFromString(words[2]);
+            } else if (command == "spawn" && words.size() == 3) {
+                step.pid = words[1].toUInt(&ok);
+                step.name = words[2];
+            } else if (command == "exit" && words.size() == 2) {
+                step.op = Op::Exit;
+                step.pid = words[1].toUInt(&ok);
+            } else if (command == "burst" && words.size() == 4) {
+                bool pidOk = false;
+                step.op = Op::Burst;
+                step.count = words[1].toInt(&ok);
+                step.pid = words[2].toUInt(&pidOk);
+                step.name = words[3];
+                ok = ok && pidOk;
+            } else if (command == "exitburst" && words.size() == 3) {
+                bool pidOk = false;
+                step.op = Op::ExitBurst;
+                step.count = words[1].toInt(&ok);
+                step.pid = words[2].toUInt(&pidOk);
+                ok = ok && pidOk;
+            } else {
+                ok = false;
+            }
+
+            if (!ok) {
+                if (error) {
+                    *error = QString("line %1: cannot parse '%2'").arg(i + 1).arg(line);
+                }
+                return false;
+            }
+            steps.append(step);
+        }
+        return true;
+    }
+
+    bool load(const QString& path, QString* error = nullptr)
+    {
+        QFile file(path);
+        if (!file.open(QIODevice::ReadOnly)) {
+            if (error) {
+                *error = "cannot open " + path;
+            }
+            return false;
+        }
+        return parse(QString::fromUtf8(file.readAll()), error);
+    }
+};
+
+/**
+ * @brief Plays a ProcessScenario on a virtual clock
+ *
+ * Each step is scheduled at its script time (relative to the clock when
+ * the player is created), so advancing the MockTimeSource interleaves the
+ * steps with the monitor's polls exactly as they would happen live.
+ */
+class ScenarioPlayer
+{
+public:
+    ScenarioPlayer(const ProcessScenario& scenario, MockTimeSource& time,
+                   MockProcessSource& processes, ApplicationRepository* repository)
+        : m_scheduler(&time),
+          m_time(time),
+          m_processes(processes),
+          m_repository(repository)
+    {
+        const qint64 start = time.elapsed();
+        for (const ProcessScenario::Step& step : scenario.steps) {
+            m_scheduler.schedule(start + step.at, [this, step]() { apply(step); });
+        }
+        m_end = start + scenario.duration;
+    }
+
+    /**
+     * @brief Virtual time at which pid was last spawned, -1 if never
+     */
+    qint64 spawnedAt(DWORD pid) const { return m_spawnedAt.value(pid, -1); }
+
+    qint64 end() const { return m_end; }
+    int spawned() const { return m_spawnCount; }
+    int exited() const { return m_exitCount; }
+    bool finished() const { return m_scheduler.pendingCount() == 0; }
+
+private:
+    void apply(const ProcessScenario::Step& step)
+    {
+        switch (step.op) {
+        case ProcessScenario::Op::App:
+            if (m_repository) {
+                m_repository->findOrCreate(step.name)->setCategory(step.category);
+            }
+            break;
+        case ProcessScenario::Op::Spawn:
+            spawn(step.pid, step.name);
+            break;
+        case ProcessScenario::Op::Exit:
+            m_processes.exit(step.pid);
+            ++m_exitCount;
+            break;
+        case ProcessScenario::Op::Burst:
+            for (int i = 0; i < step.count; ++i) {
+                spawn(step.pid + static_cast<DWORD>(i), QString(step.name).replace("%1", QString::number(i)));
+            }
+            break;
+        case ProcessScenario::Op::ExitBurst:
+            for (int i = 0; i < step.count; ++i) {
+                m_processes.exit(step.pid + static_cast<DWORD>(i));
+            }
+            m_exitCount += step.count;
+            break;
+        }
+    }
+
+    void spawn(DWORD pid, const QString& name)
+    {
+        m_processes.spawn(pid, name);
+        m_spawnedAt.insert(pid, m_time.elapsed());
+        ++m_spawnCount;
+    }
+
+    DeadlineScheduler m_scheduler;
+    MockTimeSource& m_time;
+    MockProcessSource& m_processes;
+    ApplicationRepository* m_repository;
+    QHash<DWORD, qint64> m_spawnedAt;
+    qint64 m_end = 0;
+    int m_spawnCount = 0;
+    int m_exitCount = 0;
+};
+
+#endif // MOCKPROCESSSOURCE_H
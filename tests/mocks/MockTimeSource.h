@@ -0,0 +1,98 @@
+#ifndef MOCKTIMESOURCE_H
+#define MOCKTIMESOURCE_H
+
+#include "services/infrastructure/DeadlineScheduler.h"
+#include "services/infrastructure/TimeSource.h"
+#include <QList>
+
+/**
+ * @brief Virtual clock for tests and simulations
+ *
+ * Time stands still until advance() or advanceTo() is called. Every
+ * DeadlineScheduler built on this source attaches to it, and advancing
+ * runs their deadlines in time order, with elapsed() reading exactly each
+ * deadline while its callbacks run. A simulated day costs only the work
+ * done at its deadlines, not the time in between.
+ *
+ * Wall-clock time is the starting epoch plus elapsed time; setWallClock()
+ * moves it independently to simulate a clock change.
+ *
+ * Not thread-safe: advance it from the thread that owns the schedulers.
+ */
+class MockTimeSource : public TimeSource
+{
+public:
+    static constexpr qint64 DEFAULT_EPOCH = 1700000000;    // 2023-11-14 22:13:20 UTC
+
+    explicit MockTimeSource(qint64 epochSeconds = DEFAULT_EPOCH)
+        : m_now(0), m_wallOffset(epochSeconds * 1000)
+    {
+    }
+
+    qint64 elapsed() const override { return m_now; }
+    qint64 currentSecsSinceEpoch() const override { return (m_wallOffset + m_now) / 1000; }
+    bool isVirtual() const override { return true; }
+
+    void attach(DeadlineScheduler* scheduler) override { m_schedulers.append(scheduler); }
+    void detach(DeadlineScheduler* scheduler) override { m_schedulers.removeOne(scheduler); }
+
+    /**
+     * @brief Move time forward by ms, running every deadline on the way
+     * @return Number of callbacks run
+     */
+    int advance(qint64 ms) { return advanceTo(m_now + ms); }
+
+    int advanceTo(qint64 time)
+    {
+        int ran = 0;
+        for (;;) {
+            // Earliest deadline over all schedulers; callbacks may add or
+            // remove schedulers, so look again after every step
+            DeadlineScheduler* earliest = nullptr;
+            qint64 next = -1;
+            for (DeadlineScheduler* scheduler : m_schedulers) {
+                qint64 deadline = scheduler->nextDeadline();
+                if (deadline >= 0 && (next < 0 || deadline < next)) {
+                    earliest = scheduler;
+                    next = deadline;
+                }
+            }
+            if (!earliest || next > time) {
+                break;
+            }
+            m_now = qMax(m_now, next);
+            ran += earliest->advanceTo(m_now);
+        }
+        m_now = qMax(m_now, time);
+        const QList<DeadlineScheduler*> schedulers = m_schedulers;
+        for (DeadlineScheduler* scheduler : schedulers) {
+            ran += scheduler->advanceTo(m_now);
+        }
+        return ran;
+    }
+
+    /**
+     * @brief Set the wall clock without moving monotonic time
+     */
+    void setWallClock(qint64 secondsSinceEpoch) { m_wallOffset = secondsSinceEpoch * 1000 - m_now; }
+
+private:
+    qint64 m_now;
+    qint64 m_wallOffset;
+    QList<DeadlineScheduler*> m_schedulers;
+};
+
+/**
+ * @brief Installs a source as TimeSource::current() for the lifetime of a scope
+ */
+class ScopedTimeSource
+{
+public:
+    explicit ScopedTimeSource(TimeSource* source) { TimeSource::setCurrent(source); }
+    ~ScopedTimeSource() { TimeSource::setCurrent(nullptr); }
+
+    ScopedTimeSource(const ScopedTimeSource&) = delete;
+    ScopedTimeSource& operator=(const ScopedTimeSource&) = delete;
+};
+
+#endif // MOCKTIMESOURCE_H
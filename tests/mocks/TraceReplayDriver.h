@@ -0,0 +1,77 @@
+#ifndef TRACEREPLAYDRIVER_H
+#define TRACEREPLAYDRIVER_H
+
+#include "services/infrastructure/ProcessTrace.h"
+#include "MockTimeSource.h"
+#include <QElapsedTimer>
+#include <QThread>
+
+/**
+ * @brief Feeds a recorded process trace through the pipeline
+ *
+ * The ReplayProcessSource and everything polling it run on a
+ * MockTimeSource; the driver decides how fast that clock moves:
+ *
+ * - speed 0: as fast as possible. The clock jumps straight to each record,
+ *   so only the polls and deadlines in between cost anything.
+ * - speed 1: real time, as recorded.
+ * - speed n: n times faster than real time.
+ *
+ * Paced replays advance the clock in PACED_STEP_MS steps and sleep until
+ * the wall clock has caught up with each one, so polls and timers keep
+ * their recorded spacing, scaled by the speed.
+ */
+class TraceReplayDriver
+{
+public:
+    static constexpr qint64 PACED_STEP_MS = 50;
+
+    TraceReplayDriver(MockTimeSource& time, ReplayProcessSource& source, double speed = 0.0)
+        : m_time(time),
+          m_source(source),
+          m_speed(speed)
+    {
+    }
+
+    /**
+     * @brief Replay the whole trace, then run tail ms more so its last
+     * records are polled
+     * @return Wall-clock milliseconds the replay took
+     */
+    qint64 run(qint64 tail)
+    {
+        m_wall.start();
+        m_origin = m_time.elapsed();
+        while (!m_source.finished()) {
+            advanceTo(m_source.nextDue());
+        }
+        advanceTo(m_time.elapsed() + tail);
+        return m_wall.elapsed();
+    }
+
+private:
+    void advanceTo(qint64 target)
+    {
+        if (m_speed <= 0.0) {
+            m_time.advanceTo(target);
+            return;
+        }
+        while (m_time.elapsed() < target) {
+            const qint64 step = qMin(target, m_time.elapsed() + PACED_STEP_MS);
+            const qint64 wallDue = static_cast<qint64>(static_cast<double>(step - m_origin) / m_speed);
+            const qint64 wait = wallDue - m_wall.elapsed();
+            if (wait > 0) {
+                QThread::msleep(static_cast<unsigned long>(wait));
+            }
+            m_time.advanceTo(step);
+        }
+    }
+
+    MockTimeSource& m_time;
+    ReplayProcessSource& m_source;
+    double m_speed;
+    QElapsedTimer m_wall;
+    qint64 m_origin = 0;
+};
+
+#endif // TRACEREPLAYDRIVER_H
@@ -0,0 +1,212 @@
+#include <QtTest/QtTest>
+#include "services/metrics/AllocationTracker.h"
+#include "services/infrastructure/ProcessMonitor.h"
+#include "services/application/ProcessEventDispatcher.h"
+#include "services/utils/ProcessUtils.h"
+#include "managers/CategorizationManager.h"
+#include "repositories/ApplicationRepository.h"
+#include "domain/Application.h"
+#include "services/logging/EventLogger.h"
+#include "../mocks/MockProcessSource.h"
+#include "../mocks/MockTimeSource.h"
+#include <QTemporaryDir>
+#include <memory>
+#include <thread>
+
+/**
+ * @class TestAllocations
+ * @brief Allocation budgets for the paths that run on every poll.
+ *
+ * Built with MF_TRACK_ALLOCATIONS, so every operator new in this binary is
+ * counted (see AllocationTracker for what that leaves out). This class tests:
+ * 1. Counting per thread and per scope.
+ * 2. A steady-state monitor tick (scheduler included) within TICK_BUDGET.
+ * 3. The process snapshot diff when nothing changed.
+ * 4. Dispatch of known and unknown processes within DISPATCH_BUDGET.
+ * 5. Repository lookups within LOOKUP_BUDGET.
+ *
+ * A failure prints what was allocated; raise a budget only together with
+ * the change that needs it.
+ */
+class TestAllocations : public QObject
+{
+    Q_OBJECT
+
+private:
+    static constexpr int POLL = ProcessMonitor::POLL_INTERVAL_MS;
+    static constexpr quint64 TICK_BUDGET = 0;
+    static constexpr quint64 DISPATCH_BUDGET = 0;
+    static constexpr quint64 LOOKUP_BUDGET = 0;
+    static constexpr int APP_COUNT = 1000;
+    static constexpr int ROUNDS = 100;
+
+    QTemporaryDir m_dir;
+
+    static QString processName(int i)
+    {
+        return QString("app%1.exe").arg(i);
+    }
+
+    // Every tenth application is a game, the rest work applications
+    static void fill(ApplicationRepository& repository)
+    {
+        for (int i = 0; i < APP_COUNT; ++i) {
+            Application app(processName(i), i % 10 == 0 ? Application::Category::Game
+                                                        : Application::Category::Work);
+            repository.save(&app);
+        }
+        repository.publishSnapshot();
+    }
+
+    static QByteArray describe(const AllocationStats& stats, int rounds)
+    {
+        return QByteArray::number(stats.allocations) + " allocations (" + QByteArray::number(stats.bytes)
+            + " bytes) over " + QByteArray::number(rounds) + " rounds";
+    }
+
+private slots:
+    void initTestCase() {
+        QVERIFY(AllocationTracker::ENABLED);
+        QVERIFY(m_dir.isValid());
+        // Debug lines are formatted and printed; budgets are for the paths themselves
+        LogFilter::configure("*=info");
+    }
+
+    void test_scope_counts_this_thread() {
+        AllocationScope scope;
+        std::unique_ptr<QObject> object(new QObject);
+        const AllocationStats allocated = scope.stats();
+        QVERIFY(allocated.allocations >= 1);
+        QVERIFY(allocated.bytes >= sizeof(QObject));
+
+        object.reset();
+        QVERIFY(scope.stats().frees >= 1);
+    }
+
+    void test_other_threads_not_in_scope() {
+        AllocationStats worker;
+        const AllocationStats totalBefore = AllocationTracker::total();
+        std::thread thread([&worker]() {
+            AllocationScope scope;
+            delete new QObject;
+            worker = scope.stats();
+        });
+
+        // Started after the thread object (which allocates here) exists
+        AllocationScope scope;
+        thread.join();
+        QCOMPARE(scope.stats().allocations, quint64(0));
+        QVERIFY(worker.allocations >= 1);
+        QVERIFY(AllocationTracker::total().allocations - totalBefore.allocations >= worker.allocations);
+    }
+
+    void test_steady_monitor_tick() {
+        ApplicationRepository repository(m_dir.filePath("tick.json"));
+        fill(repository);
+
+        MockTimeSource time;
+        MockProcessSource processes;
+        for (int i = 0; i < APP_COUNT; ++i) {
+            processes.spawn(static_cast<DWORD>(4 * (i + 1)), processName(i));
+        }
+        for (int i = 0; i < 100; ++i) {
+            processes.spawn(static_cast<DWORD>(100000 + i), QString("unknown%1.exe").arg(i));
+        }
+
+        ProcessMonitor monitor(&repository, &time, &processes);
+        QSignalSpy started(&monitor, &ProcessMonitor::processStarted);
+        monitor.startMonitor();
+
+        // The first polls see every process and size the containers
+        time.advance(3 * POLL);
+        const int seen = started.count();
+        QVERIFY(seen > 0);
+
+        AllocationScope scope;
+        time.advance(ROUNDS * POLL);
+        const AllocationStats stats = scope.stats();
+        QCOMPARE(processes.updateCount(), ROUNDS + 3);
+        QCOMPARE(started.count(), seen);
+        QVERIFY2(stats.allocations <= TICK_BUDGET * ROUNDS, describe(stats, ROUNDS));
+        monitor.stopMonitor();
+    }
+
+    void test_unchanged_snapshot_diff() {
+        QSet<DWORD> running;
+        for (DWORD pid = 4; pid < 4 * 500; pid += 4) {
+            running.insert(pid);
+        }
+        const QString name("synthetic.exe");
+        QHash<DWORD, QString> map;
+        ProcessUtils::applySnapshot(map, running, [&name](DWORD) { return name; });
+
+        AllocationScope scope;
+        for (int round = 0; round < ROUNDS; ++round) {
+            ProcessUtils::applySnapshot(map, running, [&name](DWORD) { return name; });
+        }
+        const AllocationStats stats = scope.stats();
+        QCOMPARE(map.size(), running.size());
+        QVERIFY2(stats.allocations == 0, describe(stats, ROUNDS));
+    }
+
+    void test_dispatch() {
+        ApplicationRepository repository(m_dir.filePath("dispatch.json"));
+        fill(repository);
+        CategorizationManager categorization(&repository);
+        ProcessEventDispatcher dispatcher(&repository, &categorization);
+        int games = 0;
+        int work = 0;
+        int uncategorized = 0;
+        connect(&dispatcher, &ProcessEventDispatcher::gameDetected, this, [&games]() { ++games; });
+        connect(&dispatcher, &ProcessEventDispatcher::workApplicationDetected, this, [&work]() { ++work; });
+        connect(&dispatcher, &ProcessEventDispatcher::uncategorizedAppDetected, this,
+                [&uncategorized]() { ++uncategorized; });
+
+        // Names are built before measuring; the monitor hands over its own
+        QStringList names;
+        for (int i = 0; i < ROUNDS; ++i) {
+            names.append(processName(i));
+        }
+        const QString unknown("neverseen.exe");
+        dispatcher.onProcessStarted(1, names.first());
+
+        AllocationScope scope;
+        for (int i = 0; i < ROUNDS; ++i) {
+            dispatcher.onProcessStarted(static_cast<DWORD>(i + 2), names[i]);
+            dispatcher.onProcessStarted(static_cast<DWORD>(i + 2), unknown);
+        }
+        const AllocationStats stats = scope.stats();
+        QCOMPARE(games, 1 + ROUNDS / 10);
+        QCOMPARE(work, ROUNDS - ROUNDS / 10);
+        QCOMPARE(uncategorized, ROUNDS);
+        QVERIFY2(stats.allocations <= DISPATCH_BUDGET * ROUNDS, describe(stats, ROUNDS));
+    }
+
+    void test_repository_lookup() {
+        ApplicationRepository repository(m_dir.filePath("lookup.json"));
+        fill(repository);
+
+        QStringList names;
+        for (int i = 0; i < ROUNDS; ++i) {
+            names.append(processName(i * 7 % APP_COUNT));
+        }
+        const QString missing("missing.exe");
+        repository.find(names.first());
+
+        AllocationScope scope;
+        int found = 0;
+        for (const QString& name : names) {
+            found += repository.find(name) ? 1 : 0;
+            found += repository.findOrCreate(name) ? 1 : 0;
+            found += repository.find(missing) ? 1 : 0;
+            const ApplicationRepository::SnapshotGuard snapshot = repository.readSnapshot();
+            found += snapshot->find(name) ? 1 : 0;
+        }
+        const AllocationStats stats = scope.stats();
+        QCOMPARE(found, 3 * ROUNDS);
+        QVERIFY2(stats.allocations <= LOOKUP_BUDGET * ROUNDS, describe(stats, ROUNDS));
+    }
+};
+
+QTEST_GUILESS_MAIN(TestAllocations)
+#include "test_Allocations.moc"
@@ -1,8 +1,16 @@
 #include <QtTest/QtTest>
 #include "repositories/ApplicationRepository.h"
+#include "repositories/ApplicationCodecs.h"
+#include "repositories/ApplicationImporter.h"
+#include "repositories/SnapshotPublisher.h"
 #include "domain/Application.h" // Include the new Application class
+#include "../mocks/MockTimeSource.h"
+#include <QDateTime>
 #include <QFile>
 #include <QDebug>
+#include <QThread>
+#include <QTimeZone>
+#include <memory>
 
 /**
  * @class TestApplicationRepository
@@ -15,6 +23,19 @@
  * 4. Persisting changes (Save/Load).
  * 5. Case-insensitivity of lookups.
  * 6. Correctly overwriting data.
+ * 7. Keeping the category and usage indexes in sync with entity changes.
+ * 8. Publishing snapshots for background readers, batched and unbatched,
+ *    coalesced per event loop turn and sharing unchanged entries.
+ * 9. Detecting stale ApplicationId handles after removal and reuse.
+ * 10. Composing ApplicationQuery filters for in-place forEach() walks.
+ * 11. Streaming loads that span several import chunks, and rejecting
+ *     truncated files without losing the loaded data. Out-of-range enum
+ *     values fall back to their defaults.
+ * 12. Usage rollups fed by finished sessions to the second, split across buckets,
+ *     bucketed by local calendar days and persisted with the repository.
+ * 13. Session length sketches: percentiles, persistence, merging over a
+ *     query and the history-aware warning schedule.
+ * 14. Timestamps and recency queries following an injected TimeSource.
  */
 class TestApplicationRepository : public QObject
 {
@@ -163,6 +184,548 @@ private slots:
         app->setCategory(Application::Category::Game);
         QCOMPARE(repo.findOrCreate("app.exe")->getCategory(), Application::Category::Game);
     }
+    
+    /**
+     * @brief Tests that the category index follows setCategory() and remove().
+     */
+    void test_category_index_tracks_changes() {
+        ApplicationRepository repo(m_testDbPath);
+        
+        Application* app = repo.findOrCreate("indexed.exe");
+        QVERIFY(repo.findByCategory(Application::Category::Uncategorized).contains(app));
+        
+        // Changing the category through the entity moves it between buckets
+        app->setCategory(Application::Category::Game);
+        QVERIFY(!repo.findByCategory(Application::Category::Uncategorized).contains(app));
+        QCOMPARE(repo.findByCategory(Application::Category::Game).size(), 1);
+        
+        QList<Application*> games = repo.findByCategories({
+            Application::Category::Game,
+            Application::Category::Leisure
+        });
+        QCOMPARE(games.size(), 1);
+        QCOMPARE(games.first(), app);
+        
+        // Removed applications disappear from every index
+        QVERIFY(repo.remove("indexed.exe"));
+        QVERIFY(repo.findByCategory(Application::Category::Game).isEmpty());
+        QVERIFY(repo.findRecentlyUsed().isEmpty());
+    }
+    
+    /**
+     * @brief Tests that usage queries are ordered and honor their limits.
+     */
+    void test_usage_indexes_order_and_limit() {
+        ApplicationRepository repo(m_testDbPath);
+        
+        Application* rare = repo.findOrCreate("rare.exe");
+        Application* often = repo.findOrCreate("often.exe");
+        for (int i = 0; i < 12; ++i) {
+            often->recordSessionStart();
+        }
+        for (int i = 0; i < 11; ++i) {
+            rare->recordSessionStart();
+        }
+        
+        QList<Application*> frequent = repo.findFrequentlyUsed(10);
+        QCOMPARE(frequent.size(), 2);
+        QCOMPARE(frequent.first(), often);
+        
+        QList<Application*> top = repo.findFrequentlyUsed(0, 1);
+        QCOMPARE(top.size(), 1);
+        QCOMPARE(top.first(), often);
+        
+        QCOMPARE(repo.findRecentlyUsed(7, 1).size(), 1);
+        QCOMPARE(repo.findRecentlyUsed(7).size(), 2);
+    }
+    
+    /**
+     * @brief Tests that changes reach the published snapshot.
+     */
+    void test_snapshot_publishes_changes() {
+        ApplicationRepository repo(m_testDbPath);
+        
+        quint64 initialVersion = repo.readSnapshot()->version();
+        QVERIFY(!repo.readSnapshot()->exists("snap.exe"));
+        
+        Application* app = repo.findOrCreate("snap.exe");
+        app->setCategory(Application::Category::Game);
+        
+        {
+            ApplicationRepository::SnapshotGuard snapshot = repo.readSnapshot();
+            const Application* copy = snapshot->find("SNAP.EXE");
+            QVERIFY(copy != nullptr);
+            QVERIFY(copy != app); // Readers get their own immutable copy
+            QCOMPARE(copy->getCategory(), Application::Category::Game);
+            QVERIFY(snapshot->version() > initialVersion);
+        }
+        
+        QVERIFY(repo.remove("snap.exe"));
+        QVERIFY(!repo.readSnapshot()->exists("snap.exe"));
+    }
+    
+    /**
+     * @brief Tests that readers beyond the slot count still get in, and
+     * keep their version alive until they leave.
+     */
+    void test_snapshot_readers_overflow() {
+        SnapshotPublisher<int> publisher;
+        publisher.publish(std::make_unique<const int>(1));
+        
+        std::vector<SnapshotPublisher<int>::ReadGuard> readers;
+        for (int i = 0; i < 100; ++i) {
+            readers.push_back(publisher.read());
+            QCOMPARE(*readers.back(), 1);
+        }
+        
+        publisher.publish(std::make_unique<const int>(2));
+        QCOMPARE(*publisher.read(), 2);
+        QCOMPARE(publisher.retiredCount(), size_t(1));
+        
+        // The slotted readers leave first; the overflow ones still hold 1
+        readers.erase(readers.begin(), readers.begin() + 64);
+        publisher.reclaim();
+        QCOMPARE(publisher.retiredCount(), size_t(1));
+        QCOMPARE(*readers.back(), 1);
+        
+        readers.clear();
+        publisher.reclaim();
+        QCOMPARE(publisher.retiredCount(), size_t(0));
+    }
+    
+    /**
+     * @brief Tests that a BatchUpdate publishes exactly one new version.
+     */
+    void test_snapshot_batches_changes() {
+        ApplicationRepository repo(m_testDbPath);
+        quint64 before = repo.readSnapshot()->version();
+        
+        {
+            ApplicationRepository::BatchUpdate batch(&repo);
+            repo.findOrCreate("one.exe")->setCategory(Application::Category::Work);
+            repo.findOrCreate("two.exe")->setCategory(Application::Category::Game);
+            
+            // Nothing is visible to readers until the batch ends
+            QCOMPARE(repo.readSnapshot()->version(), before);
+            QCOMPARE(repo.readSnapshot()->count(), 0);
+        }
+        
+        ApplicationRepository::SnapshotGuard snapshot = repo.readSnapshot();
+        QCOMPARE(snapshot->version(), before + 1);
+        QCOMPARE(snapshot->count(), 2);
+        QCOMPARE(snapshot->find("two.exe")->getCategory(), Application::Category::Game);
+    }
+
+    /**
+     * @brief Tests that changes outside a batch are published together on
+     * the next event loop turn, and that versions share unchanged entries.
+     */
+    void test_snapshot_coalesces_and_shares() {
+        ApplicationRepository repo(m_testDbPath);
+        {
+            ApplicationRepository::BatchUpdate batch(&repo);
+            for (int i = 0; i < 100; ++i) {
+                repo.findOrCreate(QString("app%1.exe").arg(i));
+            }
+        }
+        ApplicationRepository::SnapshotGuard before = repo.readSnapshot();
+
+        repo.find("app1.exe")->setCategory(Application::Category::Game);
+        repo.find("app2.exe")->setCategory(Application::Category::Work);
+        repo.remove("app3.exe");
+
+        // Other threads see all three changes, as one version, once the
+        // event loop has turned
+        quint64 seen = 0;
+        auto readVersion = [&repo, &seen]() {
+            std::unique_ptr<QThread> reader(QThread::create([&repo, &seen]() {
+                seen = repo.readSnapshot()->version();
+            }));
+            reader->start();
+            reader->wait();
+        };
+        readVersion();
+        QCOMPARE(seen, before->version());
+        QTest::qWait(0);
+        readVersion();
+        QCOMPARE(seen, before->version() + 1);
+
+        ApplicationRepository::SnapshotGuard after = repo.readSnapshot();
+        QCOMPARE(after->count(), 99);
+        QCOMPARE(after->find("app1.exe")->getCategory(), Application::Category::Game);
+        QVERIFY(!after->exists("app3.exe"));
+
+        // The older version is untouched, and unchanged entries are shared
+        QCOMPARE(before->count(), 100);
+        QCOMPARE(before->find("app1.exe")->getCategory(), Application::Category::Uncategorized);
+        QVERIFY(before->exists("app3.exe"));
+        QVERIFY(before->find("app4.exe") == after->find("app4.exe"));
+        QVERIFY(before->find("app1.exe") != after->find("app1.exe"));
+    }
+
+    /**
+     * @brief Tests that handles resolve until their entry is removed, even
+     * when the freed slot is reused by another application.
+     */
+    void test_stale_handle_detected() {
+        ApplicationRepository repo(m_testDbPath);
+        
+        Application* app = repo.findOrCreate("handle.exe");
+        ApplicationId id = repo.findId("HANDLE.EXE");
+        QVERIFY(!id.isNull());
+        QCOMPARE(repo.idOf(app), id);
+        QCOMPARE(repo.get(id), app);
+        
+        QVERIFY(repo.remove("handle.exe"));
+        QVERIFY(repo.get(id) == nullptr);
+        QVERIFY(repo.findId("handle.exe").isNull());
+        
+        // The next entry takes the freed slot but gets a new generation
+        Application* reused = repo.findOrCreate("other.exe");
+        ApplicationId reusedId = repo.idOf(reused);
+        QCOMPARE(reusedId.index, id.index);
+        QVERIFY(reusedId != id);
+        QVERIFY(repo.get(id) == nullptr);
+        QCOMPARE(repo.get(reusedId), reused);
+        
+        // Saving a detached copy updates the stored entry in place
+        Application copy = *reused;
+        copy.setCategory(Application::Category::Work);
+        repo.save(&copy);
+        QCOMPARE(repo.get(reusedId), reused);
+        QCOMPARE(reused->getCategory(), Application::Category::Work);
+        QVERIFY(repo.idOf(&copy).isNull());
+        
+        // Clearing invalidates every outstanding handle
+        repo.clear();
+        QVERIFY(repo.get(reusedId) == nullptr);
+        QVERIFY(repo.get(ApplicationId()) == nullptr);
+    }
+    
+    /**
+     * @brief Tests that category, lastSeen and session filters combine with AND.
+     */
+    void test_query_filters_compose() {
+        ApplicationRepository repo(m_testDbPath);
+        
+        Application* busyGame = repo.findOrCreate("busy_game.exe");
+        busyGame->setCategory(Application::Category::Game);
+        for (int i = 0; i < 5; ++i) {
+            busyGame->recordSessionStart();
+        }
+        Application* idleGame = repo.findOrCreate("idle_game.exe");
+        idleGame->setCategory(Application::Category::Game);
+        Application* busyWork = repo.findOrCreate("busy_work.exe");
+        busyWork->setCategory(Application::Category::Work);
+        for (int i = 0; i < 5; ++i) {
+            busyWork->recordSessionStart();
+        }
+        
+        qint64 lastHour = QDateTime::currentSecsSinceEpoch() - 3600;
+        ApplicationQuery games = ApplicationQuery().inCategories({Application::Category::Game});
+        ApplicationQuery busy = ApplicationQuery().withMinSessions(3);
+        
+        QCOMPARE(repo.count(games), 2);
+        QCOMPARE(repo.count(busy), 2);
+        QCOMPARE(repo.count(games & busy), 1);
+        QCOMPARE(repo.count(ApplicationQuery(games).seenSince(lastHour).withMinSessions(3)), 1);
+        QCOMPARE(repo.count(ApplicationQuery().seenBetween(0, lastHour)), 0);
+        QCOMPARE(repo.count(ApplicationQuery().excludingCategories({Application::Category::Game})), 1);
+        QCOMPARE(repo.count(games & ApplicationQuery().inCategories({Application::Category::Work})), 0);
+        QCOMPARE(repo.count(ApplicationQuery()), 3);
+        
+        // Visitors see the stored entities themselves, not copies
+        const Application* visited = nullptr;
+        repo.forEach(games & busy, [&visited](const Application& app) {
+            visited = &app;
+        });
+        QCOMPARE(visited, busyGame);
+        
+        // Returning false stops the walk
+        int calls = 0;
+        repo.forEach([&calls](const Application&) {
+            ++calls;
+            return false;
+        });
+        QCOMPARE(calls, 1);
+    }
+    
+    /**
+     * @brief Tests a load large enough to be split into several import
+     * chunks, and that a truncated file is rejected as a whole.
+     */
+    void test_streaming_load_spans_chunks() {
+        const int appCount = 5000;
+        {
+            ApplicationRepository repo(m_testDbPath);
+            for (int i = 0; i < appCount; ++i) {
+                Application* app = repo.findOrCreate(QString("stream%1.exe").arg(i));
+                app->setDisplayName(QString("Stream \"%1\"").arg(i));
+                app->setCategory(i % 2 ? Application::Category::Game : Application::Category::Work);
+            }
+            QVERIFY(repo.saveAll());
+        }
+        
+        QFile file(m_testDbPath);
+        QVERIFY(file.open(QIODevice::ReadOnly));
+        QByteArray data = file.readAll();
+        file.close();
+        QVERIFY(data.size() > 2 * ApplicationImporter::DEFAULT_CHUNK_BYTES);
+        
+        ApplicationRepository repo(m_testDbPath);
+        QCOMPARE(repo.count(ApplicationQuery()), appCount);
+        for (int i = 0; i < appCount; i += 997) {
+            const Application* app = repo.find(QString("stream%1.exe").arg(i));
+            QVERIFY(app != nullptr);
+            QCOMPARE(app->getDisplayName(), QString("Stream \"%1\"").arg(i));
+        }
+        
+        // Cut the file inside the applications array
+        QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+        file.write(data.left(data.size() / 2));
+        file.close();
+        
+        QVERIFY(!repo.load());
+        QCOMPARE(repo.count(ApplicationQuery()), appCount);
+    }
+    
+    /**
+     * @brief Tests that enum fields out of range in a file fall back to
+     * their defaults instead of being truncated into their bitfields.
+     */
+    void test_out_of_range_enums_fall_back() {
+        QFile file(m_testDbPath);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write("{\"version\": 1, \"applications\": ["
+                   "{\"processName\": \"strategy.exe\", \"category\": \"Game\", \"warningStrategy\": 12}]}");
+        file.close();
+
+        ApplicationRepository repo(m_testDbPath);
+        const Application* loaded = repo.find("strategy.exe");
+        QVERIFY(loaded != nullptr);
+        QCOMPARE(loaded->getCategory(), Application::Category::Game);
+        QCOMPARE(loaded->getWarningStrategy(), Application::WarningStrategy::Standard);
+
+        // CBOR map keyed by field index: processName, category 17, warningStrategy 5
+        const char cbor[] = {
+            '\xA3', '\x00', '\x65', 'c', '.', 'e', 'x', 'e', '\x02', '\x11', '\x09', '\x05'
+        };
+        const char* pos = cbor;
+        Application app;
+        ApplicationCborCodec codec;
+        QVERIFY(codec.decode(pos, cbor + sizeof(cbor), app));
+        QCOMPARE(app.getProcessName(), QString("c.exe"));
+        QCOMPARE(app.getCategory(), Application::Category::Uncategorized);
+        QCOMPARE(app.getWarningStrategy(), Application::WarningStrategy::Standard);
+    }
+    
+    /**
+     * @brief Tests that finished sessions reach the hour/day/week rollups
+     * and that they survive a save/load cycle.
+     */
+    void test_usage_rollups_follow_sessions() {
+        using Resolution = UsageRollups::Resolution;
+        const qint64 now = QDateTime::currentSecsSinceEpoch();
+        {
+            ApplicationRepository repo(m_testDbPath);
+            Application* game = repo.findOrCreate("Rollup.exe");
+            game->setCategory(Application::Category::Game);
+            game->recordSessionEnd(30);
+            game->recordSessionEnd(15);
+            
+            const UsageRollups& rollups = repo.usageRollups();
+            UsageRollups::Usage today = rollups.appUsage("rollup.exe", Resolution::Day, now - 3600, now + 3600);
+            QCOMPARE(today.sessions, 2);
+            QCOMPARE(today.seconds, qint64(45 * 60));
+            QCOMPARE(rollups.categoryUsage(Application::Category::Game, Resolution::Week, now - 3600, now + 3600).seconds,
+                     qint64(45 * 60));
+            QCOMPARE(rollups.categoryUsage(Application::Category::Work, Resolution::Week, now).sessions, 0);
+            
+            QVERIFY(repo.saveAll());
+        }
+        
+        ApplicationRepository repo(m_testDbPath);
+        UsageRollups::Usage week = repo.usageRollups().appUsage("rollup.exe", Resolution::Week, now - 3600, now + 3600);
+        QCOMPARE(week.sessions, 2);
+        QCOMPARE(week.seconds, qint64(45 * 60));
+        QFile::remove(m_testDbPath + ".rollups");
+    }
+    
+    /**
+     * @brief Tests that the rollups get a session's exact seconds, not the
+     * whole minutes kept in the totals.
+     */
+    void test_usage_rollups_exact_seconds() {
+        using Resolution = UsageRollups::Resolution;
+        const qint64 now = QDateTime::currentSecsSinceEpoch();
+        ApplicationRepository repo(m_testDbPath);
+        Application* game = repo.findOrCreate("Short.exe");
+        game->recordSessionEnd(now - 20, now, 20);
+        game->recordSessionEnd(now - 200, now, 95);    // Paused for part of it
+        
+        QCOMPARE(game->getTotalMinutesUsed(), 2);
+        QCOMPARE(game->getLastSeenSecs(), now);
+        UsageRollups::Usage today = repo.usageRollups().appUsage("short.exe", Resolution::Day, now - 3600, now + 3600);
+        QCOMPARE(today.sessions, 2);
+        QCOMPARE(today.seconds, qint64(115));
+    }
+    
+    /**
+     * @brief Tests bucket alignment and how a session that crosses bucket
+     * boundaries is split.
+     */
+    void test_usage_rollups_split_sessions() {
+        using Resolution = UsageRollups::Resolution;
+        const qint64 day = 24 * 3600;
+        const qint64 monday = 20003 * day; // 2024-10-07
+        UsageRollups rollups(QTimeZone::utc());
+        QCOMPARE(rollups.bucketStart(Resolution::Week, monday + 6 * day + 10), monday);
+        QCOMPARE(rollups.bucketStart(Resolution::Week, monday - 1), monday - 7 * day);
+        
+        
+        // 90 minutes from 23:30 Sunday: 30 before midnight, 60 after
+        rollups.record("game.exe", Application::Category::Game, monday - 1800, monday + 3600, 5400);
+        QCOMPARE(rollups.appUsage("game.exe", Resolution::Week, monday - 1).seconds, qint64(1800));
+        QCOMPARE(rollups.appUsage("game.exe", Resolution::Week, monday - 1).sessions, 0);
+        QCOMPARE(rollups.appUsage("game.exe", Resolution::Day, monday).seconds, qint64(3600));
+        QCOMPARE(rollups.appUsage("game.exe", Resolution::Day, monday).sessions, 1);
+        QCOMPARE(rollups.appUsage("game.exe", Resolution::Hour, monday - 7200, monday + 7200).seconds,
+                 qint64(5400));
+        
+        // Old hour buckets expire, their days and weeks stay
+        rollups.compact(monday + UsageRollups::HOUR_RETENTION + day);
+        QCOMPARE(rollups.appUsage("game.exe", Resolution::Hour, monday).seconds, qint64(0));
+        QCOMPARE(rollups.appUsage("game.exe", Resolution::Day, monday).seconds, qint64(3600));
+    }
+    
+    /**
+     * @brief Tests that day and week buckets follow the calendar of the
+     * rollups' time zone, including days that DST makes 23 or 25 hours long.
+     */
+    void test_usage_rollups_local_days() {
+        using Resolution = UsageRollups::Resolution;
+        const qint64 hour = 3600;
+        const qint64 utcMonday = 20003 * 24 * hour; // 2024-10-07 00:00 UTC
+
+        // Five hours behind UTC, Monday starts at 05:00 UTC
+        UsageRollups rollups(QTimeZone(-5 * 3600));
+        const qint64 monday = utcMonday + 5 * hour;
+        QCOMPARE(rollups.bucketStart(Resolution::Day, utcMonday + 2 * hour), monday - 24 * hour);
+        QCOMPARE(rollups.bucketStart(Resolution::Week, monday), monday);
+        QCOMPARE(rollups.bucketStart(Resolution::Week, monday - 1), monday - 7 * 24 * hour);
+
+        // 22:00 to 23:00 Sunday local time is Monday in UTC, but counts for Sunday
+        rollups.record("late.exe", Application::Category::Game, monday - 2 * hour, monday - hour, 3600);
+        QCOMPARE(rollups.appUsage("late.exe", Resolution::Day, monday - hour).seconds, qint64(3600));
+        QCOMPARE(rollups.appUsage("late.exe", Resolution::Day, monday).seconds, qint64(0));
+        QCOMPARE(rollups.appUsage("late.exe", Resolution::Week, monday - hour).sessions, 1);
+        QCOMPARE(rollups.appUsage("late.exe", Resolution::Week, monday).sessions, 0);
+
+        const QTimeZone berlin("Europe/Berlin");
+        if (!berlin.isValid()) {
+            QSKIP("No time zone database for the DST part");
+        }
+
+        // 2024-10-27 in Berlin has 25 hours: 22:00 UTC on the 26th to 23:00 UTC on the 27th
+        UsageRollups dst(berlin);
+        const qint64 dayStart = 20023 * 24 * hour - 2 * hour;
+        const qint64 dayEnd = dayStart + 25 * hour;
+        QCOMPARE(dst.bucketStart(Resolution::Day, dayStart + 12 * hour), dayStart);
+        QCOMPARE(dst.bucketStart(Resolution::Day, dayEnd), dayEnd);
+
+        dst.record("long.exe", Application::Category::Game, dayStart, dayEnd, 25 * hour);
+        QCOMPARE(dst.appUsage("long.exe", Resolution::Day, dayStart).seconds, 25 * hour);
+        QCOMPARE(dst.appUsage("long.exe", Resolution::Day, dayStart - 1).seconds, qint64(0));
+        QCOMPARE(dst.appUsage("long.exe", Resolution::Day, dayEnd).seconds, qint64(0));
+    }
+    
+    /**
+     * @brief Tests session length percentiles, their persistence and
+     * merging across applications.
+     */
+    void test_session_length_sketch() {
+        const double accuracy = SessionLengthSketch::RELATIVE_ACCURACY;
+        {
+            ApplicationRepository repo(m_testDbPath);
+            Application* game = repo.findOrCreate("sketch.exe");
+            game->setCategory(Application::Category::Game);
+            for (int minutes = 1; minutes <= 100; ++minutes) {
+                game->recordSessionEnd(minutes);
+            }
+            Application* other = repo.findOrCreate("other.exe");
+            other->setCategory(Application::Category::Game);
+            for (int i = 0; i < 100; ++i) {
+                other->recordSessionEnd(200);
+            }
+            
+            QCOMPARE(game->getSessionLengths().count(), quint64(100));
+            QVERIFY(qAbs(game->getSessionLengthPercentile(0.5) - 50) <= 50 * accuracy);
+            QVERIFY(qAbs(game->getSessionLengthPercentile(0.9) - 90) <= 90 * accuracy);
+            QVERIFY(qAbs(game->getSessionLengthPercentile(0.99) - 99) <= 99 * accuracy);
+            QVERIFY(game->getSessionLengths().bucketCount() <= SessionLengthSketch::MAX_BUCKETS);
+            QVERIFY(repo.saveAll());
+        }
+        
+        ApplicationRepository repo(m_testDbPath);
+        const Application* game = repo.find("sketch.exe");
+        QVERIFY(game != nullptr);
+        QCOMPARE(game->getSessionLengths().count(), quint64(100));
+        QVERIFY(qAbs(game->getSessionLengthPercentile(0.9) - 90) <= 90 * accuracy);
+        
+        // Half of the merged sessions are 200 minutes long
+        SessionLengthSketch games = repo.sessionLengths(
+            ApplicationQuery().inCategories({Application::Category::Game}));
+        QCOMPARE(games.count(), quint64(200));
+        QVERIFY(qAbs(games.quantile(0.25) - 50) <= 50 * accuracy);
+        QVERIFY(qAbs(games.quantile(0.75) - 200) <= 200 * accuracy);
+        QVERIFY(repo.sessionLengths(ApplicationQuery().inCategories({Application::Category::Work})).isEmpty());
+        QFile::remove(m_testDbPath + ".rollups");
+    }
+    
+    /**
+     * @brief Tests that the warning schedule follows the strategy and adds
+     * an early warning when sessions usually reach the limit.
+     */
+    void test_warning_schedule_uses_history() {
+        Application app("warn.exe", Application::Category::Game);
+        QCOMPARE(app.getWarningMinutes(45), QList<int>({15, 10, 5}));
+        QCOMPARE(app.getWarningMinutes(12), QList<int>({10, 5}));
+        
+        app.setWarningStrategy(Application::WarningStrategy::None);
+        QVERIFY(app.getWarningMinutes(45).isEmpty());
+        
+        app.setWarningStrategy(Application::WarningStrategy::Gentle);
+        for (int i = 0; i < 10; ++i) {
+            app.recordSessionEnd(i < 5 ? 20 : 45);
+        }
+        QCOMPARE(app.getWarningMinutes(60), QList<int>({5}));
+        QCOMPARE(app.getWarningMinutes(45), QList<int>({22, 5}));
+    }
+    
+    /**
+     * @brief Tests that lastSeen and findRecentlyUsed() read the installed
+     * time source, so weeks of usage can be simulated instantly.
+     */
+    void test_recency_follows_time_source() {
+        MockTimeSource time;
+        ScopedTimeSource installed(&time);
+        ApplicationRepository repo(m_testDbPath);
+        
+        Application* old = repo.findOrCreate("old.exe");
+        QCOMPARE(old->getFirstSeen().toSecsSinceEpoch(), MockTimeSource::DEFAULT_EPOCH);
+        QCOMPARE(Application().getLastSeenSecs(), qint64(0));   // Only named constructors read the clock
+        
+        time.advance(10LL * 24 * 3600 * 1000);
+        Application* recent = repo.findOrCreate("recent.exe");
+        recent->updateLastSeen();
+        QCOMPARE(recent->getLastSeen().toSecsSinceEpoch(), time.currentSecsSinceEpoch());
+        
+        QCOMPARE(repo.findRecentlyUsed(7), QList<Application*>({recent}));
+        QCOMPARE(repo.findRecentlyUsed(30).size(), 2);
+        
+        old->updateLastSeen();
+        QCOMPARE(repo.findRecentlyUsed(7).size(), 2);
+    }
 };
 
 // Generate test main function
@@ -0,0 +1,284 @@
+#include <QtTest/QtTest>
+#include "services/logging/EventLogger.h"
+#include "services/logging/LogRing.h"
+#include "services/logging/LogSegments.h"
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRegularExpression>
+#include <QTemporaryDir>
+#include <thread>
+#include <vector>
+
+/**
+ * @class TestEventLogger
+ * @brief Unit tests for the asynchronous logging backend.
+ *
+ * This class tests:
+ * 1. LogRing order, wrap-around and overflow.
+ * 2. Messages from several threads all reaching the file, in order per thread.
+ * 3. The line format and shutdown restoring the previous handler.
+ * 4. Structured events through the binary log and back, including a cut-off tail.
+ * 5. Per-category runtime filtering, which must not evaluate the arguments,
+ *    and the floor the resource watchdog puts under it.
+ * 6. Segment rotation, compression and the disk budget.
+ */
+class TestEventLogger : public QObject
+{
+    Q_OBJECT
+
+private:
+    static QStringList readLines(const QString& path)
+    {
+        QFile file(path);
+        if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+            return QStringList();
+        }
+        return QString::fromUtf8(file.readAll()).split('\n', Qt::SkipEmptyParts);
+    }
+
+private slots:
+    void test_ring_order_and_overflow() {
+        LogRing<QString, 4> ring;
+        QString value;
+        QVERIFY(!ring.tryPop(value));
+
+        for (int round = 0; round < 3; ++round) {       // Wraps around twice
+            for (int i = 0; i < 4; ++i) {
+                QVERIFY(ring.tryPush(QString::number(i)));
+            }
+            QString extra("extra");
+            QVERIFY(!ring.tryPush(std::move(extra)));   // Full: refused, value kept
+            QCOMPARE(extra, QString("extra"));
+
+            for (int i = 0; i < 4; ++i) {
+                QVERIFY(ring.tryPop(value));
+                QCOMPARE(value, QString::number(i));
+            }
+            QVERIFY(!ring.tryPop(value));
+        }
+        QCOMPARE(ring.pushed(), quint64(12));
+    }
+
+    void test_messages_from_threads() {
+        QTemporaryDir dir;
+        const QString path = dir.filePath("threads.log");
+        EventLogger::install(path, false);
+
+        // Well under the ring's capacity, so nothing may be dropped
+        const int threads = 4;
+        const int perThread = EventLogger::RING_CAPACITY / (2 * threads);
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threads; ++t) {
+            workers.emplace_back([t, perThread]() {
+                for (int i = 0; i < perThread; ++i) {
+                    qDebug().noquote() << QString("thread %1 message %2").arg(t).arg(i);
+                }
+            });
+        }
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+        EventLogger::flush();
+        QCOMPARE(EventLogger::droppedCount(), quint64(0));
+        EventLogger::shutdown();
+
+        QList<int> next(threads, 0);
+        int messages = 0;
+        for (const QString& line : readLines(path)) {
+            const int at = line.indexOf("thread ");
+            if (at < 0) {
+                continue;
+            }
+            const QStringList words = line.mid(at).split(' ');
+            const int t = words[1].toInt();
+            QCOMPARE(words[3].toInt(), next[t]);
+            ++next[t];
+            ++messages;
+        }
+        QCOMPARE(messages, threads * perThread);
+    }
+
+    void test_line_format_and_shutdown() {
+        QTemporaryDir dir;
+        const QString path = dir.filePath("format.log");
+        EventLogger::install(path, false);
+        qWarning() << "disk almost full";
+        EventLogger::shutdown();
+        EventLogger::shutdown();        // Already stopped
+
+        // Handled by QtTest's handler again, not written to the file
+        qInfo() << "after shutdown";
+
+        const QStringList lines = readLines(path);
+        QCOMPARE(lines.size(), 2);      // The install banner, then ours
+        const QRegularExpression format(
+            R"(^\[WARN\] \[\d{4}-\d\d-\d\d \d\d:\d\d:\d\d\.\d{3}\] \[.*:\d+\] disk almost full$)");
+        QVERIFY2(format.match(lines[1]).hasMatch(), qPrintable(lines[1]));
+    }
+
+    void test_structured_round_trip() {
+        QTemporaryDir dir;
+        const QString textPath = dir.filePath("text.log");
+        const QString binaryPath = dir.filePath("events.blog");
+        EventLogger::install(textPath, false, binaryPath);
+        for (quint32 pid = 40; pid < 43; ++pid) {      // One definition, three events
+            MF_LOG_EVENT(QtInfoMsg, "Process started: %1 PID: %2", QString("game.exe"), pid);
+        }
+        MF_LOG_EVENT(QtWarningMsg, "ratio %1 over %2, delta %3", 0.5, true, -7);
+        qWarning() << "plain message";
+        EventLogger::shutdown();
+
+        // Structured events went to the binary log only
+        const QStringList lines = readLines(textPath);
+        QCOMPARE(lines.size(), 2);
+        QVERIFY(lines[1].endsWith("plain message"));
+
+        QFile file(binaryPath);
+        QVERIFY(file.open(QIODevice::ReadOnly));
+        const QByteArray data = file.readAll();
+
+        StructuredLogReader reader;
+        QVERIFY(reader.load(data));
+        QList<StructuredLogReader::Event> events;
+        StructuredLogReader::Event event;
+        while (reader.next(event)) {
+            events.append(event);
+        }
+        QVERIFY2(!reader.isDamaged(), qPrintable(reader.errorString()));
+        QCOMPARE(events.size(), 4);
+
+        QCOMPARE(events[2].message(), QString("Process started: game.exe PID: 42"));
+        QCOMPARE(events[2].level, QtInfoMsg);
+        QVERIFY(events[2].file.endsWith("test_EventLogger.cpp"));
+        QCOMPARE(events[3].message(), QString("ratio 0.5 over true, delta -7"));
+
+        const QRegularExpression format(
+            R"(^\[INFO\] \[\d{4}-\d\d-\d\d \d\d:\d\d:\d\d\.\d{3}\] \[.*test_EventLogger\.cpp:\d+\] Process started: game\.exe PID: 40$)");
+        const QString text = StructuredLogReader::toText(events[0]);
+        QVERIFY2(format.match(text).hasMatch(), qPrintable(text));
+
+        const QJsonObject json = QJsonDocument::fromJson(StructuredLogReader::toJson(events[3])).object();
+        QCOMPARE(json["level"].toString(), QString("WARN"));
+        QCOMPARE(json["format"].toString(), QString("ratio %1 over %2, delta %3"));
+        QCOMPARE(json["message"].toString(), QString("ratio 0.5 over true, delta -7"));
+
+        // A log cut off mid-record keeps everything before the cut
+        StructuredLogReader truncated;
+        QVERIFY(truncated.load(data.left(data.size() - 1)));
+        int complete = 0;
+        while (truncated.next(event)) {
+            ++complete;
+        }
+        QCOMPARE(complete, 3);
+        QVERIFY(truncated.isDamaged());
+
+        // Without an installed logger, events reach Qt's handler directly
+        QTest::ignoreMessage(QtWarningMsg, "not installed 7");
+        MF_LOG_EVENT(QtWarningMsg, "not installed %1", 7);
+    }
+
+    void test_category_filter() {
+        QVERIFY(LogFilter::isEnabled(LogCategory::Repository, MF_LOG_LEVEL_DEBUG));
+
+        QVERIFY(LogFilter::configure("*=info; repository=warning,history=off"));
+        QVERIFY(!LogFilter::isEnabled(LogCategory::Dispatch, MF_LOG_LEVEL_DEBUG));
+        QVERIFY(LogFilter::isEnabled(LogCategory::Dispatch, MF_LOG_LEVEL_INFO));
+        QVERIFY(!LogFilter::isEnabled(LogCategory::Repository, MF_LOG_LEVEL_INFO));
+        QVERIFY(LogFilter::isEnabled(LogCategory::Repository, MF_LOG_LEVEL_CRITICAL));
+        QVERIFY(!LogFilter::isEnabled(LogCategory::History, MF_LOG_LEVEL_CRITICAL));
+
+        // Bad rules are reported, the good ones still applied
+        QVERIFY(!LogFilter::configure("ui=loud,nowhere=debug,process=critical"));
+        QVERIFY(LogFilter::isEnabled(LogCategory::Ui, MF_LOG_LEVEL_INFO));
+        QVERIFY(!LogFilter::isEnabled(LogCategory::Process, MF_LOG_LEVEL_WARNING));
+
+        // A disabled call never looks at its arguments
+        int evaluated = 0;
+        auto argument = [&evaluated]() { return ++evaluated; };
+        MF_LOG_WARNING(History, "history %1", argument());
+        QCOMPARE(evaluated, 0);
+
+        QTest::ignoreMessage(QtCriticalMsg, "repository 1");
+        MF_LOG_CRITICAL(Repository, "repository %1", argument());
+        QCOMPARE(evaluated, 1);
+
+        LogFilter::reset();
+        QVERIFY(LogFilter::isEnabled(LogCategory::History, MF_LOG_LEVEL_DEBUG));
+    }
+
+    void test_filter_floor() {
+        QVERIFY(LogFilter::configure("*=info,history=critical"));
+        LogFilter::setFloor(MF_LOG_LEVEL_WARNING);
+        QCOMPARE(LogFilter::floor(), MF_LOG_LEVEL_WARNING);
+        QVERIFY(!LogFilter::isEnabled(LogCategory::Dispatch, MF_LOG_LEVEL_INFO));
+        QVERIFY(LogFilter::isEnabled(LogCategory::Dispatch, MF_LOG_LEVEL_WARNING));
+        QVERIFY(!LogFilter::isEnabled(LogCategory::History, MF_LOG_LEVEL_WARNING));
+
+        // Levels set under the floor take effect when it is lifted
+        LogFilter::setMinimumLevel(LogCategory::Ui, MF_LOG_LEVEL_DEBUG);
+        QVERIFY(!LogFilter::isEnabled(LogCategory::Ui, MF_LOG_LEVEL_DEBUG));
+        LogFilter::setFloor(MF_LOG_LEVEL_DEBUG);
+        QVERIFY(LogFilter::isEnabled(LogCategory::Ui, MF_LOG_LEVEL_DEBUG));
+        QVERIFY(LogFilter::isEnabled(LogCategory::Dispatch, MF_LOG_LEVEL_INFO));
+        QVERIFY(!LogFilter::isEnabled(LogCategory::History, MF_LOG_LEVEL_WARNING));
+
+        LogFilter::setFloor(LogFilter::LEVEL_OFF);
+        LogFilter::reset();
+        QCOMPARE(LogFilter::floor(), MF_LOG_LEVEL_DEBUG);
+        QVERIFY(LogFilter::isEnabled(LogCategory::History, MF_LOG_LEVEL_DEBUG));
+    }
+
+    void test_segment_rotation() {
+        QTemporaryDir dir;
+        const QString path = dir.filePath("segments.log");
+        const qint64 segmentSize = 1024;
+        const qint64 diskBudget = 3 * segmentSize;
+        const int lines = 1000;                             // About 19 segments
+
+        LogSegments log;
+        QVERIFY(log.open(path, segmentSize, diskBudget));
+        QCOMPARE(QFileInfo(path).size(), segmentSize);      // Preallocated
+        for (int i = 0; i < lines; ++i) {
+            QVERIFY(log.write(QString("line %1 %2\n").arg(i, 4, 10, QChar('0'))
+                                  .arg(i * 7919 % 100003, 8, 10, QChar('0')).toUtf8()));
+        }
+        QVERIFY(log.rotations() >= 15);
+        log.close();
+
+        // Closed segments are compressed and the oldest evicted to fit
+        const QStringList segments = LogSegments::segments(path);
+        QVERIFY(!segments.isEmpty());
+        qint64 total = QFileInfo(path).size();
+        QByteArray text;
+        for (const QString& segment : segments) {
+            QVERIFY2(segment.endsWith(LogSegments::COMPRESSED_SUFFIX), qPrintable(segment));
+            total += QFileInfo(segment).size();
+            text += LogSegments::readSegment(segment);
+        }
+        QVERIFY(total <= diskBudget);
+
+        // What is left is the newest lines, in order, ending in the active segment
+        QFile active(path);
+        QVERIFY(active.open(QIODevice::ReadOnly));
+        text += active.readAll();
+        const QStringList kept = QString::fromUtf8(text).split('\n', Qt::SkipEmptyParts);
+        QVERIFY(!kept.isEmpty());
+        const int first = kept.first().split(' ')[1].toInt();
+        QVERIFY(first > 0);
+        for (int i = 0; i < kept.size(); ++i) {
+            QCOMPARE(kept[i].split(' ')[1].toInt(), first + i);
+        }
+        QCOMPARE(first + kept.size(), lines);
+
+        // Reopening rotates the previous run's log out
+        const int before = LogSegments::segments(path).size();
+        QVERIFY(log.open(path, segmentSize, 64 * 1024));
+        log.close();
+        QCOMPARE(LogSegments::segments(path).size(), before + 1);
+        QCOMPARE(QFileInfo(path).size(), qint64(0));
+    }
+};
+
+QTEST_GUILESS_MAIN(TestEventLogger)
+#include "test_EventLogger.moc"
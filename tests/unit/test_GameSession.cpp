@@ -4,6 +4,8 @@
 
 // Include your actual source file
 #include "../../src/domain/GameSession.h"
+#include "../../src/services/infrastructure/DeadlineScheduler.h"
+#include "../mocks/MockTimeSource.h"
 
 class TestGameSession : public QObject {
     Q_OBJECT
@@ -14,9 +16,207 @@ private slots:
     }
     
     void test_session_creation() {
-        GameSession session(1234, "game.exe");
+        DeadlineScheduler scheduler;
+        GameSession session(1234, "game.exe", &scheduler);
         QVERIFY(true);  // Simple test to start
     }
+
+    void test_scheduler_runs_deadlines_in_order() {
+        DeadlineScheduler scheduler;
+        QList<int> order;
+        const qint64 base = scheduler.now();
+
+        // Spread over several wheel levels, one of them past the top level's range
+        const QList<qint64> delays = {5, 70, 4100, 300000, 86400000, 1LL << 37};
+        for (int i = delays.size() - 1; i >= 0; --i) {
+            scheduler.schedule(base + delays[i], [&order, i]() { order.append(i); });
+        }
+        QCOMPARE(scheduler.pendingCount(), delays.size());
+        QCOMPARE(scheduler.nextDeadline(), base + delays[0]);
+
+        for (int i = 0; i < delays.size(); ++i) {
+            QCOMPARE(scheduler.advanceTo(base + delays[i] - 1), 0);
+            QCOMPARE(scheduler.advanceTo(base + delays[i]), 1);
+            QCOMPARE(order.last(), i);
+        }
+        QCOMPARE(scheduler.pendingCount(), 0);
+        QCOMPARE(scheduler.nextDeadline(), qint64(-1));
+    }
+
+    void test_scheduler_cancel() {
+        DeadlineScheduler scheduler;
+        int runs = 0;
+        DeadlineScheduler::Handle first = scheduler.scheduleIn(1000, [&runs]() { ++runs; });
+        DeadlineScheduler::Handle second = scheduler.scheduleIn(2000, [&runs]() { ++runs; });
+
+        QVERIFY(scheduler.cancel(first));
+        QVERIFY(!scheduler.cancel(first));
+        QVERIFY(!scheduler.cancel(0));
+
+        // A recycled entry must not be reachable through the old handle
+        DeadlineScheduler::Handle third = scheduler.scheduleIn(3000, [&runs]() { runs += 10; });
+        QVERIFY(third != first);
+        QVERIFY(!scheduler.cancel(first));
+
+        QCOMPARE(scheduler.advanceTo(scheduler.now() + 10000), 2);
+        QCOMPARE(runs, 11);
+        QVERIFY(!scheduler.cancel(second));
+    }
+
+    void test_scheduler_cancel_in_same_pass() {
+        DeadlineScheduler scheduler;
+        const qint64 base = scheduler.now();
+        QList<int> ran;
+        DeadlineScheduler::Handle later = 0;
+        DeadlineScheduler::Handle self = 0;
+        self = scheduler.schedule(base + 100, [&]() {
+            ran.append(1);
+            QVERIFY(!scheduler.cancel(self));      // Already running
+            QVERIFY(scheduler.cancel(later));      // Due in this pass, not run yet
+        });
+        later = scheduler.schedule(base + 200, [&]() { ran.append(2); });
+        scheduler.schedule(base + 300, [&]() { ran.append(3); });
+
+        // All three are collected by one pass; the second must not run
+        QCOMPARE(scheduler.advanceTo(base + 1000), 2);
+        QCOMPARE(ran, QList<int>({1, 3}));
+        QVERIFY(!scheduler.cancel(later));
+        QCOMPARE(scheduler.pendingCount(), 0);
+    }
+
+    void test_scheduler_callbacks_may_reschedule() {
+        DeadlineScheduler scheduler;
+        const qint64 base = scheduler.now();
+        int runs = 0;
+        std::function<void()> repeat = [&]() {
+            if (++runs < 5) {
+                scheduler.schedule(base + (runs + 1) * 60000, repeat);
+            }
+        };
+        scheduler.schedule(base + 60000, repeat);
+
+        // Each run schedules the next one, which is already due
+        scheduler.advanceTo(base + 10 * 60000);
+        QCOMPARE(runs, 1);
+        while (scheduler.pendingCount() > 0) {
+            scheduler.advanceTo(base + 10 * 60000);
+        }
+        QCOMPARE(runs, 5);
+    }
+
+    void test_scheduler_wakes_only_for_deadlines() {
+        DeadlineScheduler scheduler;
+        int runs = 0;
+        for (int i = 1; i <= 3; ++i) {
+            scheduler.scheduleIn(i * 30, [&runs]() { ++runs; });
+        }
+        scheduler.scheduleIn(60000, [&runs]() { ++runs; });
+
+        QTRY_COMPARE_WITH_TIMEOUT(runs, 3, 2000);
+        QTest::qWait(100);
+        QCOMPARE(runs, 3);
+        QVERIFY(scheduler.wakeups() <= 3);
+        QCOMPARE(scheduler.pendingCount(), 1);
+    }
+
+    void test_monotonic_clock() {
+        for (auto policy : {MonotonicClock::SuspendPolicy::ExcludeSuspend,
+                            MonotonicClock::SuspendPolicy::IncludeSuspend}) {
+            MonotonicClock clock(policy);
+            const qint64 before = clock.elapsed();
+            QVERIFY(before >= 0);
+            QTest::qSleep(50);
+            const qint64 after = clock.elapsed();
+            QVERIFY(after - before >= 40);      // Windows ticks are 15.6 ms
+            QVERIFY(after - before < 5000);
+        }
+
+        SystemTimeSource boottime(MonotonicClock::SuspendPolicy::IncludeSuspend);
+        DeadlineScheduler scheduler(&boottime);
+        QCOMPARE(scheduler.timeSource(), &boottime);
+        QCOMPARE(static_cast<SystemTimeSource*>(TimeSource::system())->suspendPolicy(),
+                 MonotonicClock::SuspendPolicy::ExcludeSuspend);
+    }
+
+    void test_session_time_is_derived() {
+        DeadlineScheduler scheduler;
+        GameSession session(1234, "game.exe", &scheduler);
+        QCOMPARE(session.activeSeconds(), 0);
+
+        session.startCountdown(1);
+        QCOMPARE(session.remainingSeconds(), 60);
+
+        // A blocked event loop must not stop the clock
+        QTest::qSleep(1100);
+        QCOMPARE(session.activeSeconds(), 1);
+        QCOMPARE(session.remainingSeconds(), 59);
+    }
+
+    void test_session_deadlines() {
+        DeadlineScheduler scheduler;
+        GameSession session(1234, "game.exe", &scheduler);
+        QSignalSpy warnings(&session, &GameSession::warningIssued);
+        QSignalSpy finished(&session, &GameSession::sessionFinished);
+
+        const qint64 start = scheduler.now();
+        session.startCountdown(20);
+        QCOMPARE(scheduler.pendingCount(), 4);      // 15, 10 and 5 minutes left, then the limit
+        QCOMPARE(scheduler.nextDeadline(), start + 5 * 60000);
+
+        scheduler.advanceTo(start + 5 * 60000);
+        QCOMPARE(warnings.count(), 1);
+        QCOMPARE(warnings.at(0).at(0).toInt(), 15);
+
+        scheduler.advanceTo(start + 20 * 60000 - 1);
+        QCOMPARE(warnings.count(), 3);
+        QCOMPARE(finished.count(), 0);
+
+        scheduler.advanceTo(start + 20 * 60000);
+        QCOMPARE(finished.count(), 1);
+        QCOMPARE(session.terminationReason(), SessionRecord::Termination::TimeLimitReached);
+        QCOMPARE(session.activeSeconds(), 20 * 60);  // Fixed at the limit, not read from the clock
+        QCOMPARE(session.remainingSeconds(), 0);
+        QCOMPARE(scheduler.pendingCount(), 0);
+    }
+
+    void test_session_on_virtual_clock() {
+        MockTimeSource time;
+        DeadlineScheduler scheduler(&time);
+        GameSession session(1234, "game.exe", &scheduler);
+        QSignalSpy warnings(&session, &GameSession::warningIssued);
+        QSignalSpy finished(&session, &GameSession::sessionFinished);
+        QCOMPARE(session.startedAt(), MockTimeSource::DEFAULT_EPOCH);
+
+        session.startCountdown(45);
+        time.advance(30 * 60000);
+        QCOMPARE(warnings.count(), 1);
+        QCOMPARE(session.activeSeconds(), 30 * 60);
+        QCOMPARE(session.remainingSeconds(), 15 * 60);
+
+        // Callbacks see the time of their own deadline
+        QList<qint64> seen;
+        connect(&session, &GameSession::warningIssued, this, [&](int) { seen.append(time.elapsed()); });
+        QCOMPARE(time.advance(60 * 60000), 3);
+        QCOMPARE(seen, QList<qint64>({35 * 60000, 40 * 60000}));
+        QCOMPARE(finished.count(), 1);
+        QCOMPARE(session.activeSeconds(), 45 * 60);
+        QCOMPARE(time.currentSecsSinceEpoch(), MockTimeSource::DEFAULT_EPOCH + 90 * 60);
+    }
+
+    void test_session_cancels_deadlines() {
+        DeadlineScheduler scheduler;
+        {
+            GameSession session(1234, "game.exe", &scheduler);
+            session.setWarningMinutes({5});
+            session.startCountdown(3);             // Too short for the warning
+            QCOMPARE(scheduler.pendingCount(), 1);
+            QVERIFY(session.remainingSeconds() > 170);
+
+            session.startCountdown(30);
+            QCOMPARE(scheduler.pendingCount(), 2);
+        }
+        QCOMPARE(scheduler.pendingCount(), 0);
+    }
     
     void cleanupTestCase() {
         // Called after last test
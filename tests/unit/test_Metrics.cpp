@@ -0,0 +1,117 @@
+#include <QtTest/QtTest>
+#include "services/metrics/Metrics.h"
+#include <QTemporaryDir>
+#include <thread>
+#include <vector>
+
+/**
+ * @class TestMetrics
+ * @brief Unit tests for the metrics registry.
+ *
+ * This class tests:
+ * 1. Counters summing their per-thread shards.
+ * 2. Histogram bucket boundaries and percentiles.
+ * 3. Registration by name and the Prometheus text output.
+ */
+class TestMetrics : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void test_counter_across_threads() {
+        Counter counter;
+        const int threads = 8;
+        const int perThread = 100000;
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threads; ++t) {
+            workers.emplace_back([&counter, perThread]() {
+                for (int i = 0; i < perThread; ++i) {
+                    counter.add();
+                }
+            });
+        }
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+        QCOMPARE(counter.value(), quint64(threads * perThread));
+
+        counter.reset();
+        QCOMPARE(counter.value(), quint64(0));
+    }
+
+    void test_histogram_buckets() {
+        // Every value lands in a bucket that contains it, within 1/8
+        for (quint64 value : {quint64(0), quint64(7), quint64(8), quint64(9), quint64(1000),
+                              quint64(123456789), quint64(1) << 40, ~quint64(0)}) {
+            const int bucket = LatencyHistogram::bucketOf(value);
+            QVERIFY(bucket >= 0 && bucket < LatencyHistogram::BUCKETS);
+            QVERIFY(LatencyHistogram::bucketLowerBound(bucket) <= value);
+            QVERIFY(LatencyHistogram::bucketUpperBound(bucket) >= value);
+            const quint64 width = LatencyHistogram::bucketUpperBound(bucket) - LatencyHistogram::bucketLowerBound(bucket);
+            QVERIFY(width <= value / LatencyHistogram::SUB_BUCKETS);
+        }
+
+        // Consecutive buckets tile the range
+        for (int bucket = 1; bucket < LatencyHistogram::BUCKETS; ++bucket) {
+            QCOMPARE(LatencyHistogram::bucketLowerBound(bucket), LatencyHistogram::bucketUpperBound(bucket - 1) + 1);
+        }
+    }
+
+    void test_histogram_percentiles() {
+        LatencyHistogram histogram;
+        QCOMPARE(histogram.percentile(0.5), quint64(0));
+
+        for (int i = 1; i <= 1000; ++i) {
+            histogram.record(i * 1000);     // 1 us .. 1 ms
+        }
+        QCOMPARE(histogram.count(), quint64(1000));
+        QCOMPARE(histogram.sum(), quint64(500500000));
+
+        const quint64 p50 = histogram.percentile(0.5);
+        QVERIFY2(p50 >= 500000 && p50 <= 500000 + 500000 / 8, qPrintable(QString::number(p50)));
+        const quint64 p99 = histogram.percentile(0.99);
+        QVERIFY2(p99 >= 990000 && p99 <= 990000 + 990000 / 8, qPrintable(QString::number(p99)));
+        QCOMPARE(histogram.countBelow(1 << 20), quint64(1000));
+        QCOMPARE(histogram.countBelow(1 << 19), quint64(524));     // 1000..524000 ns
+
+        histogram.record(-5);                   // Clock went backwards: counts as 0
+        QCOMPARE(histogram.countBelow(1), quint64(1));
+    }
+
+    void test_registry_and_prometheus() {
+        Counter& ticks = MetricsRegistry::counter("test_ticks_total", "Ticks seen by the test");
+        QCOMPARE(&MetricsRegistry::counter("test_ticks_total", "Ticks seen by the test"), &ticks);
+        Gauge& depth = MetricsRegistry::gauge("test_queue_depth", "Queue depth");
+        LatencyHistogram& latency = MetricsRegistry::histogram("test_latency_seconds", "Test latency");
+
+        MetricsRegistry::resetAll();
+        ticks.add(3);
+        depth.set(-2);
+        latency.record(1500);                   // 1.5 us
+        latency.record(3000000);                // 3 ms
+        {
+            ScopedLatency timing(latency);
+        }
+
+        const QByteArray text = MetricsRegistry::toPrometheus();
+        QVERIFY(text.contains("# HELP test_ticks_total Ticks seen by the test\n"));
+        QVERIFY(text.contains("# TYPE test_ticks_total counter\ntest_ticks_total 3\n"));
+        QVERIFY(text.contains("# TYPE test_queue_depth gauge\ntest_queue_depth -2\n"));
+        QVERIFY(text.contains("# TYPE test_latency_seconds histogram\n"));
+        QVERIFY(text.contains("test_latency_seconds_bucket{le=\"+Inf\"} 3\n"));
+        QVERIFY(text.contains("test_latency_seconds_count 3\n"));
+
+        // Buckets are cumulative; 2^22 ns holds both recorded values
+        QVERIFY(text.contains("test_latency_seconds_bucket{le=\"0.004194304\"} 3\n"));
+
+        QTemporaryDir dir;
+        const QString path = dir.filePath("metrics.prom");
+        QVERIFY(MetricsRegistry::writeSnapshot(path));
+        QFile file(path);
+        QVERIFY(file.open(QIODevice::ReadOnly));
+        QVERIFY(file.readAll().contains("test_ticks_total 3"));
+    }
+};
+
+QTEST_GUILESS_MAIN(TestMetrics)
+#include "test_Metrics.moc"
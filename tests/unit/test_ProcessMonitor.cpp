@@ -1,64 +1,406 @@
 #include <QtTest/QtTest>
-#include "monitoring/ProcessMonitor.h"
-#include "core/GameList.h"
-
-// Mock process source for testing
-class MockProcessSource {
-public:
-    QMap<DWORD, QString> mockProcesses;
-    
-    QMap<DWORD, QString> getProcesses() {
-        return mockProcesses;
-    }
-    
-    void addProcess(DWORD pid, QString name) {
-        mockProcesses[pid] = name;
-    }
-    
-    void removeProcess(DWORD pid) {
-        mockProcesses.remove(pid);
-    }
-};
+#include "services/infrastructure/ProcessMonitor.h"
+#include "services/infrastructure/ProcessTrace.h"
+#include "services/utils/ProcessUtils.h"
+#include "services/metrics/DetectionLatency.h"
+#include "services/metrics/Metrics.h"
+#include "repositories/ApplicationRepository.h"
+#include "domain/Application.h"
+#include "../mocks/MockProcessSource.h"
+#include "../mocks/MockTimeSource.h"
+#include <QTemporaryDir>
+#include <algorithm>
 
+/**
+ * @class TestProcessMonitor
+ * @brief Unit tests for ProcessMonitor driven by a scripted process list.
+ *
+ * The monitor polls a MockProcessSource on a MockTimeSource, so each test
+ * controls exactly which processes exist at each poll. This class tests:
+ * 1. processStarted for new processes, once per pid.
+ * 2. Skipping System and Utility applications on the monitor thread.
+ * 3. processTerminated, and pid reuse across and within polls.
+ * 4. Start/stop of the polling, and throttled polling.
+ * 5. The scenario format used by the pipeline benchmarks.
+ * 6. Process traces: the file format, recording and replay.
+ * 7. The snapshot diff both real process sources use.
+ * 8. Detection latency stamps, and process start times from the system.
+ */
 class TestProcessMonitor : public QObject {
     Q_OBJECT
-    
+
+private:
+    static constexpr int POLL = ProcessMonitor::POLL_INTERVAL_MS;
+
+    QTemporaryDir m_dir;
+
+    static QStringList startedNames(const QSignalSpy& spy)
+    {
+        QStringList names;
+        for (int i = 0; i < spy.count(); ++i) {
+            names.append(spy.at(i).at(1).toString());
+        }
+        names.sort();
+        return names;
+    }
+
+    // "start <pid> <name>" / "exit <pid>" per signal, with the poll it came from
+    static void logEvents(ProcessMonitor& monitor, MockTimeSource& time, QStringList& log)
+    {
+        QObject::connect(&monitor, &ProcessMonitor::processStarted, [&time, &log](DWORD pid, const QString& name) {
+            log.append(QString("%1 start %2 %3").arg(time.elapsed()).arg(pid).arg(name));
+        });
+        QObject::connect(&monitor, &ProcessMonitor::processTerminated, [&time, &log](DWORD pid) {
+            log.append(QString("%1 exit %2").arg(time.elapsed()).arg(pid));
+        });
+    }
+
 private slots:
     void test_signal_on_new_game() {
-        GameList list;
-        list.setCategorization("game.exe", true);
-        
-        ProcessMonitor monitor(&list);
-        QSignalSpy gameSpy(&monitor, &ProcessMonitor::gameDetected);
-        
-        // Simulate finding a game - you'll need to adapt this
-        // based on your actual implementation
-        
-        QCOMPARE(gameSpy.count(), 0);  // No signals yet
+        MockTimeSource time;
+        MockProcessSource processes;
+        ProcessMonitor monitor(nullptr, &time, &processes);
+        QSignalSpy started(&monitor, &ProcessMonitor::processStarted);
+        monitor.startMonitor();
+
+        processes.spawn(100, "Game.exe");
+        QCOMPARE(started.count(), 0);  // Nothing until the next poll
+
+        time.advance(POLL);
+        QCOMPARE(started.count(), 1);
+        QCOMPARE(started.at(0).at(0).value<DWORD>(), DWORD(100));
+        QCOMPARE(started.at(0).at(1).toString(), QString("game.exe"));
     }
-    
-    void test_signal_on_uncategorized() {
-        GameList list;
-        ProcessMonitor monitor(&list);
-        
-        QSignalSpy uncategorizedSpy(&monitor, &ProcessMonitor::uncategorizedAppDetected);
-        
-        // Test logic here
-        
-        QCOMPARE(uncategorizedSpy.count(), 0);  // Adjust based on test
+
+    void test_system_apps_not_signalled() {
+        MockTimeSource time;
+        ScopedTimeSource installed(&time);
+        ApplicationRepository repo(m_dir.filePath("apps.json"));
+        repo.findOrCreate("svchost.exe")->setCategory(Application::Category::System);
+        repo.findOrCreate("notepad.exe")->setCategory(Application::Category::Utility);
+
+        MockProcessSource processes;
+        ProcessMonitor monitor(&repo, &time, &processes);
+        QSignalSpy started(&monitor, &ProcessMonitor::processStarted);
+        monitor.startMonitor();
+
+        processes.spawn(1, "svchost.exe");
+        processes.spawn(2, "notepad.exe");
+        processes.spawn(3, "unknown.exe");
+        time.advance(POLL);
+        QCOMPARE(startedNames(started), QStringList({"unknown.exe"}));
     }
-    
+
     void test_no_duplicate_signals() {
-        GameList list;
-        list.setCategorization("game.exe", true);
-        
-        ProcessMonitor monitor(&list);
-        QSignalSpy gameSpy(&monitor, &ProcessMonitor::gameDetected);
-        
-        // Simulate same game detected twice
-        // Should only signal once for new detection
+        MockTimeSource time;
+        MockProcessSource processes;
+        ProcessMonitor monitor(nullptr, &time, &processes);
+        QSignalSpy started(&monitor, &ProcessMonitor::processStarted);
+        QSignalSpy terminated(&monitor, &ProcessMonitor::processTerminated);
+        monitor.startMonitor();
+
+        processes.spawn(100, "game.exe");
+        processes.spawn(101, "game.exe");   // Same game twice is two processes
+        time.advance(10 * POLL);
+        QCOMPARE(started.count(), 2);
+        QCOMPARE(terminated.count(), 0);
+        QCOMPARE(processes.updateCount(), 10);
+    }
+
+    void test_termination_and_pid_reuse() {
+        MockTimeSource time;
+        MockProcessSource processes;
+        ProcessMonitor monitor(nullptr, &time, &processes);
+        QSignalSpy started(&monitor, &ProcessMonitor::processStarted);
+        QSignalSpy terminated(&monitor, &ProcessMonitor::processTerminated);
+        monitor.startMonitor();
+
+        processes.spawn(100, "game.exe");
+        time.advance(POLL);
+        processes.exit(100);
+        time.advance(POLL);
+        QCOMPARE(terminated.count(), 1);
+        QCOMPARE(terminated.at(0).at(0).value<DWORD>(), DWORD(100));
+
+        // Reused after the exit was seen: a new process
+        processes.spawn(100, "editor.exe");
+        time.advance(POLL);
+        QCOMPARE(started.count(), 2);
+        QCOMPARE(started.at(1).at(1).toString(), QString("editor.exe"));
+
+        // Reused between two polls: invisible, as with the real source
+        processes.exit(100);
+        processes.spawn(100, "other.exe");
+        time.advance(POLL);
+        QCOMPARE(started.count(), 2);
+        QCOMPARE(terminated.count(), 1);
+    }
+
+    void test_start_stop() {
+        MockTimeSource time;
+        MockProcessSource processes;
+        ProcessMonitor monitor(nullptr, &time, &processes);
+        time.advance(5 * POLL);
+        QCOMPARE(processes.updateCount(), 0);
+
+        monitor.startMonitor();
+        monitor.startMonitor();             // Already running
+        time.advance(3 * POLL);
+        QCOMPARE(processes.updateCount(), 3);
+
+        monitor.stopMonitor();
+        time.advance(3 * POLL);
+        QCOMPARE(processes.updateCount(), 3);
+    }
+
+    void test_throttled_polling() {
+        constexpr int THROTTLED = ProcessMonitor::THROTTLED_POLL_INTERVAL_MS;
+        MockTimeSource time;
+        ScopedTimeSource installed(&time);
+        ApplicationRepository repo(m_dir.filePath("throttle.json"));
+        repo.findOrCreate("game.exe")->setCategory(Application::Category::Game);
+
+        MockProcessSource processes;
+        ProcessMonitor monitor(&repo, &time, &processes);
+        QSignalSpy started(&monitor, &ProcessMonitor::processStarted);
+        monitor.startMonitor();
+        monitor.setThrottled(true);
+        QVERIFY(monitor.isThrottled());
+        QCOMPARE(monitor.pollInterval(), THROTTLED);
+
+        // The poll already due keeps its time; later ones are further apart
+        processes.spawn(1, "game.exe");
+        processes.spawn(2, "unknown.exe");
+        time.advance(POLL);
+        QCOMPARE(processes.updateCount(), 1);
+        QCOMPARE(startedNames(started), QStringList({"game.exe"}));
+        time.advance(THROTTLED - 1);
+        QCOMPARE(processes.updateCount(), 1);
+        time.advance(1);
+        QCOMPARE(processes.updateCount(), 2);
+        QCOMPARE(started.count(), 1);
+
+        // Lifting the throttle brings the next poll forward, and it reports
+        // the untracked process held back meanwhile
+        monitor.setThrottled(false);
+        QCOMPARE(monitor.pollInterval(), POLL);
+        time.advance(POLL);
+        QCOMPARE(processes.updateCount(), 3);
+        QCOMPARE(startedNames(started), QStringList({"game.exe", "unknown.exe"}));
+        monitor.stopMonitor();
+    }
+
+    void test_apply_snapshot() {
+        QHash<DWORD, QString> map;
+        map.insert(1, "kept.exe");
+        map.insert(2, "exited.exe");
+
+        // Names are only asked for new pids; an empty name leaves the pid out
+        QList<DWORD> asked;
+        const ProcessUtils::SnapshotDiff diff = ProcessUtils::applySnapshot(map, QSet<DWORD>{1, 3, 4},
+            [&asked](DWORD pid) {
+                asked.append(pid);
+                return pid == 3 ? QString("new.exe") : QString();
+            });
+        std::sort(asked.begin(), asked.end());
+
+        QCOMPARE(asked, QList<DWORD>({3, 4}));
+        QCOMPARE(diff.resolved, quint64(1));
+        QCOMPARE(diff.unresolved, quint64(1));
+        QCOMPARE(map.size(), 2);
+        QCOMPARE(map.value(1), QString("kept.exe"));
+        QCOMPARE(map.value(3), QString("new.exe"));
+    }
+
+    void test_detection_latency_stages() {
+        DetectionLatency::reset();
+        auto count = [](DetectionLatency::Stage stage) { return DetectionLatency::histogram(stage).count(); };
+
+        MockTimeSource time;
+        MockProcessSource processes;
+        processes.spawn(100, "running.exe");
+        ProcessMonitor monitor(nullptr, &time, &processes);
+
+        // Stand-ins for the dispatcher and session manager
+        connect(&monitor, &ProcessMonitor::processStarted, this, [](DWORD pid) {
+            DetectionLatency::delivered(pid);
+            DetectionLatency::dispatched(pid);
+            DetectionLatency::sessionStarted(pid);
+        });
+        monitor.startMonitor();
+
+        // Already running at the first poll: not timed
+        time.advance(POLL);
+        QCOMPARE(count(DetectionLatency::Stage::Delivery), quint64(0));
+
+        processes.spawn(200, "game.exe");
+        time.advance(POLL);
+        QCOMPARE(count(DetectionLatency::Stage::Delivery), quint64(1));
+        QCOMPARE(count(DetectionLatency::Stage::Dispatch), quint64(1));
+        QCOMPARE(count(DetectionLatency::Stage::SessionStart), quint64(1));
+
+        // The mock knows no start times, so nothing counts from exec
+        QCOMPARE(count(DetectionLatency::Stage::Enumeration), quint64(0));
+        QCOMPARE(count(DetectionLatency::Stage::Total), quint64(0));
+
+        // Finished pids and forgotten ones are not timed again
+        DetectionLatency::sessionStarted(200);
+        DetectionLatency::enumerated(300, ScopedLatency::now() - 5);
+        DetectionLatency::forget(300);
+        DetectionLatency::delivered(300);
+        QCOMPARE(count(DetectionLatency::Stage::SessionStart), quint64(1));
+        QCOMPARE(count(DetectionLatency::Stage::Delivery), quint64(1));
+        QCOMPARE(count(DetectionLatency::Stage::Enumeration), quint64(1));
+        monitor.stopMonitor();
+    }
+
+    void test_process_start_time() {
+#if !defined(Q_OS_LINUX) && !defined(Q_OS_WIN)
+        QSKIP("No process start times on this platform");
+#endif
+        // This test process started a little while ago
+        const qint64 started = ProcessUtils::processStartedAt(static_cast<DWORD>(QCoreApplication::applicationPid()));
+        const qint64 age = ScopedLatency::now() - started;
+        QVERIFY(started >= 0);
+        QVERIFY(age >= 0);
+        QVERIFY(age < qint64(3600) * 1000000000);
+    }
+
+    void test_scenario_playback() {
+        ProcessScenario scenario;
+        QString error;
+        QVERIFY(!scenario.parse("spawn 1\n", &error));
+        QVERIFY(error.contains("line 1"));
+
+        QVERIFY2(scenario.parse(
+            "# Two games, then a burst of helpers\n"
+            "app game.exe Game\n"
+            "spawn 10 game.exe\n"
+            "wait 3000\n"
+            "burst 50 1000 helper%1.exe   # 1000..1049\n"
+            "wait 4000\n"
+            "exitburst 50 1000\n"
+            "exit 10\n", &error), qPrintable(error));
+        QCOMPARE(scenario.steps.size(), 5);
+        QCOMPARE(scenario.duration, qint64(7000));
+
+        MockTimeSource time;
+        ScopedTimeSource installed(&time);
+        ApplicationRepository repo(m_dir.filePath("scenario.json"));
+        MockProcessSource processes;
+        ProcessMonitor monitor(&repo, &time, &processes);
+        QSignalSpy started(&monitor, &ProcessMonitor::processStarted);
+        QSignalSpy terminated(&monitor, &ProcessMonitor::processTerminated);
+        monitor.startMonitor();
+
+        ScenarioPlayer player(scenario, time, processes, &repo);
+        time.advanceTo(player.end() + POLL);
+        QVERIFY(player.finished());
+        QCOMPARE(player.spawned(), 51);
+        QCOMPARE(started.count(), 51);
+        QCOMPARE(terminated.count(), 51);
+        QCOMPARE(repo.find("game.exe")->getCategory(), Application::Category::Game);
+        QCOMPARE(player.spawnedAt(1000), qint64(3000));
+    }
+
+    void test_trace_round_trip() {
+        const QString path = m_dir.filePath("round_trip.trace");
+        ProcessTraceWriter writer;
+        QVERIFY(writer.open(path, MockTimeSource::DEFAULT_EPOCH));
+
+        ProcessTraceRecord first;
+        first.time = 2000;
+        first.started = {{4, 0, "system"}, {100, 4, "game.exe"}, {101, 100, "game.exe"}};
+        ProcessTraceRecord second;
+        second.time = 6000;
+        second.exited = {101, 4};      // Unsorted still round-trips
+        second.started = {{7, 100, "helper.exe"}};
+        QVERIFY(writer.write(first));
+        QVERIFY(writer.write(second));
+        writer.close();
+
+        ProcessTraceReader reader;
+        QVERIFY(reader.open(path));
+        QCOMPARE(reader.startSecsSinceEpoch(), MockTimeSource::DEFAULT_EPOCH);
+
+        ProcessTraceRecord record;
+        QVERIFY(reader.next(record));
+        QCOMPARE(record.time, qint64(2000));
+        QCOMPARE(record.started.size(), 3);
+        QCOMPARE(record.started[2].pid, DWORD(101));
+        QCOMPARE(record.started[2].parentPid, DWORD(100));
+        QCOMPARE(record.started[2].name, QString("game.exe"));
+        QVERIFY(reader.next(record));
+        QCOMPARE(record.time, qint64(6000));
+        QCOMPARE(record.exited, QList<DWORD>({101, 4}));
+        QCOMPARE(record.started[0].name, QString("helper.exe"));
+        QVERIFY(!reader.next(record));
+        QVERIFY(!reader.isDamaged());
+
+        // A trace cut short reads up to its last complete record
+        QFile file(path);
+        QVERIFY(file.open(QIODevice::ReadOnly));
+        const QByteArray data = file.readAll();
+        QVERIFY(reader.load(data.left(data.size() - 3)));
+        QVERIFY(reader.next(record));
+        QVERIFY(!reader.next(record));
+        QVERIFY(reader.isDamaged());
+
+        QVERIFY(!reader.load("not a trace at all"));
+    }
+
+    void test_record_and_replay() {
+        const QString path = m_dir.filePath("replay.trace");
+        QStringList recorded;
+        {
+            MockTimeSource time;
+            MockProcessSource processes;
+            RecordingProcessSource recorder(&processes, &time);
+            QVERIFY(recorder.open(path));
+            ProcessMonitor monitor(nullptr, &time, &recorder);
+            logEvents(monitor, time, recorded);
+            monitor.startMonitor();
+
+            processes.spawn(1, "explorer.exe");
+            time.advance(POLL);
+            processes.spawn(200, "game.exe", 1);
+            processes.spawn(201, "launcher.exe", 1);
+            time.advance(3 * POLL);
+            processes.exit(201);
+            processes.spawn(202, "game.exe", 200);
+            time.advance(POLL);
+            processes.exit(200);
+            processes.exit(202);
+            time.advance(2 * POLL);
+            QVERIFY(recorder.writer().bytesWritten() > ProcessTraceWriter::HEADER_SIZE);
+        }
+        QCOMPARE(recorded.size(), 7);
+
+        ProcessTraceReader trace;
+        QVERIFY(trace.open(path));
+        MockTimeSource time;
+        ReplayProcessSource replay(trace, &time);
+        ProcessMonitor monitor(nullptr, &time, &replay);
+        QStringList replayed;
+        logEvents(monitor, time, replayed);
+        monitor.startMonitor();
+
+        // Same polling phase, same events at the same times
+        time.advance(POLL);
+        QVERIFY(replay.parentPids({1}).isEmpty());
+        time.advance(POLL);
+        QCOMPARE(replay.parentPids({200, 201}).value(201), DWORD(1));
+        time.advance(5 * POLL);
+        QVERIFY(replay.finished());
+        QCOMPARE(replay.recordsApplied(), 4);
+        QCOMPARE(replay.runningCount(), 1);
+
+        // Starts found by the same poll come in hash order
+        recorded.sort();
+        replayed.sort();
+        QCOMPARE(replayed, recorded);
     }
 };
 
-QTEST_MAIN(TestProcessMonitor)
-#include "test_ProcessMonitor.moc"
\ No newline at end of file
+QTEST_GUILESS_MAIN(TestProcessMonitor)
+#include "test_ProcessMonitor.moc"
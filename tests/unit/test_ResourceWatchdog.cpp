@@ -0,0 +1,171 @@
+#include <QtTest/QtTest>
+#include "services/infrastructure/ResourceWatchdog.h"
+#include "services/logging/EventLogger.h"
+#include "services/metrics/Metrics.h"
+#include "../mocks/MockTimeSource.h"
+
+/**
+ * @class TestResourceWatchdog
+ * @brief Unit tests for the self-resource watchdog.
+ *
+ * Usage comes from a scripted sampler and time from a MockTimeSource, so
+ * each test sets exactly how much CPU and memory every sample sees. This
+ * class tests:
+ * 1. CPU use computed from the CPU time between samples.
+ * 2. Throttling only after THROTTLE_AFTER samples over budget in a row.
+ * 3. Recovery only after RECOVER_AFTER samples well within budget.
+ * 4. The memory budget, disabled budgets, and the transition metrics.
+ * 5. Usage read from this process.
+ */
+class TestResourceWatchdog : public QObject
+{
+    Q_OBJECT
+
+private:
+    static constexpr int INTERVAL = ResourceWatchdog::SAMPLE_INTERVAL_MS;
+    static constexpr qint64 MB = 1024 * 1024;
+
+    // Usage the next sample reports; advance() adds CPU time at cpuPercent
+    struct ScriptedUsage {
+        ProcessUtils::ResourceUsage usage{0, 10 * MB};
+        double cpuPercent = 0.0;
+
+        void advance(MockTimeSource& time, int samples = 1)
+        {
+            for (int i = 0; i < samples; ++i) {
+                usage.cpuNs += static_cast<qint64>(cpuPercent / 100.0 * INTERVAL * 1e6);
+                time.advance(INTERVAL);
+            }
+        }
+    };
+
+    static ResourceWatchdog::Budget budget(double cpuPercent, qint64 rssBytes)
+    {
+        ResourceWatchdog::Budget result;
+        result.cpuPercent = cpuPercent;
+        result.rssBytes = rssBytes;
+        return result;
+    }
+
+private slots:
+    void initTestCase() {
+        LogFilter::configure("*=info");
+    }
+
+    void test_cpu_percent() {
+        MockTimeSource time;
+        ScriptedUsage script;
+        ResourceWatchdog watchdog(budget(50.0, 0), &time, [&script]() { return script.usage; });
+        watchdog.start();
+        QCOMPARE(watchdog.cpuPercent(), -1.0);
+
+        script.cpuPercent = 12.5;
+        script.advance(time);
+        QVERIFY(qAbs(watchdog.cpuPercent() - 12.5) < 0.01);
+        QCOMPARE(watchdog.rssBytes(), 10 * MB);
+        QCOMPARE(MetricsRegistry::gauge("mindfulness_self_cpu_permille", "").value(), qint64(125));
+    }
+
+    void test_throttle_and_recover() {
+        MockTimeSource time;
+        ScriptedUsage script;
+        ResourceWatchdog watchdog(budget(2.0, 0), &time, [&script]() { return script.usage; });
+        QSignalSpy changed(&watchdog, &ResourceWatchdog::throttleChanged);
+        Counter& throttles = MetricsRegistry::counter("mindfulness_watchdog_throttles_total", "");
+        Counter& recoveries = MetricsRegistry::counter("mindfulness_watchdog_recoveries_total", "");
+        const quint64 throttlesBefore = throttles.value();
+        const quint64 recoveriesBefore = recoveries.value();
+        watchdog.start();
+
+        // A single spike is not enough
+        script.cpuPercent = 10.0;
+        script.advance(time);
+        script.cpuPercent = 1.0;
+        script.advance(time);
+        QVERIFY(!watchdog.isThrottled());
+
+        script.cpuPercent = 10.0;
+        script.advance(time, ResourceWatchdog::THROTTLE_AFTER);
+        QVERIFY(watchdog.isThrottled());
+        QCOMPARE(changed.count(), 1);
+        QCOMPARE(changed.at(0).at(0).toBool(), true);
+        QVERIFY(changed.at(0).at(1).toString().startsWith("CPU"));
+        QCOMPARE(throttles.value(), throttlesBefore + 1);
+        QCOMPARE(MetricsRegistry::gauge("mindfulness_watchdog_throttled", "").value(), qint64(1));
+
+        // Within budget, but not by RECOVER_FRACTION: still throttled
+        script.cpuPercent = 1.9;
+        script.advance(time, ResourceWatchdog::RECOVER_AFTER + 1);
+        QVERIFY(watchdog.isThrottled());
+
+        // Well within, but interrupted, then long enough
+        script.cpuPercent = 0.5;
+        script.advance(time, ResourceWatchdog::RECOVER_AFTER - 1);
+        script.cpuPercent = 1.9;
+        script.advance(time);
+        script.cpuPercent = 0.5;
+        script.advance(time, ResourceWatchdog::RECOVER_AFTER - 1);
+        QVERIFY(watchdog.isThrottled());
+        script.advance(time);
+        QVERIFY(!watchdog.isThrottled());
+
+        QCOMPARE(changed.count(), 2);
+        QCOMPARE(changed.at(1).at(0).toBool(), false);
+        QCOMPARE(recoveries.value(), recoveriesBefore + 1);
+        QCOMPARE(MetricsRegistry::gauge("mindfulness_watchdog_throttled", "").value(), qint64(0));
+    }
+
+    void test_memory_budget() {
+        MockTimeSource time;
+        ScriptedUsage script;
+        ResourceWatchdog watchdog(budget(0, 100 * MB), &time, [&script]() { return script.usage; });
+        QSignalSpy changed(&watchdog, &ResourceWatchdog::throttleChanged);
+        watchdog.start();
+
+        // No CPU budget, so any CPU use is fine
+        script.cpuPercent = 90.0;
+        script.advance(time, 5);
+        QVERIFY(!watchdog.isThrottled());
+
+        script.usage.rssBytes = 150 * MB;
+        script.advance(time, ResourceWatchdog::THROTTLE_AFTER);
+        QVERIFY(watchdog.isThrottled());
+        QVERIFY(changed.at(0).at(1).toString().startsWith("RSS"));
+
+        script.usage.rssBytes = 80 * MB;
+        script.advance(time, ResourceWatchdog::RECOVER_AFTER);
+        QVERIFY(watchdog.isThrottled());
+        script.usage.rssBytes = 60 * MB;
+        script.advance(time, ResourceWatchdog::RECOVER_AFTER);
+        QVERIFY(!watchdog.isThrottled());
+        QCOMPARE(changed.count(), 2);
+    }
+
+    void test_stop() {
+        MockTimeSource time;
+        int samples = 0;
+        ResourceWatchdog watchdog(ResourceWatchdog::Budget(), &time, [&samples]() {
+            ++samples;
+            return ProcessUtils::ResourceUsage();
+        });
+        watchdog.start();
+        time.advance(2 * INTERVAL);
+        QCOMPARE(samples, 3);
+
+        watchdog.stop();
+        time.advance(2 * INTERVAL);
+        QCOMPARE(samples, 3);
+    }
+
+    void test_self_usage() {
+#if !defined(Q_OS_LINUX) && !defined(Q_OS_WIN)
+        QSKIP("No resource usage on this platform");
+#endif
+        const ProcessUtils::ResourceUsage usage = ProcessUtils::selfResourceUsage();
+        QVERIFY(usage.cpuNs >= 0);
+        QVERIFY(usage.rssBytes > 0);
+    }
+};
+
+QTEST_GUILESS_MAIN(TestResourceWatchdog)
+#include "test_ResourceWatchdog.moc"
@@ -0,0 +1,204 @@
+#include <QtTest/QtTest>
+#include "repositories/SessionHistoryStore.h"
+#include <QDir>
+#include <QFile>
+#include <QTemporaryDir>
+
+/**
+ * @class TestSessionHistoryStore
+ * @brief Unit tests for the day-partitioned session history.
+ *
+ * This class tests:
+ * 1. Persistent app keys, and none handed out that could not be saved.
+ * 2. Sealing a day's journal into a segment when the next day starts.
+ * 3. Reopening: segments, the open journal and a torn journal record.
+ * 4. Range queries, including sessions that cross the range edges.
+ * 5. Records for an already sealed day (clock set back).
+ */
+class TestSessionHistoryStore : public QObject
+{
+    Q_OBJECT
+
+private:
+    static constexpr qint64 DAY = SessionHistoryStore::SECONDS_PER_DAY;
+    static constexpr qint64 BASE = 20000 * DAY; // Midnight UTC, 2024-10-04
+
+    static SessionRecord session(quint32 appKey, qint64 start, qint64 end,
+                                 SessionRecord::Termination reason = SessionRecord::Termination::ProcessExited)
+    {
+        SessionRecord record;
+        record.appKey = appKey;
+        record.start = start;
+        record.end = end;
+        record.activeSeconds = static_cast<quint32>(end - start);
+        record.reason = reason;
+        return record;
+    }
+
+    static QList<SessionRecord> collect(const SessionHistoryStore& store, qint64 from, qint64 to)
+    {
+        QList<SessionRecord> records;
+        store.forEachInRange(from, to, [&records](const SessionRecord& record) {
+            records.append(record);
+        });
+        return records;
+    }
+
+private slots:
+    void test_app_keys_persist() {
+        QTemporaryDir dir;
+        {
+            SessionHistoryStore store(dir.path());
+            QCOMPARE(store.appKey("Game.exe"), 0u);
+            QCOMPARE(store.appKey("other.exe"), 1u);
+            QCOMPARE(store.appKey("game.exe"), 0u);
+            QCOMPARE(store.findAppKey("missing.exe"), SessionHistoryStore::ALL_APPS);
+        }
+
+        SessionHistoryStore reopened(dir.path());
+        QCOMPARE(reopened.findAppKey("GAME.EXE"), 0u);
+        QCOMPARE(reopened.processName(1), QString("other.exe"));
+    }
+
+    void test_app_key_not_assigned_when_unsaved() {
+        QTemporaryDir dir;
+        const QString keysPath = QDir(dir.path()).filePath("apps.txt");
+        {
+            // A directory in the way of the key file makes every write fail
+            SessionHistoryStore store(dir.path());
+            QVERIFY(QDir().mkdir(keysPath));
+            QCOMPARE(store.appKey("game.exe"), SessionHistoryStore::ALL_APPS);
+            QCOMPARE(store.findAppKey("game.exe"), SessionHistoryStore::ALL_APPS);
+
+            QVERIFY(QDir().rmdir(keysPath));
+            QCOMPARE(store.appKey("other.exe"), 0u);
+            QCOMPARE(store.appKey("game.exe"), 1u);
+        }
+
+        SessionHistoryStore reopened(dir.path());
+        QCOMPARE(reopened.findAppKey("other.exe"), 0u);
+        QCOMPARE(reopened.findAppKey("game.exe"), 1u);
+    }
+
+    void test_days_are_sealed_and_reopened() {
+        QTemporaryDir dir;
+        {
+            SessionHistoryStore store(dir.path());
+            QVERIFY(store.append(session(0, BASE + 100, BASE + 3700)));
+            QVERIFY(store.append(session(1, BASE + 5000, BASE + 6000, SessionRecord::Termination::TimeLimitReached)));
+            QCOMPARE(store.partitionCount(), 1);
+
+            // The first record of the next day seals the previous journal
+            QVERIFY(store.append(session(0, DAY + BASE + 10, DAY + BASE + 610)));
+            QCOMPARE(store.partitionCount(), 2);
+            QVERIFY(QFile::exists(QDir(dir.path()).filePath("2024-10-04.seg")));
+            QVERIFY(!QFile::exists(QDir(dir.path()).filePath("2024-10-04.wal")));
+        }
+
+        SessionHistoryStore store(dir.path());
+        QCOMPARE(store.recordCount(), qint64(3));
+
+        QList<SessionRecord> all = collect(store, BASE, BASE + 2 * DAY);
+        QCOMPARE(all.size(), 3);
+        QCOMPARE(all[1].appKey, 1u);
+        QCOMPARE(all[1].start, BASE + 5000);
+        QCOMPARE(all[1].end, BASE + 6000);
+        QCOMPARE(all[1].activeSeconds, 1000u);
+        QVERIFY(all[1].reason == SessionRecord::Termination::TimeLimitReached);
+        QCOMPARE(all[2].start, DAY + BASE + 10);
+    }
+
+    void test_range_queries_clip_sessions() {
+        QTemporaryDir dir;
+        SessionHistoryStore store(dir.path());
+
+        // Crosses midnight: stored under the day it ended
+        store.append(session(0, BASE - 1800, BASE + 1800));
+        store.append(session(1, BASE + 7200, BASE + 9000));
+        store.append(session(0, DAY + BASE, DAY + BASE + 600));
+
+        QCOMPARE(collect(store, BASE, BASE + DAY).size(), 2);
+        QCOMPARE(collect(store, BASE + 1800, BASE + 7200).size(), 0);
+        QCOMPARE(collect(store, BASE - DAY, BASE).size(), 1);
+
+        SessionHistoryStore::Totals today = store.totals(BASE, BASE + DAY, 0);
+        QCOMPARE(today.sessions, 1);
+        QCOMPARE(today.activeSeconds, qint64(1800)); // Half of the hour before midnight
+
+        SessionHistoryStore::Totals everything = store.totals(BASE - DAY, BASE + 2 * DAY);
+        QCOMPARE(everything.sessions, 3);
+        QCOMPARE(everything.activeSeconds, qint64(3600 + 1800 + 600));
+    }
+
+    void test_torn_journal_record_is_dropped() {
+        QTemporaryDir dir;
+        {
+            SessionHistoryStore store(dir.path());
+            store.append(session(0, BASE + 10, BASE + 20));
+            store.append(session(0, BASE + 30, BASE + 40));
+        }
+
+        QFile journal(QDir(dir.path()).filePath("2024-10-04.wal"));
+        QVERIFY(journal.open(QIODevice::ReadWrite));
+        QVERIFY(journal.resize(journal.size() - 5));
+        journal.close();
+
+        {
+            SessionHistoryStore store(dir.path());
+            QCOMPARE(store.recordCount(), qint64(1));
+            QVERIFY(store.append(session(1, BASE + 50, BASE + 60, SessionRecord::Termination::Abandoned)));
+            QCOMPARE(collect(store, BASE, BASE + DAY).size(), 2);
+        }
+
+        // The torn bytes were cut off, so the record appended after them
+        // reads back intact
+        SessionHistoryStore store(dir.path());
+        QCOMPARE(journal.size(), qint64(2 * 32));
+        const QList<SessionRecord> records = collect(store, BASE, BASE + DAY);
+        const QList<SessionRecord> expected = {
+            session(0, BASE + 10, BASE + 20),
+            session(1, BASE + 50, BASE + 60, SessionRecord::Termination::Abandoned)
+        };
+        QCOMPARE(records.size(), expected.size());
+        for (int i = 0; i < expected.size(); ++i) {
+            QCOMPARE(records[i].appKey, expected[i].appKey);
+            QCOMPARE(records[i].start, expected[i].start);
+            QCOMPARE(records[i].end, expected[i].end);
+            QCOMPARE(records[i].activeSeconds, expected[i].activeSeconds);
+            QCOMPARE(records[i].reason, expected[i].reason);
+        }
+    }
+
+    void test_late_records_stay_queryable() {
+        QTemporaryDir dir;
+        {
+            SessionHistoryStore store(dir.path());
+            store.append(session(0, BASE + 10, BASE + 20));
+            store.append(session(0, DAY + BASE + 10, DAY + BASE + 20));
+
+            // Clock set back: the record joins the journal of day 1
+            store.append(session(1, BASE + 100, BASE + 200));
+            QCOMPARE(collect(store, BASE, BASE + DAY).size(), 2);
+            store.append(session(2, 2 * DAY + BASE, 2 * DAY + BASE + 5));
+        }
+
+        // Without an open journal, a record for day 0 reopens that day, and
+        // sealing it again merges with the existing segment
+        QVERIFY(QFile::remove(QDir(dir.path()).filePath("2024-10-06.wal")));
+        {
+            SessionHistoryStore store(dir.path());
+            QCOMPARE(store.recordCount(), qint64(3));
+            store.append(session(3, BASE + 300, BASE + 400));
+            store.append(session(3, 3 * DAY + BASE, 3 * DAY + BASE + 5));
+        }
+
+        SessionHistoryStore store(dir.path());
+        QCOMPARE(store.recordCount(), qint64(5));
+        QCOMPARE(collect(store, BASE, BASE + DAY).size(), 3);
+        QCOMPARE(store.totals(BASE, BASE + 4 * DAY, 3).sessions, 2);
+        QCOMPARE(store.totals(BASE, BASE + 4 * DAY, 1).sessions, 1);
+    }
+};
+
+QTEST_MAIN(TestSessionHistoryStore)
+#include "test_SessionHistoryStore.moc"
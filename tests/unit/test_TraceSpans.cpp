@@ -0,0 +1,156 @@
+#include <QtTest/QtTest>
+#include "services/metrics/TraceSpans.h"
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTemporaryDir>
+#include <thread>
+
+/**
+ * @class TestTraceSpans
+ * @brief Unit tests for the span tracer and its Chrome trace-event export.
+ *
+ * This class tests:
+ * 1. Nothing being recorded while tracing is off.
+ * 2. Nested spans and flows on two threads, exported as valid trace JSON.
+ * 3. The per-thread ring keeping only the newest events.
+ * 4. Exporting only a recent window.
+ */
+class TestTraceSpans : public QObject
+{
+    Q_OBJECT
+
+private:
+    static QJsonArray events(qint64 windowNs = 0) {
+        QJsonParseError error;
+        const QJsonDocument document = QJsonDocument::fromJson(SpanTracer::toChromeJson(windowNs), &error);
+        if (error.error != QJsonParseError::NoError) {
+            qWarning() << error.errorString();
+            return QJsonArray();
+        }
+        return document.object().value("traceEvents").toArray();
+    }
+
+    static int countNamed(const QJsonArray& array, const QString& name, const QString& phase) {
+        int count = 0;
+        for (const QJsonValue& value : array) {
+            const QJsonObject event = value.toObject();
+            if (event.value("name").toString() == name && event.value("ph").toString() == phase) {
+                ++count;
+            }
+        }
+        return count;
+    }
+
+private slots:
+    void init() {
+        SpanTracer::clear();
+        SpanTracer::setEnabled(false);
+    }
+
+    void cleanupTestCase() {
+        SpanTracer::setEnabled(false);
+    }
+
+    void test_disabled_records_nothing() {
+        {
+            MF_TRACE_SPAN("disabled span");
+            MF_TRACE_FLOW_BEGIN("disabled flow", 1);
+        }
+        const QJsonArray array = events();
+        QCOMPARE(countNamed(array, "disabled span", "X"), 0);
+        QCOMPARE(countNamed(array, "disabled flow", "s"), 0);
+    }
+
+    void test_spans_and_flows_across_threads() {
+        SpanTracer::setThreadName("main");
+        SpanTracer::setEnabled(true);
+
+        std::thread monitor([]() {
+            SpanTracer::setThreadName("monitor");
+            MF_TRACE_SPAN("tick");
+            {
+                MF_TRACE_SPAN("enumerate");
+            }
+            MF_TRACE_FLOW_BEGIN("handoff", 42);
+        });
+        monitor.join();
+        {
+            MF_TRACE_SPAN("dispatch");
+            MF_TRACE_FLOW_END("handoff", 42);
+        }
+
+        const QJsonArray array = events();
+        QCOMPARE(countNamed(array, "tick", "X"), 1);
+        QCOMPARE(countNamed(array, "enumerate", "X"), 1);
+        QCOMPARE(countNamed(array, "dispatch", "X"), 1);
+        QCOMPARE(countNamed(array, "handoff", "s"), 1);
+        QCOMPARE(countNamed(array, "handoff", "f"), 1);
+
+        // Thread names, and the nested span inside its parent on the same thread
+        QHash<int, QString> threadNames;
+        QJsonObject tick;
+        QJsonObject enumerate;
+        QJsonObject dispatch;
+        for (const QJsonValue& value : array) {
+            const QJsonObject event = value.toObject();
+            const QString name = event.value("name").toString();
+            if (event.value("ph").toString() == "M") {
+                threadNames.insert(event.value("tid").toInt(), event.value("args").toObject().value("name").toString());
+            } else if (name == "tick") {
+                tick = event;
+            } else if (name == "enumerate") {
+                enumerate = event;
+            } else if (name == "dispatch") {
+                dispatch = event;
+            }
+        }
+        QCOMPARE(threadNames.value(tick.value("tid").toInt()), QString("monitor"));
+        QCOMPARE(threadNames.value(dispatch.value("tid").toInt()), QString("main"));
+        QCOMPARE(enumerate.value("tid").toInt(), tick.value("tid").toInt());
+        QVERIFY(enumerate.value("ts").toDouble() >= tick.value("ts").toDouble());
+        QVERIFY(enumerate.value("ts").toDouble() + enumerate.value("dur").toDouble()
+                <= tick.value("ts").toDouble() + tick.value("dur").toDouble());
+        QVERIFY(dispatch.value("ts").toDouble() >= tick.value("ts").toDouble());
+    }
+
+    void test_ring_keeps_newest() {
+        SpanTracer::setEnabled(true);
+        const int total = SpanTracer::THREAD_CAPACITY + 100;
+        for (int i = 0; i < total; ++i) {
+            const char* name = i < 100 ? "oldest" : "newest";
+            MF_TRACE_SPAN(name);
+        }
+        const QJsonArray array = events();
+        QCOMPARE(countNamed(array, "oldest", "X"), 0);
+        QCOMPARE(countNamed(array, "newest", "X"), SpanTracer::THREAD_CAPACITY);
+    }
+
+    void test_window_and_file() {
+        SpanTracer::setEnabled(true);
+        {
+            MF_TRACE_SPAN("old");
+        }
+        QTest::qWait(50);
+        {
+            MF_TRACE_SPAN("recent");
+        }
+
+        const QJsonArray recent = events(20 * 1000000);
+        QCOMPARE(countNamed(recent, "old", "X"), 0);
+        QCOMPARE(countNamed(recent, "recent", "X"), 1);
+
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        const QString path = dir.filePath("trace.json");
+        QVERIFY(SpanTracer::writeChromeTrace(path));
+        QFile file(path);
+        QVERIFY(file.open(QIODevice::ReadOnly));
+        const QJsonArray all = QJsonDocument::fromJson(file.readAll()).object().value("traceEvents").toArray();
+        QCOMPARE(countNamed(all, "old", "X"), 1);
+        QCOMPARE(countNamed(all, "recent", "X"), 1);
+    }
+};
+
+QTEST_GUILESS_MAIN(TestTraceSpans)
+#include "test_TraceSpans.moc"
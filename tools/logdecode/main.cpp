@@ -0,0 +1,53 @@
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QTextStream>
+#include "StructuredLog.h"
+#include <cstdio>
+
+/**
+ * mindfulness_logdecode: renders a binary log written by EventLogger
+ * (MINDFULNESS_BINARY_LOG) as the text log lines, or as one JSON object
+ * per line with --json.
+ */
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("mindfulness_logdecode");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Render a Mindfulness binary log");
+    parser.addHelpOption();
+    parser.addOption(QCommandLineOption("json", "One JSON object per event instead of text lines"));
+    parser.addPositionalArgument("file", "Binary log to read");
+    parser.process(app);
+
+    const QStringList files = parser.positionalArguments();
+    if (files.size() != 1) {
+        parser.showHelp(1);
+    }
+
+    StructuredLogReader reader;
+    if (!reader.open(files.first())) {
+        fprintf(stderr, "%s\n", qPrintable(reader.errorString()));
+        return 1;
+    }
+
+    const bool json = parser.isSet("json");
+    QTextStream out(stdout);
+    StructuredLogReader::Event event;
+    while (reader.next(event)) {
+        if (json) {
+            out << StructuredLogReader::toJson(event) << '\n';
+        } else {
+            out << StructuredLogReader::toText(event) << '\n';
+        }
+    }
+    out.flush();
+
+    // A log cut short by a crash still renders up to the damage
+    if (reader.isDamaged()) {
+        fprintf(stderr, "%s\n", qPrintable(reader.errorString()));
+        return 2;
+    }
+    return 0;
+}